@@ -0,0 +1,125 @@
+;; A call-heavy benchmark of recursive calls that return multiple values: $tree makes 2^26 calls,
+;; each of which returns (i64 i32 f64 f64), so it measures the cost of returning several values
+;; from a call.
+
+(module
+	(import "wasi_unstable" "fd_write" (func $wasi_fd_write (param i32 i32 i32 i32) (result i32)))
+	(import "wasi_unstable" "proc_exit" (func $wasi_proc_exit (param i32)))
+	(memory (export "memory") 1)
+
+	(global $treeDepth i32 (i32.const 25))
+
+	(global $outputIOVecAddress i32 (i32.const 0))		;; 8 byte iovec
+	(global $outputStringAddress i32 (i32.const 16))	;; 128 byte output string
+
+	;; Walks a complete binary tree of the given depth, returning the number of nodes, the depth of
+	;; the tree, the weight of the root node, and the sum of the heights of all nodes.
+	(func $tree (param $depth i32) (result i64 i32 f64 f64)
+		(local $leftNodes i64)
+		(local $leftDepth i32)
+		(local $leftWeight f64)
+		(local $leftSum f64)
+		(local $rightNodes i64)
+		(local $rightDepth i32)
+		(local $rightWeight f64)
+		(local $rightSum f64)
+
+		(if (i32.eqz (local.get $depth))
+			(then (return (i64.const 1) (i32.const 0) (f64.const 1) (f64.const 0))))
+
+		(call $tree (i32.sub (local.get $depth) (i32.const 1)))
+		(local.set $leftSum)
+		(local.set $leftWeight)
+		(local.set $leftDepth)
+		(local.set $leftNodes)
+
+		(call $tree (i32.sub (local.get $depth) (i32.const 1)))
+		(local.set $rightSum)
+		(local.set $rightWeight)
+		(local.set $rightDepth)
+		(local.set $rightNodes)
+
+		(i64.add (i64.add (local.get $leftNodes) (local.get $rightNodes)) (i64.const 1))
+		(i32.add
+			(select (local.get $leftDepth) (local.get $rightDepth)
+				(i32.gt_u (local.get $leftDepth) (local.get $rightDepth)))
+			(i32.const 1))
+		(f64.add
+			(f64.mul (f64.add (local.get $leftWeight) (local.get $rightWeight)) (f64.const 0.5))
+			(f64.const 1))
+		(f64.add
+			(f64.add (local.get $leftSum) (local.get $rightSum))
+			(f64.convert_i32_u (local.get $depth)))
+	)
+
+	;; Writes the decimal representation of a number followed by a newline at the given address,
+	;; and returns the address following it.
+	(func $writeNumber (param $address i32) (param $value i64) (result i32)
+		(local $numDigits i32)
+		(local $remaining i64)
+		(local $end i32)
+
+		;; Count the digits.
+		(local.set $remaining (local.get $value))
+		loop $countLoop
+			(local.set $numDigits (i32.add (local.get $numDigits) (i32.const 1)))
+			(local.set $remaining (i64.div_u (local.get $remaining) (i64.const 10)))
+			(br_if $countLoop (i64.ne (local.get $remaining) (i64.const 0)))
+		end
+
+		;; Write the newline, then the digits from least to most significant.
+		(local.set $end (i32.add (local.get $address) (local.get $numDigits)))
+		(i32.store8 (local.get $end) (i32.const 10))
+		(local.set $remaining (local.get $value))
+		loop $digitLoop
+			(local.set $numDigits (i32.sub (local.get $numDigits) (i32.const 1)))
+			(i32.store8
+				(i32.add (local.get $address) (local.get $numDigits))
+				(i32.add
+					(i32.wrap_i64 (i64.rem_u (local.get $remaining) (i64.const 10)))
+					(i32.const 48)))
+			(local.set $remaining (i64.div_u (local.get $remaining) (i64.const 10)))
+			(br_if $digitLoop (i32.ne (local.get $numDigits) (i32.const 0)))
+		end
+
+		(i32.add (local.get $end) (i32.const 1))
+	)
+
+	(func $main (export "_start")
+		(local $nodes i64)
+		(local $depth i32)
+		(local $weight f64)
+		(local $sum f64)
+		(local $address i32)
+
+		(call $tree (global.get $treeDepth))
+		(local.set $sum)
+		(local.set $weight)
+		(local.set $depth)
+		(local.set $nodes)
+
+		;; Print the results, one per line.
+		(local.set $address (global.get $outputStringAddress))
+		(local.set $address (call $writeNumber (local.get $address) (local.get $nodes)))
+		(local.set $address
+			(call $writeNumber (local.get $address) (i64.extend_i32_u (local.get $depth))))
+		(local.set $address
+			(call $writeNumber (local.get $address) (i64.trunc_f64_u (local.get $weight))))
+		(local.set $address
+			(call $writeNumber (local.get $address) (i64.trunc_f64_u (local.get $sum))))
+
+		(i32.store (global.get $outputIOVecAddress) (global.get $outputStringAddress))
+		(i32.store offset=4
+			(global.get $outputIOVecAddress)
+			(i32.sub (local.get $address) (global.get $outputStringAddress)))
+		(call $wasi_fd_write
+			(i32.const 1)                                            ;; fd 1
+			(global.get $outputIOVecAddress)                         ;; iovec address
+			(i32.const 1)                                            ;; 1 iovec
+			(i32.add (global.get $outputIOVecAddress) (i32.const 4)) ;; write the number of written bytes back to the iovec buf_len.
+		)
+
+		;; Pass the result of wasi_fd_write to wasi_proc_exit
+		call $wasi_proc_exit
+	)
+)
@@ -17,6 +17,7 @@ from lib.coverage import register_merge_coverage
 from lib.fuzz import register_fuzz_commands
 from lib.run import register_run
 from lib.test import register_test, register_test_install
+from lib.simd_audit import register_simd_audit
 from lib.tidy import register_tidy
 from lib.workspace import register_setup_workspace
 
@@ -91,6 +92,7 @@ def main() -> int:
     register_list_configs(subparsers)
     register_fuzz_commands(subparsers)
     register_benchmark_commands(subparsers)
+    register_simd_audit(subparsers)
     register_run(subparsers)
 
     args = parser.parse_args()
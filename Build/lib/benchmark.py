@@ -50,6 +50,9 @@ BENCHMARK_PROGRAMS: list[BenchmarkProgram] = [
     BenchmarkProgram(name="blake2b-memory64", path="Benchmarks/blake2b-memory64.wast",
                      wavm_run_args=["--abi=wasi", "--enable", "memory64"],
                      expected_output=_BLAKE2B_HASH),
+    BenchmarkProgram(name="multi-value-calls", path="Benchmarks/multi-value-calls.wast",
+                     wavm_run_args=["--abi=wasi"],
+                     expected_output=r"67108863\n25\n26\n67108837"),
     BenchmarkProgram(name="zlib", path="Benchmarks/zlib.wasm",
                      expected_output=r"sizes: 100000,25906\nok\."),
     BenchmarkProgram(name="coremark", path="Benchmarks/coremark.wasm",
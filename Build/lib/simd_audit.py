@@ -0,0 +1,421 @@
+"""SIMD codegen audit: compiles every SIMD operator for several targets and reports its cost."""
+
+import argparse
+import json
+import re
+import shutil
+import tempfile
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Optional
+
+from .build import build_single_config
+from .context import CommandContext
+from .output import output
+from .platform import get_wavm_bin_path, run_command
+
+
+# =============================================================================
+# Target Definitions
+# =============================================================================
+
+
+@dataclass
+class AuditTarget:
+    """A target to compile the SIMD operators for."""
+
+    name: str
+    wavm_compile_args: list[str]
+    mca_args: list[str] = field(default_factory=list)  # Arguments passed to llvm-mca
+
+
+AUDIT_TARGETS: list[AuditTarget] = [
+    AuditTarget(
+        name="x86_64-sse4.1",
+        wavm_compile_args=["--target-arch", "x86_64", "--target-os", "linux",
+                           "--target-cpu", "x86-64",
+                           "--target-cpu-feature", "+sse3,+ssse3,+sse4.1"],
+        mca_args=["-mtriple=x86_64-linux", "-mcpu=nehalem"],
+    ),
+    AuditTarget(
+        name="x86_64-avx2",
+        wavm_compile_args=["--target-arch", "x86_64", "--target-os", "linux",
+                           "--target-cpu", "haswell"],
+        mca_args=["-mtriple=x86_64-linux", "-mcpu=haswell"],
+    ),
+    AuditTarget(
+        name="x86_64-avx512",
+        wavm_compile_args=["--target-arch", "x86_64", "--target-os", "linux",
+                           "--target-cpu", "skylake-avx512"],
+        mca_args=["-mtriple=x86_64-linux", "-mcpu=skylake-avx512"],
+    ),
+    AuditTarget(
+        name="aarch64",
+        wavm_compile_args=["--target-arch", "aarch64", "--target-os", "linux",
+                           "--target-cpu", "neoverse-n1"],
+        mca_args=["-mtriple=aarch64-linux", "-mcpu=neoverse-n1"],
+    ),
+]
+
+
+# =============================================================================
+# Operator Table Parsing and Module Generation
+# =============================================================================
+
+
+@dataclass
+class SimdOperator:
+    """A SIMD operator parsed from Include/WAVM/IR/OperatorTable.h."""
+
+    opcode: int
+    name: str  # The WAST name, e.g. "i8x16.swizzle"
+    imm: str
+    signature: str
+    feature: str
+
+
+_OPERATOR_RE = re.compile(
+    r"^\s*visitOp\(\s*(0x[0-9a-fA-F]+)\s*,\s*\w+\s*,\s*\"([^\"]+)\"\s*,\s*([^,]+?)\s*,\s*(\w+)\s*,"
+    r"\s*(\w+)\s*\)",
+    re.MULTILINE,
+)
+
+# The parameter and result types of the functions that wrap operators with each signature.
+_SIGNATURE_TYPES: dict[str, tuple[list[str], list[str]]] = {
+    "none_to_v128": ([], ["v128"]),
+    "i32_to_v128": (["i32"], ["v128"]),
+    "i64_to_v128": (["i64"], ["v128"]),
+    "f32_to_v128": (["f32"], ["v128"]),
+    "f64_to_v128": (["f64"], ["v128"]),
+    "v128_to_v128": (["v128"], ["v128"]),
+    "v128_to_i32": (["v128"], ["i32"]),
+    "v128_to_i64": (["v128"], ["i64"]),
+    "v128_to_f32": (["v128"], ["f32"]),
+    "v128_to_f64": (["v128"], ["f64"]),
+    "v128_i32_to_v128": (["v128", "i32"], ["v128"]),
+    "v128_i64_to_v128": (["v128", "i64"], ["v128"]),
+    "v128_f32_to_v128": (["v128", "f32"], ["v128"]),
+    "v128_f64_to_v128": (["v128", "f64"], ["v128"]),
+    "v128_v128_to_v128": (["v128", "v128"], ["v128"]),
+    "v128_v128_v128_to_v128": (["v128", "v128", "v128"], ["v128"]),
+    "load_v128": (["i32"], ["v128"]),
+    "store_v128": (["i32", "v128"], []),
+    "load_v128_lane": (["i32", "v128"], ["v128"]),
+    "store_v128_lane": (["i32", "v128"], []),
+}
+
+_SHUFFLE_LANES = "0 17 2 19 4 21 6 23 8 25 10 27 12 29 14 31"
+
+
+def parse_simd_operators(source_dir: Path, features: tuple[str, ...]) -> list[SimdOperator]:
+    """Parse the operators with one of the given features from the operator table.
+
+    Operators that are commented out of the table aren't matched.
+    """
+    table = (source_dir / "Include" / "WAVM" / "IR" / "OperatorTable.h").read_text()
+    operators = []
+    for match in _OPERATOR_RE.finditer(table):
+        opcode, name, imm, signature, feature = match.groups()
+        if feature in features and signature in _SIGNATURE_TYPES:
+            operators.append(SimdOperator(int(opcode, 16), name, imm, signature, feature))
+    return operators
+
+
+def _get_imm_text(imm: str) -> str:
+    if imm.startswith("LaneIndexImm") or imm.endswith("LaneImm"):
+        return " 0"
+    if imm.startswith("ShuffleImm"):
+        return " " + _SHUFFLE_LANES
+    if imm.startswith("LiteralImm"):
+        return " i32x4 1 2 3 4"
+    return ""
+
+
+def generate_audit_module(operators: list[SimdOperator]) -> str:
+    """Generate a WAST module with one function per operator, in the order of the operators.
+
+    Each function passes its parameters straight to the operator, so the code generated for it is
+    the operator's lowering plus the function's prologue and epilogue.
+    """
+    lines = ["(module", "  (memory 1)"]
+    for op in operators:
+        params, results = _SIGNATURE_TYPES[op.signature]
+        param_text = "".join(f" (param {t})" for t in params)
+        result_text = "".join(f" (result {t})" for t in results)
+        body = "".join(f" (local.get {i})" for i in range(len(params)))
+        lines.append(f"  (func{param_text}{result_text}{body} ({op.name}{_get_imm_text(op.imm)}))")
+    lines.append(")")
+    return "\n".join(lines) + "\n"
+
+
+# =============================================================================
+# Compilation and Measurement
+# =============================================================================
+
+
+_SYMBOL_RE = re.compile(r"^functionDef(\d+): #")
+
+
+def parse_disassembly(assembly: str) -> dict[int, list[str]]:
+    """Split the output of `wavm compile --format=assembly` into instructions per function def."""
+    functions: dict[int, list[str]] = {}
+    current: Optional[list[str]] = None
+    for line in assembly.splitlines():
+        match = _SYMBOL_RE.match(line)
+        if match:
+            current = functions.setdefault(int(match.group(1)), [])
+        elif not line.strip() or not line[0].isspace():
+            current = None
+        elif current is not None and not line.strip().startswith("#"):
+            current.append(line.strip())
+    return functions
+
+
+_MCA_TOTAL_CYCLES_RE = re.compile(r"^Total Cycles:\s+(\d+)", re.MULTILINE)
+
+
+def estimate_cycles(llvm_mca: str, target: AuditTarget, instructions: list[str]) -> Optional[int]:
+    """Estimate the latency of a sequence of instructions with llvm-mca."""
+    with tempfile.NamedTemporaryFile("w", suffix=".s", delete=False) as asm_file:
+        asm_file.write("\n".join(instructions) + "\n")
+    try:
+        result = run_command([llvm_mca, *target.mca_args, "-iterations=1", asm_file.name])
+    finally:
+        Path(asm_file.name).unlink()
+    if result.returncode != 0:
+        return None
+    match = _MCA_TOTAL_CYCLES_RE.search(result.stdout)
+    return int(match.group(1)) if match else None
+
+
+def audit_target(
+    wavm_bin: Path,
+    wast_path: Path,
+    target: AuditTarget,
+    operators: list[SimdOperator],
+    llvm_mca: Optional[str],
+) -> Optional[dict[str, dict]]:
+    """Compile the audit module for a target, and return the cost of each operator."""
+    output.status(f"Compiling SIMD operators for {target.name}...")
+    asm_path = wast_path.with_suffix(f".{target.name}.s")
+    result = run_command([
+        wavm_bin, "compile", *target.wavm_compile_args,
+        "--enable", "all", "--format=assembly",
+        wast_path, asm_path,
+    ])
+    output.clear_status()
+    if result.returncode != 0:
+        output.error(f"Failed to compile for {target.name}:\n{result.output}")
+        return None
+
+    functions = parse_disassembly(asm_path.read_text())
+    costs: dict[str, dict] = {}
+    for index, op in enumerate(operators):
+        instructions = functions.get(index, [])
+        cost: dict = {"instructions": len(instructions)}
+        if llvm_mca and instructions:
+            cost["cycles"] = estimate_cycles(llvm_mca, target, instructions)
+        costs[op.name] = cost
+    return costs
+
+
+# =============================================================================
+# Results
+# =============================================================================
+
+
+def _get_results_dir(work_dir: Path) -> Path:
+    return work_dir / "simd_audit_results"
+
+
+def save_results(work_dir: Path, name: str, results: dict) -> Path:
+    """Save audit results to a JSON file."""
+    results_dir = _get_results_dir(work_dir)
+    results_dir.mkdir(parents=True, exist_ok=True)
+    path = results_dir / f"{name}.json"
+    path.write_text(json.dumps(results, indent=2))
+    output.print(f"Results saved to {path}")
+    return path
+
+
+def load_results(work_dir: Path, name: str) -> Optional[dict]:
+    """Load audit results from a JSON file."""
+    path = _get_results_dir(work_dir) / f"{name}.json"
+    if not path.exists():
+        output.error(f"Baseline not found: {path}")
+        return None
+    try:
+        return json.loads(path.read_text())
+    except (json.JSONDecodeError, IOError) as e:
+        output.error(f"Failed to load baseline: {e}")
+        return None
+
+
+def _format_cost(cost: Optional[dict]) -> str:
+    if cost is None:
+        return "-"
+    text = str(cost["instructions"])
+    if cost.get("cycles") is not None:
+        text += f"/{cost['cycles']}c"
+    return text
+
+
+def print_results(results: dict[str, dict[str, dict]], worst: Optional[int]) -> None:
+    """Print a table of the cost of each operator on each target.
+
+    If worst is given, only the operators with the highest instruction count on any target are
+    printed.
+    """
+    target_names = list(results.keys())
+    op_names = list(next(iter(results.values())).keys()) if results else []
+    if worst is not None:
+        op_names.sort(
+            key=lambda op: max(results[t].get(op, {}).get("instructions", 0) for t in target_names),
+            reverse=True,
+        )
+        op_names = op_names[:worst]
+
+    name_width = max([len(op) for op in op_names] + [8])
+    col_width = max([len(t) for t in target_names] + [10])
+    output.print(f"{'Operator':<{name_width}}  "
+                 + "  ".join(f"{t:>{col_width}}" for t in target_names))
+    output.print("-" * (name_width + (col_width + 2) * len(target_names)))
+    for op in op_names:
+        output.print(f"{op:<{name_width}}  " + "  ".join(
+            f"{_format_cost(results[t].get(op)):>{col_width}}" for t in target_names))
+
+
+def compare_results(results: dict, baseline: dict) -> list[str]:
+    """Compare results against a baseline, and return a description of each regression.
+
+    An operator regresses on a target if it compiles to more instructions than in the baseline.
+    """
+    regressions = []
+    for target_name, costs in results.items():
+        baseline_costs = baseline.get(target_name, {})
+        for op_name, cost in costs.items():
+            baseline_cost = baseline_costs.get(op_name)
+            if baseline_cost and cost["instructions"] > baseline_cost["instructions"]:
+                regressions.append(
+                    f"{target_name} {op_name}: {baseline_cost['instructions']} -> "
+                    f"{cost['instructions']} instructions"
+                )
+    return regressions
+
+
+# =============================================================================
+# Command
+# =============================================================================
+
+
+def cmd_simd_audit(args: argparse.Namespace, ctx: CommandContext) -> int:
+    """Compile every SIMD operator for each audit target, and report what it costs."""
+    targets = AUDIT_TARGETS
+    if args.target:
+        targets = [t for t in AUDIT_TARGETS if t.name in args.target]
+        unknown = set(args.target) - {t.name for t in targets}
+        if unknown:
+            output.error(f"Unknown target(s): {sorted(unknown)}")
+            output.error(f"Available: {[t.name for t in AUDIT_TARGETS]}")
+            return 1
+
+    operators = parse_simd_operators(ctx.source_dir, ("simd", "relaxedSIMD"))
+    if args.operator:
+        operator_re = re.compile(args.operator)
+        operators = [op for op in operators if operator_re.search(op.name)]
+    if not operators:
+        output.error("No SIMD operators matched")
+        return 1
+
+    llvm_mca = args.llvm_mca or shutil.which("llvm-mca")
+    if not llvm_mca:
+        output.verbose("llvm-mca not found; only reporting instruction counts")
+
+    build_dir, err = build_single_config(
+        ctx.work_dir, ctx.source_dir, args.config,
+        llvm_source=args.llvm_source, offline=args.offline,
+        suppress_summary=True,
+    )
+    if err is not None:
+        return err
+    assert build_dir is not None
+    wavm_bin = get_wavm_bin_path(build_dir)
+
+    audit_dir = ctx.work_dir / "simd_audit"
+    audit_dir.mkdir(parents=True, exist_ok=True)
+    wast_path = audit_dir / "simd_audit.wast"
+    wast_path.write_text(generate_audit_module(operators))
+
+    results: dict[str, dict[str, dict]] = {}
+    for target in targets:
+        costs = audit_target(wavm_bin, wast_path, target, operators, llvm_mca)
+        if costs is None:
+            return 1
+        results[target.name] = costs
+
+    print_results(results, args.worst)
+
+    if args.save:
+        save_results(ctx.work_dir, args.save, results)
+
+    if args.compare:
+        baseline = load_results(ctx.work_dir, args.compare)
+        if not baseline:
+            return 1
+        regressions = compare_results(results, baseline)
+        if regressions:
+            output.error(f"{len(regressions)} SIMD codegen regression(s) against "
+                         f"'{args.compare}':")
+            for regression in regressions:
+                output.error(f"  {regression}")
+            return 1
+        output.print(f"No SIMD codegen regressions against '{args.compare}'")
+
+    return 0
+
+
+def register_simd_audit(subparsers: argparse._SubParsersAction) -> None:
+    """Register the simd-audit subcommand."""
+    parser = subparsers.add_parser(
+        "simd-audit",
+        help="Report the code generated for each SIMD operator on x86-64 and AArch64 targets",
+    )
+    parser.add_argument(
+        "--config",
+        default="RelWithDebInfo",
+        help="Configuration to build and compile with (default: RelWithDebInfo)",
+    )
+    parser.add_argument(
+        "--target",
+        action="append",
+        metavar="NAME",
+        help="Audit only the named target(s) (can be repeated; default: "
+             + ", ".join(t.name for t in AUDIT_TARGETS) + ")",
+    )
+    parser.add_argument(
+        "--operator",
+        metavar="REGEX",
+        help="Audit only the operators whose name matches the regex",
+    )
+    parser.add_argument(
+        "--worst",
+        type=int,
+        metavar="N",
+        help="Only print the N operators with the most instructions",
+    )
+    parser.add_argument(
+        "--llvm-mca",
+        metavar="PATH",
+        help="Path to llvm-mca, used to estimate cycles (default: llvm-mca from PATH, if any)",
+    )
+    parser.add_argument(
+        "--save",
+        metavar="NAME",
+        help="Save results with the given name",
+    )
+    parser.add_argument(
+        "--compare",
+        metavar="NAME",
+        help="Fail if any operator compiles to more instructions than in a saved baseline",
+    )
+    parser.set_defaults(func=cmd_simd_audit)
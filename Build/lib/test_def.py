@@ -2,6 +2,9 @@
 
 import hashlib
 import re
+import socket
+import threading
+import time
 from dataclasses import dataclass, field
 from pathlib import Path
 from typing import Optional, TYPE_CHECKING
@@ -33,6 +36,58 @@ class TestResult:
     message: str = ""
 
 
+@dataclass
+class SocketClient:
+    """A client that connects to a Unix socket while a TestStep's command runs.
+
+    The client waits to receive wait_for, then sends send and shuts down its side of the
+    connection. All the bytes it receives until the connection is closed must equal
+    expected_received.
+    """
+
+    path: str  # Socket path (supports placeholders)
+    wait_for: bytes = b""
+    send: bytes = b""
+    expected_received: bytes = b""
+
+    def run(self, path: str, timeout: float, stop: threading.Event) -> Optional[str]:
+        """Run the client, and return an error message if it fails."""
+        deadline = time.monotonic() + timeout
+
+        # The command may not have started listening yet, so retry until it does.
+        while True:
+            sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            try:
+                sock.connect(path)
+                break
+            except OSError as e:
+                sock.close()
+                if stop.is_set() or time.monotonic() >= deadline:
+                    return f"Socket client failed to connect to {path}: {e}"
+                time.sleep(0.01)
+
+        try:
+            sock.settimeout(max(deadline - time.monotonic(), 0.01))
+            received = b""
+            while len(received) < len(self.wait_for):
+                chunk = sock.recv(4096)
+                if not chunk:
+                    break
+                received += chunk
+            sock.sendall(self.send)
+            sock.shutdown(socket.SHUT_WR)
+            while chunk := sock.recv(4096):
+                received += chunk
+        except OSError as e:
+            return f"Socket client failed: {e}"
+        finally:
+            sock.close()
+
+        if received != self.expected_received:
+            return f"Socket client received {received!r}, expected {self.expected_received!r}"
+        return None
+
+
 @dataclass
 class TestStep:
     """A single command to run as part of a test."""
@@ -48,6 +103,7 @@ class TestStep:
     name: Optional[str] = None  # Optional label for multi-step error messages
     collects_coverage: bool = True  # Whether to set LLVM_PROFILE_FILE for coverage
     expected_binary_output_sha256: Optional[str] = None  # SHA-256 hex digest of expected stdout bytes
+    socket_client: Optional[SocketClient] = None  # A client to run while the command runs
 
     def run(
         self,
@@ -87,10 +143,28 @@ class TestStep:
         if coverage_profraw_path:
             test_env["LLVM_PROFILE_FILE"] = coverage_profraw_path
 
+        # Start the socket client, if any, on another thread.
+        client_error: list[Optional[str]] = [None]
+        client_stop = threading.Event()
+        client_thread = None
+        if self.socket_client:
+            socket_client = self.socket_client
+            client_path = socket_client.path.format(**placeholders)
+
+            def run_client() -> None:
+                client_error[0] = socket_client.run(client_path, self.timeout, client_stop)
+
+            client_thread = threading.Thread(target=run_client, daemon=True)
+            client_thread.start()
+
         result = run_command(
             command, cwd=context.source_dir, env=test_env, timeout=self.timeout
         )
 
+        if client_thread:
+            client_stop.set()
+            client_thread.join()
+
         if result.timed_out or result.returncode != self.expected_returncode:
             return TestResult(
                 False,
@@ -108,6 +182,9 @@ class TestStep:
                     ),
                 )
 
+        if client_error[0]:
+            return TestResult(False, result.format_failure(client_error[0]))
+
         combined_output = result.stdout + result.stderr
 
         # Check expected output pattern if specified
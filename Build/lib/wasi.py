@@ -7,7 +7,7 @@ from typing import Optional
 
 from .platform import LINUX, MACOS, WINDOWS, EXE_EXT, download_and_extract, run_command
 from .task_graph import Task, TaskResult
-from .test_def import TestDef, TestStep
+from .test_def import SocketClient, TestDef, TestStep
 
 
 # =============================================================================
@@ -187,6 +187,31 @@ WASI_TESTS: list[TestDef] = [
             )
         ],
     ),
+    TestDef(
+        "wasi_stdout_buffered",
+        test_wasi_cpp_sources=["stdout"],
+        steps=[
+            TestStep(
+                name="line",
+                command=[
+                    *WASI_RUN,
+                    "--wasi-stdio-buffering=line",
+                    "{wasi_wasm_dir}/stdout.wasm",
+                ],
+                expected_output=r"Hello world!",
+            ),
+            TestStep(
+                name="full",
+                command=[
+                    *WASI_RUN,
+                    "--wasi-stdio-buffering=full",
+                    "--wasi-stdio-buffer-size=4",
+                    "{wasi_wasm_dir}/stdout.wasm",
+                ],
+                expected_output=r"Hello world!",
+            ),
+        ],
+    ),
     TestDef(
         "wasi_stdout_detected_abi",
         test_wasi_cpp_sources=["stdout"],
@@ -289,6 +314,22 @@ WASI_TESTS: list[TestDef] = [
             ),
         ],
     ),
+    TestDef(
+        "wasi_fd_map",
+        create_temp_dir=True,
+        test_wasi_cpp_sources=["write", "fd_map"],
+        steps=[
+            TestStep(
+                name="write",
+                command=[*WASI_RUN_MOUNTED, "{wasi_wasm_dir}/write.wasm", "file.txt", "fd_map_test"],
+            ),
+            TestStep(
+                name="fd_map",
+                command=[*WASI_RUN_MOUNTED, "{wasi_wasm_dir}/fd_map.wasm", "file.txt"],
+                expected_output=r"fd_map: fd_map_test",
+            ),
+        ],
+    ),
     TestDef(
         "wasi_mv",
         create_temp_dir=True,
@@ -358,6 +399,80 @@ WASI_TESTS: list[TestDef] = [
             ),
         ],
     ),
+    TestDef(
+        "wasi_ln",
+        create_temp_dir=True,
+        test_wasi_cpp_sources=["write", "ln", "readlink", "cat"],
+        steps=[
+            TestStep(
+                name="write",
+                command=[*WASI_RUN_MOUNTED, "{wasi_wasm_dir}/write.wasm", "src.txt", "ln_test"],
+            ),
+            TestStep(
+                name="ln",
+                command=[*WASI_RUN_MOUNTED, "{wasi_wasm_dir}/ln.wasm", "src.txt", "hard.txt"],
+            ),
+            TestStep(
+                name="cat_hard",
+                command=[*WASI_RUN_MOUNTED, "{wasi_wasm_dir}/cat.wasm", "hard.txt"],
+                expected_output=r"ln_test",
+            ),
+            TestStep(
+                name="ln_symbolic",
+                command=[
+                    *WASI_RUN_MOUNTED,
+                    "{wasi_wasm_dir}/ln.wasm",
+                    "-s",
+                    "src.txt",
+                    "symbolic.txt",
+                ],
+            ),
+            TestStep(
+                name="readlink",
+                command=[*WASI_RUN_MOUNTED, "{wasi_wasm_dir}/readlink.wasm", "symbolic.txt"],
+                expected_output=r"src\.txt",
+            ),
+            TestStep(
+                name="cat_symbolic",
+                command=[*WASI_RUN_MOUNTED, "{wasi_wasm_dir}/cat.wasm", "symbolic.txt"],
+                expected_output=r"ln_test",
+            ),
+            TestStep(
+                name="readlink_not_link",
+                command=[*WASI_RUN_MOUNTED, "{wasi_wasm_dir}/readlink.wasm", "src.txt"],
+                expected_output=r"Invalid argument",
+                expected_returncode=1,
+            ),
+            TestStep(
+                name="ln_symbolic_escape",
+                command=[
+                    *WASI_RUN_MOUNTED,
+                    "{wasi_wasm_dir}/ln.wasm",
+                    "-s",
+                    "../src.txt",
+                    "escape.txt",
+                ],
+                expected_output=r"Operation not permitted",
+                expected_returncode=1,
+            ),
+        ],
+    ),
+    TestDef(
+        "wasi_fallocate",
+        create_temp_dir=True,
+        test_wasi_cpp_sources=["fallocate", "stat"],
+        steps=[
+            TestStep(
+                name="fallocate",
+                command=[*WASI_RUN_MOUNTED, "{wasi_wasm_dir}/fallocate.wasm", "file.bin", "65536"],
+            ),
+            TestStep(
+                name="stat",
+                command=[*WASI_RUN_MOUNTED, "{wasi_wasm_dir}/stat.wasm", "file.bin"],
+                expected_output=r"st_size: 65536",
+            ),
+        ],
+    ),
     TestDef(
         "wasi_preadwrite",
         create_temp_dir=True,
@@ -410,6 +525,41 @@ WASI_TESTS: list[TestDef] = [
             ),
         ],
     ),
+    TestDef(
+        "wasi_sock_accept",
+        create_temp_dir=True,
+        test_wasi_cpp_sources=["sock_accept"],
+        steps=[
+            TestStep(
+                command=[
+                    *WASI_RUN,
+                    "--listen",
+                    "unix:{temp_dir}/listen.sock",
+                    "{wasi_wasm_dir}/sock_accept.wasm",
+                ],
+                expected_output=r"sock_accept: EAGAIN\nevent 2: error=0",
+            ),
+            TestStep(
+                name="echo",
+                command=[
+                    *WASI_RUN,
+                    "--listen",
+                    "unix:{temp_dir}/echo.sock",
+                    "{wasi_wasm_dir}/sock_accept.wasm",
+                    "echo",
+                ],
+                socket_client=SocketClient(
+                    path="{temp_dir}/echo.sock",
+                    wait_for=b"ready\n",
+                    send=b"ping",
+                    expected_received=b"ready\npong: ping",
+                ),
+                expected_output=(
+                    r"sock_recv: EAGAIN numBytesReceived=12345 roFlags=0x5555\nreceived: ping"
+                ),
+            ),
+        ],
+    ),
     TestDef(
         "wasi_fd_filestat_set_times",
         create_temp_dir=True,
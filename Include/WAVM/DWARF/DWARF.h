@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include "WAVM/DWARF/Sections.h"
 #include "WAVM/Inline/BasicTypes.h"
 
@@ -21,4 +22,50 @@ namespace WAVM { namespace DWARF {
 									 SourceLocation* outLocations,
 									 Uptr maxLocations);
 
+	// The function scopes and line table rows of a set of DWARF sections, sorted by address so
+	// source locations can be found by binary search instead of parsing the sections.
+	struct AddressIndex
+	{
+		static constexpr Uptr noScope = UINTPTR_MAX;
+
+		// A subprogram or inlined_subroutine DIE.
+		struct Scope
+		{
+			const char* linkageName; // into .debug_str, or nullptr
+			const char* name;        // into .debug_str, or nullptr
+			Uptr callLine;           // line in the parent scope, or decl_line for subprograms
+			Uptr parentScopeIndex;   // noScope for the outermost scope
+		};
+
+		// An address range whose innermost scope is scopeIndex (or noScope), which extends to
+		// the beginAddress of the next range.
+		struct ScopeRange
+		{
+			Uptr beginAddress;
+			Uptr scopeIndex;
+		};
+
+		// A line table row. The end of a sequence of rows is a row with line 0.
+		struct LineRow
+		{
+			Uptr address;
+			Uptr line;
+		};
+
+		std::vector<Scope> scopes;
+		std::vector<ScopeRange> scopeRanges; // sorted by beginAddress
+		std::vector<LineRow> lineRows;       // sorted by address
+	};
+
+	// Build an AddressIndex from a set of DWARF sections. The index points to strings in the
+	// sections, so it's only valid as long as they are.
+	WAVM_API void buildAddressIndex(const Sections& sections, AddressIndex& outIndex);
+
+	// Map an instruction address to source locations (inline chain) using an AddressIndex.
+	// Signal-safe: binary search, no allocation.
+	// Returns number of locations (innermost first), 0 if not found.
+	WAVM_API Uptr getSourceLocations(const AddressIndex& index,
+									 Uptr address,
+									 SourceLocation* outLocations,
+									 Uptr maxLocations);
 }}
@@ -27,7 +27,8 @@
 	V(exceptionHandling, "exception-handling", "Exception handling")                               \
 	V(extendedNameSection, "extended-name-section", "Extended name section")                       \
 	V(multipleMemories, "multi-memory", "Multiple memories")                                       \
-	V(memory64, "memory64", "Memories with 64-bit addresses")
+	V(memory64, "memory64", "Memories with 64-bit addresses")                                      \
+	V(relaxedSIMD, "relaxed-simd", "Relaxed SIMD")
 
 // Non-standard extensions. These are disabled by default, but may be enabled on the command-line.
 #define WAVM_ENUM_NONSTANDARD_FEATURES(V)                                                          \
@@ -89,6 +90,18 @@ namespace WAVM { namespace IR {
 		Uptr maxDataSegments = UINTPTR_MAX;
 		Uptr maxSyntaxRecursion = 500;
 
+		// If false, the code compiled for the module accesses unshared memories with ordinary
+		// loads and stores instead of volatile ones, which allows LLVM to optimize them, but may
+		// make out-of-bounds accesses trap imprecisely: an access whose result is unused may not
+		// trap at all, and a trapping access may be reordered with the accesses around it.
+		bool preciseMemoryTraps = true;
+
+		// If true, the code compiled for the module checks the stack pointer against the stack
+		// limit of the executing context (see Runtime::setContextStackLimit) on entry to each
+		// function, and traps with a stack overflow if it is exceeded. This doesn't depend on
+		// hitting a guard page, so it works on stacks that don't have one.
+		bool explicitStackLimitChecks = false;
+
 		FeatureSpec(FeatureLevel featureLevel = FeatureLevel::mature)
 		{
 			setFeatureLevel(featureLevel);
@@ -10,15 +10,17 @@
 #include "WAVM/IR/Types.h"
 #include "WAVM/Inline/Assert.h"
 #include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/SharedBytes.h"
 
 namespace WAVM { namespace IR {
-	enum class Opcode : U16;
+	enum class Opcode : U32;
 
 	// An initializer expression: serialized like any other code, but only supports a few specific
 	// instructions.
 	template<typename Ref> struct InitializerExpressionBase
 	{
-		enum class Type : U16
+		// Type must be the same size as Opcode, so that writing type initializes all of typeOpcode.
+		enum class Type : U32
 		{
 			i32_const = 0x0041,
 			i64_const = 0x0042,
@@ -97,7 +99,9 @@ namespace WAVM { namespace IR {
 		IndexedFunctionType type;
 		std::vector<ValueType> nonParameterLocalTypes;
 		std::vector<U8> code;
-		std::vector<std::vector<Uptr>> branchTables;
+
+		// The non-default target depths of all the function's br_table operators, concatenated.
+		std::vector<Uptr> branchTableTargetDepths;
 	};
 
 	// A table definition
@@ -163,19 +167,20 @@ namespace WAVM { namespace IR {
 	};
 
 	// A data segment: a literal sequence of bytes that is copied into a Runtime::Memory when
-	// instantiating a module
+	// instantiating a module. The bytes may be shared with the buffer the module was loaded from.
 	struct DataSegment
 	{
 		bool isActive;
 		Uptr memoryIndex;
 		InitializerExpression baseOffset;
-		std::shared_ptr<std::vector<U8>> data;
+		SharedBytes data;
 	};
 
 	// An element expression: a literal reference used to initialize a table element.
 	struct ElemExpr
 	{
-		enum class Type
+		// Type must be the same size as Opcode, so that writing type initializes all of typeOpcode.
+		enum class Type : U32
 		{
 			invalid = 0,
 
@@ -288,17 +293,16 @@ namespace WAVM { namespace IR {
 
 	WAVM_API const char* asString(OrderedSectionID id);
 
-	// A custom module section as an array of bytes
+	// A custom module section as an array of bytes, which may be shared with the buffer the module
+	// was loaded from.
 	struct CustomSection
 	{
 		OrderedSectionID afterSection{OrderedSectionID::moduleBeginning};
 		std::string name;
-		std::vector<U8> data;
+		SharedBytes data;
 
 		CustomSection() = default;
-		CustomSection(OrderedSectionID inAfterSection,
-					  std::string&& inName,
-					  std::vector<U8>&& inData)
+		CustomSection(OrderedSectionID inAfterSection, std::string&& inName, SharedBytes&& inData)
 		: afterSection(inAfterSection), name(std::move(inName)), data(std::move(inData))
 		{
 		}
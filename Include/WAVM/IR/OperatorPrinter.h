@@ -38,10 +38,13 @@ namespace WAVM { namespace IR {
 		{
 			std::string result = " " + std::to_string(imm.defaultTargetDepth);
 			const char* prefix = " [";
-			WAVM_ASSERT(imm.branchTableIndex < functionDef.branchTables.size());
-			for(auto depth : functionDef.branchTables[imm.branchTableIndex])
+			WAVM_ASSERT(imm.firstTargetDepthIndex + imm.numTargetDepths
+						<= functionDef.branchTableTargetDepths.size());
+			const Uptr* targetDepths
+				= functionDef.branchTableTargetDepths.data() + imm.firstTargetDepthIndex;
+			for(Uptr index = 0; index < imm.numTargetDepths; ++index)
 			{
-				result += prefix + std::to_string(depth);
+				result += prefix + std::to_string(targetDepths[index]);
 				prefix = ",";
 			}
 			result += "]";
@@ -3,7 +3,8 @@
 
 // clang-format off
 
-// Enumerate the WebAssembly operators
+// Enumerate the WebAssembly operators. Prefixed opcodes are written as (prefix << 8) | index, or
+// as (prefix << 16) | index if the index doesn't fit in a byte.
 
 #define WAVM_ENUM_CONTROL_OPERATORS(visitOp)                                                                                                                     \
 	visitOp(0x0002, block              , "block"                            , ControlStructureImm       , POLYMORPHIC               , mvp                    )   \
@@ -597,6 +598,27 @@
 	visitOp(0xfdfd, i32x4_trunc_sat_f64x2_u_zero  , "i32x4.trunc_sat_f64x2_u_zero"  , NoImm                     , v128_to_v128              , simd                   )   \
 	visitOp(0xfdfe, f64x2_convert_low_i32x4_s     , "f64x2.convert_low_i32x4_s"     , NoImm                     , v128_to_v128              , simd                   )   \
 	visitOp(0xfdff, f64x2_convert_low_i32x4_u     , "f64x2.convert_low_i32x4_u"     , NoImm                     , v128_to_v128              , simd                   )   \
+/* Relaxed SIMD                                                                                                                                                       */ \
+	visitOp(0xfd0100, i8x16_relaxed_swizzle       , "i8x16.relaxed_swizzle"         , NoImm                     , v128_v128_to_v128         , relaxedSIMD            )   \
+	visitOp(0xfd0101, i32x4_relaxed_trunc_f32x4_s , "i32x4.relaxed_trunc_f32x4_s"   , NoImm                     , v128_to_v128              , relaxedSIMD            )   \
+	visitOp(0xfd0102, i32x4_relaxed_trunc_f32x4_u , "i32x4.relaxed_trunc_f32x4_u"   , NoImm                     , v128_to_v128              , relaxedSIMD            )   \
+	visitOp(0xfd0103, i32x4_relaxed_trunc_f64x2_s_zero, "i32x4.relaxed_trunc_f64x2_s_zero", NoImm               , v128_to_v128              , relaxedSIMD            )   \
+	visitOp(0xfd0104, i32x4_relaxed_trunc_f64x2_u_zero, "i32x4.relaxed_trunc_f64x2_u_zero", NoImm               , v128_to_v128              , relaxedSIMD            )   \
+	visitOp(0xfd0105, f32x4_relaxed_madd          , "f32x4.relaxed_madd"            , NoImm                     , v128_v128_v128_to_v128    , relaxedSIMD            )   \
+	visitOp(0xfd0106, f32x4_relaxed_nmadd         , "f32x4.relaxed_nmadd"           , NoImm                     , v128_v128_v128_to_v128    , relaxedSIMD            )   \
+	visitOp(0xfd0107, f64x2_relaxed_madd          , "f64x2.relaxed_madd"            , NoImm                     , v128_v128_v128_to_v128    , relaxedSIMD            )   \
+	visitOp(0xfd0108, f64x2_relaxed_nmadd         , "f64x2.relaxed_nmadd"           , NoImm                     , v128_v128_v128_to_v128    , relaxedSIMD            )   \
+	visitOp(0xfd0109, i8x16_relaxed_laneselect    , "i8x16.relaxed_laneselect"      , NoImm                     , v128_v128_v128_to_v128    , relaxedSIMD            )   \
+	visitOp(0xfd010a, i16x8_relaxed_laneselect    , "i16x8.relaxed_laneselect"      , NoImm                     , v128_v128_v128_to_v128    , relaxedSIMD            )   \
+	visitOp(0xfd010b, i32x4_relaxed_laneselect    , "i32x4.relaxed_laneselect"      , NoImm                     , v128_v128_v128_to_v128    , relaxedSIMD            )   \
+	visitOp(0xfd010c, i64x2_relaxed_laneselect    , "i64x2.relaxed_laneselect"      , NoImm                     , v128_v128_v128_to_v128    , relaxedSIMD            )   \
+	visitOp(0xfd010d, f32x4_relaxed_min           , "f32x4.relaxed_min"             , NoImm                     , v128_v128_to_v128         , relaxedSIMD            )   \
+	visitOp(0xfd010e, f32x4_relaxed_max           , "f32x4.relaxed_max"             , NoImm                     , v128_v128_to_v128         , relaxedSIMD            )   \
+	visitOp(0xfd010f, f64x2_relaxed_min           , "f64x2.relaxed_min"             , NoImm                     , v128_v128_to_v128         , relaxedSIMD            )   \
+	visitOp(0xfd0110, f64x2_relaxed_max           , "f64x2.relaxed_max"             , NoImm                     , v128_v128_to_v128         , relaxedSIMD            )   \
+	visitOp(0xfd0111, i16x8_relaxed_q15mulr_s     , "i16x8.relaxed_q15mulr_s"       , NoImm                     , v128_v128_to_v128         , relaxedSIMD            )   \
+	visitOp(0xfd0112, i16x8_relaxed_dot_i8x16_i7x16_s, "i16x8.relaxed_dot_i8x16_i7x16_s", NoImm                 , v128_v128_to_v128         , relaxedSIMD            )   \
+	visitOp(0xfd0113, i32x4_relaxed_dot_i8x16_i7x16_add_s, "i32x4.relaxed_dot_i8x16_i7x16_add_s", NoImm         , v128_v128_v128_to_v128    , relaxedSIMD            )   \
 /* Atomic fence                                                                                                                                                       */ \
 	visitOp(0xfe03, atomic_fence                  , "atomic.fence"                  , AtomicFenceImm            , none_to_none              , atomics                )
 
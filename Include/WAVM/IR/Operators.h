@@ -58,8 +58,10 @@ namespace WAVM { namespace IR {
 	{
 		Uptr defaultTargetDepth;
 
-		// An index into the FunctionDef's branchTables array.
-		Uptr branchTableIndex;
+		// The range of the FunctionDef's branchTableTargetDepths array that contains the
+		// operator's non-default target depths.
+		Uptr firstTargetDepthIndex;
+		Uptr numTargetDepths;
 	};
 
 	template<typename Value> struct LiteralImm
@@ -170,7 +172,7 @@ namespace WAVM { namespace IR {
 		ReferenceType referenceType;
 	};
 
-	enum class Opcode : U16
+	enum class Opcode : U32
 	{
 #define VISIT_OPCODE(opcode, name, ...) name = opcode,
 		WAVM_ENUM_OPERATORS(VISIT_OPCODE)
@@ -178,22 +180,406 @@ namespace WAVM { namespace IR {
 	};
 
 	inline constexpr U64 maxSingleByteOpcode = 0xdf;
+	inline constexpr U64 maxTwoByteOpcode = 0xffff;
 
-	template<typename Imm> struct OpcodeAndImm
+	// The byte that starts the encoding of opcodes greater than maxTwoByteOpcode in
+	// FunctionDef::code. It isn't a valid opcode or opcode prefix.
+	inline constexpr U8 wideOpcodeEscape = 0xe0;
+
+	// Operators are encoded in FunctionDef::code as the opcode, followed by the operator's
+	// immediates. Opcodes up to maxSingleByteOpcode are encoded as a single byte, opcodes up to
+	// maxTwoByteOpcode as two bytes: the prefix byte followed by the low byte, and wider opcodes
+	// as wideOpcodeEscape followed by the three low bytes of the opcode. Indices, depths and
+	// offsets are encoded as unsigned LEB128, I32 and I64 literals as signed LEB128, and other
+	// immediates as their raw bytes. The encoding isn't validated when it is decoded: it must be
+	// produced by OperatorEncoderStream.
+
+	// The maximum number of bytes used to encode any operator.
+	inline constexpr Uptr maxEncodedOperatorBytes = 32;
+
+	WAVM_FORCEINLINE void encodeVarUInt(U8*& nextByte, U64 value)
 	{
-		Opcode opcode;
-		Imm imm;
-	};
+		while(value >= 0x80)
+		{
+			*nextByte++ = U8(value) | 0x80;
+			value >>= 7;
+		}
+		*nextByte++ = U8(value);
+	}
 
-	// Specialize for the empty immediate struct so they don't take an extra byte of space.
-	template<> struct OpcodeAndImm<NoImm>
+	WAVM_FORCEINLINE U64 decodeVarUInt(const U8*& nextByte)
 	{
-		union
+		U8 byte = *nextByte++;
+		if(!(byte & 0x80)) { return byte; }
+
+		U64 value = byte & 0x7f;
+		for(Uptr shift = 7; true; shift += 7)
 		{
-			Opcode opcode;
-			NoImm imm;
-		};
-	};
+			byte = *nextByte++;
+			value |= U64(byte & 0x7f) << shift;
+			if(!(byte & 0x80)) { return value; }
+		}
+	}
+
+	WAVM_FORCEINLINE void encodeVarSInt(U8*& nextByte, I64 value)
+	{
+		while(value < -64 || value >= 64)
+		{
+			*nextByte++ = U8(value) | 0x80;
+			value >>= 7;
+		}
+		*nextByte++ = U8(value) & 0x7f;
+	}
+
+	WAVM_FORCEINLINE I64 decodeVarSInt(const U8*& nextByte)
+	{
+		U64 value = 0;
+		Uptr shift = 0;
+		U8 byte;
+		do
+		{
+			byte = *nextByte++;
+			value |= U64(byte & 0x7f) << shift;
+			shift += 7;
+		} while(byte & 0x80);
+
+		// Sign extend the value from the last byte's sign bit.
+		if(shift < 64 && (byte & 0x40)) { value |= ~U64(0) << shift; }
+		return I64(value);
+	}
+
+	template<typename Value> WAVM_FORCEINLINE void encodeRaw(U8*& nextByte, const Value& value)
+	{
+		memcpy(nextByte, &value, sizeof(Value));
+		nextByte += sizeof(Value);
+	}
+
+	template<typename Value> WAVM_FORCEINLINE void decodeRaw(const U8*& nextByte, Value& outValue)
+	{
+		memcpy(&outValue, nextByte, sizeof(Value));
+		nextByte += sizeof(Value);
+	}
+
+	WAVM_FORCEINLINE void encodeOpcode(U8*& nextByte, Opcode opcode)
+	{
+		if(U32(opcode) <= maxSingleByteOpcode) { *nextByte++ = U8(opcode); }
+		else if(U32(opcode) <= maxTwoByteOpcode)
+		{
+			*nextByte++ = U8(U32(opcode) >> 8);
+			*nextByte++ = U8(opcode);
+		}
+		else
+		{
+			*nextByte++ = wideOpcodeEscape;
+			*nextByte++ = U8(U32(opcode) >> 16);
+			*nextByte++ = U8(U32(opcode) >> 8);
+			*nextByte++ = U8(opcode);
+		}
+	}
+
+	WAVM_FORCEINLINE Opcode decodeOpcode(const U8*& nextByte)
+	{
+		const U8 firstByte = *nextByte++;
+		if(firstByte <= maxSingleByteOpcode) { return Opcode(firstByte); }
+		if(firstByte != wideOpcodeEscape) { return Opcode((U32(firstByte) << 8) | *nextByte++); }
+		const U32 opcode = (U32(nextByte[0]) << 16) | (U32(nextByte[1]) << 8) | nextByte[2];
+		nextByte += 3;
+		return Opcode(opcode);
+	}
+
+	// Encode and decode each type of immediate.
+
+	WAVM_FORCEINLINE void encodeImm(U8*&, const NoImm&) {}
+	WAVM_FORCEINLINE void decodeImm(const U8*&, NoImm&) {}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const MemoryImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.memoryIndex);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, MemoryImm& imm)
+	{
+		imm.memoryIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const MemoryCopyImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.destMemoryIndex);
+		encodeVarUInt(nextByte, imm.sourceMemoryIndex);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, MemoryCopyImm& imm)
+	{
+		imm.destMemoryIndex = Uptr(decodeVarUInt(nextByte));
+		imm.sourceMemoryIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const TableImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.tableIndex);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, TableImm& imm)
+	{
+		imm.tableIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const TableCopyImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.destTableIndex);
+		encodeVarUInt(nextByte, imm.sourceTableIndex);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, TableCopyImm& imm)
+	{
+		imm.destTableIndex = Uptr(decodeVarUInt(nextByte));
+		imm.sourceTableIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const ControlStructureImm& imm)
+	{
+		*nextByte++ = U8(imm.type.format);
+		switch(imm.type.format)
+		{
+		case IndexedBlockType::noParametersOrResult: break;
+		case IndexedBlockType::oneResult: encodeRaw(nextByte, imm.type.resultType); break;
+		case IndexedBlockType::functionType: encodeVarUInt(nextByte, imm.type.index); break;
+		default: WAVM_UNREACHABLE();
+		}
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, ControlStructureImm& imm)
+	{
+		imm.type.format = IndexedBlockType::Format(*nextByte++);
+		switch(imm.type.format)
+		{
+		case IndexedBlockType::noParametersOrResult: imm.type.index = 0; break;
+		case IndexedBlockType::oneResult: decodeRaw(nextByte, imm.type.resultType); break;
+		case IndexedBlockType::functionType:
+			imm.type.index = Uptr(decodeVarUInt(nextByte));
+			break;
+		default: WAVM_UNREACHABLE();
+		}
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const SelectImm& imm)
+	{
+		encodeRaw(nextByte, imm.type);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, SelectImm& imm)
+	{
+		decodeRaw(nextByte, imm.type);
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const BranchImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.targetDepth);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, BranchImm& imm)
+	{
+		imm.targetDepth = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const BranchTableImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.defaultTargetDepth);
+		encodeVarUInt(nextByte, imm.firstTargetDepthIndex);
+		encodeVarUInt(nextByte, imm.numTargetDepths);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, BranchTableImm& imm)
+	{
+		imm.defaultTargetDepth = Uptr(decodeVarUInt(nextByte));
+		imm.firstTargetDepthIndex = Uptr(decodeVarUInt(nextByte));
+		imm.numTargetDepths = Uptr(decodeVarUInt(nextByte));
+	}
+
+	template<typename Value>
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const LiteralImm<Value>& imm)
+	{
+		encodeRaw(nextByte, imm.value);
+	}
+	template<typename Value>
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, LiteralImm<Value>& imm)
+	{
+		decodeRaw(nextByte, imm.value);
+	}
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const LiteralImm<I32>& imm)
+	{
+		encodeVarSInt(nextByte, imm.value);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, LiteralImm<I32>& imm)
+	{
+		imm.value = I32(decodeVarSInt(nextByte));
+	}
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const LiteralImm<I64>& imm)
+	{
+		encodeVarSInt(nextByte, imm.value);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, LiteralImm<I64>& imm)
+	{
+		imm.value = decodeVarSInt(nextByte);
+	}
+
+	template<bool isGlobal>
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const GetOrSetVariableImm<isGlobal>& imm)
+	{
+		encodeVarUInt(nextByte, imm.variableIndex);
+	}
+	template<bool isGlobal>
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, GetOrSetVariableImm<isGlobal>& imm)
+	{
+		imm.variableIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const FunctionImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.functionIndex);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, FunctionImm& imm)
+	{
+		imm.functionIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const FunctionRefImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.functionIndex);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, FunctionRefImm& imm)
+	{
+		imm.functionIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const CallIndirectImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.type.index);
+		encodeVarUInt(nextByte, imm.tableIndex);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, CallIndirectImm& imm)
+	{
+		imm.type.index = Uptr(decodeVarUInt(nextByte));
+		imm.tableIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const BaseLoadOrStoreImm& imm)
+	{
+		*nextByte++ = imm.alignmentLog2;
+		encodeVarUInt(nextByte, imm.offset);
+		encodeVarUInt(nextByte, imm.memoryIndex);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, BaseLoadOrStoreImm& imm)
+	{
+		imm.alignmentLog2 = *nextByte++;
+		imm.offset = decodeVarUInt(nextByte);
+		imm.memoryIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	template<Uptr naturalAlignmentLog2, Uptr numLanes>
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte,
+									const LoadOrStoreLaneImm<naturalAlignmentLog2, numLanes>& imm)
+	{
+		encodeImm(nextByte, static_cast<const BaseLoadOrStoreImm&>(imm));
+		*nextByte++ = imm.laneIndex;
+	}
+	template<Uptr naturalAlignmentLog2, Uptr numLanes>
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte,
+									LoadOrStoreLaneImm<naturalAlignmentLog2, numLanes>& imm)
+	{
+		decodeImm(nextByte, static_cast<BaseLoadOrStoreImm&>(imm));
+		imm.laneIndex = *nextByte++;
+	}
+
+	template<Uptr numLanes>
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const LaneIndexImm<numLanes>& imm)
+	{
+		*nextByte++ = imm.laneIndex;
+	}
+	template<Uptr numLanes>
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, LaneIndexImm<numLanes>& imm)
+	{
+		imm.laneIndex = *nextByte++;
+	}
+
+	template<Uptr numLanes>
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const ShuffleImm<numLanes>& imm)
+	{
+		encodeRaw(nextByte, imm.laneIndices);
+	}
+	template<Uptr numLanes>
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, ShuffleImm<numLanes>& imm)
+	{
+		decodeRaw(nextByte, imm.laneIndices);
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const AtomicFenceImm& imm)
+	{
+		*nextByte++ = U8(imm.order);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, AtomicFenceImm& imm)
+	{
+		imm.order = MemoryOrder(*nextByte++);
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const ExceptionTypeImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.exceptionTypeIndex);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, ExceptionTypeImm& imm)
+	{
+		imm.exceptionTypeIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const RethrowImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.catchDepth);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, RethrowImm& imm)
+	{
+		imm.catchDepth = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const DataSegmentAndMemImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.dataSegmentIndex);
+		encodeVarUInt(nextByte, imm.memoryIndex);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, DataSegmentAndMemImm& imm)
+	{
+		imm.dataSegmentIndex = Uptr(decodeVarUInt(nextByte));
+		imm.memoryIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const DataSegmentImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.dataSegmentIndex);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, DataSegmentImm& imm)
+	{
+		imm.dataSegmentIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const ElemSegmentAndTableImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.elemSegmentIndex);
+		encodeVarUInt(nextByte, imm.tableIndex);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, ElemSegmentAndTableImm& imm)
+	{
+		imm.elemSegmentIndex = Uptr(decodeVarUInt(nextByte));
+		imm.tableIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const ElemSegmentImm& imm)
+	{
+		encodeVarUInt(nextByte, imm.elemSegmentIndex);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, ElemSegmentImm& imm)
+	{
+		imm.elemSegmentIndex = Uptr(decodeVarUInt(nextByte));
+	}
+
+	WAVM_FORCEINLINE void encodeImm(U8*& nextByte, const ReferenceTypeImm& imm)
+	{
+		encodeRaw(nextByte, imm.referenceType);
+	}
+	WAVM_FORCEINLINE void decodeImm(const U8*& nextByte, ReferenceTypeImm& imm)
+	{
+		decodeRaw(nextByte, imm.referenceType);
+	}
 
 	// Decodes an operator from an input stream and dispatches by opcode.
 	struct OperatorDecoderStream
@@ -207,18 +593,15 @@ namespace WAVM { namespace IR {
 
 		template<typename Visitor> typename Visitor::Result decodeOp(Visitor& visitor)
 		{
-			WAVM_ASSERT(nextByte + sizeof(Opcode) <= end);
-			Opcode opcode;
-			memcpy(&opcode, nextByte, sizeof(Opcode));
-			switch(opcode)
+			WAVM_ASSERT(nextByte < end);
+			switch(decodeOpcode(nextByte))
 			{
 #define VISIT_OPCODE(opcode, name, nameString, Imm, ...)                                           \
 	case Opcode::name: {                                                                           \
-		WAVM_ASSERT(nextByte + sizeof(OpcodeAndImm<Imm>) <= end);                                  \
-		OpcodeAndImm<Imm> encodedOperator;                                                         \
-		memcpy(&encodedOperator, nextByte, sizeof(OpcodeAndImm<Imm>));                             \
-		nextByte += sizeof(OpcodeAndImm<Imm>);                                                     \
-		return visitor.name(encodedOperator.imm);                                                  \
+		Imm imm;                                                                                   \
+		decodeImm(nextByte, imm);                                                                  \
+		WAVM_ASSERT(nextByte <= end);                                                              \
+		return visitor.name(imm);                                                                  \
 	}
 				WAVM_ENUM_OPERATORS(VISIT_OPCODE)
 #undef VISIT_OPCODE
@@ -249,12 +632,13 @@ namespace WAVM { namespace IR {
 #define VISIT_OPCODE(_, name, nameString, Imm, ...)                                                \
 	void name(Imm imm = {})                                                                        \
 	{                                                                                              \
-		OpcodeAndImm<Imm> encodedOperator;                                                         \
-		encodedOperator.opcode = Opcode::name;                                                     \
-		encodedOperator.imm = imm;                                                                 \
-		memcpy(byteStream.advance(sizeof(OpcodeAndImm<Imm>)),                                      \
-			   &encodedOperator,                                                                   \
-			   sizeof(OpcodeAndImm<Imm>));                                                         \
+		U8 encodedOperator[maxEncodedOperatorBytes];                                               \
+		U8* nextByte = encodedOperator;                                                            \
+		encodeOpcode(nextByte, Opcode::name);                                                      \
+		encodeImm(nextByte, imm);                                                                  \
+		const Uptr numEncodedBytes = Uptr(nextByte - encodedOperator);                             \
+		WAVM_ASSERT(numEncodedBytes <= maxEncodedOperatorBytes);                                   \
+		memcpy(byteStream.advance(numEncodedBytes), encodedOperator, numEncodedBytes);             \
 	}
 		WAVM_ENUM_OPERATORS(VISIT_OPCODE)
 #undef VISIT_OPCODE
@@ -3,13 +3,16 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cstring> // IWYU pragma: keep
+#include <memory>
 #include <string>
 #include <vector>
 #include "WAVM/Inline/Assert.h"
 #include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/SharedBytes.h"
 #include "WAVM/Logging/Logging.h"
 #include "WAVM/Platform/Defines.h"
 #include "WAVM/Platform/File.h"
+#include "WAVM/Platform/Memory.h"
 #include "WAVM/VFS/VFS.h"
 
 namespace WAVM {
@@ -62,6 +65,47 @@ namespace WAVM {
 		return false;
 	}
 
+	// Maps a file into memory, or loads it like loadFile if it can't be mapped (e.g. it is a pipe).
+	// The file stays mapped until outFileBytes and every SharedBytes sliced from it are destroyed,
+	// and must not be truncated until then (see Platform::mapFile).
+	inline bool mapOrLoadFile(const char* filename, SharedBytes& outFileBytes)
+	{
+		VFS::VFD* vfd = nullptr;
+		VFS::Result result = Platform::getHostFS().open(
+			filename, VFS::FileAccessMode::readOnly, VFS::FileCreateMode::openExisting, vfd);
+		if(result != VFS::Result::success)
+		{
+			Log::printf(
+				Log::error, "Error loading '%s': %s\n", filename, VFS::describeResult(result));
+			return false;
+		}
+
+		const U8* mappedBytes = nullptr;
+		Uptr numMappedBytes = 0;
+		Uptr hostDescriptor = 0;
+		if(vfd->getHostDescriptor(hostDescriptor) == VFS::Result::success)
+		{
+			mappedBytes = Platform::mapFile(hostDescriptor, numMappedBytes);
+		}
+
+		// The mapping doesn't need the file to stay open.
+		WAVM_ERROR_UNLESS(vfd->close() == VFS::Result::success);
+
+		if(!mappedBytes)
+		{
+			std::vector<U8> fileContents;
+			if(!loadFile(filename, fileContents)) { return false; }
+			outFileBytes = SharedBytes(std::move(fileContents));
+			return true;
+		}
+
+		std::shared_ptr<const U8> mapping(mappedBytes, [numMappedBytes](const U8* baseAddress) {
+			Platform::unmapFile(baseAddress, numMappedBytes);
+		});
+		outFileBytes = SharedBytes(std::move(mapping), mappedBytes, numMappedBytes);
+		return true;
+	}
+
 	inline bool saveFile(const char* filename, const void* fileBytes, Uptr numFileBytes)
 	{
 		VFS::Result result;
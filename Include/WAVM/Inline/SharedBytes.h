@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string.h>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "WAVM/Inline/Assert.h"
+#include "WAVM/Inline/BasicTypes.h"
+
+namespace WAVM {
+	// An immutable array of bytes that shares ownership of the storage it references. The storage
+	// may be a std::vector owned by the SharedBytes, or part of a larger buffer owned by some other
+	// object (e.g. a mapped file), in which case copying the SharedBytes or slicing it doesn't copy
+	// any bytes.
+	struct SharedBytes
+	{
+		SharedBytes() : bytes(nullptr), numBytes(0) {}
+
+		SharedBytes(std::vector<U8>&& inBytes)
+		{
+			auto vector = std::make_shared<const std::vector<U8>>(std::move(inBytes));
+			bytes = vector->data();
+			numBytes = vector->size();
+			owner = std::move(vector);
+		}
+
+		SharedBytes(const U8* inBytes, Uptr inNumBytes)
+		: SharedBytes(std::vector<U8>(inBytes, inBytes + inNumBytes))
+		{
+		}
+
+		// References bytes in storage that is kept alive by inOwner.
+		SharedBytes(std::shared_ptr<const void> inOwner, const U8* inBytes, Uptr inNumBytes)
+		: owner(std::move(inOwner)), bytes(inBytes), numBytes(inNumBytes)
+		{
+		}
+
+		const U8* data() const { return bytes; }
+		Uptr size() const { return numBytes; }
+		bool empty() const { return numBytes == 0; }
+
+		const U8* begin() const { return bytes; }
+		const U8* end() const { return bytes + numBytes; }
+
+		const U8& operator[](Uptr index) const
+		{
+			WAVM_ASSERT(index < numBytes);
+			return bytes[index];
+		}
+
+		// Returns true if the given bytes are entirely within this array.
+		bool contains(const U8* rangeBytes, Uptr rangeNumBytes) const
+		{
+			return rangeBytes >= bytes && rangeNumBytes <= numBytes
+				   && Uptr(rangeBytes - bytes) <= numBytes - rangeNumBytes;
+		}
+
+		// Returns a SharedBytes that references part of this array, and shares ownership of its
+		// storage.
+		SharedBytes slice(const U8* sliceBytes, Uptr sliceNumBytes) const
+		{
+			WAVM_ASSERT(contains(sliceBytes, sliceNumBytes));
+			return SharedBytes(owner, sliceBytes, sliceNumBytes);
+		}
+
+		friend bool operator==(const SharedBytes& left, const SharedBytes& right)
+		{
+			return left.numBytes == right.numBytes
+				   && (!left.numBytes || left.bytes == right.bytes
+					   || !memcmp(left.bytes, right.bytes, left.numBytes));
+		}
+		friend bool operator!=(const SharedBytes& left, const SharedBytes& right)
+		{
+			return !(left == right);
+		}
+
+	private:
+		std::shared_ptr<const void> owner;
+		const U8* bytes;
+		Uptr numBytes;
+	};
+}
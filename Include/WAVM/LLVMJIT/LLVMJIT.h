@@ -175,8 +175,10 @@ namespace WAVM { namespace LLVMJIT {
 	};
 
 	// Loads a module from object code, and binds its undefined symbols to the provided bindings.
+	// The object code is copied, so it doesn't need to outlive the call.
 	WAVM_API std::shared_ptr<Module> loadModule(
-		const std::vector<U8>& objectFileBytes,
+		const U8* objectFileBytes,
+		Uptr numObjectFileBytes,
 		HashMap<std::string, FunctionBinding>&& wavmIntrinsicsExportMap,
 		std::vector<IR::FunctionType>&& types,
 		std::vector<FunctionBinding>&& functionImports,
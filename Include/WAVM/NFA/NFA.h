@@ -38,10 +38,30 @@ namespace WAVM { namespace NFA {
 	// Dumps the NFA's states and edges to the GraphViz .dot format.
 	WAVM_API std::string dumpNFAGraphViz(const Builder* builder);
 
+	// The transition tables of a DFA, which may be saved (e.g. as C++ source by a build-time
+	// generator) and used to recreate the DFA without rebuilding it from a NFA.
+	struct MachineTables
+	{
+		// Maps each character to the offset of its character class's row in the transition map.
+		const U32* charToOffsetMap;
+
+		// A [charClass][state] map from each state and character class to the next state.
+		const StateIndex* stateAndOffsetToNextStateMap;
+
+		Uptr numClasses;
+		Uptr numStates;
+	};
+
 	// Encapsulates a NFA that has been translated into a DFA that can be efficiently executed.
 	struct WAVM_API Machine
 	{
-		Machine() : stateAndOffsetToNextStateMap(nullptr), numClasses(0), numStates(0) {}
+		Machine()
+		: stateAndOffsetToNextStateMap(nullptr)
+		, ownsStateAndOffsetToNextStateMap(false)
+		, numClasses(0)
+		, numStates(0)
+		{
+		}
 		~Machine();
 
 		Machine(Machine&& inMachine) noexcept { moveFrom(std::move(inMachine)); }
@@ -50,6 +70,13 @@ namespace WAVM { namespace NFA {
 		// Constructs a DFA from the abstract builder object (which is destroyed).
 		Machine(Builder* inBuilder);
 
+		// Constructs a DFA from precomputed tables. The DFA references the tables' transition map
+		// instead of copying it, so it must remain valid for the lifetime of the DFA.
+		Machine(const MachineTables& tables);
+
+		// Returns the DFA's transition tables, which are valid for the lifetime of the DFA.
+		MachineTables getTables() const;
+
 		// Feeds characters into the DFA until it reaches a terminal state.
 		// Upon reaching a terminal state, the state is returned, and the nextChar pointer
 		// is updated to point to the first character not consumed by the DFA.
@@ -95,7 +122,8 @@ namespace WAVM { namespace NFA {
 		static constexpr InternalStateIndex internalMaxStates = INT16_MAX;
 
 		U32 charToOffsetMap[256];
-		InternalStateIndex* stateAndOffsetToNextStateMap;
+		const InternalStateIndex* stateAndOffsetToNextStateMap;
+		bool ownsStateAndOffsetToNextStateMap;
 		Uptr numClasses;
 		Uptr numStates;
 
@@ -34,7 +34,9 @@
 	V(avx512f, "avx512f")                                                                          \
 	V(avx512bw, "avx512bw")                                                                        \
 	V(avx512dq, "avx512dq")                                                                        \
-	V(avx512vl, "avx512vl")
+	V(avx512vl, "avx512vl")                                                                        \
+	V(avx512vnni, "avx512vnni")                                                                    \
+	V(avxvnni, "avxvnni")
 
 // AArch64 CPU feature list. V(fieldName, cliName)
 // NEON is baseline on AArch64, so not included.
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include "WAVM/VFS/VFS.h"
 
@@ -22,4 +23,18 @@ namespace WAVM { namespace Platform {
 		virtual ~HostFS() override {}
 	};
 	WAVM_API HostFS& getHostFS();
+
+	// Creates a stream socket listening on an address of the form "tcp:<IPv4 address>:<port>",
+	// "tcp6:[<IPv6 address>]:<port>", or "unix:<path>". Connections are received with VFD::accept.
+	WAVM_API VFS::Result listenOnSocket(const std::string& address,
+										VFS::VFD*& outVFD,
+										const VFS::VFDFlags& flags = VFS::VFDFlags{});
+
+	// Creates a stream socket connected to an address of the form accepted by listenOnSocket.
+	WAVM_API VFS::Result connectToSocket(const std::string& address,
+										 VFS::VFD*& outVFD,
+										 const VFS::VFDFlags& flags = VFS::VFDFlags{});
+
+	// Creates a reactor that can wait on the VFDs created by the host platform.
+	WAVM_API std::unique_ptr<VFS::Reactor> createReactor();
 }}
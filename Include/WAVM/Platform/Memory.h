@@ -47,6 +47,34 @@ namespace WAVM { namespace Platform {
 	// baseVirtualAddress must be a multiple of the preferred page size.
 	WAVM_API void decommitVirtualPages(U8* baseVirtualAddress, Uptr numPages);
 
+	// Maps numPages pages of a file, starting at fileOffset, to the specified virtual pages,
+	// replacing whatever was mapped there. The pages are readable and writable, but private to the
+	// process: writes to them are copy-on-write, and aren't written back to the file. Pages that
+	// are entirely past the end of the file are mapped to zeroed memory.
+	// hostDescriptor is a file descriptor as returned by VFS::VFD::getHostDescriptor, and
+	// baseVirtualAddress and fileOffset must be multiples of the preferred page size.
+	// Unwritten pages keep reading from the file, so the file is only mapped if it is sealed
+	// against being shrunk or written (e.g. a Linux memfd with F_SEAL_SHRINK and F_SEAL_WRITE).
+	// That makes the mapping a private snapshot of the file, which can't raise SIGBUS.
+	// Returns false if the file can't be mapped (e.g. it isn't a regular file, isn't sealed, or the
+	// platform doesn't support mapping files), in which case the pages aren't modified.
+	WAVM_API bool mapFileToVirtualPages(U8* baseVirtualAddress,
+										Uptr numPages,
+										Uptr hostDescriptor,
+										U64 fileOffset);
+
+	// Maps the whole contents of a file to newly allocated read-only virtual pages. Changes to the
+	// file while it is mapped may be visible through the mapping. hostDescriptor is a file
+	// descriptor as returned by VFS::VFD::getHostDescriptor, and may be closed without unmapping
+	// the file.
+	// The file must not be truncated while it is mapped: accessing the mapped pages past its new
+	// end raises SIGBUS.
+	// Returns nullptr if the file can't be mapped (e.g. it isn't a regular file, or is empty).
+	WAVM_API const U8* mapFile(Uptr hostDescriptor, Uptr& outNumBytes);
+
+	// Unmaps a file mapped by mapFile.
+	WAVM_API void unmapFile(const U8* baseAddress, Uptr numBytes);
+
 	// Frees virtual addresses. baseVirtualAddress must also be the address returned by
 	// allocateVirtualPages.
 	WAVM_API void freeVirtualPages(U8* baseVirtualAddress, Uptr numPages);
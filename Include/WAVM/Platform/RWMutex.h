@@ -41,6 +41,10 @@ namespace WAVM { namespace Platform {
 			{
 				mutex->lock(shareability);
 			}
+			Lock(Lock&& movee) noexcept : mutex(movee.mutex), shareability(movee.shareability)
+			{
+				movee.mutex = nullptr;
+			}
 			~Lock() { unlock(); }
 
 			void unlock()
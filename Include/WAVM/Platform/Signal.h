@@ -29,4 +29,26 @@ namespace WAVM { namespace Platform {
 	WAVM_API bool catchSignals(void (*thunk)(void*),
 							   bool (*filter)(void*, Signal, UnwindState&&),
 							   void* argument);
+
+	// The maximum number of frames in a sampled call stack.
+	inline constexpr Uptr maxSampleFrames = 64;
+
+	// Starts interrupting the process at the given rate, in samples per second of CPU time used by
+	// the process. Each interruption calls sampleCallback on the thread that was interrupted with
+	// the interrupted call stack: the address of the interrupted instruction, followed by return
+	// addresses from innermost to outermost. sampleCallback is called from a signal handler, so
+	// must be signal-safe. Only one sampler may be active at a time. Returns false if sampling
+	// isn't supported by the platform.
+	// The call stack is captured by following the chain of frame pointers, since unwinding with
+	// the unwind tables isn't signal-safe. A frame that doesn't maintain the frame pointer hides
+	// its caller, and the stack stops at the first frame pointer that doesn't point further up the
+	// thread's stack. Threads that haven't run WAVM code only report the interrupted instruction.
+	// Sampling may cause blocking system calls that can't be restarted to fail with EINTR.
+	WAVM_API bool startSampling(Uptr samplesPerSecond,
+								void (*sampleCallback)(void*, const Uptr* ips, Uptr numIPs),
+								void* argument);
+
+	// Stops the active sampler. When this returns, sampleCallback won't be called again, and all
+	// calls to it have returned.
+	WAVM_API void stopSampling();
 }}
@@ -129,6 +129,13 @@ namespace WAVM { namespace Intrinsics {
 								IR::TypeTuple({IR::inferValueType<Args>()...}),
 								WAVM::IR::CallingConvention::intrinsicWithContextSwitch);
 	}
+	template<typename R, typename... Args>
+	IR::FunctionType inferLeafIntrinsicFunctionType(R (*)(Args...))
+	{
+		return IR::FunctionType(IR::inferResultType<R>(),
+								IR::TypeTuple({IR::inferValueType<Args>()...}),
+								WAVM::IR::CallingConvention::c);
+	}
 }}
 
 #define WAVM_DEFINE_INTRINSIC_MODULE(name)                                                         \
@@ -152,6 +159,23 @@ namespace WAVM { namespace Intrinsics {
 		WAVM::Intrinsics::inferIntrinsicFunctionType(&cName));                                     \
 	static Result cName(WAVM::Runtime::ContextRuntimeData* contextRuntimeData, ##__VA_ARGS__)
 
+// Defines an intrinsic function that doesn't need the ContextRuntimeData: it must not call back
+// into WebAssembly code, grow or unmap memories or tables, or throw exceptions. It is called with
+// the plain C calling convention, so it doesn't need to be passed the context pointer.
+// Compiled code that calls a leaf intrinsic directly (the wavmIntrinsics called by the JIT, or
+// the thunk generated for an intrinsic module's function) doesn't reload the memory base pointers
+// after the call. A WebAssembly module that imports a leaf intrinsic still calls it through the
+// thunk and reloads the memory base pointers afterward, since its imports are only bound after it
+// is compiled.
+#define WAVM_DEFINE_LEAF_INTRINSIC_FUNCTION(module, nameString, Result, cName, ...)                \
+	static Result cName(__VA_ARGS__);                                                              \
+	static WAVM::Intrinsics::Function cName##Intrinsic(                                            \
+		getIntrinsicModule_##module(),                                                             \
+		nameString,                                                                                \
+		(void*)&cName,                                                                             \
+		WAVM::Intrinsics::inferLeafIntrinsicFunctionType(&cName));                                 \
+	static Result cName(__VA_ARGS__)
+
 #define WAVM_DEFINE_INTRINSIC_FUNCTION_WITH_CONTEXT_SWITCH(module, nameString, Result, cName, ...) \
 	static WAVM::Intrinsics::ResultInContextRuntimeData<Result>* cName(                            \
 		WAVM::Runtime::ContextRuntimeData* contextRuntimeData, ##__VA_ARGS__);                     \
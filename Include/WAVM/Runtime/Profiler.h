@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+#include "WAVM/Inline/BasicTypes.h"
+
+namespace WAVM { namespace Runtime {
+
+	enum class ProfileFormat
+	{
+		// Folded stacks, as consumed by flamegraph.pl and similar tools: one line per unique call
+		// stack, with the frames from outermost to innermost separated by ';', followed by a space
+		// and the number of samples of that stack.
+		foldedStacks,
+
+		// An uncompressed pprof profile.proto. The line numbers of WebAssembly frames are the
+		// indices of the sampled instructions within their function.
+		pprof,
+	};
+
+	// Starts sampling the call stacks of the threads in the process at the given rate, in samples
+	// per second of CPU time. Samples are taken by interrupting the running thread with a signal,
+	// so the cost of sampling is proportional to the rate. Returns false if the platform doesn't
+	// support sampling, or a profile is already being recorded.
+	// Samples are resolved to functions periodically while profiling, so samples of code that is
+	// freed while profiling may be attributed to an unknown function.
+	WAVM_API bool startProfiling(Uptr samplesPerSecond = 1000);
+
+	// Stops sampling, and returns the profile recorded since startProfiling in the given format.
+	WAVM_API std::vector<U8> stopProfiling(ProfileFormat format);
+}}
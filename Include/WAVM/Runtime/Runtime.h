@@ -3,12 +3,14 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include "WAVM/IR/FeatureSpec.h"
 #include "WAVM/IR/Types.h"
 #include "WAVM/IR/Value.h"
 #include "WAVM/Inline/BasicTypes.h"
 #include "WAVM/Inline/Config.h"
+#include "WAVM/Inline/SharedBytes.h"
 #include "WAVM/Inline/StringBuilder.h"
 #include "WAVM/Platform/Defines.h"
 #include "WAVM/Platform/Diagnostics.h"
@@ -355,6 +357,95 @@ namespace WAVM { namespace Runtime {
 								 const IR::UntaggedValue arguments[] = nullptr,
 								 IR::UntaggedValue results[] = nullptr);
 
+	// Checks that a Function can be invoked with the given signature, and prepares it to be invoked
+	// by invokeFunctionUnchecked. If it can't, an invokeSignatureMismatch exception is thrown.
+	WAVM_API void checkInvokeSignature(const Function* function, IR::FunctionType invokeSig);
+
+	// Invokes a Function like invokeFunction, but without checking the invoke signature. The
+	// function must have been checked by checkInvokeSignature with the signature the arguments and
+	// results arrays are laid out for.
+	// If catchSignals is false, the caller must already be inside an unwindSignalsAsExceptions or
+	// catchRuntimeExceptions thunk, which will catch any signal raised by the function. The signal
+	// unwinds directly to that thunk without calling destructors of any C++ frames in between.
+	WAVM_API void invokeFunctionUnchecked(Context* context,
+										  const Function* function,
+										  const IR::UntaggedValue arguments[],
+										  IR::UntaggedValue results[],
+										  bool catchSignals = true);
+
+	// A Function and Context bound together, with the function's type checked against a C++
+	// signature when it's bound. Calling it doesn't check the function's type again.
+	template<typename Signature> struct TypedFunction;
+	template<typename Result, typename... Args> struct TypedFunction<Result(Args...)>
+	{
+		TypedFunction(Context* inContext, const Function* inFunction)
+		: context(inContext), function(inFunction)
+		{
+			checkInvokeSignature(function,
+								 IR::FunctionType(inferResultType<Result>(),
+												  IR::TypeTuple({inferValueType<Args>()...})));
+		}
+
+		// Calls the function, translating any signals it raises to runtime exceptions.
+		Result operator()(Args... args) const { return invoke(true, args...); }
+
+		// Calls the function without a signal-catching frame of its own: see the catchSignals
+		// parameter of invokeFunctionUnchecked. This avoids the cost of setting up the frame on
+		// every call when calling the function many times from one unwindSignalsAsExceptions thunk.
+		Result callWithinSignalScope(Args... args) const { return invoke(false, args...); }
+
+	private:
+		Context* context;
+		const Function* function;
+
+		// IR::inferValueType doesn't infer v128 from V128, since intrinsic functions can't take
+		// or return V128 values, but TypedFunction passes them through UntaggedValues.
+		template<typename T> static constexpr IR::ValueType inferValueType()
+		{
+			if constexpr(std::is_same_v<T, V128>) { return IR::ValueType::v128; }
+			else
+			{
+				return IR::inferValueType<T>();
+			}
+		}
+		template<typename T> static IR::TypeTuple inferResultType()
+		{
+			if constexpr(std::is_same_v<T, V128>) { return IR::TypeTuple(IR::ValueType::v128); }
+			else
+			{
+				return IR::inferResultType<T>();
+			}
+		}
+
+		Result invoke(bool catchSignals, Args... args) const
+		{
+			IR::UntaggedValue arguments[sizeof...(Args) + 1] = {IR::UntaggedValue(args)...};
+			IR::UntaggedValue results[1];
+			invokeFunctionUnchecked(context, function, arguments, results, catchSignals);
+
+			if constexpr(!std::is_void_v<Result>)
+			{
+				constexpr IR::ValueType type = inferValueType<Result>();
+				const IR::UntaggedValue& result = results[0];
+				static_assert(type == IR::ValueType::i32 || type == IR::ValueType::i64
+								  || type == IR::ValueType::f32 || type == IR::ValueType::f64
+								  || type == IR::ValueType::v128 || type == IR::ValueType::funcref
+								  || type == IR::ValueType::externref,
+							  "Unsupported TypedFunction result type");
+				if constexpr(type == IR::ValueType::i32) { return Result(result.u32); }
+				else if constexpr(type == IR::ValueType::i64) { return Result(result.u64); }
+				else if constexpr(type == IR::ValueType::f32) { return result.f32; }
+				else if constexpr(type == IR::ValueType::f64) { return result.f64; }
+				else if constexpr(type == IR::ValueType::v128) { return result.v128; }
+				else if constexpr(type == IR::ValueType::funcref) { return result.function; }
+				else
+				{
+					return result.object;
+				}
+			}
+		}
+	};
+
 	// Returns the type of a Function.
 	WAVM_API IR::FunctionType getFunctionType(const Function* function);
 
@@ -414,6 +505,21 @@ namespace WAVM { namespace Runtime {
 	// Unmaps a range of memory pages within the memory's address-space.
 	WAVM_API void unmapMemoryPages(Memory* memory, Uptr pageIndex, Uptr numPages);
 
+	// Maps numPages pages of a file, starting at fileOffset, over the memory's pages starting at
+	// pageIndex. The pages must be within the memory's current size, and fileOffset must be a
+	// multiple of IR::numBytesPerPage. The mapping is copy-on-write: writes to the pages are
+	// private to the memory, and pages past the end of the file read as zeros. hostDescriptor is a
+	// file descriptor as returned by VFS::VFD::getHostDescriptor. Returns false if the file can't
+	// be mapped, in which case the memory isn't modified. The pages may be unmapped with
+	// unmapMemoryPages.
+	// Only files that are sealed against being shrunk or written can be mapped (see
+	// Platform::mapFileToVirtualPages), so the pages are a snapshot of the file that can't fault.
+	WAVM_API bool mapFileToMemoryPages(Memory* memory,
+									   Uptr pageIndex,
+									   Uptr numPages,
+									   Uptr hostDescriptor,
+									   U64 fileOffset);
+
 	// Validates that an offset range is wholly inside a Memory's virtual address range.
 	// Note that this returns an address range that may fault on access, though it's guaranteed not
 	// to be mapped by anything other than the given Memory.
@@ -469,26 +575,82 @@ namespace WAVM { namespace Runtime {
 	typedef const std::shared_ptr<const Module>& ModuleConstRefParam;
 
 	// Compiles an IR module to object code.
-	WAVM_API ModuleRef compileModule(const IR::Module& irModule);
+	// If releaseFunctionBodies is true, the compiled module only keeps the function bodies in the
+	// form of the binary module they were compiled from. They are decoded again each time
+	// getModuleIRWithFunctionBodies is called for the module.
+	WAVM_API ModuleRef compileModule(const IR::Module& irModule,
+									 bool releaseFunctionBodies = false);
 
 	// Load and compiles a binary module, returning either an error or a module.
 	// If true is returned, the load succeeded, and outModule contains the loaded module.
 	// If false is returned, the load failed. If outError != nullptr, *outError will contain the
 	// error that caused the load to fail.
+	// releaseFunctionBodies has the same meaning as for compileModule: if it's true, the module
+	// keeps a copy of wasmBytes instead of the decoded function bodies.
 	WAVM_API bool loadBinaryModule(const U8* wasmBytes,
 								   Uptr numWASMBytes,
 								   ModuleRef& outModule,
 								   const IR::FeatureSpec& featureSpec = IR::FeatureSpec(),
+								   WASM::LoadError* outError = nullptr,
+								   bool releaseFunctionBodies = false);
+
+	// Loads and compiles a binary module like the above, but the module's data segments and custom
+	// sections reference the bytes in wasmBytes instead of copying them. If releaseFunctionBodies
+	// is true, the module keeps a reference to wasmBytes to decode the function bodies from, so
+	// releasing them doesn't copy anything (e.g. the bytes of a mapped module file, which the OS
+	// may page out while they aren't used).
+	WAVM_API bool loadBinaryModule(const SharedBytes& wasmBytes,
+								   ModuleRef& outModule,
+								   const IR::FeatureSpec& featureSpec = IR::FeatureSpec(),
+								   WASM::LoadError* outError = nullptr,
+								   bool releaseFunctionBodies = false);
+
+	// Loads and compiles a binary module incrementally, as its bytes become available (e.g. while
+	// the module is being downloaded). The module's function bodies are decoded and validated as
+	// soon as all their bytes have been fed to the stream, so decoding overlaps with receiving the
+	// module, and only the compilation of the module to object code waits for the final bytes.
+	struct ModuleStream;
+	WAVM_API ModuleStream* createModuleStream(const IR::FeatureSpec& featureSpec
+											  = IR::FeatureSpec());
+	WAVM_API void destroyModuleStream(ModuleStream* stream);
+
+	// Feeds the next bytes of the module to the stream. Returns false if the bytes fed so far are
+	// not the start of a valid module, in which case the stream can't accept any more bytes. If
+	// outError != nullptr, *outError will contain the error that caused the load to fail.
+	WAVM_API bool feedModuleStream(ModuleStream* stream,
+								   const U8* bytes,
+								   Uptr numBytes,
 								   WASM::LoadError* outError = nullptr);
 
+	// Signals that all the module's bytes have been fed to the stream, and compiles the module.
+	// If true is returned, the load succeeded, and outModule contains the loaded module. After
+	// that, it's a fatal error to feed or finish the stream again, but it must still be destroyed
+	// by destroyModuleStream.
+	WAVM_API bool finishModuleStream(ModuleStream* stream,
+									 ModuleRef& outModule,
+									 WASM::LoadError* outError = nullptr);
+
 	// Loads a previously compiled module from a combination of an IR module and the object code
 	// returned by getObjectCode for the previously compiled module.
 	WAVM_API ModuleRef loadPrecompiledModule(const IR::Module& irModule,
 											 const std::vector<U8>& objectCode);
 
-	// Accesses the IR for a compiled module.
+	// Loads a previously compiled module like the above, but shares the object code instead of
+	// copying it (e.g. the data of a custom section in a mapped module file).
+	WAVM_API ModuleRef loadPrecompiledModule(const IR::Module& irModule,
+											 const SharedBytes& objectCode);
+
+	// Accesses the IR for a compiled module. If the module's function bodies were released, the
+	// function definitions in the returned IR have empty code, but everything else is intact.
 	WAVM_NO_DANGLING WAVM_API const IR::Module& getModuleIR(ModuleConstRefParam module);
 
+	// Returns the IR for a compiled module including its function bodies, for uses like printing
+	// or disassembling the module. If the module's function bodies were released, this decodes
+	// the module again each time it's called, and the decoded IR is freed when the returned
+	// pointer is released. Otherwise, the returned pointer shares ownership of the module.
+	WAVM_API std::shared_ptr<const IR::Module> getModuleIRWithFunctionBodies(
+		ModuleConstRefParam module);
+
 	// Extracts the compiled object code for a module. This may be used as an input to
 	// loadPrecompiledModule to bypass redundant compilations of the module.
 	WAVM_API std::vector<U8> getObjectCode(ModuleConstRefParam module);
@@ -510,7 +672,9 @@ namespace WAVM { namespace Runtime {
 	// Gets the start function of a Instance.
 	WAVM_API Function* getStartFunction(const Instance* instance);
 
-	// Gets the default table/memory for a Instance.
+	// Gets the default table/memory for a Instance. If the module doesn't import or export its
+	// default table, its code may assume the table only holds the elements it was initialized
+	// with, so the caller must not modify the table's elements.
 	WAVM_API Memory* getDefaultMemory(const Instance* instance);
 	WAVM_API Table* getDefaultTable(const Instance* instance);
 
@@ -582,6 +746,16 @@ namespace WAVM { namespace Runtime {
 
 	WAVM_API Compartment* getCompartment(const Context* context);
 
+	// Sets the lowest stack address that code compiled with FeatureSpec::explicitStackLimitChecks
+	// may call a function at while executing in the context. If a function is called with the
+	// stack pointer below it, a stackOverflow exception is thrown. The runtime functions that
+	// WebAssembly code calls, including the one that throws the exception, don't check the limit,
+	// so there must be enough stack below it for them. A null limit (the default) disables the
+	// checks. The limit is an address on the stack of the thread that executes the context, so it
+	// must be changed if the context is used on another thread.
+	WAVM_API void setContextStackLimit(Context* context, const void* stackLimit);
+	WAVM_API const void* getContextStackLimit(const Context* context);
+
 	// Creates a new context, initializing its mutable global state from the given context.
 	WAVM_API Context* cloneContext(const Context* context, Compartment* newCompartment);
 
@@ -6,6 +6,7 @@
 
 #include <atomic>
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <utility>
 #include "WAVM/IR/IR.h"
@@ -61,7 +62,7 @@ namespace WAVM { namespace Runtime {
 	inline constexpr Uptr contextNumBytes = 16384;
 	inline constexpr Uptr maxThunkArgAndReturnBytes = 256;
 	inline constexpr Uptr maxMutableGlobals
-		= (contextNumBytes - maxThunkArgAndReturnBytes - sizeof(Context*))
+		= (contextNumBytes - maxThunkArgAndReturnBytes - sizeof(Context*) - sizeof(Uptr))
 		  / sizeof(IR::UntaggedValue);
 	inline constexpr Uptr contextRuntimeDataAlignment = 16384;
 
@@ -73,6 +74,11 @@ namespace WAVM { namespace Runtime {
 	{
 		U8 thunkArgAndReturnData[maxThunkArgAndReturnBytes];
 		Context* context;
+
+		// Code compiled with FeatureSpec::explicitStackLimitChecks traps with a stack overflow if
+		// a function is entered with the stack pointer below this address.
+		Uptr stackLimit;
+
 		IR::UntaggedValue mutableGlobals[maxMutableGlobals];
 	};
 
@@ -192,13 +198,29 @@ namespace WAVM { namespace Runtime {
 		Runtime::Function* function = nullptr;
 		Uptr numCodeBytes = 0;
 		std::atomic<Uptr> numRootReferences{0};
-		std::string debugName;
+
+		// The function's debug name is either owned by the FunctionMutableData, or is a string in
+		// a table of names that is shared with other FunctionMutableDatas (e.g. those created for
+		// each instance of a module), and is kept alive by sharedDebugNames.
+		std::string ownedDebugName;
+		std::shared_ptr<const void> sharedDebugNames;
+		const std::string* sharedDebugName = nullptr;
+
 		std::atomic<InvokeThunkPointer> invokeThunk{nullptr};
 		void* userData{nullptr};
 		void (*finalizeUserData)(void*);
 
 		FunctionMutableData(std::string&& inDebugName)
-		: debugName(inDebugName), userData(nullptr), finalizeUserData(nullptr)
+		: ownedDebugName(std::move(inDebugName)), userData(nullptr), finalizeUserData(nullptr)
+		{
+		}
+
+		FunctionMutableData(const std::shared_ptr<const void>& inSharedDebugNames,
+							const std::string& inDebugName)
+		: sharedDebugNames(inSharedDebugNames)
+		, sharedDebugName(&inDebugName)
+		, userData(nullptr)
+		, finalizeUserData(nullptr)
 		{
 		}
 
@@ -207,6 +229,11 @@ namespace WAVM { namespace Runtime {
 			WAVM_ASSERT(numRootReferences.load(std::memory_order_acquire) == 0);
 			if(finalizeUserData) { (*finalizeUserData)(userData); }
 		}
+
+		const std::string& getDebugName() const
+		{
+			return sharedDebugName ? *sharedDebugName : ownedDebugName;
+		}
 	};
 
 	struct Function
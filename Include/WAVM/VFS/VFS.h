@@ -49,6 +49,13 @@ namespace WAVM { namespace VFS {
 		pipe
 	};
 
+	enum class SocketShutdownMode
+	{
+		read,
+		write,
+		readWrite
+	};
+
 	enum class VFDSync
 	{
 		none,
@@ -110,6 +117,16 @@ namespace WAVM { namespace VFS {
 		Uptr numBytes;
 	};
 
+	struct SocketRecvFlags
+	{
+		// If true, the received data is not removed from the socket's receive queue.
+		bool peek{false};
+
+		// If true, the receive blocks until the buffers are full, the peer closes the connection,
+		// or an error occurs.
+		bool waitAll{false};
+	};
+
 	// Error codes
 	// clang-format off
 
@@ -154,10 +171,19 @@ namespace WAVM { namespace VFS {
 		v(isDirectory, "Is a directory") \
 		v(isNotDirectory, "Isn't a directory") \
 		v(isNotEmpty, "Directory isn't empty") \
+		v(isNotSymbolicLink, "Isn't a symbolic link") \
+		v(crossesDevices, "Link crosses devices") \
 		v(brokenPipe, "Pipe is broken") \
 		v(missingDevice, "Device is missing") \
 		v(busy, "Device or resource busy") \
-		v(notSupported, "Operation not supported")
+		v(notSupported, "Operation not supported") \
+		/* Socket errors */ \
+		v(notSocket, "File descriptor is not a socket") \
+		v(notConnected, "Socket is not connected") \
+		v(connectionRefused, "Connection refused") \
+		v(connectionReset, "Connection reset by peer") \
+		v(addressInUse, "Address already in use") \
+		v(invalidAddress, "Invalid socket address")
 
 	enum class Result : I32
 	{
@@ -205,6 +231,12 @@ namespace WAVM { namespace VFS {
 		virtual Result getFileInfo(FileInfo& outInfo) = 0;
 		virtual Result setVFDFlags(const VFDFlags& flags) = 0;
 		virtual Result setFileSize(U64 numBytes) = 0;
+
+		// Allocates storage for the byte range [offset, offset + numBytes) of the file, extending
+		// the file if the range ends past the end of the file. Writes to the range won't fail for
+		// lack of free space, and may be faster than writes that extend the file.
+		virtual Result allocate(U64 offset, U64 numBytes) = 0;
+
 		virtual Result setFileTimes(bool setLastAccessTime,
 									Time lastAccessTime,
 									bool setLastWriteTime,
@@ -213,6 +245,24 @@ namespace WAVM { namespace VFS {
 
 		virtual Result openDir(DirEntStream*& outStream) = 0;
 
+		// Socket operations: VFDs that aren't sockets return Result::notSocket.
+		virtual Result recv(const IOReadBuffer* buffers,
+							Uptr numBuffers,
+							SocketRecvFlags flags,
+							Uptr* outNumBytesRead = nullptr,
+							bool* outDataTruncated = nullptr)
+			= 0;
+		virtual Result send(const IOWriteBuffer* buffers,
+							Uptr numBuffers,
+							Uptr* outNumBytesWritten = nullptr)
+			= 0;
+		virtual Result shutdown(SocketShutdownMode mode) = 0;
+		virtual Result accept(VFD*& outVFD, const VFDFlags& flags = VFDFlags{}) = 0;
+
+		// Gets the host descriptor that backs the VFD, so a host Reactor can wait on it. VFDs that
+		// aren't backed by a host descriptor return Result::notSupported.
+		virtual Result getHostDescriptor(Uptr& outDescriptor) = 0;
+
 		Result read(void* outData,
 					Uptr numBytes,
 					Uptr* outNumBytesRead = nullptr,
@@ -259,6 +309,51 @@ namespace WAVM { namespace VFS {
 		virtual Result unlinkFile(const std::string& path) = 0;
 		virtual Result removeDir(const std::string& path) = 0;
 		virtual Result createDir(const std::string& path) = 0;
+
+		// Creates a new directory entry at newPath for the file at existingPath. If existingPath is
+		// a symbolic link, the new entry refers to the link, not to the file it points to.
+		virtual Result createHardLink(const std::string& existingPath, const std::string& newPath)
+			= 0;
+
+		// Creates a symbolic link at linkPath. The target path is stored in the link unmodified,
+		// and if it is relative, is interpreted relative to the directory containing the link.
+		virtual Result createSymbolicLink(const std::string& targetPath,
+										  const std::string& linkPath)
+			= 0;
+		virtual Result readSymbolicLink(const std::string& path, std::string& outTargetPath) = 0;
+	};
+
+	// An entry in the set of VFDs that a Reactor waits on.
+	struct PollEntry
+	{
+		VFD* vfd{nullptr};
+
+		// The readiness to wait for.
+		bool waitForRead{false};
+		bool waitForWrite{false};
+
+		// The readiness observed by Reactor::poll. If the VFD can't be polled, error is set and the
+		// entry is counted as ready.
+		bool readable{false};
+		bool writable{false};
+		bool hangup{false};
+		Result error{Result::success};
+	};
+
+	// Waits for I/O readiness on many VFDs at once. A Reactor may keep state about the VFDs it has
+	// waited on between calls to poll, so it should be reused for repeated waits on the same VFDs.
+	// A Reactor may only be used by one thread at a time.
+	struct Reactor
+	{
+		virtual ~Reactor() {}
+
+		// Waits until at least one entry is ready or the timeout elapses, and writes the number of
+		// ready entries to outNumReadyEntries. A timeout of Time::infinity() waits indefinitely.
+		virtual Result poll(PollEntry* entries,
+							Uptr numEntries,
+							Time timeout,
+							Uptr& outNumReadyEntries)
+			= 0;
 	};
 
 	WAVM_API const char* describeResult(Result result);
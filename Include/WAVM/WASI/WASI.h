@@ -20,13 +20,37 @@ namespace WAVM { namespace WASI {
 
 	struct Process;
 
+	enum class StdioBuffering
+	{
+		// Each write to stdout or stderr is passed directly to the host VFD.
+		none,
+		// Writes are buffered until a newline is written or the buffer is full.
+		line,
+		// Writes are buffered until the buffer is full.
+		full,
+	};
+
+	// Configures how a process's writes to stdout and stderr are handled. Buffered output is
+	// flushed when the buffer is full, when the process calls fd_sync or fd_datasync on the FD,
+	// when the process calls proc_exit, and when the process is destroyed.
+	struct StdioConfig
+	{
+		StdioBuffering buffering = StdioBuffering::none;
+		Uptr numBufferBytes = 4096;
+
+		// If non-zero, the last numCaptureBytes written to stdout and stderr are kept in a ring
+		// buffer that may be read with drainProcessStdioCapture.
+		Uptr numCaptureBytes = 0;
+	};
+
 	WAVM_API std::shared_ptr<Process> createProcess(Runtime::Compartment* compartment,
 													std::vector<std::string>&& inArgs,
 													std::vector<std::string>&& inEnvs,
 													VFS::FileSystem* fileSystem,
 													VFS::VFD* stdIn,
 													VFS::VFD* stdOut,
-													VFS::VFD* stdErr);
+													VFS::VFD* stdErr,
+													const StdioConfig& stdioConfig = StdioConfig());
 
 	WAVM_API Runtime::Resolver& getProcessResolver(Process& process);
 
@@ -34,6 +58,22 @@ namespace WAVM { namespace WASI {
 	WAVM_API Runtime::Memory* getProcessMemory(const Process& process);
 	WAVM_API void setProcessMemory(Process& process, Runtime::Memory* memory);
 
+	// Adds a listening socket to the process's FD table, and returns the FD it was assigned. The
+	// process takes ownership of the VFD. The guest may accept connections from the socket with
+	// sock_accept, but it isn't reported as a preopened directory.
+	WAVM_API U32 addProcessListeningSocket(Process& process,
+										   VFS::VFD* socketVFD,
+										   std::string&& address);
+
+	// Writes any buffered stdout and stderr output to the host VFDs.
+	WAVM_API void flushProcessStdio(Process& process);
+
+	// Removes the output captured since the last call from the process's capture ring buffer, and
+	// returns it. If outNumDroppedBytes is non-null, it receives the number of bytes that were
+	// overwritten because the ring buffer was full.
+	WAVM_API std::string drainProcessStdioCapture(Process& process,
+												  Uptr* outNumDroppedBytes = nullptr);
+
 	enum class SyscallTraceLevel
 	{
 		none,
@@ -4,6 +4,7 @@
 #include <vector>
 #include "WAVM/IR/Validate.h"
 #include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/SharedBytes.h"
 
 namespace WAVM { namespace IR {
 	struct Module;
@@ -20,6 +21,11 @@ namespace WAVM { namespace WASM {
 	// If true is returned, the load succeeded, and outModule contains the loaded module.
 	// If false is returned, the load failed. If outError != nullptr, *outError will contain the
 	// error that caused the load to fail.
+	// The function bodies in the module's code section are decoded and validated by up to
+	// maxCodeDecodeThreads threads, including the calling thread. If it is 0, the number of threads
+	// is chosen from the number of hardware threads and the size of the code section. The result
+	// doesn't depend on the number of threads: if more than one function body is malformed or
+	// invalid, the error in the body with the lowest index is reported.
 	struct LoadError
 	{
 		enum class Type
@@ -33,5 +39,39 @@ namespace WAVM { namespace WASM {
 	WAVM_API bool loadBinaryModule(const U8* wasmBytes,
 								   Uptr numWASMBytes,
 								   IR::Module& outModule,
-								   LoadError* outError = nullptr);
+								   LoadError* outError = nullptr,
+								   Uptr maxCodeDecodeThreads = 0);
+
+	// Loads a binary module like the above, but the data segments and custom sections of the
+	// loaded module reference the bytes in wasmBytes instead of copying them, and share ownership
+	// of their storage (e.g. a mapped file).
+	WAVM_API bool loadBinaryModule(const SharedBytes& wasmBytes,
+								   IR::Module& outModule,
+								   LoadError* outError = nullptr,
+								   Uptr maxCodeDecodeThreads = 0);
+
+	// Decodes a binary module incrementally, as its bytes become available (e.g. while the module
+	// is being downloaded). Sections are decoded and validated once all their bytes have been fed
+	// to the decoder, except for the code section, whose function bodies are each decoded and
+	// validated as soon as all of the body's bytes have been fed to the decoder.
+	struct ModuleStreamDecoder;
+
+	// Creates a decoder that decodes a module into outModule, which must outlive the decoder.
+	WAVM_API ModuleStreamDecoder* createModuleStreamDecoder(IR::Module& outModule);
+	WAVM_API void destroyModuleStreamDecoder(ModuleStreamDecoder* decoder);
+
+	// Feeds the next bytes of the module to the decoder. The bytes are copied, so they don't need
+	// to outlive the call. Returns false if the bytes fed so far are not the start of a valid
+	// module, in which case the decoder can't decode any more bytes. If outError != nullptr,
+	// *outError will contain the error that caused the decoding to fail.
+	WAVM_API bool feedModuleStreamDecoder(ModuleStreamDecoder* decoder,
+										  const U8* bytes,
+										  Uptr numBytes,
+										  LoadError* outError = nullptr);
+
+	// Signals that all the module's bytes have been fed to the decoder. Returns true if they form
+	// a valid module, which has been decoded to the decoder's output module. Once it has returned
+	// true, it's a fatal error to feed or finish the decoder again.
+	WAVM_API bool finishModuleStreamDecoder(ModuleStreamDecoder* decoder,
+											LoadError* outError = nullptr);
 }}
@@ -39,6 +39,7 @@ typedef struct wasm_ref_t wasm_ref_t;
 typedef struct wasm_trap_t wasm_trap_t;
 typedef struct wasm_foreign_t wasm_foreign_t;
 typedef struct wasm_module_t wasm_module_t;
+typedef struct wasm_module_stream_t wasm_module_stream_t;
 typedef struct wasm_func_t wasm_func_t;
 typedef struct wasm_table_t wasm_table_t;
 typedef struct wasm_memory_t wasm_memory_t;
@@ -117,6 +118,7 @@ WASM_DECLARE_FEATURE(multivalue)
 WASM_DECLARE_FEATURE(reference_types)
 WASM_DECLARE_FEATURE(extended_name_section)
 WASM_DECLARE_FEATURE(multimemory)
+WASM_DECLARE_FEATURE(relaxed_simd)
 
 // Non-standard extensions.
 WASM_DECLARE_FEATURE(shared_tables)
@@ -440,6 +442,19 @@ WASM_C_API own char* wasm_module_print(const wasm_module_t* module, size_t* out_
 
 WASM_C_API bool wasm_module_validate(const char* binary, size_t num_binary_bytes);
 
+// Streaming module compilation: the module's bytes are fed to a stream as they become available,
+// and decoded as they arrive. wasm_module_new_streaming compiles the module once all its bytes have
+// been fed to the stream, and returns NULL if they are not a valid module. Once it has returned a
+// module, the stream may only be deleted.
+
+WASM_DECLARE_OWN(module_stream)
+
+WASM_C_API own wasm_module_stream_t* wasm_module_stream_new(wasm_engine_t*);
+WASM_C_API bool wasm_module_stream_feed(wasm_module_stream_t*,
+										const char* bytes,
+										size_t num_bytes);
+WASM_C_API own wasm_module_t* wasm_module_new_streaming(wasm_module_stream_t*);
+
 WASM_C_API size_t wasm_module_num_imports(const wasm_module_t* module);
 WASM_C_API void wasm_module_import(const wasm_module_t* module,
 								   size_t index,
@@ -469,6 +484,16 @@ WASM_C_API own wasm_func_t* wasm_func_new_with_env(wasm_compartment_t*,
 												   void (*finalizer)(void*),
 												   const char* debug_name);
 
+// Creates a function that calls native_function directly with the C calling convention: it is
+// passed the function's parameters as C arguments, and returns its result (if any) as a C return
+// value. This avoids marshalling the arguments and results through arrays, but the function must
+// not call back into WebAssembly or trap, and may have at most one result. Returns NULL if the
+// function type has more than one result. debug_name may be NULL.
+WASM_C_API own wasm_func_t* wasm_func_new_native(wasm_compartment_t*,
+												 const wasm_functype_t*,
+												 void* native_function,
+												 const char* debug_name);
+
 WASM_C_API own wasm_functype_t* wasm_func_type(const wasm_func_t*);
 WASM_C_API size_t wasm_func_param_arity(const wasm_func_t*);
 WASM_C_API size_t wasm_func_result_arity(const wasm_func_t*);
@@ -1,8 +1,10 @@
 // Signal-safe, zero-allocation DWARF v4/v5 parser for source location lookup.
 // Parses .debug_info, .debug_abbrev, and .debug_str on-the-fly to resolve
-// an instruction address to a chain of source locations (for inline functions).
+// an instruction address to a chain of source locations (for inline functions),
+// or ahead of time to build a sorted AddressIndex for faster lookups.
 
 #include "WAVM/DWARF/DWARF.h"
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
 #include "WAVM/DWARF/Constants.h"
@@ -650,28 +652,30 @@ static void readDIENames(const U8* debugInfo,
 	}
 }
 
-// Look up the line number at a given address in the DWARF line number program.
-// Returns the line number, or 0 if not found.
+// Run the DWARF line number program at the given offset in .debug_line, calling
+// visitRow(address, line, isEndSequence) for each row it emits. If visitRow returns false, the
+// program is stopped without visiting the remaining rows.
 // Signal-safe: no allocations.
-static Uptr lookupLineAtAddress(const U8* debugLine,
-								Uptr debugLineSize,
-								Uptr stmtListOffset,
-								Uptr targetAddress,
-								U8 addrSize)
+template<typename VisitRow>
+static void forEachLineRow(const U8* debugLine,
+						   Uptr debugLineSize,
+						   Uptr stmtListOffset,
+						   U8 addrSize,
+						   VisitRow&& visitRow)
 {
-	if(!debugLine || stmtListOffset >= debugLineSize) { return 0; }
+	if(!debugLine || stmtListOffset >= debugLineSize) { return; }
 
 	MemoryInputStream lineStream(debugLine + stmtListOffset, debugLineSize - stmtListOffset);
 
 	// Read unit_length.
 	U32 initialLength;
-	if(!tryRead(lineStream, initialLength)) { return 0; }
+	if(!tryRead(lineStream, initialLength)) { return; }
 	U8 fmt;
 	Uptr unitLength;
 	if(initialLength == 0xFFFFFFFF)
 	{
 		U64 len64;
-		if(!tryRead(lineStream, len64)) { return 0; }
+		if(!tryRead(lineStream, len64)) { return; }
 		fmt = 8;
 		unitLength = Uptr(len64);
 	}
@@ -682,12 +686,12 @@ static Uptr lookupLineAtAddress(const U8* debugLine,
 	}
 
 	// Create a sub-stream for this unit's data.
-	if(unitLength > lineStream.capacity()) { return 0; }
+	if(unitLength > lineStream.capacity()) { return; }
 	MemoryInputStream stream(lineStream.tryAdvance(unitLength), unitLength);
 
 	// Version.
 	U16 version;
-	if(!tryRead(stream, version)) { return 0; }
+	if(!tryRead(stream, version)) { return; }
 
 	Log::printf(Log::traceDwarf,
 				"  Line table: version=%u fmt=%u unitLength=%" WAVM_PRIuPTR "\n",
@@ -698,7 +702,7 @@ static Uptr lookupLineAtAddress(const U8* debugLine,
 	// DWARF v5 has address_size and segment_selector_size before header_length.
 	if(version >= 5)
 	{
-		if(!stream.tryAdvance(2)) { return 0; } // skip address_size and segment_selector_size
+		if(!stream.tryAdvance(2)) { return; } // skip address_size and segment_selector_size
 	}
 
 	// header_length.
@@ -706,34 +710,34 @@ static Uptr lookupLineAtAddress(const U8* debugLine,
 	if(fmt == 8)
 	{
 		U64 hl;
-		if(!tryRead(stream, hl)) { return 0; }
+		if(!tryRead(stream, hl)) { return; }
 		headerLength = Uptr(hl);
 	}
 	else
 	{
 		U32 hl;
-		if(!tryRead(stream, hl)) { return 0; }
+		if(!tryRead(stream, hl)) { return; }
 		headerLength = Uptr(hl);
 	}
 
 	Uptr programStartPos = stream.position() + headerLength;
-	if(programStartPos > unitLength) { return 0; }
+	if(programStartPos > unitLength) { return; }
 
 	// Read header fields.
 	U8 minInstructionLength;
-	if(!tryRead(stream, minInstructionLength)) { return 0; }
+	if(!tryRead(stream, minInstructionLength)) { return; }
 	if(version >= 4)
 	{
-		if(!stream.tryAdvance(1)) { return 0; } // skip max_operations_per_instruction
+		if(!stream.tryAdvance(1)) { return; } // skip max_operations_per_instruction
 	}
-	if(!stream.tryAdvance(1)) { return 0; } // skip default_is_stmt
+	if(!stream.tryAdvance(1)) { return; } // skip default_is_stmt
 	U8 lineBaseU8;
-	if(!tryRead(stream, lineBaseU8)) { return 0; }
+	if(!tryRead(stream, lineBaseU8)) { return; }
 	I8 lineBase = I8(lineBaseU8);
 	U8 lineRange;
-	if(!tryRead(stream, lineRange)) { return 0; }
+	if(!tryRead(stream, lineRange)) { return; }
 	U8 opcodeBase;
-	if(!tryRead(stream, opcodeBase)) { return 0; }
+	if(!tryRead(stream, opcodeBase)) { return; }
 
 	Log::printf(Log::traceDwarf,
 				"  Line header: minInsnLen=%u lineBase=%d lineRange=%u opcodeBase=%u\n",
@@ -743,9 +747,9 @@ static Uptr lookupLineAtAddress(const U8* debugLine,
 				opcodeBase);
 
 	// Record standard opcode lengths (pointer into the underlying buffer).
-	if(opcodeBase < 1) { return 0; }
+	if(opcodeBase < 1) { return; }
 	const U8* stdOpLengths = stream.tryAdvance(opcodeBase - 1);
-	if(!stdOpLengths) { return 0; }
+	if(!stdOpLengths) { return; }
 
 	// Jump to program start.
 	stream.seek(programStartPos);
@@ -753,8 +757,6 @@ static Uptr lookupLineAtAddress(const U8* debugLine,
 	// State machine.
 	Uptr smAddress = 0;
 	I64 smLine = 1;
-	Uptr bestLine = 0;
-	bool found = false;
 
 	while(stream.capacity())
 	{
@@ -780,18 +782,13 @@ static Uptr lookupLineAtAddress(const U8* debugLine,
 			{
 			case DW_LNE_end_sequence:
 				Log::printf(Log::traceDwarf,
-							"  Line: end_sequence addr=0x%" WAVM_PRIxPTR " line=%" PRId64
-							" found=%d bestLine=%" WAVM_PRIuPTR "\n",
+							"  Line: end_sequence addr=0x%" WAVM_PRIxPTR " line=%" PRId64 "\n",
 							smAddress,
-							smLine,
-							(int)found,
-							bestLine);
-				if(found && targetAddress < smAddress) { return bestLine; }
+							smLine);
+				if(!visitRow(smAddress, Uptr(smLine), true)) { return; }
 				// Reset.
 				smAddress = 0;
 				smLine = 1;
-				found = false;
-				bestLine = 0;
 				break;
 			case DW_LNE_set_address: {
 				if(addrSize == 8)
@@ -822,12 +819,7 @@ static Uptr lookupLineAtAddress(const U8* debugLine,
 							"  Line: copy addr=0x%" WAVM_PRIxPTR " line=%" PRId64 "\n",
 							smAddress,
 							smLine);
-				if(smAddress <= targetAddress)
-				{
-					bestLine = Uptr(smLine);
-					found = true;
-				}
-				else if(found) { return bestLine; }
+				if(!visitRow(smAddress, Uptr(smLine), false)) { return; }
 				break;
 			case DW_LNS_advance_pc: {
 				U64 adv;
@@ -874,15 +866,44 @@ static Uptr lookupLineAtAddress(const U8* debugLine,
 						"  Line: special addr=0x%" WAVM_PRIxPTR " line=%" PRId64 "\n",
 						smAddress,
 						smLine);
-			// Emit row.
-			if(smAddress <= targetAddress)
-			{
-				bestLine = Uptr(smLine);
-				found = true;
-			}
-			else if(found) { return bestLine; }
+			if(!visitRow(smAddress, Uptr(smLine), false)) { return; }
 		}
 	}
+}
+
+// Look up the line number at a given address in the DWARF line number program.
+// Returns the line number, or 0 if not found.
+// Signal-safe: no allocations.
+static Uptr lookupLineAtAddress(const U8* debugLine,
+								Uptr debugLineSize,
+								Uptr stmtListOffset,
+								Uptr targetAddress,
+								U8 addrSize)
+{
+	Uptr bestLine = 0;
+	bool found = false;
+	forEachLineRow(debugLine,
+				   debugLineSize,
+				   stmtListOffset,
+				   addrSize,
+				   [&](Uptr rowAddress, Uptr rowLine, bool isEndSequence) {
+					   if(isEndSequence)
+					   {
+						   if(found && targetAddress < rowAddress) { return false; }
+						   found = false;
+						   bestLine = 0;
+					   }
+					   else if(rowAddress <= targetAddress)
+					   {
+						   bestLine = rowLine;
+						   found = true;
+					   }
+					   else if(found)
+					   {
+						   return false;
+					   }
+					   return true;
+				   });
 
 	Log::printf(Log::traceDwarf,
 				"  Line lookup result: found=%d bestLine=%" WAVM_PRIuPTR "\n",
@@ -891,263 +912,478 @@ static Uptr lookupLineAtAddress(const U8* debugLine,
 	return found ? bestLine : 0;
 }
 
-Uptr DWARF::getSourceLocations(const Sections& sections,
-							   Uptr address,
-							   SourceLocation* outLocations,
-							   Uptr maxLocations)
+// The header and top-level attributes of a compile unit.
+struct CompileUnit
 {
-	if(!sections.debugInfo || !sections.debugAbbrev || maxLocations == 0) { return 0; }
+	Uptr startPos; // Offset of the CU header in .debug_info.
+	U8 dwarfFormat; // 4 or 8 (DWARF32 vs DWARF64)
+	U8 addrSize;
+	Uptr abbrevOffset;
+	Uptr addrBase;
+	Uptr strOffsetsBase;
+	Uptr lowPC;
+	Uptr highPC;
+	Uptr stmtListOffset; // Uptr(-1) if the CU has no line table.
+
+	// The CU's data following the unit_length field, and the position within it of the CU DIE's
+	// first child.
+	const U8* data;
+	Uptr numDataBytes;
+	Uptr firstChildPos;
+};
+
+// Read the CU header and CU DIE at the current position of infoStream, and advance infoStream
+// to the next CU. Returns false if the CU can't be read, or isn't a compile unit.
+// Signal-safe: no allocations.
+static bool readCompileUnit(const Sections& sections,
+							MemoryInputStream& infoStream,
+							CompileUnit& outCU)
+{
+	outCU.startPos = infoStream.position();
+
+	// Parse CU header: initial length.
+	U32 initialLength;
+	if(!tryRead(infoStream, initialLength))
+	{
+		infoStream.seek(infoStream.position() + infoStream.capacity());
+		return false;
+	}
+	outCU.dwarfFormat = 4; // DWARF32
+	U64 cuLength;
+	if(initialLength == 0xFFFFFFFF)
+	{
+		// DWARF64
+		U64 len64;
+		if(!tryRead(infoStream, len64))
+		{
+			infoStream.seek(infoStream.position() + infoStream.capacity());
+			return false;
+		}
+		outCU.dwarfFormat = 8;
+		cuLength = len64;
+	}
+	else
+	{
+		cuLength = initialLength;
+	}
+	const U8 dwarfFormat = outCU.dwarfFormat;
+
+	// Create a sub-stream for this CU's data (after the length field).
+	Uptr clampedLength = Uptr(cuLength);
+	if(clampedLength > infoStream.capacity()) { clampedLength = infoStream.capacity(); }
+	outCU.data = infoStream.tryAdvance(clampedLength);
+	outCU.numDataBytes = clampedLength;
+	MemoryInputStream cuStream(outCU.data, clampedLength);
+
+	U16 version;
+	if(!tryRead(cuStream, version)) { return false; }
 
 	Log::printf(Log::traceDwarf,
-				"getSourceLocations: address=0x%" WAVM_PRIxPTR " debugInfo=%p(%" WAVM_PRIuPTR
-				") debugAbbrev=%p(%" WAVM_PRIuPTR ") debugStr=%p(%" WAVM_PRIuPTR
-				") debugLine=%p(%" WAVM_PRIuPTR ")\n",
-				address,
-				(const void*)sections.debugInfo,
-				sections.debugInfoSize,
-				(const void*)sections.debugAbbrev,
-				sections.debugAbbrevSize,
-				(const void*)sections.debugStr,
-				sections.debugStrSize,
-				(const void*)sections.debugLine,
-				sections.debugLineSize);
+				"  CU at offset %" WAVM_PRIuPTR ": version=%u dwarfFormat=%u length=%" PRIu64 "\n",
+				outCU.startPos,
+				version,
+				dwarfFormat,
+				cuLength);
 
-	MemoryInputStream infoStream(sections.debugInfo, sections.debugInfoSize);
+	U8 addrSize;
+	Uptr abbrevOffset;
 
-	// Scan CU headers to find the CU containing the address.
-	while(infoStream.capacity())
+	if(version >= 5)
+	{
+		// DWARF v5: version, unit_type, address_size, debug_abbrev_offset
+		U8 unitType;
+		if(!tryRead(cuStream, unitType)) { return false; }
+		if(!tryRead(cuStream, addrSize)) { return false; }
+		if(dwarfFormat == 8)
+		{
+			U64 v;
+			if(!tryRead(cuStream, v)) { return false; }
+			abbrevOffset = Uptr(v);
+		}
+		else
+		{
+			U32 v;
+			if(!tryRead(cuStream, v)) { return false; }
+			abbrevOffset = Uptr(v);
+		}
+		Log::printf(Log::traceDwarf,
+					"  v5 header: unitType=0x%02x addrSize=%u abbrevOffset=%" WAVM_PRIuPTR "\n",
+					unitType,
+					addrSize,
+					abbrevOffset);
+	}
+	else
 	{
-		Uptr cuStartPos = infoStream.position();
-
-		// Parse CU header: initial length.
-		U32 initialLength;
-		if(!tryRead(infoStream, initialLength)) { break; }
-		U8 dwarfFormat = 4; // DWARF32
-		U64 cuLength;
-		if(initialLength == 0xFFFFFFFF)
+		// DWARF v4 and earlier: version, debug_abbrev_offset, address_size
+		if(dwarfFormat == 8)
 		{
-			// DWARF64
-			U64 len64;
-			if(!tryRead(infoStream, len64)) { break; }
-			dwarfFormat = 8;
-			cuLength = len64;
+			U64 v;
+			if(!tryRead(cuStream, v)) { return false; }
+			abbrevOffset = Uptr(v);
 		}
 		else
 		{
-			cuLength = initialLength;
+			U32 v;
+			if(!tryRead(cuStream, v)) { return false; }
+			abbrevOffset = Uptr(v);
 		}
+		if(!tryRead(cuStream, addrSize)) { return false; }
+		Log::printf(Log::traceDwarf,
+					"  v4 header: addrSize=%u abbrevOffset=%" WAVM_PRIuPTR "\n",
+					addrSize,
+					abbrevOffset);
+	}
+	outCU.addrSize = addrSize;
+	outCU.abbrevOffset = abbrevOffset;
+
+	// Read the CU DIE to get the address range.
+	U64 cuAbbrevCode;
+	if(!trySerializeVarUInt64(cuStream, cuAbbrevCode)) { return false; }
+	if(cuAbbrevCode == 0) { return false; }
+
+	AbbrevEntry cuAbbrevBuf;
+	if(!findAbbrev(sections.debugAbbrev,
+				   sections.debugAbbrevSize,
+				   abbrevOffset,
+				   cuAbbrevCode,
+				   cuAbbrevBuf)
+	   || cuAbbrevBuf.tag != DW_TAG_compile_unit)
+	{
+		Log::printf(Log::traceDwarf,
+					"  CU DIE: abbrevCode=%" PRIu64 ", not compile_unit, skipping\n",
+					cuAbbrevCode);
+		return false;
+	}
 
-		// Create a sub-stream for this CU's data (after the length field).
-		Uptr clampedLength = Uptr(cuLength);
-		if(clampedLength > infoStream.capacity()) { clampedLength = infoStream.capacity(); }
-		MemoryInputStream cuStream(infoStream.tryAdvance(clampedLength), clampedLength);
-
-		U16 version;
-		if(!tryRead(cuStream, version)) { continue; }
+	Log::printf(Log::traceDwarf,
+				"  CU DIE: abbrevCode=%" PRIu64 " tag=compile_unit numAttrs=%" WAVM_PRIuPTR "\n",
+				cuAbbrevCode,
+				cuAbbrevBuf.numAttrs);
 
+	// Log all CU DIE attributes for debugging.
+	for(Uptr i = 0; i < cuAbbrevBuf.numAttrs; ++i)
+	{
 		Log::printf(Log::traceDwarf,
-					"  CU at offset %" WAVM_PRIuPTR ": version=%u dwarfFormat=%u length=%" PRIu64
-					"\n",
-					cuStartPos,
-					version,
-					dwarfFormat,
-					cuLength);
-
-		U8 addrSize;
-		Uptr abbrevOffset;
+					"    attr[%" WAVM_PRIuPTR "]: %s(0x%04x) form=%s(0x%02x)\n",
+					i,
+					getAttrName(cuAbbrevBuf.attrs[i].name),
+					cuAbbrevBuf.attrs[i].name,
+					getFormName(cuAbbrevBuf.attrs[i].form),
+					cuAbbrevBuf.attrs[i].form);
+	}
 
-		if(version >= 5)
+	// Pass 1: scan the CU DIE to find DW_AT_addr_base and DW_AT_str_offsets_base.
+	// These must be resolved before reading addrx/strx forms in pass 2.
+	Uptr cuDieAttrsPos = cuStream.position();
+	Uptr addrBase = 0;
+	Uptr strOffsetsBase = 0;
+	for(Uptr i = 0; i < cuAbbrevBuf.numAttrs && cuStream.capacity(); ++i)
+	{
+		U16 attrName = cuAbbrevBuf.attrs[i].name;
+		U8 attrForm = cuAbbrevBuf.attrs[i].form;
+		if(attrName == DW_AT_addr_base)
 		{
-			// DWARF v5: version, unit_type, address_size, debug_abbrev_offset
-			U8 unitType;
-			if(!tryRead(cuStream, unitType)) { continue; }
-			if(!tryRead(cuStream, addrSize)) { continue; }
-			if(dwarfFormat == 8)
-			{
-				U64 v;
-				if(!tryRead(cuStream, v)) { continue; }
-				abbrevOffset = Uptr(v);
-			}
-			else
-			{
-				U32 v;
-				if(!tryRead(cuStream, v)) { continue; }
-				abbrevOffset = Uptr(v);
-			}
-			Log::printf(Log::traceDwarf,
-						"  v5 header: unitType=0x%02x addrSize=%u abbrevOffset=%" WAVM_PRIuPTR "\n",
-						unitType,
-						addrSize,
-						abbrevOffset);
+			addrBase = readAddrFormValue(attrForm, cuStream, addrSize, dwarfFormat, nullptr, 0, 0);
+			Log::printf(Log::traceDwarf, "    addr_base = %" WAVM_PRIuPTR "\n", addrBase);
+		}
+		else if(attrName == DW_AT_str_offsets_base)
+		{
+			strOffsetsBase = readRefValue(attrForm, cuStream, dwarfFormat);
+			Log::printf(
+				Log::traceDwarf, "    str_offsets_base = %" WAVM_PRIuPTR "\n", strOffsetsBase);
 		}
 		else
 		{
-			// DWARF v4 and earlier: version, debug_abbrev_offset, address_size
-			if(dwarfFormat == 8)
-			{
-				U64 v;
-				if(!tryRead(cuStream, v)) { continue; }
-				abbrevOffset = Uptr(v);
-			}
-			else
-			{
-				U32 v;
-				if(!tryRead(cuStream, v)) { continue; }
-				abbrevOffset = Uptr(v);
-			}
-			if(!tryRead(cuStream, addrSize)) { continue; }
-			Log::printf(Log::traceDwarf,
-						"  v4 header: addrSize=%u abbrevOffset=%" WAVM_PRIuPTR "\n",
-						addrSize,
-						abbrevOffset);
+			skipForm(attrForm, cuStream, addrSize, dwarfFormat, cuAbbrevBuf.attrs[i].implicitConst);
 		}
+	}
+	cuStream.seek(cuDieAttrsPos);
+	outCU.addrBase = addrBase;
+	outCU.strOffsetsBase = strOffsetsBase;
+
+	// Pass 2: read CU attributes to find low_pc/high_pc and stmt_list.
+	Uptr cuLowPC = 0;
+	Uptr cuHighPC = 0;
+	bool highPCIsOffset = false;
+	Uptr stmtListOffset = Uptr(-1);
+	for(Uptr i = 0; i < cuAbbrevBuf.numAttrs && cuStream.capacity(); ++i)
+	{
+		U16 attrName = cuAbbrevBuf.attrs[i].name;
+		U8 attrForm = cuAbbrevBuf.attrs[i].form;
+		Uptr attrStartPos = cuStream.position();
 
-		// Read the CU DIE to get the address range.
-		U64 cuAbbrevCode;
-		if(!trySerializeVarUInt64(cuStream, cuAbbrevCode)) { continue; }
-		if(cuAbbrevCode == 0) { continue; }
-
-		AbbrevEntry cuAbbrevBuf;
-		if(!findAbbrev(sections.debugAbbrev,
-					   sections.debugAbbrevSize,
-					   abbrevOffset,
-					   cuAbbrevCode,
-					   cuAbbrevBuf)
-		   || cuAbbrevBuf.tag != DW_TAG_compile_unit)
+		if(attrName == DW_AT_low_pc)
 		{
+			cuLowPC = readAddrFormValue(attrForm,
+										cuStream,
+										addrSize,
+										dwarfFormat,
+										sections.debugAddr,
+										sections.debugAddrSize,
+										addrBase);
 			Log::printf(Log::traceDwarf,
-						"  CU DIE: abbrevCode=%" PRIu64 ", not compile_unit, skipping\n",
-						cuAbbrevCode);
-			continue;
+						"    low_pc = 0x%" WAVM_PRIxPTR " (form=%s)\n",
+						cuLowPC,
+						getFormName(attrForm));
 		}
-
-		Log::printf(Log::traceDwarf,
-					"  CU DIE: abbrevCode=%" PRIu64 " tag=compile_unit numAttrs=%" WAVM_PRIuPTR
-					"\n",
-					cuAbbrevCode,
-					cuAbbrevBuf.numAttrs);
-
-		// Log all CU DIE attributes for debugging.
-		for(Uptr i = 0; i < cuAbbrevBuf.numAttrs; ++i)
+		else if(attrName == DW_AT_high_pc)
 		{
+			// high_pc can be an address or a constant (offset from low_pc).
+			cuHighPC = readAddrFormValue(attrForm,
+										 cuStream,
+										 addrSize,
+										 dwarfFormat,
+										 sections.debugAddr,
+										 sections.debugAddrSize,
+										 addrBase);
+			if(attrForm != DW_FORM_addr) { highPCIsOffset = true; }
 			Log::printf(Log::traceDwarf,
-						"    attr[%" WAVM_PRIuPTR "]: %s(0x%04x) form=%s(0x%02x)\n",
-						i,
-						getAttrName(cuAbbrevBuf.attrs[i].name),
-						cuAbbrevBuf.attrs[i].name,
-						getFormName(cuAbbrevBuf.attrs[i].form),
-						cuAbbrevBuf.attrs[i].form);
+						"    high_pc = 0x%" WAVM_PRIxPTR " (form=%s, isOffset=%d)\n",
+						cuHighPC,
+						getFormName(attrForm),
+						(int)highPCIsOffset);
 		}
-
-		// Pass 1: scan the CU DIE to find DW_AT_addr_base and DW_AT_str_offsets_base.
-		// These must be resolved before reading addrx/strx forms in pass 2.
-		Uptr cuDieAttrsPos = cuStream.position();
-		Uptr addrBase = 0;
-		Uptr strOffsetsBase = 0;
-		for(Uptr i = 0; i < cuAbbrevBuf.numAttrs && cuStream.capacity(); ++i)
+		else if(attrName == DW_AT_stmt_list)
 		{
-			U16 attrName = cuAbbrevBuf.attrs[i].name;
-			U8 attrForm = cuAbbrevBuf.attrs[i].form;
-			if(attrName == DW_AT_addr_base)
-			{
-				addrBase
-					= readAddrFormValue(attrForm, cuStream, addrSize, dwarfFormat, nullptr, 0, 0);
-				Log::printf(Log::traceDwarf, "    addr_base = %" WAVM_PRIuPTR "\n", addrBase);
-			}
-			else if(attrName == DW_AT_str_offsets_base)
-			{
-				strOffsetsBase = readRefValue(attrForm, cuStream, dwarfFormat);
-				Log::printf(
-					Log::traceDwarf, "    str_offsets_base = %" WAVM_PRIuPTR "\n", strOffsetsBase);
-			}
-			else
-			{
-				skipForm(
-					attrForm, cuStream, addrSize, dwarfFormat, cuAbbrevBuf.attrs[i].implicitConst);
-			}
+			stmtListOffset = readRefValue(attrForm, cuStream, dwarfFormat);
+			Log::printf(Log::traceDwarf,
+						"    stmt_list = %" WAVM_PRIuPTR " (form=%s)\n",
+						stmtListOffset,
+						getFormName(attrForm));
+		}
+		else
+		{
+			skipForm(attrForm, cuStream, addrSize, dwarfFormat, cuAbbrevBuf.attrs[i].implicitConst);
 		}
-		cuStream.seek(cuDieAttrsPos);
-
-		// Pass 2: read CU attributes to find low_pc/high_pc and stmt_list.
-		Uptr cuLowPC = 0;
-		Uptr cuHighPC = 0;
-		bool highPCIsOffset = false;
-		Uptr stmtListOffset = Uptr(-1);
-		for(Uptr i = 0; i < cuAbbrevBuf.numAttrs && cuStream.capacity(); ++i)
+		// Safety: if stream didn't advance and the form isn't zero-length, we're stuck.
+		if(cuStream.position() == attrStartPos && attrForm != DW_FORM_flag_present
+		   && attrForm != DW_FORM_implicit_const)
 		{
-			U16 attrName = cuAbbrevBuf.attrs[i].name;
-			U8 attrForm = cuAbbrevBuf.attrs[i].form;
-			Uptr attrStartPos = cuStream.position();
+			break;
+		}
+	}
 
-			if(attrName == DW_AT_low_pc)
-			{
-				cuLowPC = readAddrFormValue(attrForm,
-											cuStream,
-											addrSize,
-											dwarfFormat,
-											sections.debugAddr,
-											sections.debugAddrSize,
-											addrBase);
-				Log::printf(Log::traceDwarf,
-							"    low_pc = 0x%" WAVM_PRIxPTR " (form=%s)\n",
-							cuLowPC,
-							getFormName(attrForm));
-			}
-			else if(attrName == DW_AT_high_pc)
-			{
-				// high_pc can be an address or a constant (offset from low_pc).
-				cuHighPC = readAddrFormValue(attrForm,
-											 cuStream,
+	if(highPCIsOffset) { cuHighPC = cuLowPC + cuHighPC; }
+
+	outCU.lowPC = cuLowPC;
+	outCU.highPC = cuHighPC;
+	outCU.stmtListOffset = stmtListOffset;
+
+	// cuStream position is now after the CU DIE attributes, at the first child DIE.
+	outCU.firstChildPos = cuStream.position();
+	return true;
+}
+
+// Skip all the attributes of a DIE.
+static void skipDIEAttributes(const CompileUnit& cu, const AbbrevEntry& abbrev, InputStream& stream)
+{
+	for(Uptr i = 0; i < abbrev.numAttrs && stream.capacity(); ++i)
+	{
+		skipForm(abbrev.attrs[i].form,
+				 stream,
+				 cu.addrSize,
+				 cu.dwarfFormat,
+				 abbrev.attrs[i].implicitConst);
+	}
+}
+
+// The attributes of a subprogram or inlined_subroutine DIE.
+struct ScopeDIE
+{
+	Uptr lowPC;
+	Uptr highPC;
+	const char* linkageName;
+	const char* name;
+	Uptr callLine;
+	Uptr abstractOrigin;
+};
+
+// Read the attributes of a subprogram or inlined_subroutine DIE.
+// Signal-safe: no allocations.
+static void readScopeDIE(const Sections& sections,
+						 const CompileUnit& cu,
+						 const AbbrevEntry& abbrev,
+						 InputStream& stream,
+						 ScopeDIE& outDIE)
+{
+	const bool isSubprogram = (abbrev.tag == DW_TAG_subprogram);
+	const U8 addrSize = cu.addrSize;
+	const U8 dwarfFormat = cu.dwarfFormat;
+
+	outDIE = ScopeDIE{0, 0, nullptr, nullptr, 0, 0};
+	bool hpIsOffset = false;
+
+	for(Uptr i = 0; i < abbrev.numAttrs && stream.capacity(); ++i)
+	{
+		U16 attrName = abbrev.attrs[i].name;
+		U8 attrForm = abbrev.attrs[i].form;
+
+		if(attrName == DW_AT_low_pc)
+		{
+			outDIE.lowPC = readAddrFormValue(attrForm,
+											 stream,
 											 addrSize,
 											 dwarfFormat,
 											 sections.debugAddr,
 											 sections.debugAddrSize,
-											 addrBase);
-				if(attrForm != DW_FORM_addr) { highPCIsOffset = true; }
-				Log::printf(Log::traceDwarf,
-							"    high_pc = 0x%" WAVM_PRIxPTR " (form=%s, isOffset=%d)\n",
-							cuHighPC,
-							getFormName(attrForm),
-							(int)highPCIsOffset);
-			}
-			else if(attrName == DW_AT_stmt_list)
-			{
-				stmtListOffset = readRefValue(attrForm, cuStream, dwarfFormat);
-				Log::printf(Log::traceDwarf,
-							"    stmt_list = %" WAVM_PRIuPTR " (form=%s)\n",
-							stmtListOffset,
-							getFormName(attrForm));
-			}
-			else
-			{
-				skipForm(
-					attrForm, cuStream, addrSize, dwarfFormat, cuAbbrevBuf.attrs[i].implicitConst);
-			}
-			// Safety: if stream didn't advance and the form isn't zero-length, we're stuck.
-			if(cuStream.position() == attrStartPos && attrForm != DW_FORM_flag_present
-			   && attrForm != DW_FORM_implicit_const)
-			{
-				break;
-			}
+											 cu.addrBase);
+		}
+		else if(attrName == DW_AT_high_pc)
+		{
+			outDIE.highPC = readAddrFormValue(attrForm,
+											  stream,
+											  addrSize,
+											  dwarfFormat,
+											  sections.debugAddr,
+											  sections.debugAddrSize,
+											  cu.addrBase);
+			if(attrForm != DW_FORM_addr) { hpIsOffset = true; }
+		}
+		else if(attrName == DW_AT_name)
+		{
+			outDIE.name = readStrpValue(attrForm,
+										stream,
+										dwarfFormat,
+										sections.debugStr,
+										sections.debugStrSize,
+										sections.debugStrOffsets,
+										sections.debugStrOffsetsSize,
+										cu.strOffsetsBase);
+		}
+		else if(attrName == DW_AT_linkage_name)
+		{
+			outDIE.linkageName = readStrpValue(attrForm,
+											   stream,
+											   dwarfFormat,
+											   sections.debugStr,
+											   sections.debugStrSize,
+											   sections.debugStrOffsets,
+											   sections.debugStrOffsetsSize,
+											   cu.strOffsetsBase);
 		}
+		else if(attrName == DW_AT_call_line)
+		{
+			outDIE.callLine = readAddrFormValue(attrForm,
+												stream,
+												addrSize,
+												dwarfFormat,
+												sections.debugAddr,
+												sections.debugAddrSize,
+												cu.addrBase);
+		}
+		else if(attrName == DW_AT_abstract_origin)
+		{
+			outDIE.abstractOrigin = readRefValue(attrForm, stream, dwarfFormat);
+		}
+		else if(attrName == DW_AT_decl_line && isSubprogram && outDIE.callLine == 0)
+		{
+			outDIE.callLine = readAddrFormValue(attrForm,
+												stream,
+												addrSize,
+												dwarfFormat,
+												sections.debugAddr,
+												sections.debugAddrSize,
+												cu.addrBase);
+		}
+		else
+		{
+			skipForm(attrForm, stream, addrSize, dwarfFormat, abbrev.attrs[i].implicitConst);
+		}
+	}
+
+	if(hpIsOffset) { outDIE.highPC = outDIE.lowPC + outDIE.highPC; }
 
-		if(highPCIsOffset) { cuHighPC = cuLowPC + cuHighPC; }
+	Log::printf(Log::traceDwarf,
+				"  DIE %s: lowPC=0x%" WAVM_PRIxPTR " highPC=0x%" WAVM_PRIxPTR
+				" name=%s linkageName=%s callLine=%" WAVM_PRIuPTR " abstractOrigin=%" WAVM_PRIuPTR
+				" hasChildren=%d\n",
+				getTagName(abbrev.tag),
+				outDIE.lowPC,
+				outDIE.highPC,
+				outDIE.name ? outDIE.name : "(null)",
+				outDIE.linkageName ? outDIE.linkageName : "(null)",
+				outDIE.callLine,
+				outDIE.abstractOrigin,
+				(int)abbrev.hasChildren);
+}
+
+// If a scope DIE has no names, read them from the DIE referenced by its DW_AT_abstract_origin.
+// Signal-safe: no allocations.
+static void resolveAbstractOriginNames(const Sections& sections,
+									   const CompileUnit& cu,
+									   ScopeDIE& scope)
+{
+	if(scope.linkageName || scope.name || scope.abstractOrigin == 0) { return; }
+
+	// abstract_origin is a CU-relative offset for ref1/2/4/8.
+	Uptr absOffset = cu.startPos + scope.abstractOrigin;
+	// For ref_addr, it's already an absolute offset, but we handled that above.
+	Log::printf(
+		Log::traceDwarf, "  Following abstract_origin at offset %" WAVM_PRIuPTR "\n", absOffset);
+	if(absOffset < sections.debugInfoSize)
+	{
+		readDIENames(sections.debugInfo,
+					 sections.debugInfoSize,
+					 absOffset,
+					 sections.debugAbbrev,
+					 sections.debugAbbrevSize,
+					 cu.abbrevOffset,
+					 cu.addrSize,
+					 cu.dwarfFormat,
+					 sections.debugStr,
+					 sections.debugStrSize,
+					 sections.debugStrOffsets,
+					 sections.debugStrOffsetsSize,
+					 cu.strOffsetsBase,
+					 scope.name,
+					 scope.linkageName);
+	}
+}
+
+Uptr DWARF::getSourceLocations(const Sections& sections,
+							   Uptr address,
+							   SourceLocation* outLocations,
+							   Uptr maxLocations)
+{
+	if(!sections.debugInfo || !sections.debugAbbrev || maxLocations == 0) { return 0; }
+
+	Log::printf(Log::traceDwarf,
+				"getSourceLocations: address=0x%" WAVM_PRIxPTR " debugInfo=%p(%" WAVM_PRIuPTR
+				") debugAbbrev=%p(%" WAVM_PRIuPTR ") debugStr=%p(%" WAVM_PRIuPTR
+				") debugLine=%p(%" WAVM_PRIuPTR ")\n",
+				address,
+				(const void*)sections.debugInfo,
+				sections.debugInfoSize,
+				(const void*)sections.debugAbbrev,
+				sections.debugAbbrevSize,
+				(const void*)sections.debugStr,
+				sections.debugStrSize,
+				(const void*)sections.debugLine,
+				sections.debugLineSize);
+
+	MemoryInputStream infoStream(sections.debugInfo, sections.debugInfoSize);
+
+	// Scan CU headers to find the CU containing the address.
+	while(infoStream.capacity())
+	{
+		CompileUnit cu;
+		if(!readCompileUnit(sections, infoStream, cu)) { continue; }
 
 		Log::printf(Log::traceDwarf,
 					"  CU range: [0x%" WAVM_PRIxPTR ", 0x%" WAVM_PRIxPTR ") target=0x%" WAVM_PRIxPTR
 					"\n",
-					cuLowPC,
-					cuHighPC,
+					cu.lowPC,
+					cu.highPC,
 					address);
 
 		// Check if address is in this CU's range.
-		if(cuLowPC == 0 && cuHighPC == 0)
+		if(cu.lowPC == 0 && cu.highPC == 0)
 		{
 			// No range info; skip to next CU. (DW_AT_ranges not supported yet.)
 			Log::printf(Log::traceDwarf, "  CU has no range info, skipping\n");
 			continue;
 		}
-		if(address < cuLowPC || address >= cuHighPC)
+		if(address < cu.lowPC || address >= cu.highPC)
 		{
 			Log::printf(Log::traceDwarf, "  Address not in CU range, skipping\n");
 			continue;
@@ -1155,19 +1391,15 @@ Uptr DWARF::getSourceLocations(const Sections& sections,
 
 		Log::printf(Log::traceDwarf, "  Address is in CU range, walking DIEs\n");
 
+		MemoryInputStream cuStream(cu.data, cu.numDataBytes);
+		cuStream.seek(cu.firstChildPos);
+
 		// Walk DIEs within this CU looking for subprogram/inlined_subroutine containing address.
 		Uptr numLocations = 0;
 
 		// Stack of function scopes for tracking inline nesting.
-		struct ScopeEntry
-		{
-			const char* linkageName;
-			const char* name;
-			Uptr callLine;
-			Uptr abstractOrigin;
-		};
 		static constexpr Uptr maxScopeDepth = 16;
-		ScopeEntry scopeStack[maxScopeDepth];
+		ScopeDIE scopeStack[maxScopeDepth];
 		Uptr scopeDepth = 0;
 
 		// Depth tracking for skipping children of non-matching DIEs.
@@ -1186,7 +1418,6 @@ Uptr DWARF::getSourceLocations(const Sections& sections,
 		WalkNestType walkStack[maxWalkDepth];
 		Uptr walkDepth = 0;
 
-		// cuStream position is now after the CU DIE attributes, at the first child DIE.
 		while(cuStream.capacity())
 		{
 			U64 abbrevCode;
@@ -1220,7 +1451,7 @@ Uptr DWARF::getSourceLocations(const Sections& sections,
 			AbbrevEntry abbrevBuf;
 			if(!findAbbrev(sections.debugAbbrev,
 						   sections.debugAbbrevSize,
-						   abbrevOffset,
+						   cu.abbrevOffset,
 						   abbrevCode,
 						   abbrevBuf))
 			{
@@ -1234,14 +1465,7 @@ Uptr DWARF::getSourceLocations(const Sections& sections,
 			if(skipping)
 			{
 				// Skip all attributes.
-				for(Uptr i = 0; i < abbrevBuf.numAttrs && cuStream.capacity(); ++i)
-				{
-					skipForm(abbrevBuf.attrs[i].form,
-							 cuStream,
-							 addrSize,
-							 dwarfFormat,
-							 abbrevBuf.attrs[i].implicitConst);
-				}
+				skipDIEAttributes(cu, abbrevBuf, cuStream);
 				if(abbrevBuf.hasChildren) { ++skipDepth; }
 				continue;
 			}
@@ -1253,14 +1477,7 @@ Uptr DWARF::getSourceLocations(const Sections& sections,
 			if(!isInteresting)
 			{
 				// Skip attributes.
-				for(Uptr i = 0; i < abbrevBuf.numAttrs && cuStream.capacity(); ++i)
-				{
-					skipForm(abbrevBuf.attrs[i].form,
-							 cuStream,
-							 addrSize,
-							 dwarfFormat,
-							 abbrevBuf.attrs[i].implicitConst);
-				}
+				skipDIEAttributes(cu, abbrevBuf, cuStream);
 				if(abbrevBuf.tag == DW_TAG_lexical_block && abbrevBuf.hasChildren)
 				{
 					// Transparent container: recurse into children to find
@@ -1279,113 +1496,12 @@ Uptr DWARF::getSourceLocations(const Sections& sections,
 			}
 
 			// Parse interesting DIE attributes.
-			Uptr lowPC = 0;
-			Uptr highPC = 0;
-			bool hpIsOffset = false;
-			const char* dieName = nullptr;
-			const char* dieLinkageName = nullptr;
-			Uptr callLine = 0;
-			Uptr abstractOrigin = 0;
-
-			for(Uptr i = 0; i < abbrevBuf.numAttrs && cuStream.capacity(); ++i)
-			{
-				U16 attrName = abbrevBuf.attrs[i].name;
-				U8 attrForm = abbrevBuf.attrs[i].form;
-
-				if(attrName == DW_AT_low_pc)
-				{
-					lowPC = readAddrFormValue(attrForm,
-											  cuStream,
-											  addrSize,
-											  dwarfFormat,
-											  sections.debugAddr,
-											  sections.debugAddrSize,
-											  addrBase);
-				}
-				else if(attrName == DW_AT_high_pc)
-				{
-					highPC = readAddrFormValue(attrForm,
-											   cuStream,
-											   addrSize,
-											   dwarfFormat,
-											   sections.debugAddr,
-											   sections.debugAddrSize,
-											   addrBase);
-					if(attrForm != DW_FORM_addr) { hpIsOffset = true; }
-				}
-				else if(attrName == DW_AT_name)
-				{
-					dieName = readStrpValue(attrForm,
-											cuStream,
-											dwarfFormat,
-											sections.debugStr,
-											sections.debugStrSize,
-											sections.debugStrOffsets,
-											sections.debugStrOffsetsSize,
-											strOffsetsBase);
-				}
-				else if(attrName == DW_AT_linkage_name)
-				{
-					dieLinkageName = readStrpValue(attrForm,
-												   cuStream,
-												   dwarfFormat,
-												   sections.debugStr,
-												   sections.debugStrSize,
-												   sections.debugStrOffsets,
-												   sections.debugStrOffsetsSize,
-												   strOffsetsBase);
-				}
-				else if(attrName == DW_AT_call_line)
-				{
-					callLine = readAddrFormValue(attrForm,
-												 cuStream,
-												 addrSize,
-												 dwarfFormat,
-												 sections.debugAddr,
-												 sections.debugAddrSize,
-												 addrBase);
-				}
-				else if(attrName == DW_AT_abstract_origin)
-				{
-					abstractOrigin = readRefValue(attrForm, cuStream, dwarfFormat);
-				}
-				else if(attrName == DW_AT_decl_line && isSubprogram && callLine == 0)
-				{
-					callLine = readAddrFormValue(attrForm,
-												 cuStream,
-												 addrSize,
-												 dwarfFormat,
-												 sections.debugAddr,
-												 sections.debugAddrSize,
-												 addrBase);
-				}
-				else
-				{
-					skipForm(attrForm,
-							 cuStream,
-							 addrSize,
-							 dwarfFormat,
-							 abbrevBuf.attrs[i].implicitConst);
-				}
-			}
-
-			if(hpIsOffset) { highPC = lowPC + highPC; }
-
-			Log::printf(Log::traceDwarf,
-						"  DIE %s: lowPC=0x%" WAVM_PRIxPTR " highPC=0x%" WAVM_PRIxPTR
-						" name=%s linkageName=%s callLine=%" WAVM_PRIuPTR
-						" abstractOrigin=%" WAVM_PRIuPTR " hasChildren=%d\n",
-						getTagName(abbrevBuf.tag),
-						lowPC,
-						highPC,
-						dieName ? dieName : "(null)",
-						dieLinkageName ? dieLinkageName : "(null)",
-						callLine,
-						abstractOrigin,
-						(int)abbrevBuf.hasChildren);
+			ScopeDIE scopeDIE;
+			readScopeDIE(sections, cu, abbrevBuf, cuStream, scopeDIE);
 
 			// Check if this DIE's address range contains our target address.
-			bool contains = (lowPC != 0 && address >= lowPC && address < highPC);
+			bool contains
+				= (scopeDIE.lowPC != 0 && address >= scopeDIE.lowPC && address < scopeDIE.highPC);
 
 			if(!contains)
 			{
@@ -1402,14 +1518,7 @@ Uptr DWARF::getSourceLocations(const Sections& sections,
 			Log::printf(Log::traceDwarf, "    -> contains target, pushing scope\n");
 
 			// This DIE contains the address. Push it onto the scope stack.
-			if(scopeDepth < maxScopeDepth)
-			{
-				ScopeEntry& scope = scopeStack[scopeDepth++];
-				scope.linkageName = dieLinkageName;
-				scope.name = dieName;
-				scope.callLine = callLine;
-				scope.abstractOrigin = abstractOrigin;
-			}
+			if(scopeDepth < maxScopeDepth) { scopeStack[scopeDepth++] = scopeDIE; }
 
 			// If this DIE has no children, it's a leaf, so we're done walking.
 			if(!abbrevBuf.hasChildren) { break; }
@@ -1424,51 +1533,28 @@ Uptr DWARF::getSourceLocations(const Sections& sections,
 		// Look up the line at the target address from the line table.
 		// This gives the instruction index for the innermost frame.
 		Uptr lineAtAddress = 0;
-		if(stmtListOffset != Uptr(-1) && sections.debugLine)
+		if(cu.stmtListOffset != Uptr(-1) && sections.debugLine)
 		{
 			Log::printf(Log::traceDwarf,
 						"  Looking up line at address 0x%" WAVM_PRIxPTR
 						" in line table at offset %" WAVM_PRIuPTR "\n",
 						address,
-						stmtListOffset);
-			lineAtAddress = lookupLineAtAddress(
-				sections.debugLine, sections.debugLineSize, stmtListOffset, address, addrSize);
+						cu.stmtListOffset);
+			lineAtAddress = lookupLineAtAddress(sections.debugLine,
+												sections.debugLineSize,
+												cu.stmtListOffset,
+												address,
+												cu.addrSize);
 			Log::printf(Log::traceDwarf, "  lineAtAddress = %" WAVM_PRIuPTR "\n", lineAtAddress);
 		}
 		// Build the output source location chain from the scope stack.
 		// Innermost function first.
 		for(Uptr i = scopeDepth; i > 0 && numLocations < maxLocations; --i)
 		{
-			ScopeEntry& scope = scopeStack[i - 1];
+			ScopeDIE& scope = scopeStack[i - 1];
 
 			// If names aren't set directly, follow abstract_origin.
-			if(!scope.linkageName && !scope.name && scope.abstractOrigin != 0)
-			{
-				// abstract_origin is a CU-relative offset for ref1/2/4/8.
-				Uptr absOffset = cuStartPos + scope.abstractOrigin;
-				// For ref_addr, it's already an absolute offset, but we handled that above.
-				Log::printf(Log::traceDwarf,
-							"  Following abstract_origin at offset %" WAVM_PRIuPTR "\n",
-							absOffset);
-				if(absOffset < sections.debugInfoSize)
-				{
-					readDIENames(sections.debugInfo,
-								 sections.debugInfoSize,
-								 absOffset,
-								 sections.debugAbbrev,
-								 sections.debugAbbrevSize,
-								 abbrevOffset,
-								 addrSize,
-								 dwarfFormat,
-								 sections.debugStr,
-								 sections.debugStrSize,
-								 sections.debugStrOffsets,
-								 sections.debugStrOffsetsSize,
-								 strOffsetsBase,
-								 scope.name,
-								 scope.linkageName);
-				}
-			}
+			resolveAbstractOriginNames(sections, cu, scope);
 
 			outLocations[numLocations].linkageName = scope.linkageName;
 			outLocations[numLocations].name = scope.name;
@@ -1499,3 +1585,269 @@ Uptr DWARF::getSourceLocations(const Sections& sections,
 	Log::printf(Log::traceDwarf, "  No matching CU found\n");
 	return 0;
 }
+
+void DWARF::buildAddressIndex(const Sections& sections, AddressIndex& outIndex)
+{
+	outIndex.scopes.clear();
+	outIndex.scopeRanges.clear();
+	outIndex.lineRows.clear();
+	if(!sections.debugInfo || !sections.debugAbbrev) { return; }
+
+	// The address range of each scope in outIndex.scopes, and the number of scopes it's nested in.
+	struct ScopeBounds
+	{
+		Uptr lowPC;
+		Uptr highPC;
+		Uptr depth;
+		Uptr scopeIndex;
+	};
+	std::vector<ScopeBounds> scopeBounds;
+
+	MemoryInputStream infoStream(sections.debugInfo, sections.debugInfoSize);
+	while(infoStream.capacity())
+	{
+		CompileUnit cu;
+		if(!readCompileUnit(sections, infoStream, cu)) { continue; }
+
+		// Like getSourceLocations, skip CUs without a contiguous address range.
+		if(cu.lowPC == 0 && cu.highPC == 0) { continue; }
+
+		// Walk all the DIEs in the CU, adding each subprogram and inlined_subroutine with an
+		// address range to the index. As in getSourceLocations, lexical blocks are transparent,
+		// and the children of other DIEs are skipped. scopeStack holds the innermost scope
+		// enclosing each level of transparent or scope DIEs.
+		std::vector<Uptr> scopeStack;
+		Uptr skipDepth = 0;
+		bool skipping = false;
+
+		MemoryInputStream cuStream(cu.data, cu.numDataBytes);
+		cuStream.seek(cu.firstChildPos);
+		while(cuStream.capacity())
+		{
+			U64 abbrevCode;
+			if(!trySerializeVarUInt64(cuStream, abbrevCode)) { break; }
+
+			if(abbrevCode == 0)
+			{
+				// Null DIE: end of children list.
+				if(skipping)
+				{
+					if(skipDepth > 0) { --skipDepth; }
+					else
+					{
+						skipping = false;
+					}
+				}
+				else if(scopeStack.size())
+				{
+					scopeStack.pop_back();
+				}
+				else
+				{
+					// End of the CU DIE's children.
+					break;
+				}
+				continue;
+			}
+
+			AbbrevEntry abbrevBuf;
+			if(!findAbbrev(sections.debugAbbrev,
+						   sections.debugAbbrevSize,
+						   cu.abbrevOffset,
+						   abbrevCode,
+						   abbrevBuf))
+			{
+				break;
+			}
+
+			const Uptr enclosingScopeIndex
+				= scopeStack.size() ? scopeStack.back() : AddressIndex::noScope;
+
+			if(skipping)
+			{
+				skipDIEAttributes(cu, abbrevBuf, cuStream);
+				if(abbrevBuf.hasChildren) { ++skipDepth; }
+				continue;
+			}
+			else if(abbrevBuf.tag != DW_TAG_subprogram
+					&& abbrevBuf.tag != DW_TAG_inlined_subroutine)
+			{
+				skipDIEAttributes(cu, abbrevBuf, cuStream);
+				if(abbrevBuf.tag == DW_TAG_lexical_block && abbrevBuf.hasChildren)
+				{
+					scopeStack.push_back(enclosingScopeIndex);
+				}
+				else if(abbrevBuf.hasChildren)
+				{
+					skipping = true;
+					skipDepth = 0;
+				}
+				continue;
+			}
+
+			ScopeDIE scopeDIE;
+			readScopeDIE(sections, cu, abbrevBuf, cuStream, scopeDIE);
+
+			// Clamp the scope's address range to the range of the scope (or CU) that encloses it,
+			// since lookups only consider the scopes nested within a scope that contains the
+			// address.
+			Uptr lowPC = scopeDIE.lowPC;
+			Uptr highPC = scopeDIE.highPC;
+			Uptr depth = 0;
+			if(enclosingScopeIndex == AddressIndex::noScope)
+			{
+				lowPC = std::max(lowPC, cu.lowPC);
+				highPC = std::min(highPC, cu.highPC);
+			}
+			else
+			{
+				const ScopeBounds& enclosingBounds = scopeBounds[enclosingScopeIndex];
+				lowPC = std::max(lowPC, enclosingBounds.lowPC);
+				highPC = std::min(highPC, enclosingBounds.highPC);
+				depth = enclosingBounds.depth + 1;
+			}
+
+			if(scopeDIE.lowPC == 0 || lowPC >= highPC)
+			{
+				// The scope doesn't contain any addresses, so neither can its children.
+				if(abbrevBuf.hasChildren)
+				{
+					skipping = true;
+					skipDepth = 0;
+				}
+				continue;
+			}
+
+			resolveAbstractOriginNames(sections, cu, scopeDIE);
+
+			const Uptr scopeIndex = outIndex.scopes.size();
+			outIndex.scopes.push_back(
+				{scopeDIE.linkageName, scopeDIE.name, scopeDIE.callLine, enclosingScopeIndex});
+			scopeBounds.push_back({lowPC, highPC, depth, scopeIndex});
+
+			if(abbrevBuf.hasChildren) { scopeStack.push_back(scopeIndex); }
+		}
+
+		// Add the CU's line table rows to the index. The end of each sequence is added as a row
+		// with line 0, so addresses between sequences don't map to the last row of a sequence.
+		if(cu.stmtListOffset != Uptr(-1) && sections.debugLine)
+		{
+			forEachLineRow(sections.debugLine,
+						   sections.debugLineSize,
+						   cu.stmtListOffset,
+						   cu.addrSize,
+						   [&](Uptr rowAddress, Uptr rowLine, bool isEndSequence) {
+							   outIndex.lineRows.push_back(
+								   {rowAddress, isEndSequence ? 0 : rowLine});
+							   return true;
+						   });
+		}
+	}
+
+	// Sort the line rows by address. A sequence may begin at the address another ends at, so
+	// order the end of a sequence before any other rows at the same address. Rows within a
+	// sequence keep their order, so the last of several rows at an address is used.
+	std::stable_sort(outIndex.lineRows.begin(),
+					 outIndex.lineRows.end(),
+					 [](const AddressIndex::LineRow& a, const AddressIndex::LineRow& b) {
+						 return a.address != b.address ? a.address < b.address
+													   : (a.line == 0 && b.line != 0);
+					 });
+
+	// Flatten the nested scope ranges into a sorted list of the addresses where the innermost
+	// scope changes. Sort the scopes by address, with enclosing scopes before the scopes nested in
+	// them, and sweep through them with a stack of the scopes that contain the current address.
+	std::stable_sort(scopeBounds.begin(),
+					 scopeBounds.end(),
+					 [](const ScopeBounds& a, const ScopeBounds& b) {
+						 return a.lowPC != b.lowPC ? a.lowPC < b.lowPC : a.depth < b.depth;
+					 });
+
+	auto addScopeRange = [&outIndex](Uptr beginAddress, Uptr scopeIndex) {
+		std::vector<AddressIndex::ScopeRange>& scopeRanges = outIndex.scopeRanges;
+		if(scopeRanges.size() && scopeRanges.back().beginAddress == beginAddress)
+		{
+			scopeRanges.back().scopeIndex = scopeIndex;
+		}
+		else if(scopeRanges.size() ? scopeRanges.back().scopeIndex != scopeIndex
+								   : scopeIndex != AddressIndex::noScope)
+		{
+			scopeRanges.push_back({beginAddress, scopeIndex});
+		}
+	};
+
+	std::vector<ScopeBounds> openScopes;
+	auto closeScopesBefore = [&](Uptr address) {
+		while(openScopes.size() && openScopes.back().highPC <= address)
+		{
+			const Uptr endAddress = openScopes.back().highPC;
+			openScopes.pop_back();
+			addScopeRange(endAddress,
+						  openScopes.size() ? openScopes.back().scopeIndex : AddressIndex::noScope);
+		}
+	};
+
+	for(ScopeBounds bounds : scopeBounds)
+	{
+		closeScopesBefore(bounds.lowPC);
+
+		// Sibling scopes shouldn't overlap, but if they do, truncate the later scope to the end of
+		// the earlier one so the open scopes stay nested.
+		if(openScopes.size()) { bounds.highPC = std::min(bounds.highPC, openScopes.back().highPC); }
+
+		openScopes.push_back(bounds);
+		addScopeRange(bounds.lowPC, bounds.scopeIndex);
+	}
+	closeScopesBefore(UINTPTR_MAX);
+
+	outIndex.scopes.shrink_to_fit();
+	outIndex.scopeRanges.shrink_to_fit();
+	outIndex.lineRows.shrink_to_fit();
+
+	Log::printf(Log::traceDwarf,
+				"buildAddressIndex: %" WAVM_PRIuPTR " scopes, %" WAVM_PRIuPTR
+				" scope ranges, %" WAVM_PRIuPTR " line rows\n",
+				outIndex.scopes.size(),
+				outIndex.scopeRanges.size(),
+				outIndex.lineRows.size());
+}
+
+Uptr DWARF::getSourceLocations(const AddressIndex& index,
+							   Uptr address,
+							   SourceLocation* outLocations,
+							   Uptr maxLocations)
+{
+	if(maxLocations == 0) { return 0; }
+
+	// Find the innermost scope containing the address.
+	auto scopeRangeIt = std::upper_bound(
+		index.scopeRanges.begin(),
+		index.scopeRanges.end(),
+		address,
+		[](Uptr address, const AddressIndex::ScopeRange& range) {
+			return address < range.beginAddress;
+		});
+	if(scopeRangeIt == index.scopeRanges.begin()) { return 0; }
+	Uptr scopeIndex = (scopeRangeIt - 1)->scopeIndex;
+
+	// Find the last line table row at or before the address.
+	Uptr line = 0;
+	auto lineRowIt = std::upper_bound(
+		index.lineRows.begin(),
+		index.lineRows.end(),
+		address,
+		[](Uptr address, const AddressIndex::LineRow& row) { return address < row.address; });
+	if(lineRowIt != index.lineRows.begin()) { line = (lineRowIt - 1)->line; }
+
+	// Build the output source location chain from the innermost scope outward. The line of each
+	// outer frame is the call_line of the scope inlined into it.
+	Uptr numLocations = 0;
+	while(scopeIndex != AddressIndex::noScope && numLocations < maxLocations)
+	{
+		const AddressIndex::Scope& scope = index.scopes[scopeIndex];
+		outLocations[numLocations++] = {scope.linkageName, scope.name, line};
+		line = scope.callLine;
+		scopeIndex = scope.parentScopeIndex;
+	}
+	return numLocations;
+}
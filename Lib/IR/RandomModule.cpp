@@ -1172,8 +1172,7 @@ void IR::generateValidModule(Module& module, RandomStream& random)
 		}
 		if(!module.memories.size() || random.get(1))
 		{
-			module.dataSegments.push_back(
-				{false, UINTPTR_MAX, {}, std::make_shared<std::vector<U8>>(std::move(bytes))});
+			module.dataSegments.push_back({false, UINTPTR_MAX, {}, SharedBytes(std::move(bytes))});
 		}
 		else
 		{
@@ -1183,7 +1182,7 @@ void IR::generateValidModule(Module& module, RandomStream& random)
 				{true,
 				 memoryIndex,
 				 generateInitializerExpression(module, random, asValueType(memoryType.indexType)),
-				 std::make_shared<std::vector<U8>>(std::move(bytes))});
+				 SharedBytes(std::move(bytes))});
 		}
 	};
 
@@ -513,9 +513,11 @@ struct FunctionValidationContext
 
 		// Validate that each target has the same number of parameters as the default target, and
 		// that the parameters for each target match the arguments provided.
-		WAVM_ASSERT(imm.branchTableIndex < functionDef.branchTables.size());
-		const std::vector<Uptr>& targetDepths = functionDef.branchTables[imm.branchTableIndex];
-		for(Uptr targetIndex = 0; targetIndex < targetDepths.size(); ++targetIndex)
+		WAVM_ASSERT(imm.firstTargetDepthIndex + imm.numTargetDepths
+					<= functionDef.branchTableTargetDepths.size());
+		const Uptr* targetDepths
+			= functionDef.branchTableTargetDepths.data() + imm.firstTargetDepthIndex;
+		for(Uptr targetIndex = 0; targetIndex < imm.numTargetDepths; ++targetIndex)
 		{
 			const ControlContext& branchTarget = getBranchTargetByDepth(targetDepths[targetIndex]);
 			const TypeTuple targetParams = branchTarget.params;
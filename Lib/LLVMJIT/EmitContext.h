@@ -148,7 +148,10 @@ namespace WAVM { namespace LLVMJIT {
 										 IR::FunctionType intrinsicType,
 										 const std::initializer_list<llvm::Value*>& args)
 		{
-			WAVM_ASSERT(intrinsicType.callingConvention() == IR::CallingConvention::intrinsic);
+			// Leaf intrinsics are called directly with the C calling convention, without passing
+			// them the context pointer.
+			WAVM_ASSERT(intrinsicType.callingConvention() == IR::CallingConvention::intrinsic
+						|| intrinsicType.callingConvention() == IR::CallingConvention::c);
 
 			llvm::Module* llvmModule = irBuilder.GetInsertBlock()->getParent()->getParent();
 			llvm::Function* intrinsicFunction = llvmModule->getFunction(intrinsicName);
@@ -166,11 +169,32 @@ namespace WAVM { namespace LLVMJIT {
 				intrinsicFunction, args, intrinsicType, getInnermostUnwindToBlock());
 		}
 
-		// Creates either a call or an invoke if the call occurs inside a try.
+		// Emits a call to a runtime intrinsic that never returns, followed by an unreachable
+		// terminator. The intrinsic is declared noreturn and cold, so LLVM lays out the blocks
+		// that call it after the hot code in the function, and doesn't spill or restore values
+		// around the call.
+		void emitNoReturnIntrinsic(const char* intrinsicName,
+								   IR::FunctionType intrinsicType,
+								   const std::initializer_list<llvm::Value*>& args)
+		{
+			emitRuntimeIntrinsic(intrinsicName, intrinsicType, args);
+
+			llvm::Module* llvmModule = irBuilder.GetInsertBlock()->getParent()->getParent();
+			llvm::Function* intrinsicFunction = llvmModule->getFunction(intrinsicName);
+			intrinsicFunction->addFnAttr(llvm::Attribute::NoReturn);
+			intrinsicFunction->addFnAttr(llvm::Attribute::Cold);
+
+			irBuilder.CreateUnreachable();
+		}
+
+		// Creates either a call or an invoke if the call occurs inside a try. If
+		// calleePreservesContext is true, the callee is known to return the same context pointer
+		// it was passed, so the context variable and memory base pointers aren't reloaded.
 		ValueVector emitCallOrInvoke(llvm::Value* callee,
 									 llvm::ArrayRef<llvm::Value*> args,
 									 IR::FunctionType calleeType,
-									 llvm::BasicBlock* unwindToBlock = nullptr)
+									 llvm::BasicBlock* unwindToBlock = nullptr,
+									 bool calleePreservesContext = false)
 		{
 			const IR::CallingConvention callingConvention = calleeType.callingConvention();
 
@@ -246,12 +270,20 @@ namespace WAVM { namespace LLVMJIT {
 			switch(callingConvention)
 			{
 			case IR::CallingConvention::wasm: {
-				// Update the context variable.
-				auto newContextPointer = irBuilder.CreateExtractValue(returnValue, {0});
-				irBuilder.CreateStore(newContextPointer, contextPointerVariable);
+				llvm::Value* newContextPointer;
+				if(calleePreservesContext)
+				{
+					newContextPointer = callArgs[0];
+				}
+				else
+				{
+					// Update the context variable.
+					newContextPointer = irBuilder.CreateExtractValue(returnValue, {0});
+					irBuilder.CreateStore(newContextPointer, contextPointerVariable);
 
-				// Reload the memory/table base pointers.
-				reloadMemoryBases();
+					// Reload the memory/table base pointers.
+					reloadMemoryBases();
+				}
 
 				if(areResultsReturnedDirectly(calleeType.results()))
 				{
@@ -330,12 +362,11 @@ namespace WAVM { namespace LLVMJIT {
 				IR::ValueType iptrValueType = iptrType->getIntegerBitWidth() == 32
 												  ? IR::ValueType::i32
 												  : IR::ValueType::i64;
-				emitRuntimeIntrinsic("throwException",
-									 IR::FunctionType(IR::TypeTuple{},
-													  IR::TypeTuple{iptrValueType},
-													  IR::CallingConvention::intrinsic),
-									 {irBuilder.CreatePtrToInt(exception, iptrType)});
-				irBuilder.CreateUnreachable();
+				emitNoReturnIntrinsic("throwException",
+									  IR::FunctionType(IR::TypeTuple{},
+													   IR::TypeTuple{iptrValueType},
+													   IR::CallingConvention::intrinsic),
+									  {irBuilder.CreatePtrToInt(exception, iptrType)});
 
 				// Load the results from the results array.
 				irBuilder.SetInsertPoint(returnBlock);
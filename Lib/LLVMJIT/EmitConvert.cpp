@@ -166,9 +166,8 @@ llvm::Value* EmitFunctionContext::emitTruncFloatToInt(ValueType destType,
 	irBuilder.CreateCondBr(isNaN, nanBlock, notNaNBlock, moduleContext.likelyFalseBranchWeights);
 
 	irBuilder.SetInsertPoint(nanBlock);
-	emitRuntimeIntrinsic(
+	emitNoReturnIntrinsic(
 		"invalidFloatOperationTrap", FunctionType({}, {}, IR::CallingConvention::intrinsic), {});
-	irBuilder.CreateUnreachable();
 
 	irBuilder.SetInsertPoint(notNaNBlock);
 	auto isOverflow
@@ -178,10 +177,9 @@ llvm::Value* EmitFunctionContext::emitTruncFloatToInt(ValueType destType,
 		isOverflow, overflowBlock, noOverflowBlock, moduleContext.likelyFalseBranchWeights);
 
 	irBuilder.SetInsertPoint(overflowBlock);
-	emitRuntimeIntrinsic("divideByZeroOrIntegerOverflowTrap",
-						 FunctionType({}, {}, IR::CallingConvention::intrinsic),
-						 {});
-	irBuilder.CreateUnreachable();
+	emitNoReturnIntrinsic("divideByZeroOrIntegerOverflowTrap",
+						  FunctionType({}, {}, IR::CallingConvention::intrinsic),
+						  {});
 
 	irBuilder.SetInsertPoint(noOverflowBlock);
 	return isSigned ? irBuilder.CreateFPToSI(operand, asLLVMType(llvmContext, destType))
@@ -221,176 +219,109 @@ EMIT_UNARY_OP(
 	i64_trunc_f64_u,
 	emitTruncFloatToInt<F64>(ValueType::i64, false, -1.0, 18446744073709551616.0, operand))
 
-template<typename Int, typename Float>
+// LLVM's saturating conversion intrinsics match the WebAssembly semantics exactly: NaN converts
+// to zero, and out-of-range values saturate to the min or max of the destination type. Using them
+// instead of a conversion followed by selects lets each target's backend pick its best lowering.
 llvm::Value* EmitFunctionContext::emitTruncFloatToIntSat(llvm::Type* destType,
 														 bool isSigned,
-														 Float minFloatBounds,
-														 Float maxFloatBounds,
-														 Int minIntBounds,
-														 Int maxIntBounds,
 														 llvm::Value* operand)
 {
-	llvm::Value* result = isSigned ? irBuilder.CreateFPToSI(operand, destType)
-								   : irBuilder.CreateFPToUI(operand, destType);
-
-	result = irBuilder.CreateSelect(
-		irBuilder.CreateFCmpOGE(operand, emitLiteral(llvmContext, maxFloatBounds)),
-		emitLiteral(llvmContext, maxIntBounds),
-		result);
-	result = irBuilder.CreateSelect(
-		irBuilder.CreateFCmpOLE(operand, emitLiteral(llvmContext, minFloatBounds)),
-		emitLiteral(llvmContext, minIntBounds),
-		result);
-	result = irBuilder.CreateSelect(irBuilder.CreateFCmp(llvm::CmpInst::FCMP_UNO, operand, operand),
-									emitLiteral(llvmContext, Int(0)),
-									result);
-
-	return result;
+	return callLLVMIntrinsic({destType, operand->getType()},
+							 isSigned ? llvm::Intrinsic::fptosi_sat : llvm::Intrinsic::fptoui_sat,
+							 {operand});
 }
 
-EMIT_UNARY_OP(i32_trunc_sat_f32_s,
-			  emitTruncFloatToIntSat(llvmContext.i32Type,
-									 true,
-									 F32(INT32_MIN),
-									 F32(INT32_MAX),
-									 INT32_MIN,
-									 INT32_MAX,
-									 operand))
-EMIT_UNARY_OP(i32_trunc_sat_f64_s,
-			  emitTruncFloatToIntSat(llvmContext.i32Type,
-									 true,
-									 F64(INT32_MIN),
-									 F64(INT32_MAX),
-									 INT32_MIN,
-									 INT32_MAX,
-									 operand))
-EMIT_UNARY_OP(i32_trunc_sat_f32_u,
-			  emitTruncFloatToIntSat(llvmContext.i32Type,
-									 false,
-									 0.0f,
-									 F32(UINT32_MAX),
-									 U32(0),
-									 UINT32_MAX,
-									 operand))
-EMIT_UNARY_OP(i32_trunc_sat_f64_u,
-			  emitTruncFloatToIntSat(llvmContext.i32Type,
-									 false,
-									 0.0,
-									 F64(UINT32_MAX),
-									 U32(0),
-									 UINT32_MAX,
-									 operand))
-EMIT_UNARY_OP(i64_trunc_sat_f32_s,
-			  emitTruncFloatToIntSat(llvmContext.i64Type,
-									 true,
-									 F32(INT64_MIN),
-									 F32(INT64_MAX),
-									 INT64_MIN,
-									 INT64_MAX,
-									 operand))
-EMIT_UNARY_OP(i64_trunc_sat_f64_s,
-			  emitTruncFloatToIntSat(llvmContext.i64Type,
-									 true,
-									 F64(INT64_MIN),
-									 F64(INT64_MAX),
-									 INT64_MIN,
-									 INT64_MAX,
-									 operand))
-EMIT_UNARY_OP(i64_trunc_sat_f32_u,
-			  emitTruncFloatToIntSat(llvmContext.i64Type,
-									 false,
-									 0.0f,
-									 F32(UINT64_MAX),
-									 U64(0),
-									 UINT64_MAX,
-									 operand))
-EMIT_UNARY_OP(i64_trunc_sat_f64_u,
-			  emitTruncFloatToIntSat(llvmContext.i64Type,
-									 false,
-									 0.0,
-									 F64(UINT64_MAX),
-									 U64(0),
-									 UINT64_MAX,
-									 operand))
-
-template<typename Int, typename Float, Uptr numElements>
-llvm::Value* EmitFunctionContext::emitTruncVectorFloatToIntSat(llvm::Type* destType,
-															   bool isSigned,
-															   Float minFloatBounds,
-															   Float maxFloatBounds,
-															   Int minIntBounds,
-															   Int maxIntBounds,
-															   Int nanResult,
-															   llvm::Value* operand)
+EMIT_UNARY_OP(i32_trunc_sat_f32_s, emitTruncFloatToIntSat(llvmContext.i32Type, true, operand))
+EMIT_UNARY_OP(i32_trunc_sat_f64_s, emitTruncFloatToIntSat(llvmContext.i32Type, true, operand))
+EMIT_UNARY_OP(i32_trunc_sat_f32_u, emitTruncFloatToIntSat(llvmContext.i32Type, false, operand))
+EMIT_UNARY_OP(i32_trunc_sat_f64_u, emitTruncFloatToIntSat(llvmContext.i32Type, false, operand))
+EMIT_UNARY_OP(i64_trunc_sat_f32_s, emitTruncFloatToIntSat(llvmContext.i64Type, true, operand))
+EMIT_UNARY_OP(i64_trunc_sat_f64_s, emitTruncFloatToIntSat(llvmContext.i64Type, true, operand))
+EMIT_UNARY_OP(i64_trunc_sat_f32_u, emitTruncFloatToIntSat(llvmContext.i64Type, false, operand))
+EMIT_UNARY_OP(i64_trunc_sat_f64_u, emitTruncFloatToIntSat(llvmContext.i64Type, false, operand))
+
+void EmitFunctionContext::i32x4_trunc_sat_f32x4_s(NoImm)
 {
-	auto result = isSigned ? irBuilder.CreateFPToSI(operand, destType)
-						   : irBuilder.CreateFPToUI(operand, destType);
-
-	auto minFloatBoundsVec
-		= irBuilder.CreateVectorSplat(numElements, emitLiteral(llvmContext, minFloatBounds));
-	auto maxFloatBoundsVec
-		= irBuilder.CreateVectorSplat(numElements, emitLiteral(llvmContext, maxFloatBounds));
-
-	result = emitVectorSelect(
-		irBuilder.CreateFCmpOGE(operand, maxFloatBoundsVec),
-		irBuilder.CreateVectorSplat(numElements, emitLiteral(llvmContext, maxIntBounds)),
-		result);
-	result = emitVectorSelect(
-		irBuilder.CreateFCmpOLE(operand, minFloatBoundsVec),
-		irBuilder.CreateVectorSplat(numElements, emitLiteral(llvmContext, minIntBounds)),
-		result);
-	result = emitVectorSelect(
-		irBuilder.CreateFCmp(llvm::CmpInst::FCMP_UNO, operand, operand),
-		irBuilder.CreateVectorSplat(numElements, emitLiteral(llvmContext, nanResult)),
-		result);
-	return result;
+	auto operand = irBuilder.CreateBitCast(pop(), llvmContext.f32x4Type);
+
+	if(moduleContext.targetArch == llvm::Triple::x86_64
+	   || moduleContext.targetArch == llvm::Triple::x86)
+	{
+		// x86 cvttps2dq converts NaN and out-of-range lanes to INT32_MIN. Flip the lanes that are
+		// >= 2^31 to INT32_MAX, and zero the NaN lanes, which is cheaper than the clamping that the
+		// generic lowering of fptosi.sat uses.
+		auto result = callLLVMIntrinsic({}, llvm::Intrinsic::x86_sse2_cvttps2dq, {operand});
+		auto positiveOverflowMask = irBuilder.CreateSExt(
+			irBuilder.CreateFCmpOGE(
+				operand,
+				irBuilder.CreateVectorSplat(4, emitLiteral(llvmContext, 2147483648.0f))),
+			llvmContext.i32x4Type);
+		auto orderedMask = irBuilder.CreateSExt(irBuilder.CreateFCmpORD(operand, operand),
+												llvmContext.i32x4Type);
+		push(irBuilder.CreateAnd(irBuilder.CreateXor(result, positiveOverflowMask), orderedMask));
+	}
+	else
+	{
+		push(emitTruncFloatToIntSat(llvmContext.i32x4Type, true, operand));
+	}
 }
 
-EMIT_UNARY_OP(
-	i32x4_trunc_sat_f32x4_s,
-	(emitTruncVectorFloatToIntSat<I32, F32, 4>)(llvmContext.i32x4Type,
-												true,
-												F32(INT32_MIN),
-												F32(INT32_MAX),
-												INT32_MIN,
-												INT32_MAX,
-												I32(0),
-												irBuilder.CreateBitCast(operand,
-																		llvmContext.f32x4Type)))
-EMIT_UNARY_OP(
-	i32x4_trunc_sat_f32x4_u,
-	(emitTruncVectorFloatToIntSat<U32, F32, 4>)(llvmContext.i32x4Type,
-												false,
-												0.0f,
-												F32(UINT32_MAX),
-												U32(0),
-												UINT32_MAX,
-												U32(0),
-												irBuilder.CreateBitCast(operand,
-																		llvmContext.f32x4Type)))
+EMIT_UNARY_OP(i32x4_trunc_sat_f32x4_u,
+			  emitTruncFloatToIntSat(llvmContext.i32x4Type,
+									 false,
+									 irBuilder.CreateBitCast(operand, llvmContext.f32x4Type)))
 
 EMIT_UNARY_OP(i32x4_trunc_sat_f64x2_s_zero,
-			  insertIntoHalfZeroVector(emitTruncVectorFloatToIntSat<I32, F64, 2>(
+			  insertIntoHalfZeroVector(emitTruncFloatToIntSat(
 				  llvmContext.i32x2Type,
 				  true,
-				  F64(INT32_MIN),
-				  F64(INT32_MAX),
-				  INT32_MIN,
-				  INT32_MAX,
-				  I32(0),
 				  irBuilder.CreateBitCast(operand, llvmContext.f64x2Type))))
 
 EMIT_UNARY_OP(i32x4_trunc_sat_f64x2_u_zero,
-			  insertIntoHalfZeroVector(emitTruncVectorFloatToIntSat<U32, F64, 2>(
+			  insertIntoHalfZeroVector(emitTruncFloatToIntSat(
 				  llvmContext.i32x2Type,
 				  false,
-				  F64(0),
-				  F64(UINT32_MAX),
-				  0,
-				  UINT32_MAX,
-				  I32(0),
 				  irBuilder.CreateBitCast(operand, llvmContext.f64x2Type))))
 
+// The relaxed conversions may return INT32_MIN for NaN and out-of-range lanes instead of
+// saturating, which is what the x86 conversion instructions do. On other targets, the native
+// conversion instructions saturate, so the relaxed conversions use the strict lowering.
+void EmitFunctionContext::i32x4_relaxed_trunc_f32x4_s(NoImm)
+{
+	if(moduleContext.targetArch == llvm::Triple::x86_64
+	   || moduleContext.targetArch == llvm::Triple::x86)
+	{
+		auto operand = irBuilder.CreateBitCast(pop(), llvmContext.f32x4Type);
+		push(callLLVMIntrinsic({}, llvm::Intrinsic::x86_sse2_cvttps2dq, {operand}));
+	}
+	else
+	{
+		i32x4_trunc_sat_f32x4_s(NoImm());
+	}
+}
+
+void EmitFunctionContext::i32x4_relaxed_trunc_f32x4_u(NoImm) { i32x4_trunc_sat_f32x4_u(NoImm()); }
+
+void EmitFunctionContext::i32x4_relaxed_trunc_f64x2_s_zero(NoImm)
+{
+	if(moduleContext.targetArch == llvm::Triple::x86_64
+	   || moduleContext.targetArch == llvm::Triple::x86)
+	{
+		// cvttpd2dq zeroes the upper two lanes of its result.
+		auto operand = irBuilder.CreateBitCast(pop(), llvmContext.f64x2Type);
+		push(callLLVMIntrinsic({}, llvm::Intrinsic::x86_sse2_cvttpd2dq, {operand}));
+	}
+	else
+	{
+		i32x4_trunc_sat_f64x2_s_zero(NoImm());
+	}
+}
+
+void EmitFunctionContext::i32x4_relaxed_trunc_f64x2_u_zero(NoImm)
+{
+	i32x4_trunc_sat_f64x2_u_zero(NoImm());
+}
+
 EMIT_UNARY_OP(i32_extend8_s, sext(trunc(operand, llvmContext.i8Type), llvmContext.i32Type))
 EMIT_UNARY_OP(i32_extend16_s, sext(trunc(operand, llvmContext.i16Type), llvmContext.i32Type))
 EMIT_UNARY_OP(i64_extend8_s, sext(trunc(operand, llvmContext.i8Type), llvmContext.i64Type))
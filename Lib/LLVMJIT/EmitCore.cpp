@@ -270,12 +270,14 @@ void EmitFunctionContext::br_table(BranchTableImm imm)
 	}
 
 	// Create a LLVM switch instruction.
-	WAVM_ASSERT(imm.branchTableIndex < functionDef.branchTables.size());
-	const std::vector<Uptr>& targetDepths = functionDef.branchTables[imm.branchTableIndex];
+	WAVM_ASSERT(imm.firstTargetDepthIndex + imm.numTargetDepths
+				<= functionDef.branchTableTargetDepths.size());
+	const Uptr* targetDepths
+		= functionDef.branchTableTargetDepths.data() + imm.firstTargetDepthIndex;
 	auto llvmSwitch
-		= irBuilder.CreateSwitch(index, defaultTarget.block, (unsigned int)targetDepths.size());
+		= irBuilder.CreateSwitch(index, defaultTarget.block, (unsigned int)imm.numTargetDepths);
 
-	for(Uptr targetIndex = 0; targetIndex < targetDepths.size(); ++targetIndex)
+	for(Uptr targetIndex = 0; targetIndex < imm.numTargetDepths; ++targetIndex)
 	{
 		BranchTarget& target = getBranchTargetByDepth(targetDepths[targetIndex]);
 
@@ -314,9 +316,8 @@ void EmitFunctionContext::return_(NoImm)
 void EmitFunctionContext::unreachable(NoImm)
 {
 	// Call an intrinsic that causes a trap, and insert the LLVM unreachable terminator.
-	emitRuntimeIntrinsic(
+	emitNoReturnIntrinsic(
 		"unreachableTrap", FunctionType({}, {}, IR::CallingConvention::intrinsic), {});
-	irBuilder.CreateUnreachable();
 
 	enterUnreachable();
 }
@@ -325,6 +326,15 @@ void EmitFunctionContext::unreachable(NoImm)
 // Call operators
 //
 
+// Returns true if the function is a definition that always returns the context it was called with,
+// so the memory base pointers don't need to be reloaded after calling it.
+bool EmitFunctionContext::doesFunctionPreserveContext(Uptr functionIndex)
+{
+	const Uptr numImports = irModule.functions.imports.size();
+	return functionIndex >= numImports
+		   && moduleContext.functionDefPreservesContext[functionIndex - numImports];
+}
+
 void EmitFunctionContext::call(FunctionImm imm)
 {
 	WAVM_ASSERT(imm.functionIndex < moduleContext.functions.size());
@@ -348,7 +358,8 @@ void EmitFunctionContext::call(FunctionImm imm)
 	ValueVector results = emitCallOrInvoke(callee,
 										   llvm::ArrayRef<llvm::Value*>(llvmArgs, numArguments),
 										   calleeType,
-										   getInnermostUnwindToBlock());
+										   getInnermostUnwindToBlock(),
+										   doesFunctionPreserveContext(imm.functionIndex));
 
 	// Push the results on the operand stack.
 	for(llvm::Value* result : results) { push(result); }
@@ -362,6 +373,30 @@ void EmitFunctionContext::call_indirect(CallIndirectImm imm)
 	// Compile the function index.
 	auto elementIndex = pop();
 
+	// If the table always holds the elements it was initialized with, and the element index is a
+	// constant that selects a function of the callee type, call that function directly.
+	const std::vector<Uptr>& tableElements = moduleContext.immutableTableElements[imm.tableIndex];
+	if(auto constantElementIndex = llvm::dyn_cast<llvm::ConstantInt>(elementIndex))
+	{
+		const U64 constantIndex = constantElementIndex->getZExtValue();
+		const Uptr functionIndex = constantIndex < tableElements.size()
+									   ? tableElements[Uptr(constantIndex)]
+									   : UINTPTR_MAX;
+		if(functionIndex != UINTPTR_MAX
+		   && irModule.types[irModule.functions.getType(functionIndex).index] == calleeType)
+		{
+			call({functionIndex});
+			return;
+		}
+	}
+
+	// If the table always holds the elements it was initialized with, and only one of them is a
+	// function of the callee type, guard on the loaded element and call that function directly if
+	// it matches.
+	const Uptr* singleFunctionIndex
+		= moduleContext.immutableTableFunctionsByType[imm.tableIndex].get(calleeType);
+	const Uptr speculatedFunctionIndex = singleFunctionIndex ? *singleFunctionIndex : UINTPTR_MAX;
+
 	// Pop the call arguments from the operand stack.
 	const Uptr numArguments = calleeType.params().size();
 	auto llvmArgs = (llvm::Value**)alloca(sizeof(llvm::Value*) * numArguments);
@@ -409,6 +444,36 @@ void EmitFunctionContext::call_indirect(CallIndirectImm imm)
 	auto runtimeFunction = irBuilder.CreateIntToPtr(
 		irBuilder.CreateAdd(biasedValueLoad, moduleContext.tableReferenceBias),
 		llvmContext.ptrType);
+	llvm::BasicBlock* directCallEndBlock = nullptr;
+	ValueVector directCallResults;
+	if(speculatedFunctionIndex != UINTPTR_MAX)
+	{
+		// A function's code is at the end of its Runtime::Function.
+		llvm::Function* speculatedFunction = moduleContext.functions[speculatedFunctionIndex];
+		auto speculatedRuntimeFunction = irBuilder.CreateInBoundsGEP(
+			llvmContext.i8Type,
+			speculatedFunction,
+			{emitLiteralIptr(-Iptr(offsetof(Runtime::Function, code)), moduleContext.iptrType)});
+
+		auto directCallBlock = llvm::BasicBlock::Create(llvmContext, "directCall", function);
+		auto indirectCallBlock = llvm::BasicBlock::Create(llvmContext, "indirectCall", function);
+		irBuilder.CreateCondBr(irBuilder.CreateICmpEQ(runtimeFunction, speculatedRuntimeFunction),
+							   directCallBlock,
+							   indirectCallBlock,
+							   moduleContext.likelyTrueBranchWeights);
+
+		irBuilder.SetInsertPoint(directCallBlock);
+		directCallResults
+			= emitCallOrInvoke(speculatedFunction,
+							   llvm::ArrayRef<llvm::Value*>(llvmArgs, numArguments),
+							   calleeType,
+							   getInnermostUnwindToBlock(),
+							   doesFunctionPreserveContext(speculatedFunctionIndex));
+		directCallEndBlock = irBuilder.GetInsertBlock();
+
+		irBuilder.SetInsertPoint(indirectCallBlock);
+	}
+
 	auto elementTypeId = loadFromUntypedPointer(
 		irBuilder.CreateInBoundsGEP(
 			llvmContext.i8Type,
@@ -445,6 +510,25 @@ void EmitFunctionContext::call_indirect(CallIndirectImm imm)
 										   calleeType,
 										   getInnermostUnwindToBlock());
 
+	// If there was a direct call, merge its results with the indirect call's.
+	if(directCallEndBlock)
+	{
+		llvm::BasicBlock* indirectCallEndBlock = irBuilder.GetInsertBlock();
+		auto callEndBlock = llvm::BasicBlock::Create(llvmContext, "callIndirectEnd", function);
+		irBuilder.CreateBr(callEndBlock);
+		irBuilder.SetInsertPoint(directCallEndBlock);
+		irBuilder.CreateBr(callEndBlock);
+
+		irBuilder.SetInsertPoint(callEndBlock);
+		for(Uptr resultIndex = 0; resultIndex < results.size(); ++resultIndex)
+		{
+			llvm::PHINode* phi = irBuilder.CreatePHI(results[resultIndex]->getType(), 2);
+			phi->addIncoming(directCallResults[resultIndex], directCallEndBlock);
+			phi->addIncoming(results[resultIndex], indirectCallEndBlock);
+			results[resultIndex] = phi;
+		}
+	}
+
 	// Push the results on the operand stack.
 	for(llvm::Value* result : results) { push(result); }
 }
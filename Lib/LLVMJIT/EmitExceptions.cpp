@@ -82,12 +82,11 @@ void EmitFunctionContext::endTryCatch()
 	// handlers.
 	llvm::BasicBlock* savedInsertionPoint = irBuilder.GetInsertBlock();
 	irBuilder.SetInsertPoint(catchContext.nextHandlerBlock);
-	emitRuntimeIntrinsic(
+	emitNoReturnIntrinsic(
 		"throwException",
 		FunctionType(
 			TypeTuple{}, TypeTuple{moduleContext.iptrValueType}, CallingConvention::intrinsic),
 		{irBuilder.CreatePtrToInt(catchContext.exceptionPointer, moduleContext.iptrType)});
-	irBuilder.CreateUnreachable();
 	irBuilder.SetInsertPoint(savedInsertionPoint);
 
 	catchStack.pop_back();
@@ -351,25 +350,23 @@ void EmitFunctionContext::throw_(ExceptionTypeImm imm)
 			IR::CallingConvention::intrinsic),
 		{exceptionTypeId, argsPointerAsInt, emitLiteral(llvmContext, I32(1))})[0];
 
-	emitRuntimeIntrinsic(
+	emitNoReturnIntrinsic(
 		"throwException",
 		FunctionType(
 			TypeTuple{}, TypeTuple{moduleContext.iptrValueType}, IR::CallingConvention::intrinsic),
 		{irBuilder.CreatePtrToInt(exceptionPointer, moduleContext.iptrType)});
 
-	irBuilder.CreateUnreachable();
 	enterUnreachable();
 }
 void EmitFunctionContext::rethrow(RethrowImm imm)
 {
 	WAVM_ASSERT(imm.catchDepth < catchStack.size());
 	CatchContext& catchContext = catchStack[catchStack.size() - imm.catchDepth - 1];
-	emitRuntimeIntrinsic(
+	emitNoReturnIntrinsic(
 		"throwException",
 		FunctionType(
 			TypeTuple{}, TypeTuple{moduleContext.iptrValueType}, IR::CallingConvention::intrinsic),
 		{irBuilder.CreatePtrToInt(catchContext.exceptionPointer, moduleContext.iptrType)});
 
-	irBuilder.CreateUnreachable();
 	enterUnreachable();
 }
@@ -166,8 +166,7 @@ void EmitFunctionContext::emitConditionalTrapIntrinsic(
 		booleanCondition, trueBlock, endBlock, moduleContext.likelyFalseBranchWeights);
 
 	irBuilder.SetInsertPoint(trueBlock);
-	emitRuntimeIntrinsic(intrinsicName, intrinsicType, args);
-	irBuilder.CreateUnreachable();
+	emitNoReturnIntrinsic(intrinsicName, intrinsicType, args);
 
 	irBuilder.SetInsertPoint(endBlock);
 }
@@ -355,11 +354,33 @@ void EmitFunctionContext::emit()
 		}
 	}
 
+	if(irModule.featureSpec.explicitStackLimitChecks)
+	{
+		// Trap if the stack pointer is below the context's stack limit. The stack pointer is read
+		// after the prologue has allocated the function's fixed-size stack frame, so the check
+		// covers the frame.
+		llvm::Value* stackPointer = irBuilder.CreatePtrToInt(
+			callLLVMIntrinsic({llvmContext.ptrType}, llvm::Intrinsic::stacksave, {}),
+			moduleContext.iptrType);
+		llvm::Value* stackLimit = loadFromUntypedPointer(
+			irBuilder.CreateInBoundsGEP(
+				llvmContext.i8Type,
+				irBuilder.CreateLoad(llvmContext.ptrType, contextPointerVariable),
+				{emitLiteralIptr(offsetof(Runtime::ContextRuntimeData, stackLimit),
+								 moduleContext.iptrType)}),
+			moduleContext.iptrType,
+			moduleContext.iptrAlignment);
+		emitConditionalTrapIntrinsic(irBuilder.CreateICmpULT(stackPointer, stackLimit),
+									 "stackOverflowTrap",
+									 FunctionType({}, {}, IR::CallingConvention::intrinsic),
+									 {});
+	}
+
 	if(EMIT_ENTER_EXIT_HOOKS)
 	{
 		emitRuntimeIntrinsic(
 			"debugEnterFunction",
-			FunctionType({}, {ValueType::funcref}, IR::CallingConvention::intrinsic),
+			FunctionType({}, {ValueType::funcref}, IR::CallingConvention::c),
 			{llvm::ConstantExpr::getSub(
 				llvm::ConstantExpr::getPtrToInt(function, moduleContext.iptrType),
 				emitLiteralIptr(offsetof(Runtime::Function, code), moduleContext.iptrType))});
@@ -390,7 +411,7 @@ void EmitFunctionContext::emit()
 	{
 		emitRuntimeIntrinsic(
 			"debugExitFunction",
-			FunctionType({}, {ValueType::funcref}, IR::CallingConvention::intrinsic),
+			FunctionType({}, {ValueType::funcref}, IR::CallingConvention::c),
 			{llvm::ConstantExpr::getSub(
 				llvm::ConstantExpr::getPtrToInt(function, moduleContext.iptrType),
 				emitLiteralIptr(offsetof(Runtime::Function, code), moduleContext.iptrType))});
@@ -177,6 +177,8 @@ namespace WAVM { namespace LLVMJIT {
 										  IR::FunctionType intrinsicType,
 										  const std::initializer_list<llvm::Value*>& args);
 
+		bool doesFunctionPreserveContext(Uptr functionIndex);
+
 		void pushControlStack(ControlContext::Type type,
 							  IR::TypeTuple resultTypes,
 							  llvm::BasicBlock* endBlock,
@@ -256,25 +258,10 @@ namespace WAVM { namespace LLVMJIT {
 										 Float maxBounds,
 										 llvm::Value* operand);
 
-		template<typename Int, typename Float>
 		llvm::Value* emitTruncFloatToIntSat(llvm::Type* destType,
 											bool isSigned,
-											Float minFloatBounds,
-											Float maxFloatBounds,
-											Int minIntBounds,
-											Int maxIntBounds,
 											llvm::Value* operand);
 
-		template<typename Int, typename Float, Uptr numElements>
-		llvm::Value* emitTruncVectorFloatToIntSat(llvm::Type* destType,
-												  bool isSigned,
-												  Float minFloatBounds,
-												  Float maxFloatBounds,
-												  Int minIntBounds,
-												  Int maxIntBounds,
-												  Int nanResult,
-												  llvm::Value* operand);
-
 		llvm::Value* emitBitSelect(llvm::Value* mask,
 								   llvm::Value* trueValue,
 								   llvm::Value* falseValue);
@@ -36,6 +36,16 @@ enum class BoundsCheckOp
 	trapOnOutOfBounds
 };
 
+// Returns whether accesses to a memory should be volatile. Volatile accesses prevent LLVM from
+// removing or reordering accesses that trap by faulting on the memory's guard pages, and from
+// assuming that shared memories aren't concurrently accessed by other threads.
+static bool isMemoryAccessVolatile(EmitFunctionContext& functionContext, Uptr memoryIndex)
+{
+	const IR::Module& irModule = functionContext.moduleContext.irModule;
+	return irModule.featureSpec.preciseMemoryTraps
+		   || irModule.memories.getType(memoryIndex).isShared;
+}
+
 static llvm::Value* getMemoryNumPages(EmitFunctionContext& functionContext, Uptr memoryIndex)
 {
 	llvm::Constant* memoryOffset = functionContext.moduleContext.memoryOffsets[memoryIndex];
@@ -271,8 +281,13 @@ void EmitFunctionContext::memory_copy(MemoryCopyImm imm)
 	llvm::Value* numBytesUptr = irBuilder.CreateZExt(numBytes, moduleContext.iptrType);
 
 	// Use the LLVM memmove instruction to do the copy.
-	irBuilder.CreateMemMove(
-		destPointer, LLVM_ALIGNMENT(1), sourcePointer, LLVM_ALIGNMENT(1), numBytesUptr, true);
+	irBuilder.CreateMemMove(destPointer,
+						   LLVM_ALIGNMENT(1),
+						   sourcePointer,
+						   LLVM_ALIGNMENT(1),
+						   numBytesUptr,
+						   isMemoryAccessVolatile(*this, imm.sourceMemoryIndex)
+							   || isMemoryAccessVolatile(*this, imm.destMemoryIndex));
 }
 
 void EmitFunctionContext::memory_fill(MemoryImm imm)
@@ -292,7 +307,7 @@ void EmitFunctionContext::memory_fill(MemoryImm imm)
 						   irBuilder.CreateTrunc(value, llvmContext.i8Type),
 						   numBytesUptr,
 						   LLVM_ALIGNMENT(1),
-						   true);
+						   isMemoryAccessVolatile(*this, imm.memoryIndex));
 }
 
 //
@@ -315,7 +330,7 @@ void EmitFunctionContext::memory_fill(MemoryImm imm)
 		/* Don't trust the alignment hint provided by the WebAssembly code, since the load can't   \
 		 * trap if it's wrong. */                                                                  \
 		load->setAlignment(LLVM_ALIGNMENT(1));                                                     \
-		load->setVolatile(true);                                                                   \
+		load->setVolatile(isMemoryAccessVolatile(*this, imm.memoryIndex));                         \
 		push(conversionOp(load, destType));                                                        \
 	}
 #define EMIT_STORE_OP(name, llvmMemoryType, numBytesLog2, conversionOp)                            \
@@ -333,7 +348,7 @@ void EmitFunctionContext::memory_fill(MemoryImm imm)
 		auto pointer = coerceAddressToPointer(boundedAddress, imm.memoryIndex);                    \
 		auto memoryValue = conversionOp(value, llvmMemoryType);                                    \
 		auto store = irBuilder.CreateStore(memoryValue, pointer);                                  \
-		store->setVolatile(true);                                                                  \
+		store->setVolatile(isMemoryAccessVolatile(*this, imm.memoryIndex));                        \
 		/* Don't trust the alignment hint provided by the WebAssembly code, since the store can't  \
 		 * trap if it's wrong. */                                                                  \
 		store->setAlignment(LLVM_ALIGNMENT(1));                                                    \
@@ -415,7 +430,7 @@ static void emitLoadLane(EmitFunctionContext& functionContext,
 	// Don't trust the alignment hint provided by the WebAssembly code, since the load can't trap if
 	// it's wrong.
 	load->setAlignment(LLVM_ALIGNMENT(1));
-	load->setVolatile(true);
+	load->setVolatile(isMemoryAccessVolatile(functionContext, loadOrStoreImm.memoryIndex));
 
 	vector = functionContext.irBuilder.CreateInsertElement(vector, load, laneIndex);
 	functionContext.push(vector);
@@ -446,7 +461,7 @@ static void emitStoreLane(EmitFunctionContext& functionContext,
 	// Don't trust the alignment hint provided by the WebAssembly code, since the load can't trap if
 	// it's wrong.
 	store->setAlignment(LLVM_ALIGNMENT(1));
-	store->setVolatile(true);
+	store->setVolatile(isMemoryAccessVolatile(functionContext, loadOrStoreImm.memoryIndex));
 }
 
 #define EMIT_LOAD_LANE_OP(name, llvmVectorType, naturalAlignmentLog2, numLanes)                    \
@@ -514,7 +529,7 @@ static void emitLoadInterleaved(EmitFunctionContext& functionContext,
 			/* Don't trust the alignment hint provided by the WebAssembly code, since the load
 			 * can't trap if it's wrong. */
 			load->setAlignment(LLVM_ALIGNMENT(1));
-			load->setVolatile(true);
+			load->setVolatile(isMemoryAccessVolatile(functionContext, imm.memoryIndex));
 			loads[vectorIndex] = load;
 		}
 		for(U32 vectorIndex = 0; vectorIndex < numVectors; ++vectorIndex)
@@ -595,7 +610,7 @@ static void emitStoreInterleaved(EmitFunctionContext& functionContext,
 					llvmValueType,
 					pointer,
 					{emitLiteral(functionContext.llvmContext, U32(vectorIndex))}));
-			store->setVolatile(true);
+			store->setVolatile(isMemoryAccessVolatile(functionContext, imm.memoryIndex));
 			store->setAlignment(LLVM_ALIGNMENT(1));
 		}
 	}
@@ -1,13 +1,16 @@
 #include <stdint.h>
+#include <algorithm>
 #include <cstring>
 #include <vector>
 #include "EmitFunctionContext.h"
 #include "EmitModuleContext.h"
 #include "LLVMJITPrivate.h"
 #include "WAVM/IR/Module.h"
+#include "WAVM/IR/Operators.h"
 #include "WAVM/IR/Types.h"
 #include "WAVM/Inline/BasicTypes.h"
 #include "WAVM/Inline/Errors.h"
+#include "WAVM/Inline/HashMap.h"
 #include "WAVM/Inline/Timing.h"
 
 PUSH_DISABLE_WARNINGS_FOR_LLVM_HEADERS
@@ -23,6 +26,7 @@ PUSH_DISABLE_WARNINGS_FOR_LLVM_HEADERS
 #include <llvm/IR/Metadata.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Type.h>
+#include <llvm/MC/MCSubtargetInfo.h>
 #include <llvm/Target/TargetMachine.h>
 POP_DISABLE_WARNINGS_FOR_LLVM_HEADERS
 
@@ -49,6 +53,11 @@ EmitModuleContext::EmitModuleContext(const IR::Module& inIRModule,
 	targetArch = targetMachine->getTargetTriple().getArch();
 	useWindowsSEH = targetMachine->getTargetTriple().getOS() == llvm::Triple::Win32;
 
+	const llvm::MCSubtargetInfo* subtargetInfo = targetMachine->getMCSubtargetInfo();
+	hasX86VNNI = (targetArch == llvm::Triple::x86_64 || targetArch == llvm::Triple::x86)
+				 && (subtargetInfo->checkFeatures("+avxvnni")
+					 || subtargetInfo->checkFeatures("+avx512vnni,+avx512vl"));
+
 	const U32 numPointerBytes = targetMachine->getProgramPointerSize();
 	iptrAlignment = numPointerBytes;
 	iptrType = getIptrType(llvmContext, numPointerBytes);
@@ -115,6 +124,241 @@ static llvm::Constant* createImportedConstant(llvm::Module& llvmModule, llvm::Tw
 									externalName);
 }
 
+// Determines which function definitions always return the same context pointer they were called
+// with, so their callers don't need to reload the memory base pointers after calling them. A
+// function may return a different context if it executes memory.grow, calls an imported function,
+// calls a function through a table, or calls a function definition that may do any of those.
+static std::vector<bool> getFunctionDefsThatPreserveContext(const IR::Module& irModule)
+{
+	const Uptr numImports = irModule.functions.imports.size();
+	const Uptr numDefs = irModule.functions.defs.size();
+
+	std::vector<bool> preservesContext(numDefs, true);
+	std::vector<std::vector<Uptr>> callerDefIndices(numDefs);
+	std::vector<Uptr> pendingDefIndices;
+	for(Uptr functionDefIndex = 0; functionDefIndex < numDefs; ++functionDefIndex)
+	{
+		const FunctionDef& functionDef = irModule.functions.defs[functionDefIndex];
+		const U8* nextByte = functionDef.code.data();
+		const U8* end = nextByte + functionDef.code.size();
+		while(nextByte < end && preservesContext[functionDefIndex])
+		{
+			const Opcode opcode = decodeOpcode(nextByte);
+			if(opcode == Opcode::call)
+			{
+				FunctionImm imm;
+				decodeImm(nextByte, imm);
+				if(imm.functionIndex < numImports) { preservesContext[functionDefIndex] = false; }
+				else
+				{
+					callerDefIndices[imm.functionIndex - numImports].push_back(functionDefIndex);
+				}
+				continue;
+			}
+			else if(opcode == Opcode::call_indirect || opcode == Opcode::memory_grow)
+			{
+				preservesContext[functionDefIndex] = false;
+			}
+
+			// Skip the operator's immediates.
+			switch(opcode)
+			{
+#define VISIT_OPCODE(_, name, nameString, Imm, ...)                                                \
+	case Opcode::name: {                                                                           \
+		Imm imm;                                                                                   \
+		decodeImm(nextByte, imm);                                                                  \
+		break;                                                                                     \
+	}
+				WAVM_ENUM_OPERATORS(VISIT_OPCODE)
+#undef VISIT_OPCODE
+			default: WAVM_UNREACHABLE();
+			}
+		}
+
+		if(!preservesContext[functionDefIndex]) { pendingDefIndices.push_back(functionDefIndex); }
+	}
+
+	// Propagate the possibility of changing the context from each function to its callers.
+	while(pendingDefIndices.size())
+	{
+		const Uptr calleeDefIndex = pendingDefIndices.back();
+		pendingDefIndices.pop_back();
+		for(Uptr callerDefIndex : callerDefIndices[calleeDefIndex])
+		{
+			if(preservesContext[callerDefIndex])
+			{
+				preservesContext[callerDefIndex] = false;
+				pendingDefIndices.push_back(callerDefIndex);
+			}
+		}
+	}
+
+	return preservesContext;
+}
+
+// The largest number of initialized elements getImmutableTableElements will track for a table.
+static constexpr Uptr maxImmutableTableElements = 65536;
+
+// Determines which tables always hold the elements they are initialized with, and returns the
+// function index of each element of those tables (or UINTPTR_MAX for null elements). A table
+// qualifies if it isn't imported or exported, its active elem segments have constant offsets,
+// and the module's code never writes to it. Tables that don't qualify get an empty vector, which
+// is indistinguishable from a table that only contains null elements.
+static std::vector<std::vector<Uptr>> getImmutableTableElements(const IR::Module& irModule)
+{
+	std::vector<bool> isImmutable(irModule.tables.size(), false);
+	for(Uptr tableIndex = irModule.tables.imports.size(); tableIndex < irModule.tables.size();
+		++tableIndex)
+	{
+		const TableType& tableType = irModule.tables.getType(tableIndex);
+		isImmutable[tableIndex]
+			= tableType.elementType == ReferenceType::funcref && !tableType.isShared;
+	}
+	for(const Export& export_ : irModule.exports)
+	{
+		if(export_.kind == ExternKind::table) { isImmutable[export_.index] = false; }
+	}
+	for(const ElemSegment& elemSegment : irModule.elemSegments)
+	{
+		if(elemSegment.type == ElemSegment::Type::active
+		   && elemSegment.baseOffset.type != InitializerExpression::Type::i32_const
+		   && elemSegment.baseOffset.type != InitializerExpression::Type::i64_const)
+		{ isImmutable[elemSegment.tableIndex] = false; }
+	}
+
+	// Find any instructions that write to the tables.
+	if(std::find(isImmutable.begin(), isImmutable.end(), true) != isImmutable.end())
+	{
+		for(const FunctionDef& functionDef : irModule.functions.defs)
+		{
+			const U8* nextByte = functionDef.code.data();
+			const U8* end = nextByte + functionDef.code.size();
+			while(nextByte < end)
+			{
+				const Opcode opcode = decodeOpcode(nextByte);
+				switch(opcode)
+				{
+				case Opcode::table_set:
+				case Opcode::table_grow:
+				case Opcode::table_fill: {
+					TableImm imm;
+					decodeImm(nextByte, imm);
+					isImmutable[imm.tableIndex] = false;
+					continue;
+				}
+				case Opcode::table_copy: {
+					TableCopyImm imm;
+					decodeImm(nextByte, imm);
+					isImmutable[imm.destTableIndex] = false;
+					continue;
+				}
+				case Opcode::table_init: {
+					ElemSegmentAndTableImm imm;
+					decodeImm(nextByte, imm);
+					isImmutable[imm.tableIndex] = false;
+					continue;
+				}
+				default: break;
+				}
+
+				// Skip the operator's immediates.
+				switch(opcode)
+				{
+#define VISIT_OPCODE(_, name, nameString, Imm, ...)                                                \
+	case Opcode::name: {                                                                           \
+		Imm imm;                                                                                   \
+		decodeImm(nextByte, imm);                                                                  \
+		break;                                                                                     \
+	}
+					WAVM_ENUM_OPERATORS(VISIT_OPCODE)
+#undef VISIT_OPCODE
+				default: WAVM_UNREACHABLE();
+				}
+			}
+		}
+	}
+
+	// Apply the active elem segments to each immutable table. Elements past the end of the vector
+	// are null.
+	std::vector<std::vector<Uptr>> tableElements(irModule.tables.size());
+	for(const ElemSegment& elemSegment : irModule.elemSegments)
+	{
+		if(elemSegment.type != ElemSegment::Type::active || !isImmutable[elemSegment.tableIndex])
+		{ continue; }
+
+		std::vector<Uptr>& elements = tableElements[elemSegment.tableIndex];
+		const ElemSegment::Contents& contents = *elemSegment.contents;
+		const U64 tableSize = irModule.tables.getType(elemSegment.tableIndex).size.min;
+		const U64 baseOffset = elemSegment.baseOffset.type == InitializerExpression::Type::i32_const
+								   ? U64(U32(elemSegment.baseOffset.i32))
+								   : U64(elemSegment.baseOffset.i64);
+		const Uptr numElements = contents.encoding == ElemSegment::Encoding::index
+									 ? contents.elemIndices.size()
+									 : contents.elemExprs.size();
+
+		// A segment that doesn't fit in the table fails instantiation, so it doesn't matter what
+		// the table would contain.
+		if(baseOffset > tableSize || numElements > tableSize - baseOffset) { continue; }
+
+		// Don't track the elements of very large tables.
+		if(baseOffset + numElements > maxImmutableTableElements)
+		{
+			isImmutable[elemSegment.tableIndex] = false;
+			elements.clear();
+			continue;
+		}
+
+		if(elements.size() < baseOffset + numElements)
+		{ elements.resize(Uptr(baseOffset + numElements), UINTPTR_MAX); }
+		for(Uptr elementIndex = 0; elementIndex < numElements; ++elementIndex)
+		{
+			Uptr& element = elements[Uptr(baseOffset) + elementIndex];
+			if(contents.encoding == ElemSegment::Encoding::index)
+			{
+				WAVM_ASSERT(contents.externKind == ExternKind::function);
+				element = contents.elemIndices[elementIndex];
+			}
+			else
+			{
+				const ElemExpr& elemExpr = contents.elemExprs[elementIndex];
+				switch(elemExpr.type)
+				{
+				case ElemExpr::Type::ref_null: element = UINTPTR_MAX; break;
+				case ElemExpr::Type::ref_func: element = elemExpr.index; break;
+
+				case ElemExpr::Type::invalid:
+				default: WAVM_UNREACHABLE();
+				}
+			}
+		}
+	}
+
+	return tableElements;
+}
+
+// For each table, maps each function type to the index of the only function of that type in the
+// table's elements, or UINTPTR_MAX if there are several functions of that type.
+static std::vector<HashMap<FunctionType, Uptr>> getTableFunctionsByType(
+	const IR::Module& irModule,
+	const std::vector<std::vector<Uptr>>& tableElements)
+{
+	std::vector<HashMap<FunctionType, Uptr>> tableFunctionsByType(tableElements.size());
+	for(Uptr tableIndex = 0; tableIndex < tableElements.size(); ++tableIndex)
+	{
+		for(Uptr functionIndex : tableElements[tableIndex])
+		{
+			if(functionIndex == UINTPTR_MAX) { continue; }
+
+			const FunctionType type
+				= irModule.types[irModule.functions.getType(functionIndex).index];
+			Uptr& singleFunctionIndex
+				= tableFunctionsByType[tableIndex].getOrAdd(type, functionIndex);
+			if(singleFunctionIndex != functionIndex) { singleFunctionIndex = UINTPTR_MAX; }
+		}
+	}
+	return tableFunctionsByType;
+}
+
 void LLVMJIT::emitModule(const IR::Module& irModule,
 						 LLVMContext& llvmContext,
 						 llvm::Module& outLLVMModule,
@@ -266,6 +510,11 @@ void LLVMJIT::emitModule(const IR::Module& irModule,
 		moduleContext.functions[functionIndex] = function;
 	}
 
+	moduleContext.functionDefPreservesContext = getFunctionDefsThatPreserveContext(irModule);
+	moduleContext.immutableTableElements = getImmutableTableElements(irModule);
+	moduleContext.immutableTableFunctionsByType
+		= getTableFunctionsByType(irModule, moduleContext.immutableTableElements);
+
 	// Compile each function in the module.
 	for(Uptr functionDefIndex = 0; functionDefIndex < irModule.functions.defs.size();
 		++functionDefIndex)
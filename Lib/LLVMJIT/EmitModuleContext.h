@@ -5,6 +5,7 @@
 #include "WAVM/IR/Module.h"
 #include "WAVM/IR/Types.h"
 #include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/HashMap.h"
 
 PUSH_DISABLE_WARNINGS_FOR_LLVM_HEADERS
 #include <llvm/ADT/ArrayRef.h>
@@ -30,6 +31,9 @@ namespace WAVM { namespace LLVMJIT {
 		llvm::Triple::ArchType targetArch;
 		bool useWindowsSEH;
 
+		// Whether the target has the x86 VNNI dot product instructions for 128-bit vectors.
+		bool hasX86VNNI;
+
 		llvm::Type* iptrType;
 		IR::ValueType iptrValueType;
 		U32 iptrAlignment;
@@ -43,6 +47,17 @@ namespace WAVM { namespace LLVMJIT {
 		std::vector<llvm::Constant*> globals;
 		std::vector<llvm::Constant*> exceptionTypeIds;
 
+		// For each function definition, whether it always returns the context it was called with.
+		std::vector<bool> functionDefPreservesContext;
+
+		// For each table, the function index of each element if the table always holds the
+		// elements it's initialized with (UINTPTR_MAX for null elements), or an empty vector.
+		std::vector<std::vector<Uptr>> immutableTableElements;
+
+		// For each table, maps each function type to the only function of that type in
+		// immutableTableElements, or to UINTPTR_MAX if there are several.
+		std::vector<HashMap<IR::FunctionType, Uptr>> immutableTableFunctionsByType;
+
 		llvm::Constant* defaultTableOffset;
 
 		llvm::Constant* instanceId;
@@ -1041,3 +1041,255 @@ void EmitFunctionContext::i16x8_q15mulr_sat_s(NoImm)
 	llvm::Value* result = irBuilder.CreateTrunc(saturate, llvmContext.i16x8Type);
 	push(result);
 }
+
+//
+// Relaxed SIMD
+//
+
+void EmitFunctionContext::i8x16_relaxed_swizzle(NoImm)
+{
+	if(moduleContext.targetArch == llvm::Triple::x86_64
+	   || moduleContext.targetArch == llvm::Triple::x86)
+	{
+		// pshufb writes zero for indices with the high bit set (>= 128), as the relaxed swizzle
+		// requires, and uses indices 16..127 modulo 16, which the relaxed swizzle allows. So it
+		// doesn't need the saturated add that makes pshufb also write zero for indices 16..127.
+		auto indexVector = irBuilder.CreateBitCast(pop(), llvmContext.i8x16Type);
+		auto elementVector = irBuilder.CreateBitCast(pop(), llvmContext.i8x16Type);
+		push(callLLVMIntrinsic(
+			{}, llvm::Intrinsic::x86_ssse3_pshuf_b_128, {elementVector, indexVector}));
+	}
+	else
+	{
+		i8x16_swizzle(NoImm());
+	}
+}
+
+// llvm.fmuladd lets the backend fuse the multiply and add if the target has FMA instructions, and
+// the relaxed multiply-add allows either result.
+#define EMIT_SIMD_RELAXED_MADD_OPS(type)                                                           \
+	void EmitFunctionContext::type##_relaxed_madd(NoImm)                                           \
+	{                                                                                              \
+		auto addend = irBuilder.CreateBitCast(pop(), llvmContext.type##Type);                      \
+		auto right = irBuilder.CreateBitCast(pop(), llvmContext.type##Type);                       \
+		auto left = irBuilder.CreateBitCast(pop(), llvmContext.type##Type);                        \
+		push(callLLVMIntrinsic({llvmContext.type##Type},                                           \
+							   llvm::Intrinsic::experimental_constrained_fmuladd,                  \
+							   {left,                                                              \
+								right,                                                             \
+								addend,                                                            \
+								moduleContext.fpRoundingModeMetadata,                              \
+								moduleContext.fpExceptionMetadata}));                              \
+	}                                                                                              \
+	void EmitFunctionContext::type##_relaxed_nmadd(NoImm)                                          \
+	{                                                                                              \
+		auto addend = irBuilder.CreateBitCast(pop(), llvmContext.type##Type);                      \
+		auto right = irBuilder.CreateBitCast(pop(), llvmContext.type##Type);                       \
+		auto left = irBuilder.CreateBitCast(pop(), llvmContext.type##Type);                        \
+		push(callLLVMIntrinsic({llvmContext.type##Type},                                           \
+							   llvm::Intrinsic::experimental_constrained_fmuladd,                  \
+							   {irBuilder.CreateFNeg(left),                                        \
+								right,                                                             \
+								addend,                                                            \
+								moduleContext.fpRoundingModeMetadata,                              \
+								moduleContext.fpExceptionMetadata}));                              \
+	}
+
+EMIT_SIMD_RELAXED_MADD_OPS(f32x4)
+EMIT_SIMD_RELAXED_MADD_OPS(f64x2)
+
+// The relaxed lane select may either select each bit by the corresponding bit of the mask, or
+// select each lane by the most significant bit of the mask lane. x86 has instructions that do the
+// latter for 8-bit, 32-bit and 64-bit lanes, and AArch64 has an instruction that does the former.
+#define EMIT_SIMD_RELAXED_LANESELECT_OP(type, x86BlendType, x86BlendIntrinsic)                     \
+	void EmitFunctionContext::type##_relaxed_laneselect(NoImm)                                     \
+	{                                                                                              \
+		if(moduleContext.targetArch == llvm::Triple::x86_64                                        \
+		   || moduleContext.targetArch == llvm::Triple::x86)                                       \
+		{                                                                                          \
+			auto mask = irBuilder.CreateBitCast(pop(), x86BlendType);                              \
+			auto falseValue = irBuilder.CreateBitCast(pop(), x86BlendType);                        \
+			auto trueValue = irBuilder.CreateBitCast(pop(), x86BlendType);                         \
+			push(callLLVMIntrinsic({}, x86BlendIntrinsic, {falseValue, trueValue, mask}));         \
+		}                                                                                          \
+		else                                                                                       \
+		{                                                                                          \
+			v128_bitselect(NoImm());                                                               \
+		}                                                                                          \
+	}
+
+EMIT_SIMD_RELAXED_LANESELECT_OP(i8x16, llvmContext.i8x16Type, llvm::Intrinsic::x86_sse41_pblendvb)
+EMIT_SIMD_RELAXED_LANESELECT_OP(i32x4, llvmContext.f32x4Type, llvm::Intrinsic::x86_sse41_blendvps)
+EMIT_SIMD_RELAXED_LANESELECT_OP(i64x2, llvmContext.f64x2Type, llvm::Intrinsic::x86_sse41_blendvpd)
+
+void EmitFunctionContext::i16x8_relaxed_laneselect(NoImm) { v128_bitselect(NoImm()); }
+
+// The relaxed min and max may return either operand if either is NaN, or if they are zeros of
+// opposite sign. That allows using the x86 min and max instructions without fixing up those cases,
+// and AArch64 fmin and fmax, which implement the strict semantics.
+#define EMIT_SIMD_RELAXED_MIN_MAX_OP(type, op, x86Intrinsic, aarch64Intrinsic)                     \
+	void EmitFunctionContext::type##_relaxed_##op(NoImm)                                           \
+	{                                                                                              \
+		if(moduleContext.targetArch == llvm::Triple::x86_64                                        \
+		   || moduleContext.targetArch == llvm::Triple::x86)                                       \
+		{                                                                                          \
+			auto right = irBuilder.CreateBitCast(pop(), llvmContext.type##Type);                   \
+			auto left = irBuilder.CreateBitCast(pop(), llvmContext.type##Type);                    \
+			push(callLLVMIntrinsic({}, x86Intrinsic, {left, right}));                              \
+		}                                                                                          \
+		else if(moduleContext.targetArch == llvm::Triple::aarch64)                                 \
+		{                                                                                          \
+			auto right = irBuilder.CreateBitCast(pop(), llvmContext.type##Type);                   \
+			auto left = irBuilder.CreateBitCast(pop(), llvmContext.type##Type);                    \
+			push(callLLVMIntrinsic({llvmContext.type##Type}, aarch64Intrinsic, {left, right}));    \
+		}                                                                                          \
+		else                                                                                       \
+		{                                                                                          \
+			type##_##op(NoImm());                                                                  \
+		}                                                                                          \
+	}
+
+EMIT_SIMD_RELAXED_MIN_MAX_OP(f32x4,
+							 min,
+							 llvm::Intrinsic::x86_sse_min_ps,
+							 llvm::Intrinsic::aarch64_neon_fmin)
+EMIT_SIMD_RELAXED_MIN_MAX_OP(f32x4,
+							 max,
+							 llvm::Intrinsic::x86_sse_max_ps,
+							 llvm::Intrinsic::aarch64_neon_fmax)
+EMIT_SIMD_RELAXED_MIN_MAX_OP(f64x2,
+							 min,
+							 llvm::Intrinsic::x86_sse2_min_pd,
+							 llvm::Intrinsic::aarch64_neon_fmin)
+EMIT_SIMD_RELAXED_MIN_MAX_OP(f64x2,
+							 max,
+							 llvm::Intrinsic::x86_sse2_max_pd,
+							 llvm::Intrinsic::aarch64_neon_fmax)
+
+void EmitFunctionContext::i16x8_relaxed_q15mulr_s(NoImm)
+{
+	if(moduleContext.targetArch == llvm::Triple::x86_64
+	   || moduleContext.targetArch == llvm::Triple::x86)
+	{
+		// pmulhrsw returns INT16_MIN instead of INT16_MAX for INT16_MIN * INT16_MIN, which the
+		// relaxed Q-format multiplication allows.
+		auto right = irBuilder.CreateBitCast(pop(), llvmContext.i16x8Type);
+		auto left = irBuilder.CreateBitCast(pop(), llvmContext.i16x8Type);
+		push(callLLVMIntrinsic({}, llvm::Intrinsic::x86_ssse3_pmul_hr_sw_128, {left, right}));
+	}
+	else if(moduleContext.targetArch == llvm::Triple::aarch64)
+	{
+		auto right = irBuilder.CreateBitCast(pop(), llvmContext.i16x8Type);
+		auto left = irBuilder.CreateBitCast(pop(), llvmContext.i16x8Type);
+		push(callLLVMIntrinsic(
+			{llvmContext.i16x8Type}, llvm::Intrinsic::aarch64_neon_sqrdmulh, {left, right}));
+	}
+	else
+	{
+		i16x8_q15mulr_sat_s(NoImm());
+	}
+}
+
+// Computes the sums of adjacent pairs of products of the signed 8-bit lanes of left and the 7-bit
+// lanes of right. If a lane of right has its top bit set, it may be interpreted as either signed or
+// unsigned, and the sums may saturate, which allows using x86 pmaddubsw.
+static llvm::Value* emitRelaxedDotI8x16I7x16(EmitFunctionContext& context,
+											 llvm::Value* left,
+											 llvm::Value* right)
+{
+	llvm::IRBuilder<>& irBuilder = context.irBuilder;
+	if(context.moduleContext.targetArch == llvm::Triple::x86_64
+	   || context.moduleContext.targetArch == llvm::Triple::x86)
+	{
+		// pmaddubsw multiplies the unsigned lanes of its first operand by the signed lanes of its
+		// second operand.
+		return context.callLLVMIntrinsic(
+			{}, llvm::Intrinsic::x86_ssse3_pmadd_ub_sw_128, {right, left});
+	}
+
+	llvm::Value* product = irBuilder.CreateMul(
+		irBuilder.CreateSExt(left, context.llvmContext.i16x16Type),
+		irBuilder.CreateSExt(right, context.llvmContext.i16x16Type));
+
+	constexpr LLVM_LANE_INDEX_TYPE numOutputElements = 8;
+	LLVM_LANE_INDEX_TYPE evenMask[numOutputElements];
+	LLVM_LANE_INDEX_TYPE oddMask[numOutputElements];
+	for(LLVM_LANE_INDEX_TYPE elementIndex = 0; elementIndex < numOutputElements; ++elementIndex)
+	{
+		evenMask[elementIndex] = elementIndex * 2 + 0;
+		oddMask[elementIndex] = elementIndex * 2 + 1;
+	}
+	llvm::Constant* undefVector = llvm::UndefValue::get(context.llvmContext.i16x16Type);
+	llvm::Value* evenVector = irBuilder.CreateShuffleVector(
+		product, undefVector, llvm::ArrayRef<LLVM_LANE_INDEX_TYPE>(evenMask, numOutputElements));
+	llvm::Value* oddVector = irBuilder.CreateShuffleVector(
+		product, undefVector, llvm::ArrayRef<LLVM_LANE_INDEX_TYPE>(oddMask, numOutputElements));
+	return irBuilder.CreateAdd(evenVector, oddVector);
+}
+
+void EmitFunctionContext::i16x8_relaxed_dot_i8x16_i7x16_s(NoImm)
+{
+	auto right = irBuilder.CreateBitCast(pop(), llvmContext.i8x16Type);
+	auto left = irBuilder.CreateBitCast(pop(), llvmContext.i8x16Type);
+	push(emitRelaxedDotI8x16I7x16(*this, left, right));
+}
+
+void EmitFunctionContext::i32x4_relaxed_dot_i8x16_i7x16_add_s(NoImm)
+{
+	auto addend = irBuilder.CreateBitCast(pop(), llvmContext.i32x4Type);
+	auto right = irBuilder.CreateBitCast(pop(), llvmContext.i8x16Type);
+	auto left = irBuilder.CreateBitCast(pop(), llvmContext.i8x16Type);
+
+	if(moduleContext.hasX86VNNI)
+	{
+		// vpdpbusd adds the sums of groups of 4 products of the unsigned lanes of its second
+		// operand and the signed lanes of its third operand to its first operand. The LLVM
+		// intrinsic's parameter types vary between LLVM versions, so cast the operands to them.
+		llvm::Function* vpdpbusd
+			= moduleContext.getLLVMIntrinsic({}, llvm::Intrinsic::x86_avx512_vpdpbusd_128);
+		llvm::FunctionType* vpdpbusdType = vpdpbusd->getFunctionType();
+		push(irBuilder.CreateCall(
+			vpdpbusd,
+			{irBuilder.CreateBitCast(addend, vpdpbusdType->getParamType(0)),
+			 irBuilder.CreateBitCast(right, vpdpbusdType->getParamType(1)),
+			 irBuilder.CreateBitCast(left, vpdpbusdType->getParamType(2))}));
+		return;
+	}
+
+	// Sum the adjacent pairs of 16-bit sums, and add them to the addend.
+	llvm::Value* pairSums = emitRelaxedDotI8x16I7x16(*this, left, right);
+	llvm::Value* quadSums;
+	if(moduleContext.targetArch == llvm::Triple::x86_64
+	   || moduleContext.targetArch == llvm::Triple::x86)
+	{
+		quadSums = callLLVMIntrinsic(
+			{},
+			llvm::Intrinsic::x86_sse2_pmadd_wd,
+			{pairSums,
+			 irBuilder.CreateVectorSplat(8, llvm::ConstantInt::get(llvmContext.i16Type, 1))});
+	}
+	else
+	{
+		constexpr LLVM_LANE_INDEX_TYPE numOutputElements = 4;
+		LLVM_LANE_INDEX_TYPE evenMask[numOutputElements];
+		LLVM_LANE_INDEX_TYPE oddMask[numOutputElements];
+		for(LLVM_LANE_INDEX_TYPE elementIndex = 0; elementIndex < numOutputElements;
+			++elementIndex)
+		{
+			evenMask[elementIndex] = elementIndex * 2 + 0;
+			oddMask[elementIndex] = elementIndex * 2 + 1;
+		}
+		llvm::Value* extendedPairSums = irBuilder.CreateSExt(pairSums, llvmContext.i32x8Type);
+		llvm::Constant* undefVector = llvm::UndefValue::get(llvmContext.i32x8Type);
+		quadSums = irBuilder.CreateAdd(
+			irBuilder.CreateShuffleVector(
+				extendedPairSums,
+				undefVector,
+				llvm::ArrayRef<LLVM_LANE_INDEX_TYPE>(evenMask, numOutputElements)),
+			irBuilder.CreateShuffleVector(
+				extendedPairSums,
+				undefVector,
+				llvm::ArrayRef<LLVM_LANE_INDEX_TYPE>(oddMask, numOutputElements)));
+	}
+	push(irBuilder.CreateAdd(quadSums, addend));
+}
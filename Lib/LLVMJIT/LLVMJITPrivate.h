@@ -1,9 +1,11 @@
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
 #include <vector>
+#include "WAVM/DWARF/DWARF.h"
 #include "WAVM/DWARF/Sections.h"
 #include "WAVM/IR/Module.h"
 #include "WAVM/IR/Operators.h"
@@ -14,6 +16,7 @@
 #include "WAVM/Inline/HashMap.h"
 #include "WAVM/LLVMJIT/LLVMJIT.h"
 #include "WAVM/Platform/Alloca.h"
+#include "WAVM/Platform/Mutex.h"
 #include "WAVM/Platform/Unwind.h"
 #include "WAVM/RuntimeABI/RuntimeABI.h"
 
@@ -169,16 +172,45 @@ namespace WAVM { namespace LLVMJIT {
 
 	inline bool areResultsReturnedDirectly(IR::TypeTuple results)
 	{
-		// On X64, the calling conventions can return up to 3 i64s and 4 float/vectors.
-		// For simplicity, just allow up to 3 values to be returned, including the implicitly
-		// returned context pointer.
-		static constexpr Uptr maxDirectlyReturnedValues = 3;
-		return results.size() + 1 <= maxDirectlyReturnedValues;
+		// On X64, the calling conventions can return up to 3 integers (including the implicitly
+		// returned context pointer) and 4 floats/vectors in registers. AArch64 can return more, but
+		// use the X64 limits on all targets. If LLVM can't return a struct in registers, it returns
+		// it through a stack slot allocated by the caller, which is still correct.
+		static constexpr Uptr maxDirectlyReturnedIntegers = 3;
+		static constexpr Uptr maxDirectlyReturnedFloatsAndVectors = 4;
+
+		Uptr numIntegers = 1;
+		Uptr numFloatsAndVectors = 0;
+		for(IR::ValueType result : results)
+		{
+			switch(result)
+			{
+			case IR::ValueType::i32:
+			case IR::ValueType::i64:
+			case IR::ValueType::externref:
+			case IR::ValueType::funcref: ++numIntegers; break;
+
+			case IR::ValueType::f32:
+			case IR::ValueType::f64:
+			case IR::ValueType::v128: ++numFloatsAndVectors; break;
+
+			case IR::ValueType::none:
+			case IR::ValueType::any:
+			default: WAVM_UNREACHABLE();
+			};
+		}
+
+		return numIntegers <= maxDirectlyReturnedIntegers
+			   && numFloatsAndVectors <= maxDirectlyReturnedFloatsAndVectors;
 	}
 
 	inline llvm::StructType* getLLVMReturnStructType(LLVMContext& llvmContext,
 													 IR::TypeTuple results)
 	{
+		// The context pointer is returned by every wasm function, even one that never changes it,
+		// so table calls and thunks can call any function with the same signature. Callers of a
+		// function that preserves the context already ignore the returned pointer, so all that
+		// returning it costs is one register move in the callee.
 		if(areResultsReturnedDirectly(results))
 		{
 			// A limited number of results can be packed into a struct and returned directly.
@@ -359,19 +391,34 @@ namespace WAVM { namespace LLVMJIT {
 	struct ModuleMemoryManager;
 	struct GlobalModuleState;
 
+	// The end address of a function's code.
+	struct FunctionAddressRange
+	{
+		Uptr endAddress;
+		Runtime::Function* function;
+	};
+
 	// Encapsulates a loaded module.
 	struct Module
 	{
 		HashMap<std::string, Runtime::Function*> nameToFunctionMap;
-		std::map<Uptr, Runtime::Function*> addressToFunctionMap;
+
+		// The module's functions, sorted by end address so the function containing an address can
+		// be found by binary search. It isn't modified after the module is loaded.
+		std::vector<FunctionAddressRange> functionAddressRanges;
 		std::string debugName;
 
 		// Object bytes (patched with section addresses on ELF), used for GDB.
 		std::vector<U8> objectBytes;
 
-		// DWARF sections (pointers into the loaded image), used for signal-safe source lookup.
+		// DWARF sections (pointers into the loaded image), used for source lookup.
 		DWARF::Sections dwarfSections = {};
 
+		// Returns an index of the DWARF sections' address ranges, which is built by the first
+		// lookup of the module, since most modules never have an address looked up. Once built,
+		// lookups in the index don't parse the sections or allocate, so they are signal-safe.
+		const DWARF::AddressIndex& getDWARFAddressIndex();
+
 		Module(std::vector<U8> inObjectBytes,
 			   const HashMap<std::string, Uptr>& importedSymbolMap,
 			   bool shouldLogMetrics,
@@ -381,6 +428,10 @@ namespace WAVM { namespace LLVMJIT {
 	private:
 		ModuleMemoryManager* memoryManager;
 
+		Platform::Mutex dwarfAddressIndexMutex;
+		std::atomic<bool> isDWARFAddressIndexBuilt{false};
+		DWARF::AddressIndex dwarfAddressIndex;
+
 		// Module holds a shared pointer to GlobalModuleState to ensure that on exit it is not
 		// destructed until after all Modules have been destructed.
 		std::shared_ptr<GlobalModuleState> globalModuleState;
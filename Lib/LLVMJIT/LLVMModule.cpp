@@ -1,6 +1,7 @@
 #include <stddef.h>
 #include <stdint.h>
-#include <map>
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -18,7 +19,8 @@
 #include "WAVM/ObjectLinker/ObjectLinker.h"
 #include "WAVM/Platform/Diagnostics.h"
 #include "WAVM/Platform/Memory.h"
-#include "WAVM/Platform/RWMutex.h"
+#include "WAVM/Platform/Mutex.h"
+#include "WAVM/Platform/Thread.h"
 #include "WAVM/Platform/Unwind.h"
 #include "WAVM/RuntimeABI/RuntimeABI.h"
 
@@ -37,11 +39,77 @@ namespace WAVM { namespace Runtime {
 	struct ExceptionType;
 }}
 
+// The end address of a loaded module's image.
+struct ModuleAddressRange
+{
+	Uptr endAddress;
+	LLVMJIT::Module* module;
+};
+
+typedef std::vector<ModuleAddressRange> ModuleAddressRanges;
+
 struct LLVMJIT::GlobalModuleState
 {
-	// A map from address to loaded JIT symbols.
-	Platform::RWMutex addressToModuleMapMutex;
-	std::map<Uptr, LLVMJIT::Module*> addressToModuleMap;
+	// The loaded modules, sorted by end address. The array is read without locking, so lookups
+	// from signal handlers are never blocked by modules being loaded or unloaded: updates publish
+	// a new copy of the array, then wait for any lookups that could be reading the old copy to
+	// finish before freeing it.
+	std::atomic<const ModuleAddressRanges*> moduleAddressRanges{nullptr};
+
+	// Lookups register themselves in numReaders[readGeneration & 1] while reading the array.
+	// Updates increment readGeneration after publishing a new array, so new lookups register in
+	// the other counter, and then wait for the counter of the previous generation to drain.
+	std::atomic<Uptr> readGeneration{0};
+	std::atomic<Uptr> numReaders[2]{{0}, {0}};
+
+	// Serializes updates of moduleAddressRanges.
+	Platform::Mutex updateMutex;
+
+	// Marks a lookup of the module address ranges. Doesn't block or allocate, so it may be used in
+	// a signal handler.
+	struct ReadScope
+	{
+		ReadScope(GlobalModuleState& inState) : state(inState)
+		{
+			while(true)
+			{
+				generation = state.readGeneration.load(std::memory_order_seq_cst);
+				state.numReaders[generation & 1].fetch_add(1, std::memory_order_seq_cst);
+				if(state.readGeneration.load(std::memory_order_seq_cst) == generation) { break; }
+				state.numReaders[generation & 1].fetch_sub(1, std::memory_order_seq_cst);
+			}
+		}
+		~ReadScope() { state.numReaders[generation & 1].fetch_sub(1, std::memory_order_release); }
+
+		const ModuleAddressRanges* get() const
+		{
+			return state.moduleAddressRanges.load(std::memory_order_seq_cst);
+		}
+
+	private:
+		GlobalModuleState& state;
+		Uptr generation;
+	};
+
+	// Replaces the module address ranges with a copy modified by the update function.
+	template<typename Update> void updateModuleAddressRanges(Update&& update)
+	{
+		Platform::Mutex::Lock updateLock(updateMutex);
+
+		const ModuleAddressRanges* oldRanges = moduleAddressRanges.load(std::memory_order_seq_cst);
+		ModuleAddressRanges* newRanges
+			= oldRanges ? new ModuleAddressRanges(*oldRanges) : new ModuleAddressRanges;
+		update(*newRanges);
+		moduleAddressRanges.store(newRanges, std::memory_order_seq_cst);
+
+		// Wait for the lookups that may have read the old array before freeing it.
+		const Uptr oldGeneration = readGeneration.fetch_add(1, std::memory_order_seq_cst);
+		while(numReaders[oldGeneration & 1].load(std::memory_order_seq_cst))
+		{
+			Platform::yieldToAnotherThread();
+		}
+		delete oldRanges;
+	}
 
 	static const std::shared_ptr<GlobalModuleState>& get()
 	{
@@ -50,7 +118,7 @@ struct LLVMJIT::GlobalModuleState
 	}
 
 	GlobalModuleState() {}
-	~GlobalModuleState() {}
+	~GlobalModuleState() { delete moduleAddressRanges.load(std::memory_order_seq_cst); }
 };
 
 // Tracks the linked image memory for cleanup.
@@ -114,7 +182,7 @@ Module::Module(std::vector<U8> objectBytes,
 		Runtime::Function* function
 			= (Runtime::Function*)(loadedAddress - offsetof(Runtime::Function, code));
 		nameToFunctionMap.addOrFail(std::string(name), function);
-		addressToFunctionMap.emplace(loadedAddress + symbolSize, function);
+		functionAddressRanges.push_back({loadedAddress + symbolSize, function});
 
 		// Initialize the function mutable data.
 		WAVM_ASSERT(function->mutableData);
@@ -123,18 +191,33 @@ Module::Module(std::vector<U8> objectBytes,
 		function->mutableData->numCodeBytes = symbolSize;
 	}
 
-	// Only insert into the address map if we have valid memory allocated.
+	std::sort(functionAddressRanges.begin(),
+			  functionAddressRanges.end(),
+			  [](const FunctionAddressRange& a, const FunctionAddressRange& b) {
+				  return a.endAddress < b.endAddress;
+			  });
+
+	// Store DWARF section pointers for source location lookup. This must be done before the module
+	// is added to the module address ranges, since other threads may look up addresses in it after
+	// that.
+	dwarfSections = linkResult.dwarf;
+
+	// Only insert into the module address ranges if we have valid memory allocated.
 	if(linkResult.imageBase)
 	{
 		const Uptr moduleEndAddress = imageEnd;
-		Platform::RWMutex::ExclusiveLock addressToModuleMapLock(
-			globalModuleState->addressToModuleMapMutex);
-		globalModuleState->addressToModuleMap.emplace(moduleEndAddress, this);
+		globalModuleState->updateModuleAddressRanges([&](ModuleAddressRanges& ranges) {
+			auto insertIt = std::lower_bound(
+				ranges.begin(),
+				ranges.end(),
+				moduleEndAddress,
+				[](const ModuleAddressRange& range, Uptr address) {
+					return range.endAddress < address;
+				});
+			ranges.insert(insertIt, {moduleEndAddress, this});
+		});
 	}
 
-	// Store DWARF section pointers for signal-safe source location lookup.
-	dwarfSections = linkResult.dwarf;
-
 	// Keep the object bytes for GDB. On ELF, section addresses are patched in the bytes
 	// so GDB sees runtime addresses directly.
 	this->objectBytes = std::move(objectBytes);
@@ -173,26 +256,35 @@ Module::~Module()
 	// Unregister from GDB.
 	unregisterObjectWithGDB(gdbRegistrationHandle);
 
-	// Remove the module from the global address to module map (only if we inserted it).
+	// Remove the module from the global module address ranges (only if we inserted it). This
+	// waits for any lookups that might be using the module to finish.
 	if(memoryManager->imageBase)
 	{
-		Platform::RWMutex::ExclusiveLock addressToModuleMapLock(
-			globalModuleState->addressToModuleMapMutex);
-		globalModuleState->addressToModuleMap.erase(
-			globalModuleState->addressToModuleMap.find(reinterpret_cast<Uptr>(
-				memoryManager->imageBase
-				+ (memoryManager->numPages << Platform::getBytesPerPageLog2()))));
+		globalModuleState->updateModuleAddressRanges([this](ModuleAddressRanges& ranges) {
+			for(auto rangeIt = ranges.begin(); rangeIt != ranges.end(); ++rangeIt)
+			{
+				if(rangeIt->module == this)
+				{
+					ranges.erase(rangeIt);
+					break;
+				}
+			}
+		});
 	}
 
 	// Free the FunctionMutableData objects.
-	for(const auto& pair : addressToFunctionMap) { delete pair.second->mutableData; }
+	for(const FunctionAddressRange& range : functionAddressRanges)
+	{
+		delete range.function->mutableData;
+	}
 
 	// Delete the memory manager.
 	delete memoryManager;
 }
 
 std::shared_ptr<LLVMJIT::Module> LLVMJIT::loadModule(
-	const std::vector<U8>& objectFileBytes,
+	const U8* objectFileBytes,
+	Uptr numObjectFileBytes,
 	HashMap<std::string, FunctionBinding>&& wavmIntrinsicsExportMap,
 	std::vector<IR::FunctionType>&& types,
 	std::vector<FunctionBinding>&& functionImports,
@@ -208,8 +300,9 @@ std::shared_ptr<LLVMJIT::Module> LLVMJIT::loadModule(
 	// Bind undefined symbols in the compiled object to values.
 	HashMap<std::string, Uptr> importedSymbolMap;
 
-	// Bind the wavmIntrinsic function symbols; the compiled module assumes they have the intrinsic
-	// calling convention, so no thunking is necessary.
+	// Bind the wavmIntrinsic function symbols; the compiled module calls them with the intrinsic
+	// calling convention, or the C calling convention for leaf intrinsics, so no thunking is
+	// necessary.
 	for(auto exportMapPair : wavmIntrinsicsExportMap)
 	{
 		importedSymbolMap.addOrFail(exportMapPair.key,
@@ -313,7 +406,26 @@ std::shared_ptr<LLVMJIT::Module> LLVMJIT::loadModule(
 	addLLVMRuntimeSymbols(importedSymbolMap);
 
 	// Load the module.
-	return std::make_shared<Module>(objectFileBytes, importedSymbolMap, true, std::move(debugName));
+	// The linker patches the object bytes, so link a copy of them.
+	return std::make_shared<Module>(
+		std::vector<U8>(objectFileBytes, objectFileBytes + numObjectFileBytes),
+		importedSymbolMap,
+		true,
+		std::move(debugName));
+}
+
+const DWARF::AddressIndex& Module::getDWARFAddressIndex()
+{
+	if(!isDWARFAddressIndexBuilt.load(std::memory_order_acquire))
+	{
+		Platform::Mutex::Lock dwarfAddressIndexLock(dwarfAddressIndexMutex);
+		if(!isDWARFAddressIndexBuilt.load(std::memory_order_relaxed))
+		{
+			DWARF::buildAddressIndex(dwarfSections, dwarfAddressIndex);
+			isDWARFAddressIndexBuilt.store(true, std::memory_order_release);
+		}
+	}
+	return dwarfAddressIndex;
 }
 
 Uptr LLVMJIT::getInstructionSourceByAddress(Uptr address,
@@ -322,39 +434,46 @@ Uptr LLVMJIT::getInstructionSourceByAddress(Uptr address,
 {
 	if(maxSources == 0) { return 0; }
 
-	auto globalModuleState = GlobalModuleState::get();
-
-	Module* jitModule;
-	{
-		Platform::RWMutex::ShareableLock addressToModuleMapLock(
-			globalModuleState->addressToModuleMapMutex);
-
-		auto moduleIt = globalModuleState->addressToModuleMap.upper_bound(address);
-		if(moduleIt == globalModuleState->addressToModuleMap.end()) { return 0; }
-		jitModule = moduleIt->second;
-	}
-
-	auto functionIt = jitModule->addressToFunctionMap.upper_bound(address);
-	if(functionIt == jitModule->addressToFunctionMap.end()) { return 0; }
-	Runtime::Function* function = functionIt->second;
+	// Find the module containing the address. The module can't be unloaded while the lookup is
+	// in progress, since unloading waits for lookups of the module address ranges to finish.
+	GlobalModuleState& globalModuleState = *GlobalModuleState::get();
+	GlobalModuleState::ReadScope readScope(globalModuleState);
+	const ModuleAddressRanges* moduleAddressRanges = readScope.get();
+	if(!moduleAddressRanges) { return 0; }
+
+	auto moduleIt = std::upper_bound(
+		moduleAddressRanges->begin(),
+		moduleAddressRanges->end(),
+		address,
+		[](Uptr address, const ModuleAddressRange& range) { return address < range.endAddress; });
+	if(moduleIt == moduleAddressRanges->end()) { return 0; }
+	Module* jitModule = moduleIt->module;
+
+	auto functionIt = std::upper_bound(
+		jitModule->functionAddressRanges.begin(),
+		jitModule->functionAddressRanges.end(),
+		address,
+		[](Uptr address, const FunctionAddressRange& range) { return address < range.endAddress; });
+	if(functionIt == jitModule->functionAddressRanges.end()) { return 0; }
+	Runtime::Function* function = functionIt->function;
 	const Uptr codeAddress = reinterpret_cast<Uptr>(function->code);
 	if(address < codeAddress || address >= codeAddress + function->mutableData->numCodeBytes)
 	{
 		return 0;
 	}
 
-	// Query DWARF info using the signal-safe, zero-allocation DWARF parser.
+	// Query DWARF info using the index of the module's DWARF sections.
 	if(jitModule->dwarfSections.debugInfo)
 	{
 		DWARF::SourceLocation locations[16];
-		Uptr numLocations
-			= DWARF::getSourceLocations(jitModule->dwarfSections, address, locations, 16);
+		Uptr numLocations = DWARF::getSourceLocations(
+			jitModule->getDWARFAddressIndex(), address, locations, 16);
 
 		Log::printf(Log::traceDwarf,
 					"DWARF lookup: address=0x%" WAVM_PRIxPTR
 					" function=%s numLocations=%" WAVM_PRIuPTR "\n",
 					address,
-					function->mutableData->debugName.c_str(),
+					function->mutableData->getDebugName().c_str(),
 					numLocations);
 		for(Uptr i = 0; i < numLocations; ++i)
 		{
@@ -401,13 +520,13 @@ Uptr LLVMJIT::getInstructionSourceByAddress(Uptr address,
 		Log::printf(Log::traceDwarf,
 					"No DWARF sections for address 0x%" WAVM_PRIxPTR " function=%s\n",
 					address,
-					function->mutableData->debugName.c_str());
+					function->mutableData->getDebugName().c_str());
 	}
 
 	// Fallback: no DWARF frames available.
 	Log::printf(Log::traceDwarf,
 				"Falling back to {function=%s, 0}\n",
-				function->mutableData->debugName.c_str());
+				function->mutableData->getDebugName().c_str());
 	outSources[0] = {function, 0};
 	return 1;
 }
@@ -167,7 +167,7 @@ InvokeThunkPointer LLVMJIT::getInvokeThunk(FunctionType functionType)
 	auto jitModule = new LLVMJIT::Module(std::move(objectBytes),
 										 importedSymbolMap,
 										 false,
-										 std::string(functionMutableData->debugName));
+										 std::string(functionMutableData->getDebugName()));
 	invokeThunkCache.modules.push_back(std::unique_ptr<LLVMJIT::Module>(jitModule));
 
 	invokeThunkFunction = jitModule->nameToFunctionMap["thunk"];
@@ -392,15 +392,19 @@ NFA::Machine::Machine(Builder* builder)
 	}
 
 	// Build a [charClass][state] transition map.
-	stateAndOffsetToNextStateMap = new InternalStateIndex[numClasses * numStates];
+	InternalStateIndex* newStateAndOffsetToNextStateMap
+		= new InternalStateIndex[numClasses * numStates];
 	for(Uptr classIndex = 0; classIndex < numClasses; ++classIndex)
 	{
 		for(Uptr stateIndex = 0; stateIndex < numStates; ++stateIndex)
 		{
-			stateAndOffsetToNextStateMap[stateIndex + classIndex * numStates] = InternalStateIndex(
-				dfaStates[stateIndex].nextStateByChar[representativeCharsByClass[classIndex]]);
+			newStateAndOffsetToNextStateMap[stateIndex + classIndex * numStates]
+				= InternalStateIndex(
+					dfaStates[stateIndex].nextStateByChar[representativeCharsByClass[classIndex]]);
 		}
 	}
+	stateAndOffsetToNextStateMap = newStateAndOffsetToNextStateMap;
+	ownsStateAndOffsetToNextStateMap = true;
 
 	// Build a map from character index to offset into [charClass][initialState] transition map.
 	WAVM_ASSERT((numClasses - 1) * (numStates - 1) <= UINT32_MAX);
@@ -413,20 +417,36 @@ NFA::Machine::Machine(Builder* builder)
 	Log::printf(Log::metrics, "  reduced DFA character classes to %" WAVM_PRIuPTR "\n", numClasses);
 }
 
+NFA::Machine::Machine(const MachineTables& tables)
+: stateAndOffsetToNextStateMap(tables.stateAndOffsetToNextStateMap)
+, ownsStateAndOffsetToNextStateMap(false)
+, numClasses(tables.numClasses)
+, numStates(tables.numStates)
+{
+	memcpy(charToOffsetMap, tables.charToOffsetMap, sizeof(charToOffsetMap));
+}
+
 NFA::Machine::~Machine()
 {
-	if(stateAndOffsetToNextStateMap)
+	if(stateAndOffsetToNextStateMap && ownsStateAndOffsetToNextStateMap)
 	{
 		delete[] stateAndOffsetToNextStateMap;
-		stateAndOffsetToNextStateMap = nullptr;
 	}
+	stateAndOffsetToNextStateMap = nullptr;
+}
+
+NFA::MachineTables NFA::Machine::getTables() const
+{
+	return MachineTables{charToOffsetMap, stateAndOffsetToNextStateMap, numClasses, numStates};
 }
 
 void NFA::Machine::moveFrom(Machine&& inMachine) noexcept
 {
 	memcpy(charToOffsetMap, inMachine.charToOffsetMap, sizeof(charToOffsetMap));
 	stateAndOffsetToNextStateMap = inMachine.stateAndOffsetToNextStateMap;
+	ownsStateAndOffsetToNextStateMap = inMachine.ownsStateAndOffsetToNextStateMap;
 	inMachine.stateAndOffsetToNextStateMap = nullptr;
+	inMachine.ownsStateAndOffsetToNextStateMap = false;
 	numClasses = inMachine.numClasses;
 	numStates = inMachine.numStates;
 }
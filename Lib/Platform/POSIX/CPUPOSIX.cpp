@@ -36,6 +36,8 @@ WAVM::Platform::HostCPUFeatures WAVM::Platform::getHostCPUFeatures()
 	result.avx512bw = __builtin_cpu_supports("avx512bw");
 	result.avx512dq = __builtin_cpu_supports("avx512dq");
 	result.avx512vl = __builtin_cpu_supports("avx512vl");
+	result.avx512vnni = __builtin_cpu_supports("avx512vnni");
+	result.avxvnni = __builtin_cpu_supports("avxvnni");
 #elif WAVM_CPU_ARCH_ARM
 #if defined(__APPLE__)
 	I32 val = 0;
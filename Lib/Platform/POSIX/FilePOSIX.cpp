@@ -4,15 +4,20 @@
 #define _FILE_OFFSET_BITS 64
 #endif
 
+#include <arpa/inet.h>
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <netinet/in.h>
+#include <poll.h>
 #include <string.h>
 #include <sys/errno.h>
 #include <sys/fcntl.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/uio.h>
+#include <sys/un.h>
 #include <sys/unistd.h>
 #include <unistd.h>
 #include <algorithm>
@@ -21,12 +26,17 @@
 #include <cstdio>
 #include <cstdlib>
 #include <ctime>
+#include <memory>
+#include <vector>
 #include "WAVM/Inline/Assert.h"
 #include "WAVM/Inline/BasicTypes.h"
 #include "WAVM/Inline/Errors.h"
+#include "WAVM/Inline/HashMap.h"
+#include "WAVM/Inline/HashSet.h"
 #include "WAVM/Inline/I128.h"
 #include "WAVM/Inline/Time.h"
 #include "WAVM/Platform/Alloca.h"
+#include "WAVM/Platform/Clock.h"
 #include "WAVM/Platform/File.h"
 #include "WAVM/Platform/Mutex.h"
 #include "WAVM/VFS/VFS.h"
@@ -36,6 +46,7 @@
 #endif
 
 #ifdef __linux__
+#include <sys/epoll.h>
 #include <sys/types.h>
 #endif
 
@@ -90,8 +101,17 @@ static Result asVFSResult(int error)
 	case ETXTBSY: return Result::notAccessible;
 	case EBUSY: return Result::busy;
 	case ENOTEMPTY: return Result::isNotEmpty;
+	case EXDEV: return Result::crossesDevices;
 	case EMLINK: return Result::outOfLinksToParentDir;
 	case ENOTSUP: return Result::notSupported;
+	case EPIPE: return Result::brokenPipe;
+	case ENOTSOCK: return Result::notSocket;
+	case ENOTCONN: return Result::notConnected;
+	case ECONNREFUSED: return Result::connectionRefused;
+	case ECONNRESET: return Result::connectionReset;
+	case ECONNABORTED: return Result::connectionReset;
+	case EADDRINUSE: return Result::addressInUse;
+	case EADDRNOTAVAIL: return Result::invalidAddress;
 
 	case EINVAL:
 		// This probably needs to be handled differently for each API entry point.
@@ -518,6 +538,54 @@ struct POSIXFD : VFD
 		int result = ftruncate(fd, off_t(numBytes));
 		return result == 0 ? Result::success : asVFSResult(errno);
 	}
+	virtual Result allocate(U64 offset, U64 numBytes) override
+	{
+		const U64 maxFileSize = FILE_OFFSET_IS_64BIT ? U64(INT64_MAX) : U64(INT32_MAX);
+		if(offset > maxFileSize || numBytes > maxFileSize - offset)
+		{
+			return Result::exceededFileSizeLimit;
+		}
+		if(!numBytes) { return Result::success; }
+
+#ifdef __APPLE__
+		// MacOS doesn't have posix_fallocate, but F_PREALLOCATE can allocate space past the end of
+		// the file, which is then made part of the file by extending it with ftruncate.
+		struct stat fileStatus;
+		if(fstat(fd, &fileStatus)) { return asVFSResult(errno); }
+
+		const U64 endOffset = offset + numBytes;
+		if(endOffset <= U64(fileStatus.st_size)) { return Result::success; }
+
+		fstore_t fileStore;
+		fileStore.fst_flags = F_ALLOCATECONTIG;
+		fileStore.fst_posmode = F_PEOFPOSMODE;
+		fileStore.fst_offset = 0;
+		fileStore.fst_length = off_t(endOffset - U64(fileStatus.st_size));
+		fileStore.fst_bytesalloc = 0;
+		if(fcntl(fd, F_PREALLOCATE, &fileStore) == -1)
+		{
+			// If there isn't enough contiguous free space, allow the allocation to be fragmented.
+			fileStore.fst_flags = F_ALLOCATEALL;
+			if(fcntl(fd, F_PREALLOCATE, &fileStore) == -1) { return asVFSResult(errno); }
+		}
+
+		return ftruncate(fd, off_t(endOffset)) == 0 ? Result::success : asVFSResult(errno);
+#else
+		// posix_fallocate returns the error code instead of setting errno.
+		const int error = posix_fallocate(fd, off_t(offset), off_t(numBytes));
+		switch(error)
+		{
+		case 0: return Result::success;
+
+		// The arguments were validated above, so EINVAL means the file system doesn't support
+		// allocation, and ENODEV means the FD isn't a regular file.
+		case EINVAL:
+		case ENODEV: return Result::notSupported;
+
+		default: return asVFSResult(error);
+		};
+#endif
+	}
 	virtual Result setFileTimes(bool setLastAccessTime,
 								Time lastAccessTime,
 								bool setLastWriteTime,
@@ -596,6 +664,186 @@ struct POSIXFD : VFD
 		outStream = new POSIXDirEntStream(dir);
 		return Result::success;
 	}
+
+	virtual Result recv(const IOReadBuffer* buffers,
+						Uptr numBuffers,
+						SocketRecvFlags flags,
+						Uptr* outNumBytesRead = nullptr,
+						bool* outDataTruncated = nullptr) override
+	{
+		return Result::notSocket;
+	}
+	virtual Result send(const IOWriteBuffer* buffers,
+						Uptr numBuffers,
+						Uptr* outNumBytesWritten = nullptr) override
+	{
+		return Result::notSocket;
+	}
+	virtual Result shutdown(SocketShutdownMode mode) override { return Result::notSocket; }
+	virtual Result accept(VFD*& outVFD, const VFDFlags& flags) override
+	{
+		return Result::notSocket;
+	}
+
+	virtual Result getHostDescriptor(Uptr& outDescriptor) override
+	{
+		outDescriptor = Uptr(fd);
+		return Result::success;
+	}
+};
+
+#ifdef MSG_NOSIGNAL
+#define SOCKET_SEND_FLAGS MSG_NOSIGNAL
+#else
+// Platforms without MSG_NOSIGNAL set SO_NOSIGPIPE on the socket when it is created.
+#define SOCKET_SEND_FLAGS 0
+#endif
+
+static Result initSocket(I32 socketFD, const VFDFlags& flags)
+{
+	if(fcntl(socketFD, F_SETFD, FD_CLOEXEC)) { return asVFSResult(errno); }
+	if(fcntl(socketFD, F_SETFL, translateVFDFlags(flags))) { return asVFSResult(errno); }
+
+#ifdef SO_NOSIGPIPE
+	// Don't raise SIGPIPE when writing to a socket whose peer has closed the connection.
+	const int one = 1;
+	if(setsockopt(socketFD, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one)))
+	{
+		return asVFSResult(errno);
+	}
+#endif
+
+	return Result::success;
+}
+
+struct POSIXSocketFD : POSIXFD
+{
+	POSIXSocketFD(I32 inFD) : POSIXFD(inFD) {}
+
+	virtual Result writev(const IOWriteBuffer* buffers,
+						  Uptr numBuffers,
+						  Uptr* outNumBytesWritten = nullptr,
+						  const U64* offset = nullptr) override
+	{
+		// Use send for writes without an offset, so a closed connection returns an error instead
+		// of raising SIGPIPE.
+		if(offset) { return Result::notSeekable; }
+		return send(buffers, numBuffers, outNumBytesWritten);
+	}
+
+	virtual Result getVFDInfo(VFDInfo& outInfo) override
+	{
+		const Result result = POSIXFD::getVFDInfo(outInfo);
+		if(result == Result::success) { outInfo.type = getSocketFileType(); }
+		return result;
+	}
+
+	virtual Result getFileInfo(FileInfo& outInfo) override
+	{
+		const Result result = POSIXFD::getFileInfo(outInfo);
+		if(result == Result::success) { outInfo.type = getSocketFileType(); }
+		return result;
+	}
+
+	virtual Result recv(const IOReadBuffer* buffers,
+						Uptr numBuffers,
+						SocketRecvFlags flags,
+						Uptr* outNumBytesRead = nullptr,
+						bool* outDataTruncated = nullptr) override
+	{
+		if(outNumBytesRead) { *outNumBytesRead = 0; }
+		if(outDataTruncated) { *outDataTruncated = false; }
+
+		if(numBuffers > IOV_MAX) { return Result::tooManyBuffers; }
+
+		struct msghdr message;
+		memset(&message, 0, sizeof(message));
+		message.msg_iov = (struct iovec*)buffers;
+		message.msg_iovlen = numBuffers;
+
+		I32 recvFlags = 0;
+		if(flags.peek) { recvFlags |= MSG_PEEK; }
+		if(flags.waitAll) { recvFlags |= MSG_WAITALL; }
+
+		const ssize_t result = recvmsg(fd, &message, recvFlags);
+		if(result == -1) { return asVFSResult(errno); }
+
+		if(outNumBytesRead) { *outNumBytesRead = Uptr(result); }
+		if(outDataTruncated) { *outDataTruncated = message.msg_flags & MSG_TRUNC; }
+		return Result::success;
+	}
+
+	virtual Result send(const IOWriteBuffer* buffers,
+						Uptr numBuffers,
+						Uptr* outNumBytesWritten = nullptr) override
+	{
+		if(outNumBytesWritten) { *outNumBytesWritten = 0; }
+
+		if(numBuffers == 0) { return Result::success; }
+		else if(numBuffers > IOV_MAX) { return Result::tooManyBuffers; }
+
+		struct msghdr message;
+		memset(&message, 0, sizeof(message));
+		message.msg_iov = (struct iovec*)buffers;
+		message.msg_iovlen = numBuffers;
+
+		const ssize_t result = sendmsg(fd, &message, SOCKET_SEND_FLAGS);
+		if(result == -1) { return asVFSResult(errno); }
+
+		if(outNumBytesWritten) { *outNumBytesWritten = Uptr(result); }
+		return Result::success;
+	}
+
+	virtual Result shutdown(SocketShutdownMode mode) override
+	{
+		I32 how = 0;
+		switch(mode)
+		{
+		case SocketShutdownMode::read: how = SHUT_RD; break;
+		case SocketShutdownMode::write: how = SHUT_WR; break;
+		case SocketShutdownMode::readWrite: how = SHUT_RDWR; break;
+		default: WAVM_UNREACHABLE();
+		};
+
+		return !::shutdown(fd, how) ? Result::success : asVFSResult(errno);
+	}
+
+	virtual Result accept(VFD*& outVFD, const VFDFlags& flags) override
+	{
+		const I32 connectionFD = ::accept(fd, nullptr, nullptr);
+		if(connectionFD < 0)
+		{
+			return errno == EINVAL ? Result::notPermitted : asVFSResult(errno);
+		}
+
+		const Result result = initSocket(connectionFD, flags);
+		if(result != Result::success)
+		{
+			::close(connectionFD);
+			return result;
+		}
+
+		outVFD = new POSIXSocketFD(connectionFD);
+		return Result::success;
+	}
+
+private:
+	FileType getSocketFileType()
+	{
+		I32 socketType = 0;
+		socklen_t numSocketTypeBytes = sizeof(socketType);
+		if(getsockopt(fd, SOL_SOCKET, SO_TYPE, &socketType, &numSocketTypeBytes))
+		{
+			return FileType::unknown;
+		}
+
+		switch(socketType)
+		{
+		case SOCK_STREAM: return FileType::streamSocket;
+		case SOCK_DGRAM: return FileType::datagramSocket;
+		default: return FileType::unknown;
+		};
+	}
 };
 
 struct POSIXStdFD : POSIXFD
@@ -647,6 +895,12 @@ struct POSIXFS : HostFS
 	virtual Result removeDir(const std::string& path) override;
 	virtual Result createDir(const std::string& path) override;
 
+	virtual Result createHardLink(const std::string& existingPath,
+								  const std::string& newPath) override;
+	virtual Result createSymbolicLink(const std::string& targetPath,
+									  const std::string& linkPath) override;
+	virtual Result readSymbolicLink(const std::string& path, std::string& outTargetPath) override;
+
 	static POSIXFS& get()
 	{
 		static POSIXFS posixFS;
@@ -784,6 +1038,452 @@ Result POSIXFS::createDir(const std::string& path)
 	return !mkdir(path.c_str(), 0666) ? Result::success : asVFSResult(errno);
 }
 
+Result POSIXFS::createHardLink(const std::string& existingPath, const std::string& newPath)
+{
+	return !linkat(AT_FDCWD, existingPath.c_str(), AT_FDCWD, newPath.c_str(), 0)
+			   ? Result::success
+			   : asVFSResult(errno);
+}
+
+Result POSIXFS::createSymbolicLink(const std::string& targetPath, const std::string& linkPath)
+{
+	return !symlink(targetPath.c_str(), linkPath.c_str()) ? Result::success : asVFSResult(errno);
+}
+
+Result POSIXFS::readSymbolicLink(const std::string& path, std::string& outTargetPath)
+{
+	// readlink doesn't say how long the target path is, so retry with a larger buffer until the
+	// target path doesn't fill the buffer.
+	outTargetPath.resize(256);
+	while(true)
+	{
+		const ssize_t numTargetPathBytes
+			= readlink(path.c_str(), &outTargetPath[0], outTargetPath.size());
+		if(numTargetPathBytes < 0)
+		{
+			outTargetPath.clear();
+			return errno == EINVAL ? Result::isNotSymbolicLink : asVFSResult(errno);
+		}
+		else if(Uptr(numTargetPathBytes) < outTargetPath.size())
+		{
+			outTargetPath.resize(Uptr(numTargetPathBytes));
+			return Result::success;
+		}
+
+		outTargetPath.resize(outTargetPath.size() * 2);
+	};
+}
+
+static bool parsePort(const std::string& string, in_port_t& outPort)
+{
+	if(string.empty() || string.size() > 5) { return false; }
+
+	U32 port = 0;
+	for(char c : string)
+	{
+		if(c < '0' || c > '9') { return false; }
+		port = port * 10 + U32(c - '0');
+	}
+	if(port > UINT16_MAX) { return false; }
+
+	outPort = htons(in_port_t(port));
+	return true;
+}
+
+static Result parseSocketAddress(const std::string& address,
+								 struct sockaddr_storage& outAddress,
+								 socklen_t& outNumAddressBytes)
+{
+	memset(&outAddress, 0, sizeof(outAddress));
+
+	if(!address.compare(0, 5, "unix:"))
+	{
+		const std::string path = address.substr(5);
+
+		struct sockaddr_un* unixAddress = (struct sockaddr_un*)&outAddress;
+		if(path.empty()) { return Result::invalidAddress; }
+		if(path.size() >= sizeof(unixAddress->sun_path)) { return Result::nameTooLong; }
+
+		unixAddress->sun_family = AF_UNIX;
+		memcpy(unixAddress->sun_path, path.c_str(), path.size() + 1);
+		outNumAddressBytes = socklen_t(offsetof(struct sockaddr_un, sun_path) + path.size() + 1);
+		return Result::success;
+	}
+	else if(!address.compare(0, 4, "tcp:"))
+	{
+		const Uptr portSeparator = address.find_last_of(':');
+		if(portSeparator <= 4) { return Result::invalidAddress; }
+
+		struct sockaddr_in* inetAddress = (struct sockaddr_in*)&outAddress;
+		inetAddress->sin_family = AF_INET;
+		const std::string host = address.substr(4, portSeparator - 4);
+		if(inet_pton(AF_INET, host.c_str(), &inetAddress->sin_addr) != 1
+		   || !parsePort(address.substr(portSeparator + 1), inetAddress->sin_port))
+		{
+			return Result::invalidAddress;
+		}
+
+		outNumAddressBytes = sizeof(struct sockaddr_in);
+		return Result::success;
+	}
+	else if(!address.compare(0, 6, "tcp6:["))
+	{
+		const Uptr hostEnd = address.find("]:", 6);
+		if(hostEnd == std::string::npos) { return Result::invalidAddress; }
+
+		struct sockaddr_in6* inet6Address = (struct sockaddr_in6*)&outAddress;
+		inet6Address->sin6_family = AF_INET6;
+		const std::string host = address.substr(6, hostEnd - 6);
+		if(inet_pton(AF_INET6, host.c_str(), &inet6Address->sin6_addr) != 1
+		   || !parsePort(address.substr(hostEnd + 2), inet6Address->sin6_port))
+		{
+			return Result::invalidAddress;
+		}
+
+		outNumAddressBytes = sizeof(struct sockaddr_in6);
+		return Result::success;
+	}
+	else
+	{
+		return Result::invalidAddress;
+	}
+}
+
+static Result createSocket(const std::string& address,
+						   const VFDFlags& flags,
+						   bool listen,
+						   VFD*& outVFD)
+{
+	struct sockaddr_storage socketAddress;
+	socklen_t numSocketAddressBytes = 0;
+	Result result = parseSocketAddress(address, socketAddress, numSocketAddressBytes);
+	if(result != Result::success) { return result; }
+
+	const I32 socketFD = socket(socketAddress.ss_family, SOCK_STREAM, 0);
+	if(socketFD < 0) { return asVFSResult(errno); }
+
+	// Apply the VFD flags after connecting, so a non-blocking socket still connects synchronously.
+	result = initSocket(socketFD, VFDFlags{});
+	if(result == Result::success && listen)
+	{
+		if(socketAddress.ss_family != AF_UNIX)
+		{
+			const int one = 1;
+			if(setsockopt(socketFD, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)))
+			{
+				result = asVFSResult(errno);
+			}
+		}
+
+		if(result == Result::success
+		   && (bind(socketFD, (const struct sockaddr*)&socketAddress, numSocketAddressBytes)
+			   || ::listen(socketFD, SOMAXCONN)))
+		{
+			result = errno == EINVAL ? Result::invalidAddress : asVFSResult(errno);
+		}
+	}
+	else if(result == Result::success)
+	{
+		if(connect(socketFD, (const struct sockaddr*)&socketAddress, numSocketAddressBytes))
+		{
+			result = errno == EINVAL ? Result::invalidAddress : asVFSResult(errno);
+		}
+	}
+
+	if(result == Result::success && fcntl(socketFD, F_SETFL, translateVFDFlags(flags)))
+	{
+		result = asVFSResult(errno);
+	}
+
+	if(result != Result::success)
+	{
+		::close(socketFD);
+		return result;
+	}
+
+	outVFD = new POSIXSocketFD(socketFD);
+	return Result::success;
+}
+
+Result Platform::listenOnSocket(const std::string& address, VFD*& outVFD, const VFDFlags& flags)
+{
+	return createSocket(address, flags, true, outVFD);
+}
+
+Result Platform::connectToSocket(const std::string& address, VFD*& outVFD, const VFDFlags& flags)
+{
+	return createSocket(address, flags, false, outVFD);
+}
+
+static bool isPollEntryReady(const PollEntry& entry)
+{
+	return entry.readable || entry.writable || entry.error != Result::success;
+}
+
+// Converts a relative timeout to the number of milliseconds to pass to poll/epoll_wait, rounding
+// up so the wait doesn't return before the timeout has elapsed.
+static int getPollTimeoutMS(Time timeout)
+{
+	if(isInfinity(timeout)) { return -1; }
+	else if(timeout.ns <= 0) { return 0; }
+
+	const I128 timeoutMS = (timeout.ns + 999999) / 1000000;
+	return timeoutMS > INT_MAX ? INT_MAX : int(timeoutMS);
+}
+
+#ifdef __linux__
+// A reactor that keeps the host fds it has waited on registered with an epoll instance, so a
+// repeated wait on the same fds doesn't need to copy the whole set of fds into the kernel.
+struct EPollReactor : Reactor
+{
+	EPollReactor() : epollFD(epoll_create1(EPOLL_CLOEXEC))
+	{
+		if(epollFD < 0)
+		{
+			Errors::fatalfWithCallStack("epoll_create1 failed: %s", strerror(errno));
+		}
+	}
+
+	~EPollReactor() override { ::close(epollFD); }
+
+	virtual Result poll(PollEntry* entries,
+						Uptr numEntries,
+						Time timeout,
+						Uptr& outNumReadyEntries) override
+	{
+		outNumReadyEntries = 0;
+
+		// Merge the entries that refer to the same host fd, chaining them through nextEntryIndices.
+		fdRequests.clear();
+		nextEntryIndices.resize(numEntries);
+		for(Uptr entryIndex = 0; entryIndex < numEntries; ++entryIndex)
+		{
+			PollEntry& entry = entries[entryIndex];
+			entry.readable = entry.writable = entry.hangup = false;
+			entry.error = Result::success;
+
+			Uptr hostDescriptor = 0;
+			const Result result = entry.vfd->getHostDescriptor(hostDescriptor);
+			if(result != Result::success)
+			{
+				entry.error = result;
+				++outNumReadyEntries;
+				continue;
+			}
+
+			FDRequest& request
+				= fdRequests.getOrAdd(I32(hostDescriptor), FDRequest{0, UINTPTR_MAX});
+			if(entry.waitForRead) { request.events |= EPOLLIN | EPOLLRDHUP; }
+			if(entry.waitForWrite) { request.events |= EPOLLOUT; }
+			nextEntryIndices[entryIndex] = request.firstEntryIndex;
+			request.firstEntryIndex = entryIndex;
+		}
+
+		// Update the epoll registrations for the requested fds.
+		for(const auto& pair : fdRequests)
+		{
+			const int error = registerFD(pair.key, pair.value.events);
+			if(!error) { continue; }
+
+			for(Uptr entryIndex = pair.value.firstEntryIndex; entryIndex != UINTPTR_MAX;
+				entryIndex = nextEntryIndices[entryIndex])
+			{
+				PollEntry& entry = entries[entryIndex];
+				if(error == EPERM)
+				{
+					// Regular files and directories can't be added to an epoll set, but are
+					// always ready for I/O.
+					entry.readable = entry.waitForRead;
+					entry.writable = entry.waitForWrite;
+				}
+				else
+				{
+					entry.error = error == EBADF ? Result::notPermitted : asVFSResult(error);
+				}
+				if(isPollEntryReady(entry)) { ++outNumReadyEntries; }
+			}
+		}
+
+		// If there are already ready entries, just check for other ready entries without waiting.
+		if(outNumReadyEntries) { timeout.ns = 0; }
+
+		const bool hasDeadline = !isInfinity(timeout) && timeout.ns > 0;
+		const I128 deadlineNS
+			= hasDeadline ? getClockTime(Clock::monotonic).ns + timeout.ns : I128(0);
+
+		events.resize(std::max(Uptr(1), Uptr(fdRequests.size())));
+		while(true)
+		{
+			const int numEvents
+				= epoll_wait(epollFD, events.data(), int(events.size()), getPollTimeoutMS(timeout));
+			if(numEvents < 0) { return asVFSResult(errno); }
+
+			for(int eventIndex = 0; eventIndex < numEvents; ++eventIndex)
+			{
+				const I32 fd = events[eventIndex].data.fd;
+				const U32 eventFlags = events[eventIndex].events;
+
+				const FDRequest* request = fdRequests.get(fd);
+				if(!request)
+				{
+					// The fd was registered by an earlier poll, but isn't being waited on by this
+					// one: remove it from the epoll set so it doesn't wake up future waits.
+					unregisterFD(fd);
+					continue;
+				}
+
+				for(Uptr entryIndex = request->firstEntryIndex; entryIndex != UINTPTR_MAX;
+					entryIndex = nextEntryIndices[entryIndex])
+				{
+					PollEntry& entry = entries[entryIndex];
+					const bool wasReady = isPollEntryReady(entry);
+					if(entry.waitForRead
+					   && (eventFlags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+					{
+						entry.readable = true;
+					}
+					if(entry.waitForWrite && (eventFlags & (EPOLLOUT | EPOLLHUP | EPOLLERR)))
+					{
+						entry.writable = true;
+					}
+					if(eventFlags & (EPOLLRDHUP | EPOLLHUP)) { entry.hangup = true; }
+					if(!wasReady && isPollEntryReady(entry)) { ++outNumReadyEntries; }
+				}
+			}
+
+			if(outNumReadyEntries || timeout.ns == 0) { break; }
+			if(hasDeadline)
+			{
+				timeout.ns = deadlineNS - getClockTime(Clock::monotonic).ns;
+				if(timeout.ns <= 0) { break; }
+			}
+		}
+
+		return Result::success;
+	}
+
+private:
+	struct FDRequest
+	{
+		U32 events;
+		Uptr firstEntryIndex;
+	};
+
+	I32 epollFD;
+
+	// The fds that have been added to the epoll set, and haven't been removed from it explicitly.
+	HashSet<I32> registeredFDs;
+
+	HashMap<I32, FDRequest> fdRequests;
+	std::vector<Uptr> nextEntryIndices;
+	std::vector<struct epoll_event> events;
+
+	int registerFD(I32 fd, U32 requestedEvents)
+	{
+		struct epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = requestedEvents;
+		event.data.fd = fd;
+
+		// Closing an fd implicitly removes it from the epoll set, and the fd number may then be
+		// reused for a different file. That can't be detected from the fd number, so the
+		// registration is always updated, even if the fd is registered for the requested events:
+		// if it was closed since it was registered, the MOD fails with ENOENT, and it is added
+		// again. If an fd that isn't registered is already in the epoll set, the ADD fails with
+		// EEXIST, and it is modified instead.
+		const bool registered = registeredFDs.contains(fd);
+		int result = epoll_ctl(epollFD, registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event);
+		if(result && registered && errno == ENOENT)
+		{
+			result = epoll_ctl(epollFD, EPOLL_CTL_ADD, fd, &event);
+		}
+		else if(result && !registered && errno == EEXIST)
+		{
+			result = epoll_ctl(epollFD, EPOLL_CTL_MOD, fd, &event);
+		}
+
+		if(result)
+		{
+			const int error = errno;
+			registeredFDs.remove(fd);
+			return error;
+		}
+
+		registeredFDs.add(fd);
+		return 0;
+	}
+
+	void unregisterFD(I32 fd)
+	{
+		epoll_ctl(epollFD, EPOLL_CTL_DEL, fd, nullptr);
+		registeredFDs.remove(fd);
+	}
+};
+
+std::unique_ptr<Reactor> Platform::createReactor() { return std::make_unique<EPollReactor>(); }
+#else
+// A reactor for POSIX platforms without epoll, which passes every fd to poll on each wait.
+struct POSIXPollReactor : Reactor
+{
+	virtual Result poll(PollEntry* entries,
+						Uptr numEntries,
+						Time timeout,
+						Uptr& outNumReadyEntries) override
+	{
+		outNumReadyEntries = 0;
+
+		pollFDs.resize(numEntries);
+		for(Uptr entryIndex = 0; entryIndex < numEntries; ++entryIndex)
+		{
+			PollEntry& entry = entries[entryIndex];
+			entry.readable = entry.writable = entry.hangup = false;
+			entry.error = Result::success;
+
+			Uptr hostDescriptor = 0;
+			entry.error = entry.vfd->getHostDescriptor(hostDescriptor);
+			if(entry.error != Result::success) { ++outNumReadyEntries; }
+
+			// poll ignores entries with a negative fd.
+			pollFDs[entryIndex].fd = entry.error == Result::success ? int(hostDescriptor) : -1;
+			pollFDs[entryIndex].events
+				= (entry.waitForRead ? POLLIN : 0) | (entry.waitForWrite ? POLLOUT : 0);
+			pollFDs[entryIndex].revents = 0;
+		}
+
+		if(outNumReadyEntries) { timeout.ns = 0; }
+
+		if(::poll(pollFDs.data(), nfds_t(numEntries), getPollTimeoutMS(timeout)) < 0)
+		{
+			return asVFSResult(errno);
+		}
+
+		for(Uptr entryIndex = 0; entryIndex < numEntries; ++entryIndex)
+		{
+			PollEntry& entry = entries[entryIndex];
+			const short revents = pollFDs[entryIndex].revents;
+			if(revents & POLLNVAL) { entry.error = Result::notPermitted; }
+			if(entry.waitForRead && (revents & (POLLIN | POLLHUP | POLLERR)))
+			{
+				entry.readable = true;
+			}
+			if(entry.waitForWrite && (revents & (POLLOUT | POLLHUP | POLLERR)))
+			{
+				entry.writable = true;
+			}
+			if(revents & POLLHUP) { entry.hangup = true; }
+			if(pollFDs[entryIndex].fd >= 0 && isPollEntryReady(entry)) { ++outNumReadyEntries; }
+		}
+
+		return Result::success;
+	}
+
+private:
+	std::vector<struct pollfd> pollFDs;
+};
+
+std::unique_ptr<Reactor> Platform::createReactor() { return std::make_unique<POSIXPollReactor>(); }
+#endif
+
 std::string Platform::getCurrentWorkingDirectory()
 {
 	const Uptr maxPathBytes = pathconf(".", _PC_PATH_MAX);
@@ -1,9 +1,11 @@
 #if WAVM_PLATFORM_POSIX
 
 #include <errno.h>
+#include <fcntl.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/resource.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include "WAVM/Inline/Assert.h"
 #include "WAVM/Inline/BasicTypes.h"
@@ -177,6 +179,121 @@ void Platform::decommitVirtualPages(U8* baseVirtualAddress, Uptr numPages)
 	}
 }
 
+// Returns whether a file is sealed so that it can't be shrunk or written. Files that can't be
+// sealed, or that are on platforms without file seals, are never considered sealed.
+static bool isFileSealedAgainstChanges(int fd)
+{
+#ifdef F_GET_SEALS
+	const int seals = fcntl(fd, F_GET_SEALS);
+	return seals != -1 && (seals & F_SEAL_SHRINK) && (seals & F_SEAL_WRITE);
+#else
+	return false;
+#endif
+}
+
+bool Platform::mapFileToVirtualPages(U8* baseVirtualAddress,
+									 Uptr numPages,
+									 Uptr hostDescriptor,
+									 U64 fileOffset)
+{
+	WAVM_ERROR_UNLESS(isPageAligned(baseVirtualAddress));
+	WAVM_ERROR_UNLESS(!(fileOffset & (getBytesPerPage() - 1)));
+	const int fd = int(hostDescriptor);
+
+	struct stat fileStatus;
+	if(fstat(fd, &fileStatus) || !S_ISREG(fileStatus.st_mode) || fileOffset > U64(INT64_MAX))
+	{
+		return false;
+	}
+
+	// Unwritten pages keep reading from the file, so if the file were truncated while it's mapped,
+	// accessing them would raise SIGBUS, and if it were written, the changes would show through
+	// the mapping. Only map files that are sealed against both, which makes the mapping a private
+	// snapshot of the file.
+	if(!isFileSealedAgainstChanges(fd)) { return false; }
+
+	// Accessing a mapped page that is entirely past the end of the file raises SIGBUS, so only map
+	// the pages that contain part of the file.
+	const U64 numFileBytes = U64(fileStatus.st_size);
+	Uptr numFilePages = 0;
+	if(fileOffset < numFileBytes)
+	{
+		const U64 numBytesAfterOffset = numFileBytes - fileOffset;
+		const U64 numPagesAfterOffset
+			= (numBytesAfterOffset >> getBytesPerPageLog2())
+			  + ((numBytesAfterOffset & (getBytesPerPage() - 1)) ? 1 : 0);
+		numFilePages = numPagesAfterOffset < U64(numPages) ? Uptr(numPagesAfterOffset) : numPages;
+	}
+
+	// mmap validates the file descriptor and offset before it replaces any existing mapping, so if
+	// it fails, the pages are left unmodified.
+	if(numFilePages
+	   && mmap(baseVirtualAddress,
+			   numFilePages << getBytesPerPageLog2(),
+			   PROT_READ | PROT_WRITE,
+			   MAP_FIXED | MAP_PRIVATE,
+			   fd,
+			   off_t(fileOffset))
+			  == MAP_FAILED)
+	{
+		return false;
+	}
+
+	// Replace the pages past the end of the file with zeroed pages.
+	if(numFilePages < numPages)
+	{
+		U8* zeroBaseAddress = baseVirtualAddress + (numFilePages << getBytesPerPageLog2());
+		const Uptr numZeroBytes = (numPages - numFilePages) << getBytesPerPageLog2();
+		if(mmap(zeroBaseAddress,
+				numZeroBytes,
+				PROT_READ | PROT_WRITE,
+				MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS,
+				-1,
+				0)
+		   == MAP_FAILED)
+		{
+			Errors::fatalf("mmap(0x%" WAVM_PRIxPTR ", %" WAVM_PRIuPTR
+						   ", PROT_READ | PROT_WRITE, MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS,"
+						   " -1, 0) failed: %s",
+						   reinterpret_cast<Uptr>(zeroBaseAddress),
+						   numZeroBytes,
+						   strerror(errno));
+		}
+	}
+
+	return true;
+}
+
+const U8* Platform::mapFile(Uptr hostDescriptor, Uptr& outNumBytes)
+{
+	const int fd = int(hostDescriptor);
+
+	struct stat fileStatus;
+	if(fstat(fd, &fileStatus) || !S_ISREG(fileStatus.st_mode) || fileStatus.st_size <= 0
+	   || U64(fileStatus.st_size) > U64(UINTPTR_MAX))
+	{
+		return nullptr;
+	}
+
+	const Uptr numBytes = Uptr(fileStatus.st_size);
+	void* baseAddress = mmap(nullptr, numBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(baseAddress == MAP_FAILED) { return nullptr; }
+
+	outNumBytes = numBytes;
+	return (const U8*)baseAddress;
+}
+
+void Platform::unmapFile(const U8* baseAddress, Uptr numBytes)
+{
+	if(munmap(const_cast<U8*>(baseAddress), numBytes))
+	{
+		Errors::fatalf("munmap(0x%" WAVM_PRIxPTR ", %" WAVM_PRIuPTR ") failed: %s",
+					   reinterpret_cast<Uptr>(baseAddress),
+					   numBytes,
+					   strerror(errno));
+	}
+}
+
 void Platform::freeVirtualPages(U8* baseVirtualAddress, Uptr numPages)
 {
 	WAVM_ERROR_UNLESS(isPageAligned(baseVirtualAddress));
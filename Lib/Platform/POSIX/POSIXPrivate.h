@@ -39,6 +39,12 @@ namespace WAVM { namespace Platform {
 	extern thread_local SigAltStack sigAltStack;
 	extern thread_local SignalContext* innermostSignalContext;
 
+	// The bounds of the current thread's stack, excluding its sigaltstack, or null if the thread
+	// hasn't initialized its sigaltstack. Unlike sigAltStack, these don't need to be constructed
+	// on first use, so they may be read by a signal handler on any thread.
+	extern thread_local U8* sampleStackMinAddr;
+	extern thread_local U8* sampleStackMaxAddr;
+
 	extern bool initThreadAndGlobalSignalsOnce();
 	extern bool initGlobalSignalsOnce();
 
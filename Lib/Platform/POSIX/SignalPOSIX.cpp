@@ -1,16 +1,21 @@
 #if WAVM_PLATFORM_POSIX
 
+#include <errno.h>
 #include <pthread.h>
 #include <setjmp.h>
 #include <signal.h>
+#include <sys/time.h>
 #include <sys/signal.h>
+#include <atomic>
 #include <utility>
 #include "POSIXPrivate.h"
 #include "WAVM/Inline/Assert.h"
 #include "WAVM/Inline/BasicTypes.h"
 #include "WAVM/Inline/Config.h"
 #include "WAVM/Inline/Errors.h"
+#include "WAVM/Platform/Defines.h"
 #include "WAVM/Platform/Signal.h"
+#include "WAVM/Platform/Thread.h"
 #include "WAVM/Platform/Unwind.h"
 
 using namespace WAVM;
@@ -163,4 +168,126 @@ bool Platform::catchSignals(void (*thunk)(void*),
 	return isReturningFromSignalHandler;
 }
 
+// Captures the call stack of the code interrupted by a signal by following its chain of frame
+// pointers. This only reads memory between the interrupted stack pointer and the top of the
+// thread's stack, and requires each frame pointer to be above the previous one, so it can't fault
+// or loop on a frame pointer register that is being used for something else.
+WAVM_NO_ASAN static Uptr captureFramePointerStack(void* contextPtr, Uptr* outIPs, Uptr maxFrames)
+{
+	auto* uc = static_cast<ucontext_t*>(contextPtr);
+#if defined(__APPLE__) && defined(__aarch64__)
+	const Uptr ip = uc->uc_mcontext->__ss.__pc;
+	const Uptr sp = uc->uc_mcontext->__ss.__sp;
+	Uptr fp = uc->uc_mcontext->__ss.__fp;
+#elif defined(__APPLE__) && defined(__x86_64__)
+	const Uptr ip = uc->uc_mcontext->__ss.__rip;
+	const Uptr sp = uc->uc_mcontext->__ss.__rsp;
+	Uptr fp = uc->uc_mcontext->__ss.__rbp;
+#elif defined(__linux__) && defined(__aarch64__)
+	const Uptr ip = uc->uc_mcontext.pc;
+	const Uptr sp = uc->uc_mcontext.sp;
+	Uptr fp = uc->uc_mcontext.regs[29];
+#elif defined(__linux__) && defined(__x86_64__)
+	const Uptr ip = Uptr(uc->uc_mcontext.gregs[REG_RIP]);
+	const Uptr sp = Uptr(uc->uc_mcontext.gregs[REG_RSP]);
+	Uptr fp = Uptr(uc->uc_mcontext.gregs[REG_RBP]);
+#else
+#error "Unsupported platform for captureFramePointerStack"
+#endif
+
+	if(!maxFrames) { return 0; }
+	Uptr numFrames = 0;
+	outIPs[numFrames++] = ip;
+
+	// If the thread's stack bounds aren't known, or the interrupted code isn't running on the
+	// thread's stack (e.g. it is handling another signal on the sigaltstack), don't follow the
+	// frame pointers.
+	const Uptr stackMinAddr = reinterpret_cast<Uptr>(sampleStackMinAddr);
+	const Uptr stackMaxAddr = reinterpret_cast<Uptr>(sampleStackMaxAddr);
+	if(!stackMaxAddr || sp < stackMinAddr || sp >= stackMaxAddr) { return numFrames; }
+
+	// Each frame record is a pair of words: the caller's frame pointer, and the return address.
+	Uptr minFrameAddr = sp;
+	while(numFrames < maxFrames)
+	{
+		if(fp < minFrameAddr || (fp & (sizeof(Uptr) - 1))
+		   || fp > stackMaxAddr - 2 * sizeof(Uptr))
+		{
+			break;
+		}
+
+		const Uptr* frameRecord = reinterpret_cast<const Uptr*>(fp);
+		const Uptr returnAddress = frameRecord[1];
+		if(!returnAddress) { break; }
+		outIPs[numFrames++] = returnAddress;
+
+		minFrameAddr = fp + 2 * sizeof(Uptr);
+		fp = frameRecord[0];
+	}
+	return numFrames;
+}
+
+// The active sampler. numActiveSampleHandlers is incremented before the sampler is read by the
+// SIGPROF handler, so once stopSampling has cleared the sampler, it only needs to wait for
+// numActiveSampleHandlers to reach zero to know that no thread is still using it.
+static std::atomic<void (*)(void*, const Uptr*, Uptr)> sampleCallback{nullptr};
+static std::atomic<void*> sampleCallbackArgument{nullptr};
+static std::atomic<Uptr> numActiveSampleHandlers{0};
+
+static void sampleSignalHandler(int signalNumber, siginfo_t* signalInfo, void* contextPtr)
+{
+	const int savedErrno = errno;
+
+	numActiveSampleHandlers.fetch_add(1, std::memory_order_seq_cst);
+	auto callback = sampleCallback.load(std::memory_order_seq_cst);
+	if(callback)
+	{
+		Uptr ips[maxSampleFrames];
+		const Uptr numIPs = captureFramePointerStack(contextPtr, ips, maxSampleFrames);
+		callback(sampleCallbackArgument.load(std::memory_order_seq_cst), ips, numIPs);
+	}
+	numActiveSampleHandlers.fetch_sub(1, std::memory_order_seq_cst);
+
+	errno = savedErrno;
+}
+
+bool Platform::startSampling(Uptr samplesPerSecond,
+							 void (*inSampleCallback)(void*, const Uptr*, Uptr),
+							 void* argument)
+{
+	WAVM_ERROR_UNLESS(samplesPerSecond > 0 && samplesPerSecond <= 1000000);
+	WAVM_ERROR_UNLESS(!sampleCallback.load(std::memory_order_seq_cst));
+
+	sampleCallbackArgument.store(argument, std::memory_order_seq_cst);
+	sampleCallback.store(inSampleCallback, std::memory_order_seq_cst);
+
+	// The SIGPROF handler is left installed after sampling stops, since a SIGPROF may still be
+	// pending, and the default action for SIGPROF is to terminate the process.
+	struct sigaction signalAction;
+	signalAction.sa_sigaction = sampleSignalHandler;
+	signalAction.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESTART;
+	sigemptyset(&signalAction.sa_mask);
+	WAVM_ERROR_UNLESS(!sigaction(SIGPROF, &signalAction, nullptr));
+
+	// ITIMER_PROF counts the CPU time used by all threads in the process, and sends SIGPROF to the
+	// process when it expires. The kernel delivers it to a thread that was running.
+	struct itimerval timer;
+	timer.it_interval.tv_sec = time_t(1 / samplesPerSecond);
+	timer.it_interval.tv_usec = suseconds_t(1000000 / samplesPerSecond % 1000000);
+	timer.it_value = timer.it_interval;
+	WAVM_ERROR_UNLESS(!setitimer(ITIMER_PROF, &timer, nullptr));
+
+	return true;
+}
+
+void Platform::stopSampling()
+{
+	struct itimerval timer = {};
+	WAVM_ERROR_UNLESS(!setitimer(ITIMER_PROF, &timer, nullptr));
+
+	sampleCallback.store(nullptr, std::memory_order_seq_cst);
+	while(numActiveSampleHandlers.load(std::memory_order_seq_cst)) { yieldToAnotherThread(); }
+	sampleCallbackArgument.store(nullptr, std::memory_order_seq_cst);
+}
+
 #endif // WAVM_PLATFORM_POSIX
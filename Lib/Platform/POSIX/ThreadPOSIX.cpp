@@ -68,6 +68,9 @@ void SigAltStack::deinit()
 {
 	if(base)
 	{
+		sampleStackMinAddr = nullptr;
+		sampleStackMaxAddr = nullptr;
+
 		// Disable the sig alt stack.
 		// According to the docs, ss_size is ignored if SS_DISABLE is set, but MacOS returns an
 		// ENOMEM error if ss_size is too small regardless of whether SS_DISABLE is set.
@@ -242,6 +245,9 @@ void SigAltStack::init()
 		sigAltStackInfo.ss_sp = base;
 		sigAltStackInfo.ss_flags = 0;
 		WAVM_ERROR_UNLESS(!sigaltstack(&sigAltStackInfo, nullptr));
+
+		sampleStackMinAddr = stackMinAddr;
+		sampleStackMaxAddr = stackMaxAddr;
 	}
 }
 
@@ -257,6 +263,8 @@ void SigAltStack::getNonSignalStack(U8*& outMinGuardAddr, U8*& outMinAddr, U8*&
 }
 
 thread_local SigAltStack Platform::sigAltStack;
+thread_local U8* Platform::sampleStackMinAddr = nullptr;
+thread_local U8* Platform::sampleStackMaxAddr = nullptr;
 
 WAVM_NO_ASAN static void* createThreadEntry(void* argsVoid)
 {
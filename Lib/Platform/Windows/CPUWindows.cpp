@@ -22,6 +22,11 @@ WAVM::Platform::HostCPUFeatures WAVM::Platform::getHostCPUFeatures()
 	int leaf7[4];
 	__cpuidex(leaf7, 7, 0);
 	int ebx7 = leaf7[1];
+	int ecx7 = leaf7[2];
+
+	int leaf7Subleaf1[4];
+	__cpuidex(leaf7Subleaf1, 7, 1);
+	int eax7Subleaf1 = leaf7Subleaf1[0];
 
 	int extLeaf[4];
 	__cpuid(extLeaf, 0x80000001);
@@ -46,6 +51,10 @@ WAVM::Platform::HostCPUFeatures WAVM::Platform::getHostCPUFeatures()
 	result.avx512dq = !!(ebx7 & (1 << 17));
 	result.avx512bw = !!(ebx7 & (1 << 30));
 	result.avx512vl = !!(ebx7 & (1 << 31));
+	// Leaf 7 subleaf 0 ECX
+	result.avx512vnni = !!(ecx7 & (1 << 11));
+	// Leaf 7 subleaf 1 EAX
+	result.avxvnni = !!(eax7Subleaf1 & (1 << 4));
 	// Extended leaf 0x80000001 ECX
 	result.lzcnt = !!(ecxExt & (1 << 5));
 #elif WAVM_CPU_ARCH_ARM
@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -58,6 +59,7 @@ static Result asVFSResult(DWORD windowsError)
 	case ERROR_DIR_NOT_EMPTY: return Result::isNotEmpty;
 	case ERROR_INVALID_ADDRESS: return Result::inaccessibleBuffer;
 	case ERROR_DIRECTORY: return Result::isNotDirectory;
+	case ERROR_NOT_SAME_DEVICE: return Result::crossesDevices;
 
 	case ERROR_INVALID_PARAMETER:
 		// This probably needs to be handled differently for each API entry point.
@@ -549,6 +551,39 @@ struct WindowsFD : VFD
 				   ? Result::success
 				   : asVFSResult(GetLastError());
 	}
+	virtual Result allocate(U64 offset, U64 numBytes) override
+	{
+		if(offset > U64(INT64_MAX) || numBytes > U64(INT64_MAX) - offset)
+		{
+			return Result::exceededFileSizeLimit;
+		}
+		if(!numBytes) { return Result::success; }
+
+		RWMutex::ShareableLock lock(mutex);
+
+		// Windows can only allocate space at the end of the file, so if the range is already
+		// within the file, there's nothing to do.
+		LARGE_INTEGER fileSize;
+		if(!GetFileSizeEx(handle, &fileSize)) { return asVFSResult(GetLastError()); }
+		const U64 endOffset = offset + numBytes;
+		if(endOffset <= U64(fileSize.QuadPart)) { return Result::success; }
+
+		// Allocate the space, and then extend the file to include it.
+		FILE_ALLOCATION_INFO allocationInfo;
+		allocationInfo.AllocationSize = makeLargeInt(endOffset);
+		if(!SetFileInformationByHandle(
+			   handle, FileAllocationInfo, &allocationInfo, sizeof(allocationInfo)))
+		{
+			return asVFSResult(GetLastError());
+		}
+
+		FILE_END_OF_FILE_INFO endOfFileInfo;
+		endOfFileInfo.EndOfFile = makeLargeInt(endOffset);
+		return SetFileInformationByHandle(
+				   handle, FileEndOfFileInfo, &endOfFileInfo, sizeof(endOfFileInfo))
+				   ? Result::success
+				   : asVFSResult(GetLastError());
+	}
 	virtual Result setFileTimes(bool setLastAccessTime,
 								Time lastAccessTime,
 								bool setLastWriteTime,
@@ -608,6 +643,32 @@ struct WindowsFD : VFD
 		}
 	}
 
+	virtual Result recv(const IOReadBuffer* buffers,
+						Uptr numBuffers,
+						SocketRecvFlags flags,
+						Uptr* outNumBytesRead = nullptr,
+						bool* outDataTruncated = nullptr) override
+	{
+		return Result::notSocket;
+	}
+	virtual Result send(const IOWriteBuffer* buffers,
+						Uptr numBuffers,
+						Uptr* outNumBytesWritten = nullptr) override
+	{
+		return Result::notSocket;
+	}
+	virtual Result shutdown(SocketShutdownMode mode) override { return Result::notSocket; }
+	virtual Result accept(VFD*& outVFD, const VFDFlags& flags) override
+	{
+		return Result::notSocket;
+	}
+
+	virtual Result getHostDescriptor(Uptr& outDescriptor) override
+	{
+		outDescriptor = reinterpret_cast<Uptr>(handle);
+		return Result::success;
+	}
+
 private:
 	Platform::RWMutex mutex;
 	HANDLE handle;
@@ -732,6 +793,12 @@ struct WindowsFS : HostFS
 	virtual Result removeDir(const std::string& path) override;
 	virtual Result createDir(const std::string& path) override;
 
+	virtual Result createHardLink(const std::string& existingPath,
+								  const std::string& newPath) override;
+	virtual Result createSymbolicLink(const std::string& targetPath,
+									  const std::string& linkPath) override;
+	virtual Result readSymbolicLink(const std::string& path, std::string& outTargetPath) override;
+
 	static WindowsFS& get()
 	{
 		static WindowsFS windowsFS;
@@ -912,6 +979,33 @@ Result WindowsFS::createDir(const std::string& path)
 														  : asVFSResult(GetLastError());
 }
 
+Result WindowsFS::createHardLink(const std::string& existingPath, const std::string& newPath)
+{
+	// Convert the paths from UTF-8 VFS paths (with /) to UTF-16 Windows paths (with \).
+	std::wstring existingWindowsPath;
+	if(!getWindowsPath(existingPath, existingWindowsPath)) { return Result::invalidNameCharacter; }
+	std::wstring newWindowsPath;
+	if(!getWindowsPath(newPath, newWindowsPath)) { return Result::invalidNameCharacter; }
+
+	return CreateHardLinkW(newWindowsPath.c_str(), existingWindowsPath.c_str(), nullptr)
+			   ? Result::success
+			   : asVFSResult(GetLastError());
+}
+
+Result WindowsFS::createSymbolicLink(const std::string& targetPath, const std::string& linkPath)
+{
+	// Creating a symbolic link on Windows requires knowing whether the target is a directory, and
+	// requires a privilege that most processes don't have.
+	return Result::notSupported;
+}
+
+Result WindowsFS::readSymbolicLink(const std::string& path, std::string& outTargetPath)
+{
+	// Reading a symbolic link on Windows requires parsing its reparse point data, which isn't
+	// implemented yet.
+	return Result::notSupported;
+}
+
 Result WindowsFS::openDir(const std::string& path, DirEntStream*& outStream)
 {
 	// Convert the path from a UTF-8 VFS path (with /) to a UTF-16 Windows path (with \).
@@ -951,6 +1045,47 @@ Result WindowsFS::openDir(const std::string& path, DirEntStream*& outStream)
 	}
 }
 
+Result Platform::listenOnSocket(const std::string& address, VFD*& outVFD, const VFDFlags& flags)
+{
+	return Result::notSupported;
+}
+
+Result Platform::connectToSocket(const std::string& address, VFD*& outVFD, const VFDFlags& flags)
+{
+	return Result::notSupported;
+}
+
+// Windows doesn't support sockets as VFDs, and files, pipes, and consoles can't be waited on for
+// readiness, so the reactor just reports every entry as ready.
+struct WindowsReactor : Reactor
+{
+	virtual Result poll(PollEntry* entries,
+						Uptr numEntries,
+						Time timeout,
+						Uptr& outNumReadyEntries) override
+	{
+		// If there aren't any entries, just wait for the timeout.
+		if(!numEntries && !isInfinity(timeout) && timeout.ns > 0)
+		{
+			const I128 timeoutMS = (timeout.ns + 999999) / 1000000;
+			Sleep(timeoutMS > I128(MAXDWORD - 1) ? MAXDWORD - 1 : DWORD(timeoutMS));
+		}
+
+		for(Uptr entryIndex = 0; entryIndex < numEntries; ++entryIndex)
+		{
+			PollEntry& entry = entries[entryIndex];
+			entry.readable = entry.waitForRead;
+			entry.writable = entry.waitForWrite;
+			entry.hangup = false;
+			entry.error = Result::success;
+		}
+		outNumReadyEntries = numEntries;
+		return Result::success;
+	}
+};
+
+std::unique_ptr<Reactor> Platform::createReactor() { return std::make_unique<WindowsReactor>(); }
+
 std::string Platform::getCurrentWorkingDirectory()
 {
 	wchar_t buffer[MAX_PATH];
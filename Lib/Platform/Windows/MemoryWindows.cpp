@@ -184,6 +184,43 @@ void Platform::decommitVirtualPages(U8* baseVirtualAddress, Uptr numPages)
 	if(baseVirtualAddress && !result) { Errors::fatal("VirtualFree(MEM_DECOMMIT) failed"); }
 }
 
+bool Platform::mapFileToVirtualPages(U8* baseVirtualAddress,
+									 Uptr numPages,
+									 Uptr hostDescriptor,
+									 U64 fileOffset)
+{
+	// Windows can only map a file view over reserved address space that was allocated as a
+	// placeholder, which the reservations made by allocateVirtualPages aren't.
+	return false;
+}
+
+const U8* Platform::mapFile(Uptr hostDescriptor, Uptr& outNumBytes)
+{
+	HANDLE fileHandle = reinterpret_cast<HANDLE>(hostDescriptor);
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0
+	   || U64(fileSize.QuadPart) > U64(UINTPTR_MAX))
+	{
+		return nullptr;
+	}
+
+	// The view keeps the file mapping object alive, so its handle can be closed immediately.
+	HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(!mappingHandle) { return nullptr; }
+	void* baseAddress = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	WAVM_ERROR_UNLESS(CloseHandle(mappingHandle));
+	if(!baseAddress) { return nullptr; }
+
+	outNumBytes = Uptr(fileSize.QuadPart);
+	return (const U8*)baseAddress;
+}
+
+void Platform::unmapFile(const U8* baseAddress, Uptr numBytes)
+{
+	if(!UnmapViewOfFile(baseAddress)) { Errors::fatal("UnmapViewOfFile failed"); }
+}
+
 void Platform::freeVirtualPages(U8* baseVirtualAddress, Uptr numPages)
 {
 	WAVM_ERROR_UNLESS(isPageAligned(baseVirtualAddress));
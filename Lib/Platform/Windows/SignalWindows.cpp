@@ -92,4 +92,15 @@ bool Platform::catchSignals(void (*thunk)(void*),
 	}
 }
 
+bool Platform::startSampling(Uptr samplesPerSecond,
+							 void (*sampleCallback)(void*, const Uptr*, Uptr),
+							 void* argument)
+{
+	// Windows doesn't have a signal that is sent on a CPU time interval: sampling would need a
+	// thread that suspends the other threads and captures their contexts.
+	return false;
+}
+
+void Platform::stopSampling() {}
+
 #endif // WAVM_PLATFORM_WINDOWS
@@ -47,6 +47,7 @@ Context* Runtime::createContext(Compartment* compartment, std::string&& debugNam
 			   maxMutableGlobals * sizeof(IR::UntaggedValue));
 
 		context->runtimeData->context = context;
+		context->runtimeData->stackLimit = 0;
 	}
 
 	return context;
@@ -64,6 +65,16 @@ Runtime::Context::~Context()
 
 Compartment* Runtime::getCompartment(const Context* context) { return context->compartment; }
 
+void Runtime::setContextStackLimit(Context* context, const void* stackLimit)
+{
+	context->runtimeData->stackLimit = reinterpret_cast<Uptr>(stackLimit);
+}
+
+const void* Runtime::getContextStackLimit(const Context* context)
+{
+	return reinterpret_cast<const void*>(context->runtimeData->stackLimit);
+}
+
 Context* Runtime::cloneContext(const Context* context, Compartment* newCompartment)
 {
 	// Create a new context and initialize its runtime data with the values from the source context.
@@ -33,7 +33,7 @@ void Runtime::appendToString(StringBuilderBase& stringBuilder, const Instruction
 		break;
 	case InstructionSource::Type::wasm:
 		stringBuilder.appendf("%s+%" WAVM_PRIuPTR,
-							  source.wasm.function->mutableData->debugName.c_str(),
+							  source.wasm.function->mutableData->getDebugName().c_str(),
 							  source.wasm.instructionIndex);
 		break;
 	default: WAVM_UNREACHABLE();
@@ -162,7 +162,7 @@ std::string Runtime::describeException(const Exception* exception)
 		if(!function) { result += "<unknown function>"; }
 		else
 		{
-			result += function->mutableData->debugName;
+			result += function->mutableData->getDebugName();
 			result += " : ";
 			result += asString(getFunctionType(function));
 		}
@@ -349,7 +349,7 @@ void Runtime::handleError(const char* message, bool printCallStack, Platform::Un
 	std::fflush(stderr);
 }
 
-void Runtime::unwindSignalsAsExceptions(const std::function<void()>& thunk)
+void Runtime::unwindSignalsAsExceptions(void (*thunk)(void*), void* argument)
 {
 	// Pre-create trace-unwind resources before entering the signal-catching scope.
 	initTraceUnwindState();
@@ -357,15 +357,17 @@ void Runtime::unwindSignalsAsExceptions(const std::function<void()>& thunk)
 	// Catch signals and translate them into runtime exceptions.
 	struct UnwindContext
 	{
-		const std::function<void()>* thunk;
+		void (*thunk)(void*);
+		void* argument;
 		Platform::Signal signal;
 		CallStack callStack;
 	} context;
-	context.thunk = &thunk;
+	context.thunk = thunk;
+	context.argument = argument;
 	if(Platform::catchSignals(
 		   [](void* contextVoid) {
 			   UnwindContext& context = *(UnwindContext*)contextVoid;
-			   (*context.thunk)();
+			   context.thunk(context.argument);
 		   },
 		   [](void* contextVoid, Platform::Signal signal, Platform::UnwindState&& state) {
 			   if(!isRuntimeException(signal)) { return false; }
@@ -384,3 +386,9 @@ void Runtime::unwindSignalsAsExceptions(const std::function<void()>& thunk)
 		throw exception;
 	}
 }
+
+void Runtime::unwindSignalsAsExceptions(const std::function<void()>& thunk)
+{
+	unwindSignalsAsExceptions(
+		[](void* thunkVoid) { (*(const std::function<void()>*)thunkVoid)(); }, (void*)&thunk);
+}
@@ -11,6 +11,7 @@
 #include "WAVM/Inline/BasicTypes.h"
 #include "WAVM/Inline/HashMap.h"
 #include "WAVM/LLVMJIT/LLVMJIT.h"
+#include "WAVM/Platform/Mutex.h"
 #include "WAVM/Platform/RWMutex.h"
 #include "WAVM/Runtime/Intrinsics.h"
 #include "WAVM/Runtime/Runtime.h"
@@ -147,6 +148,65 @@ Instance* Runtime::instantiateModule(Compartment* compartment,
 									 resourceQuota);
 }
 
+// Gets a module's disassembly names, deserializing them the first time they are needed.
+static std::shared_ptr<const DisassemblyNames> getModuleDisassemblyNames(ModuleConstRefParam module)
+{
+	Platform::Mutex::Lock debugNamesLock(module->debugNamesMutex);
+	if(!module->disassemblyNames)
+	{
+		auto disassemblyNames = std::make_shared<DisassemblyNames>();
+		getDisassemblyNames(module->ir, *disassemblyNames);
+		module->disassemblyNames = std::move(disassemblyNames);
+	}
+	return module->disassemblyNames;
+}
+
+// Gets the debug names of a module's function definitions for an instance with the given module
+// debug name. The names are shared with other live instances of the module with the same module
+// debug name.
+static std::shared_ptr<const FunctionDefDebugNames> getFunctionDefDebugNames(
+	ModuleConstRefParam module,
+	const DisassemblyNames& disassemblyNames,
+	const std::string& moduleDebugName)
+{
+	Platform::Mutex::Lock debugNamesLock(module->debugNamesMutex);
+	if(const std::weak_ptr<const FunctionDefDebugNames>* cachedFunctionDefDebugNames
+	   = module->functionDefDebugNames.get(moduleDebugName))
+	{
+		if(std::shared_ptr<const FunctionDefDebugNames> functionDefDebugNames
+		   = cachedFunctionDefDebugNames->lock())
+		{
+			return functionDefDebugNames;
+		}
+	}
+
+	// Remove the names for module debug names that no instance uses anymore.
+	std::vector<std::string> unusedModuleDebugNames;
+	for(const auto& pair : module->functionDefDebugNames)
+	{
+		if(pair.value.expired()) { unusedModuleDebugNames.push_back(pair.key); }
+	}
+	for(const std::string& unusedModuleDebugName : unusedModuleDebugNames)
+	{
+		module->functionDefDebugNames.removeOrFail(unusedModuleDebugName);
+	}
+
+	auto functionDefDebugNames = std::make_shared<FunctionDefDebugNames>();
+	functionDefDebugNames->names.reserve(module->ir.functions.defs.size());
+	for(Uptr functionDefIndex = 0; functionDefIndex < module->ir.functions.defs.size();
+		++functionDefIndex)
+	{
+		const std::string& name
+			= disassemblyNames.functions[module->ir.functions.imports.size() + functionDefIndex]
+				  .name;
+		functionDefDebugNames->names.push_back(
+			"wasm!" + moduleDebugName + '!'
+			+ (name.size() ? name : "<function #" + std::to_string(functionDefIndex) + ">"));
+	}
+	module->functionDefDebugNames.set(moduleDebugName, functionDefDebugNames);
+	return functionDefDebugNames;
+}
+
 Instance* Runtime::instantiateModuleInternal(Compartment* compartment,
 											 ModuleConstRefParam module,
 											 std::vector<FunctionImportBinding>&& functionImports,
@@ -170,9 +230,10 @@ Instance* Runtime::instantiateModuleInternal(Compartment* compartment,
 	}
 	if(id == UINTPTR_MAX) { return nullptr; }
 
-	// Deserialize the disassembly names.
-	DisassemblyNames disassemblyNames;
-	getDisassemblyNames(module->ir, disassemblyNames);
+	// Get the module's disassembly names.
+	std::shared_ptr<const DisassemblyNames> sharedDisassemblyNames
+		= getModuleDisassemblyNames(module);
+	const DisassemblyNames& disassemblyNames = *sharedDisassemblyNames;
 
 	// Instantiate the module's memory and table definitions.
 	for(Uptr tableDefIndex = 0; tableDefIndex < module->ir.tables.defs.size(); ++tableDefIndex)
@@ -299,21 +360,16 @@ Instance* Runtime::instantiateModuleInternal(Compartment* compartment,
 		jitExceptionTypes.push_back({exceptionType->id});
 	}
 
-	// Create a FunctionMutableData for each function definition.
+	// Create a FunctionMutableData for each function definition, which references the function's
+	// debug name in a table shared with other instances of the module.
+	std::shared_ptr<const FunctionDefDebugNames> functionDefDebugNames
+		= getFunctionDefDebugNames(module, disassemblyNames, moduleDebugName);
+	std::shared_ptr<const void> sharedDebugNames = functionDefDebugNames;
 	std::vector<FunctionMutableData*> functionDefMutableDatas;
-	for(Uptr functionDefIndex = 0; functionDefIndex < module->ir.functions.defs.size();
-		++functionDefIndex)
+	functionDefMutableDatas.reserve(module->ir.functions.defs.size());
+	for(const std::string& debugName : functionDefDebugNames->names)
 	{
-		std::string debugName
-			= disassemblyNames.functions[module->ir.functions.imports.size() + functionDefIndex]
-				  .name;
-		if(!debugName.size())
-		{
-			debugName = "<function #" + std::to_string(functionDefIndex) + ">";
-		}
-		debugName = "wasm!" + moduleDebugName + '!' + debugName;
-
-		functionDefMutableDatas.push_back(new FunctionMutableData(std::move(debugName)));
+		functionDefMutableDatas.push_back(new FunctionMutableData(sharedDebugNames, debugName));
 	}
 
 	// Load the compiled module's object code with this instance's imports.
@@ -321,7 +377,8 @@ Instance* Runtime::instantiateModuleInternal(Compartment* compartment,
 	std::vector<Runtime::Function*> jitFunctionDefs;
 	jitFunctionDefs.resize(module->ir.functions.defs.size(), nullptr);
 	std::shared_ptr<LLVMJIT::Module> jitModule
-		= LLVMJIT::loadModule(module->objectCode,
+		= LLVMJIT::loadModule(module->objectCode.data(),
+							  module->objectCode.size(),
 							  std::move(wavmIntrinsicsExportMap),
 							  std::move(jitTypes),
 							  std::move(jitFunctionImports),
@@ -368,12 +425,8 @@ Instance* Runtime::instantiateModuleInternal(Compartment* compartment,
 	}
 
 	// Copy the module's data and elem segments into the Instance for later use.
-	DataSegmentVector dataSegments;
+	DataSegmentVector dataSegments = module->passiveDataSegments;
 	ElemSegmentVector elemSegments;
-	for(const DataSegment& dataSegment : module->ir.dataSegments)
-	{
-		dataSegments.push_back(dataSegment.isActive ? nullptr : dataSegment.data);
-	}
 	for(const ElemSegment& elemSegment : module->ir.elemSegments)
 	{
 		elemSegments.push_back(elemSegment.type == ElemSegment::Type::passive ? elemSegment.contents
@@ -436,11 +489,11 @@ Instance* Runtime::instantiateModuleInternal(Compartment* compartment,
 
 			initDataSegment(instance,
 							segmentIndex,
-							dataSegment.data.get(),
+							&dataSegment.data,
 							instance->memories[dataSegment.memoryIndex],
 							baseOffset,
 							0,
-							dataSegment.data->size());
+							dataSegment.data.size());
 		}
 	}
 
@@ -14,11 +14,8 @@ using namespace WAVM;
 using namespace WAVM::IR;
 using namespace WAVM::Runtime;
 
-void Runtime::invokeFunction(Context* context,
-							 const Function* function,
-							 FunctionType invokeSig,
-							 const UntaggedValue arguments[],
-							 UntaggedValue outResults[])
+// Throws an invokeSignatureMismatch exception if the function can't be invoked with invokeSig.
+static void checkSignature(const Function* function, FunctionType invokeSig)
 {
 	FunctionType functionType{function->encodedType};
 
@@ -35,28 +32,18 @@ void Runtime::invokeFunction(Context* context,
 		}
 		throwException(ExceptionTypes::invokeSignatureMismatch);
 	}
+}
 
-	// Assert that the function, the context, and any reference arguments are all in the same
-	// compartment.
-	if(WAVM_ENABLE_ASSERTS)
-	{
-		WAVM_ASSERT(isInCompartment(asObject(function), context->compartment));
-		for(Uptr argumentIndex = 0; argumentIndex < invokeSig.params().size(); ++argumentIndex)
-		{
-			const ValueType argType = invokeSig.params()[argumentIndex];
-			const UntaggedValue& arg = arguments[argumentIndex];
-			WAVM_ASSERT(!isReferenceType(argType) || !arg.object
-						|| isInCompartment(arg.object, context->compartment));
-		}
-	}
-
-	// Get the invoke thunk for this function type. Cache it in the function's FunctionMutableData
-	// to avoid the global lock implied by LLVMJIT::getInvokeThunk.
+// Returns the invoke thunk for a function's type.
+static InvokeThunkPointer getFunctionInvokeThunk(const Function* function)
+{
+	// Cache the invoke thunk in the function's FunctionMutableData to avoid the global lock
+	// implied by LLVMJIT::getInvokeThunk.
 	InvokeThunkPointer invokeThunk
 		= function->mutableData->invokeThunk.load(std::memory_order_acquire);
 	if(WAVM_UNLIKELY(!invokeThunk))
 	{
-		invokeThunk = LLVMJIT::getInvokeThunk(functionType);
+		invokeThunk = LLVMJIT::getInvokeThunk(FunctionType{function->encodedType});
 
 		// Replace the cached thunk pointer, but since LLVMJIT::getInvokeThunk is guaranteed to
 		// return the same thunk when called with the same FunctionType, we can assume that any
@@ -64,28 +51,29 @@ void Runtime::invokeFunction(Context* context,
 		function->mutableData->invokeThunk.store(invokeThunk, std::memory_order_release);
 	}
 	WAVM_ASSERT(invokeThunk);
+	return invokeThunk;
+}
 
-	// MacOS std::function is a little more pessimistic about heap allocating captures, and without
-	// wrapping these captured variables into a single reference, does a heap allocation for the
-	// thunk passed to unwindSignalsAsExceptions below.
+// Calls an invoke thunk, translating any signals it raises to runtime exceptions if catchSignals
+// is true.
+static void callInvokeThunk(InvokeThunkPointer invokeThunk,
+							Context* context,
+							const Function* function,
+							const UntaggedValue arguments[],
+							UntaggedValue outResults[],
+							bool catchSignals)
+{
 	struct InvokeContext
 	{
+		InvokeThunkPointer invokeThunk;
 		Context* context;
 		const Function* function;
 		const UntaggedValue* arguments;
 		UntaggedValue* outResults;
-		InvokeThunkPointer invokeThunk;
 	};
-	InvokeContext invokeContext;
-	invokeContext.context = context;
-	invokeContext.function = function;
-	invokeContext.arguments = arguments;
-	invokeContext.outResults = outResults;
-	invokeContext.invokeThunk = invokeThunk;
-
-	// Use unwindSignalsAsExceptions to ensure that any signal that occurs in WebAssembly code calls
-	// C++ destructors on the stack between here and where it is caught.
-	unwindSignalsAsExceptions([&invokeContext] {
+	InvokeContext invokeContext{invokeThunk, context, function, arguments, outResults};
+	auto invoke = [](void* invokeContextVoid) {
+		const InvokeContext& invokeContext = *(const InvokeContext*)invokeContextVoid;
 		ContextRuntimeData* contextRuntimeData = getContextRuntimeData(invokeContext.context);
 
 		// Call the invoke thunk.
@@ -93,5 +81,62 @@ void Runtime::invokeFunction(Context* context,
 									 contextRuntimeData,
 									 invokeContext.arguments,
 									 invokeContext.outResults);
-	});
+	};
+
+	// Use unwindSignalsAsExceptions to ensure that any signal that occurs in WebAssembly code calls
+	// C++ destructors on the stack between here and where it is caught.
+	if(catchSignals) { unwindSignalsAsExceptions(invoke, &invokeContext); }
+	else
+	{
+		invoke(&invokeContext);
+	}
+}
+
+void Runtime::invokeFunction(Context* context,
+							 const Function* function,
+							 FunctionType invokeSig,
+							 const UntaggedValue arguments[],
+							 UntaggedValue outResults[])
+{
+	checkSignature(function, invokeSig);
+
+	// Assert that the function, the context, and any reference arguments are all in the same
+	// compartment.
+	if(WAVM_ENABLE_ASSERTS)
+	{
+		WAVM_ASSERT(isInCompartment(asObject(function), context->compartment));
+		for(Uptr argumentIndex = 0; argumentIndex < invokeSig.params().size(); ++argumentIndex)
+		{
+			const ValueType argType = invokeSig.params()[argumentIndex];
+			const UntaggedValue& arg = arguments[argumentIndex];
+			WAVM_ASSERT(!isReferenceType(argType) || !arg.object
+						|| isInCompartment(arg.object, context->compartment));
+		}
+	}
+
+	callInvokeThunk(
+		getFunctionInvokeThunk(function), context, function, arguments, outResults, true);
+}
+
+void Runtime::checkInvokeSignature(const Function* function, FunctionType invokeSig)
+{
+	checkSignature(function, invokeSig);
+
+	// Look up the invoke thunk now, so invokeFunctionUnchecked doesn't need to.
+	getFunctionInvokeThunk(function);
+}
+
+void Runtime::invokeFunctionUnchecked(Context* context,
+									  const Function* function,
+									  const UntaggedValue arguments[],
+									  UntaggedValue outResults[],
+									  bool catchSignals)
+{
+	WAVM_ASSERT(isInCompartment(asObject(function), context->compartment));
+
+	InvokeThunkPointer invokeThunk
+		= function->mutableData->invokeThunk.load(std::memory_order_acquire);
+	WAVM_ASSERT(invokeThunk);
+
+	callInvokeThunk(invokeThunk, context, function, arguments, outResults, catchSignals);
 }
@@ -293,6 +293,28 @@ void Runtime::unmapMemoryPages(Memory* memory, Uptr pageIndex, Uptr numPages)
 	Platform::deregisterVirtualAllocation(numPages << getPlatformPagesPerWebAssemblyPageLog2());
 }
 
+bool Runtime::mapFileToMemoryPages(Memory* memory,
+								   Uptr pageIndex,
+								   Uptr numPages,
+								   Uptr hostDescriptor,
+								   U64 fileOffset)
+{
+	WAVM_ASSERT(!(fileOffset & (IR::numBytesPerPage - 1)));
+
+	// Hold the resizing mutex so the memory can't shrink while the pages are being mapped. The
+	// pages are already committed, so mapping the file over them doesn't change the number of
+	// committed pages.
+	Platform::RWMutex::ExclusiveLock resizingLock(memory->resizingMutex);
+	const Uptr memoryNumPages = memory->numPages.load(std::memory_order_acquire);
+	if(pageIndex > memoryNumPages || numPages > memoryNumPages - pageIndex) { return false; }
+	if(!numPages) { return true; }
+
+	return Platform::mapFileToVirtualPages(memory->baseAddress + pageIndex * IR::numBytesPerPage,
+										   numPages << getPlatformPagesPerWebAssemblyPageLog2(),
+										   hostDescriptor,
+										   fileOffset);
+}
+
 U8* Runtime::getMemoryBaseAddress(Memory* memory) { return memory->baseAddress; }
 
 static U8* getValidatedMemoryOffsetRangeImpl(Memory* memory,
@@ -338,25 +360,25 @@ U8* Runtime::getValidatedMemoryOffsetRange(Memory* memory, Uptr address, Uptr nu
 
 void Runtime::initDataSegment(Instance* instance,
 							  Uptr dataSegmentIndex,
-							  const std::vector<U8>* dataVector,
+							  const SharedBytes* dataBytes,
 							  Memory* memory,
 							  Uptr destAddress,
 							  Uptr sourceOffset,
 							  Uptr numBytes)
 {
 	U8* destPointer = getValidatedMemoryOffsetRange(memory, destAddress, numBytes);
-	if(sourceOffset + numBytes > dataVector->size() || sourceOffset + numBytes < sourceOffset)
+	if(sourceOffset + numBytes > dataBytes->size() || sourceOffset + numBytes < sourceOffset)
 	{
 		throwException(
 			ExceptionTypes::outOfBoundsDataSegmentAccess,
 			{asObject(instance),
 			 U64(dataSegmentIndex),
-			 U64(sourceOffset > dataVector->size() ? sourceOffset : dataVector->size())});
+			 U64(sourceOffset > dataBytes->size() ? sourceOffset : dataBytes->size())});
 	}
 	else
 	{
-		Runtime::unwindSignalsAsExceptions([destPointer, sourceOffset, numBytes, dataVector] {
-			bytewiseMemCopy(destPointer, dataVector->data() + sourceOffset, numBytes);
+		Runtime::unwindSignalsAsExceptions([destPointer, sourceOffset, numBytes, dataBytes] {
+			bytewiseMemCopy(destPointer, dataBytes->data() + sourceOffset, numBytes);
 		});
 	}
 }
@@ -406,12 +428,12 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wavmIntrinsicsMemory,
 	else
 	{
 		// Make a copy of the shared_ptr to the data and unlock the data segments mutex.
-		std::shared_ptr<std::vector<U8>> dataVector = instance->dataSegments[dataSegmentIndex];
+		std::shared_ptr<const SharedBytes> dataBytes = instance->dataSegments[dataSegmentIndex];
 		dataSegmentsLock.unlock();
 
 		initDataSegment(instance,
 						dataSegmentIndex,
-						dataVector.get(),
+						dataBytes.get(),
 						memory,
 						destAddress,
 						sourceOffset,
@@ -3,7 +3,9 @@
 #include <utility>
 #include <vector>
 #include "RuntimePrivate.h"
+#include "WAVM/Inline/Assert.h"
 #include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/SharedBytes.h"
 #include "WAVM/Inline/Timing.h"
 #include "WAVM/LLVMJIT/LLVMJIT.h"
 #include "WAVM/Platform/RWMutex.h"
@@ -29,11 +31,32 @@ static std::shared_ptr<ObjectCacheInterface> getGlobalObjectCache()
 	return globalObjectCache;
 }
 
-ModuleRef Runtime::compileModule(const IR::Module& irModule)
+// Frees the function bodies of an IR module that has been compiled, once the module's object code
+// no longer needs them.
+static void releaseIRFunctionBodies(IR::Module& irModule)
+{
+	for(FunctionDef& functionDef : irModule.functions.defs)
+	{
+		functionDef.code = std::vector<U8>();
+		functionDef.branchTableTargetDepths = std::vector<Uptr>();
+	}
+}
+
+ModuleRef Runtime::compileModule(const IR::Module& irModule, bool releaseFunctionBodies)
 {
 	// Get a pointer to the global object cache, if there is one.
 	std::shared_ptr<ObjectCacheInterface> objectCache = getGlobalObjectCache();
 
+	// Serialize the IR module to WASM if it's needed as the object cache key, or to decode the
+	// function bodies from if they are released.
+	std::vector<U8> wasmBytes;
+	if(objectCache || releaseFunctionBodies)
+	{
+		Timing::Timer saveTimer;
+		wasmBytes = WASM::saveBinaryModule(irModule);
+		Timing::logTimer("Serialized IR module to WASM", saveTimer);
+	}
+
 	std::vector<U8> objectCode;
 	if(!objectCache)
 	{
@@ -42,11 +65,6 @@ ModuleRef Runtime::compileModule(const IR::Module& irModule)
 	}
 	else
 	{
-		// Serialize the IR module to WASM.
-		Timing::Timer keyTimer;
-		std::vector<U8> wasmBytes = WASM::saveBinaryModule(irModule);
-		Timing::logTimer("Created object cache key from IR module", keyTimer);
-
 		// Check for cached object code for the module before compiling it.
 		objectCode
 			= objectCache->getCachedObject(wasmBytes.data(), wasmBytes.size(), [&irModule]() {
@@ -54,37 +72,147 @@ ModuleRef Runtime::compileModule(const IR::Module& irModule)
 			  });
 	}
 
-	return std::make_shared<Runtime::Module>(IR::Module(irModule), std::move(objectCode));
+	if(!releaseFunctionBodies)
+	{
+		return std::make_shared<Runtime::Module>(IR::Module(irModule), std::move(objectCode));
+	}
+
+	// Instead of copying irModule, decode the module's IR from the serialized WASM, so its data
+	// segments and custom sections reference the serialized bytes instead of duplicating them.
+	SharedBytes sharedWASMBytes(std::move(wasmBytes));
+	IR::Module releasedIRModule(irModule.featureSpec);
+	WAVM_ERROR_UNLESS(WASM::loadBinaryModule(sharedWASMBytes, releasedIRModule));
+	releaseIRFunctionBodies(releasedIRModule);
+
+	return std::make_shared<Runtime::Module>(
+		std::move(releasedIRModule), std::move(objectCode), std::move(sharedWASMBytes));
+}
+
+// Compiles an IR module that was loaded from a binary module, using the binary module as the key
+// for the object cache if there is one.
+static std::vector<U8> compileBinaryModule(const IR::Module& irModule,
+										   const U8* wasmBytes,
+										   Uptr numWASMBytes,
+										   const std::shared_ptr<ObjectCacheInterface>& objectCache)
+{
+	if(!objectCache)
+	{
+		// If there's no global object cache, just compile the module.
+		return LLVMJIT::compileModule(irModule, LLVMJIT::getHostTargetSpec());
+	}
+	else
+	{
+		// Check for cached object code for the module before compiling it.
+		return objectCache->getCachedObject(wasmBytes, numWASMBytes, [&irModule]() {
+			return LLVMJIT::compileModule(irModule, LLVMJIT::getHostTargetSpec());
+		});
+	}
 }
 
 bool Runtime::loadBinaryModule(const U8* wasmBytes,
 							   Uptr numWASMBytes,
 							   ModuleRef& outModule,
 							   const IR::FeatureSpec& featureSpec,
-							   WASM::LoadError* outError)
+							   WASM::LoadError* outError,
+							   bool releaseFunctionBodies)
 {
+	if(releaseFunctionBodies)
+	{
+		// The module needs a copy of the WASM bytes to decode the function bodies from, so load
+		// it from the copy, which the module's data segments and custom sections can then share.
+		return loadBinaryModule(
+			SharedBytes(wasmBytes, numWASMBytes), outModule, featureSpec, outError, true);
+	}
+
 	// Load the module IR.
 	IR::Module irModule(std::move(featureSpec));
 	if(!WASM::loadBinaryModule(wasmBytes, numWASMBytes, irModule, outError)) { return false; }
 
-	// Get a pointer to the global object cache, if there is one.
-	std::shared_ptr<ObjectCacheInterface> objectCache = getGlobalObjectCache();
+	std::vector<U8> objectCode
+		= compileBinaryModule(irModule, wasmBytes, numWASMBytes, getGlobalObjectCache());
 
-	std::vector<U8> objectCode;
-	if(!objectCache)
+	outModule = std::make_shared<Runtime::Module>(std::move(irModule), std::move(objectCode));
+	return true;
+}
+
+bool Runtime::loadBinaryModule(const SharedBytes& wasmBytes,
+							   ModuleRef& outModule,
+							   const IR::FeatureSpec& featureSpec,
+							   WASM::LoadError* outError,
+							   bool releaseFunctionBodies)
+{
+	// Load the module IR, sharing the module's data segments and custom sections with wasmBytes.
+	IR::Module irModule(featureSpec);
+	if(!WASM::loadBinaryModule(wasmBytes, irModule, outError)) { return false; }
+
+	std::vector<U8> objectCode = compileBinaryModule(
+		irModule, wasmBytes.data(), wasmBytes.size(), getGlobalObjectCache());
+
+	if(!releaseFunctionBodies)
 	{
-		// If there's no global object cache, just compile the module.
-		objectCode = LLVMJIT::compileModule(irModule, LLVMJIT::getHostTargetSpec());
+		outModule = std::make_shared<Runtime::Module>(std::move(irModule), std::move(objectCode));
 	}
 	else
 	{
-		// Check for cached object code for the module before compiling it.
-		objectCode = objectCache->getCachedObject(wasmBytes, numWASMBytes, [&irModule]() {
-			return LLVMJIT::compileModule(irModule, LLVMJIT::getHostTargetSpec());
-		});
+		releaseIRFunctionBodies(irModule);
+		outModule = std::make_shared<Runtime::Module>(
+			std::move(irModule), std::move(objectCode), SharedBytes(wasmBytes));
 	}
+	return true;
+}
 
-	outModule = std::make_shared<Runtime::Module>(std::move(irModule), std::move(objectCode));
+struct Runtime::ModuleStream
+{
+	IR::Module irModule;
+	WASM::ModuleStreamDecoder* decoder;
+	std::shared_ptr<ObjectCacheInterface> objectCache;
+
+	// The bytes of the module, which are only kept if there's an object cache that needs them as
+	// the key for the module's object code.
+	std::vector<U8> wasmBytes;
+
+	ModuleStream(const IR::FeatureSpec& featureSpec)
+	: irModule(featureSpec)
+	, decoder(WASM::createModuleStreamDecoder(irModule))
+	, objectCache(getGlobalObjectCache())
+	{
+	}
+
+	~ModuleStream() { WASM::destroyModuleStreamDecoder(decoder); }
+};
+
+ModuleStream* Runtime::createModuleStream(const IR::FeatureSpec& featureSpec)
+{
+	return new ModuleStream(featureSpec);
+}
+
+void Runtime::destroyModuleStream(ModuleStream* stream) { delete stream; }
+
+bool Runtime::feedModuleStream(ModuleStream* stream,
+							   const U8* bytes,
+							   Uptr numBytes,
+							   WASM::LoadError* outError)
+{
+	if(stream->objectCache)
+	{
+		stream->wasmBytes.insert(stream->wasmBytes.end(), bytes, bytes + numBytes);
+	}
+	return WASM::feedModuleStreamDecoder(stream->decoder, bytes, numBytes, outError);
+}
+
+bool Runtime::finishModuleStream(ModuleStream* stream,
+								 ModuleRef& outModule,
+								 WASM::LoadError* outError)
+{
+	if(!WASM::finishModuleStreamDecoder(stream->decoder, outError)) { return false; }
+
+	std::vector<U8> objectCode = compileBinaryModule(stream->irModule,
+													 stream->wasmBytes.data(),
+													 stream->wasmBytes.size(),
+													 stream->objectCache);
+
+	outModule
+		= std::make_shared<Runtime::Module>(std::move(stream->irModule), std::move(objectCode));
 	return true;
 }
 
@@ -94,5 +222,29 @@ ModuleRef Runtime::loadPrecompiledModule(const IR::Module& irModule,
 	return std::make_shared<Module>(IR::Module(irModule), std::vector<U8>(objectCode));
 }
 
+ModuleRef Runtime::loadPrecompiledModule(const IR::Module& irModule, const SharedBytes& objectCode)
+{
+	return std::make_shared<Module>(IR::Module(irModule), SharedBytes(objectCode));
+}
+
 const IR::Module& Runtime::getModuleIR(ModuleConstRefParam module) { return module->ir; }
-std::vector<U8> Runtime::getObjectCode(ModuleConstRefParam module) { return module->objectCode; }
+
+std::shared_ptr<const IR::Module> Runtime::getModuleIRWithFunctionBodies(
+	ModuleConstRefParam module)
+{
+	if(module->releasedFunctionBodiesWASMBytes.empty())
+	{
+		return std::shared_ptr<const IR::Module>(module, &module->ir);
+	}
+
+	// The module's function bodies were released after compiling it, so decode the IR again from
+	// the binary module. The decoded IR isn't kept by the module, so the function bodies are only
+	// held in memory while the caller uses them.
+	auto decodedIR = std::make_shared<IR::Module>(module->ir.featureSpec);
+	WAVM_ERROR_UNLESS(WASM::loadBinaryModule(module->releasedFunctionBodiesWASMBytes, *decodedIR));
+	return decodedIR;
+}
+std::vector<U8> Runtime::getObjectCode(ModuleConstRefParam module)
+{
+	return std::vector<U8>(module->objectCode.begin(), module->objectCode.end());
+}
@@ -0,0 +1,478 @@
+#include "WAVM/Runtime/Profiler.h"
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+#include "WAVM/Inline/Assert.h"
+#include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/HashMap.h"
+#include "WAVM/Inline/I128.h"
+#include "WAVM/Inline/Time.h"
+#include "WAVM/Platform/Clock.h"
+#include "WAVM/Platform/ConditionVariable.h"
+#include "WAVM/Platform/Diagnostics.h"
+#include "WAVM/Platform/Mutex.h"
+#include "WAVM/Platform/Signal.h"
+#include "WAVM/Platform/Thread.h"
+#include "WAVM/Runtime/Runtime.h"
+#include "WAVM/RuntimeABI/RuntimeABI.h"
+
+using namespace WAVM;
+using namespace WAVM::Platform;
+using namespace WAVM::Runtime;
+
+// Samples are captured in a signal handler, which may interrupt any code, so it can't allocate or
+// take locks: it just copies the interrupted call stack, which the platform captures by following
+// frame pointers, to a fixed-size ring buffer. A background thread periodically drains the ring
+// buffer, resolves the addresses to functions, and aggregates the samples by call stack.
+
+static constexpr Uptr numSampleSlots = 1024;
+static constexpr U64 drainIntervalNS = 100 * 1000 * 1000;
+
+static_assert(!(numSampleSlots & (numSampleSlots - 1)), "numSampleSlots must be a power of two");
+
+struct SampleSlot
+{
+	// The slot may be written by a sampler when sequence is equal to the index of the sample that
+	// will be written to it, and read by the drain thread when it's one greater than that index.
+	std::atomic<U64> sequence;
+
+	Uptr numFrames;
+	Uptr ips[maxSampleFrames];
+};
+
+struct ProfileLine
+{
+	Uptr functionIndex;
+	Uptr line;
+};
+
+// A unique sampled address, and the functions it was resolved to, from innermost to outermost.
+struct ProfileLocation
+{
+	Uptr ip;
+	std::vector<ProfileLine> lines;
+};
+
+struct Profiler
+{
+	Uptr samplesPerSecond;
+	Time startTime;
+	Time startCPUTime;
+
+	SampleSlot sampleSlots[numSampleSlots];
+	std::atomic<U64> nextSampleIndex{0};
+	std::atomic<U64> numDroppedSamples{0};
+
+	Platform::Mutex drainMutex;
+	Platform::ConditionVariable drainCondition;
+	bool isStopping{false};
+	Platform::Thread* drainThread{nullptr};
+
+	// Only accessed by the drain thread while it's running.
+	U64 nextDrainIndex{0};
+	std::vector<std::string> functionNames;
+	HashMap<std::string, Uptr> functionNameToIndexMap;
+	std::vector<ProfileLocation> locations;
+	HashMap<Uptr, Uptr> ipToLocationIndexMap;
+
+	// Maps call stacks, as location indices from innermost to outermost, to the number of times
+	// they were sampled.
+	std::map<std::vector<Uptr>, U64> stackCounts;
+
+	Profiler(Uptr inSamplesPerSecond) : samplesPerSecond(inSamplesPerSecond)
+	{
+		for(Uptr slotIndex = 0; slotIndex < numSampleSlots; ++slotIndex)
+		{
+			sampleSlots[slotIndex].sequence.store(slotIndex, std::memory_order_relaxed);
+		}
+	}
+};
+
+static Platform::Mutex& getActiveProfilerMutex()
+{
+	static Platform::Mutex mutex;
+	return mutex;
+}
+static Profiler* activeProfiler = nullptr;
+
+// Called in signal context on the thread being sampled.
+static void captureSample(void* profilerVoid, const Uptr* ips, Uptr numIPs)
+{
+	Profiler* profiler = (Profiler*)profilerVoid;
+
+	// Claim a slot in the ring buffer. If the drain thread hasn't consumed the next slot yet, the
+	// ring buffer is full, so drop the sample.
+	U64 sampleIndex = profiler->nextSampleIndex.load(std::memory_order_relaxed);
+	SampleSlot* slot;
+	while(true)
+	{
+		slot = &profiler->sampleSlots[sampleIndex & (numSampleSlots - 1)];
+		const U64 sequence = slot->sequence.load(std::memory_order_acquire);
+		if(sequence == sampleIndex)
+		{
+			if(profiler->nextSampleIndex.compare_exchange_weak(
+				   sampleIndex, sampleIndex + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if(sequence < sampleIndex)
+		{
+			profiler->numDroppedSamples.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		else
+		{
+			sampleIndex = profiler->nextSampleIndex.load(std::memory_order_relaxed);
+		}
+	}
+
+	// Copy the call stack into the slot.
+	WAVM_ASSERT(numIPs <= maxSampleFrames);
+	for(Uptr frameIndex = 0; frameIndex < numIPs; ++frameIndex)
+	{
+		slot->ips[frameIndex] = ips[frameIndex];
+	}
+	slot->numFrames = numIPs;
+
+	slot->sequence.store(sampleIndex + 1, std::memory_order_release);
+}
+
+static Uptr getFunctionIndex(Profiler* profiler, std::string&& name)
+{
+	if(const Uptr* functionIndex = profiler->functionNameToIndexMap.get(name))
+	{
+		return *functionIndex;
+	}
+
+	const Uptr functionIndex = profiler->functionNames.size();
+	profiler->functionNameToIndexMap.addOrFail(name, functionIndex);
+	profiler->functionNames.push_back(std::move(name));
+	return functionIndex;
+}
+
+static Uptr getLocationIndex(Profiler* profiler, Uptr ip)
+{
+	if(const Uptr* locationIndex = profiler->ipToLocationIndexMap.get(ip))
+	{
+		return *locationIndex;
+	}
+
+	// Resolve the address to a stack of inlined WebAssembly functions, or a native function.
+	ProfileLocation location;
+	location.ip = ip;
+	Runtime::InstructionSource sources[maxInlineSourceFrames];
+	const Uptr numSources = getInstructionSourceByAddress(ip, sources, maxInlineSourceFrames);
+	for(Uptr sourceIndex = 0; sourceIndex < numSources; ++sourceIndex)
+	{
+		const Runtime::InstructionSource& source = sources[sourceIndex];
+		switch(source.type)
+		{
+		case Runtime::InstructionSource::Type::wasm:
+			location.lines.push_back(
+				{getFunctionIndex(profiler,
+								  std::string(source.wasm.function->mutableData->getDebugName())),
+				 source.wasm.instructionIndex});
+			break;
+		case Runtime::InstructionSource::Type::native: {
+			std::string name = std::string("host!") + source.native.module.c_str();
+			if(!source.native.function.empty())
+			{
+				name += '!';
+				name += source.native.function.c_str();
+			}
+			location.lines.push_back({getFunctionIndex(profiler, std::move(name)), 0});
+			break;
+		}
+		case Runtime::InstructionSource::Type::unknown: break;
+		default: WAVM_UNREACHABLE();
+		}
+	}
+	if(location.lines.empty())
+	{
+		location.lines.push_back({getFunctionIndex(profiler, "<unknown>"), 0});
+	}
+
+	const Uptr locationIndex = profiler->locations.size();
+	profiler->locations.push_back(std::move(location));
+	profiler->ipToLocationIndexMap.addOrFail(ip, locationIndex);
+	return locationIndex;
+}
+
+static void drainSamples(Profiler* profiler)
+{
+	std::vector<Uptr> stack;
+	while(true)
+	{
+		SampleSlot& slot
+			= profiler->sampleSlots[profiler->nextDrainIndex & (numSampleSlots - 1)];
+		if(slot.sequence.load(std::memory_order_acquire) != profiler->nextDrainIndex + 1)
+		{
+			break;
+		}
+
+		// Every frame but the innermost is a return address, which may be the first instruction
+		// after the end of the calling function, so resolve the address before it instead.
+		stack.clear();
+		for(Uptr frameIndex = 0; frameIndex < slot.numFrames; ++frameIndex)
+		{
+			const Uptr ip = slot.ips[frameIndex] - (frameIndex ? 1 : 0);
+			stack.push_back(getLocationIndex(profiler, ip));
+		}
+		++profiler->stackCounts[stack];
+
+		// Release the slot to the samplers.
+		slot.sequence.store(profiler->nextDrainIndex + numSampleSlots, std::memory_order_release);
+		++profiler->nextDrainIndex;
+	}
+}
+
+static I64 drainThreadEntry(void* profilerVoid)
+{
+	Profiler* profiler = (Profiler*)profilerVoid;
+
+	while(true)
+	{
+		drainSamples(profiler);
+
+		Platform::Mutex::Lock drainLock(profiler->drainMutex);
+		if(profiler->isStopping) { break; }
+		profiler->drainCondition.wait(profiler->drainMutex, Time{I128(drainIntervalNS)});
+	}
+
+	return 0;
+}
+
+static std::vector<U8> encodeFoldedStacks(const Profiler* profiler)
+{
+	// Different addresses may resolve to the same functions, so merge the stacks by their
+	// function names.
+	std::map<std::string, U64> foldedStackCounts;
+	for(const auto& stackCount : profiler->stackCounts)
+	{
+		std::string foldedStack;
+		const std::vector<Uptr>& stack = stackCount.first;
+		for(auto locationIt = stack.rbegin(); locationIt != stack.rend(); ++locationIt)
+		{
+			const std::vector<ProfileLine>& lines = profiler->locations[*locationIt].lines;
+			for(auto lineIt = lines.rbegin(); lineIt != lines.rend(); ++lineIt)
+			{
+				if(!foldedStack.empty()) { foldedStack += ';'; }
+				foldedStack += profiler->functionNames[lineIt->functionIndex];
+			}
+		}
+		if(foldedStack.empty()) { foldedStack = "<unknown>"; }
+
+		foldedStackCounts[foldedStack] += stackCount.second;
+	}
+
+	std::string result;
+	for(const auto& foldedStackCount : foldedStackCounts)
+	{
+		result += foldedStackCount.first;
+		result += ' ';
+		result += std::to_string(foldedStackCount.second);
+		result += '\n';
+	}
+	return std::vector<U8>(result.begin(), result.end());
+}
+
+// A minimal encoder for the subset of the protobuf wire format used by pprof.
+struct ProtobufEncoder
+{
+	std::vector<U8> bytes;
+
+	void varint(U64 value)
+	{
+		while(value >= 0x80)
+		{
+			bytes.push_back(U8(value | 0x80));
+			value >>= 7;
+		}
+		bytes.push_back(U8(value));
+	}
+
+	void uintField(U32 fieldNumber, U64 value)
+	{
+		varint(U64(fieldNumber) << 3);
+		varint(value);
+	}
+
+	void bytesField(U32 fieldNumber, const U8* data, Uptr numBytes)
+	{
+		varint((U64(fieldNumber) << 3) | 2);
+		varint(numBytes);
+		bytes.insert(bytes.end(), data, data + numBytes);
+	}
+
+	void stringField(U32 fieldNumber, const std::string& string)
+	{
+		bytesField(fieldNumber, (const U8*)string.data(), string.size());
+	}
+
+	void messageField(U32 fieldNumber, const ProtobufEncoder& message)
+	{
+		bytesField(fieldNumber, message.bytes.data(), message.bytes.size());
+	}
+
+	void packedUintField(U32 fieldNumber, const std::vector<U64>& values)
+	{
+		ProtobufEncoder packedValues;
+		for(U64 value : values) { packedValues.varint(value); }
+		messageField(fieldNumber, packedValues);
+	}
+};
+
+struct StringTable
+{
+	// The first string in a pprof string table must be the empty string.
+	std::vector<std::string> strings{""};
+	HashMap<std::string, Uptr> stringToIndexMap{{"", 0}};
+
+	U64 get(const std::string& string)
+	{
+		if(const Uptr* index = stringToIndexMap.get(string)) { return *index; }
+		const Uptr index = strings.size();
+		stringToIndexMap.addOrFail(string, index);
+		strings.push_back(string);
+		return index;
+	}
+};
+
+static std::vector<U8> encodePprof(const Profiler* profiler, Time endTime, Time endCPUTime)
+{
+	// Field numbers are from pprof's profile.proto.
+	StringTable stringTable;
+	ProtobufEncoder profile;
+
+	auto encodeValueType = [&stringTable](const char* type, const char* unit) {
+		ProtobufEncoder valueType;
+		valueType.uintField(1, stringTable.get(type));
+		valueType.uintField(2, stringTable.get(unit));
+		return valueType;
+	};
+
+	// The host may not be able to sample at the requested rate (e.g. Linux only checks CPU timers
+	// on scheduler ticks), so estimate the CPU time each sample represents from the CPU time the
+	// process used while profiling.
+	U64 numSamples = profiler->numDroppedSamples.load(std::memory_order_relaxed);
+	for(const auto& stackCount : profiler->stackCounts) { numSamples += stackCount.second; }
+	U64 periodNS = 1000000000 / profiler->samplesPerSecond;
+	if(numSamples) { periodNS = U64(endCPUTime.ns - profiler->startCPUTime.ns) / numSamples; }
+
+	// Profile.sample_type: each sample has a count and an estimate of the CPU time it represents.
+	profile.messageField(1, encodeValueType("samples", "count"));
+	profile.messageField(1, encodeValueType("cpu", "nanoseconds"));
+
+	// Profile.sample
+	for(const auto& stackCount : profiler->stackCounts)
+	{
+		ProtobufEncoder sample;
+		std::vector<U64> locationIds;
+		for(Uptr locationIndex : stackCount.first) { locationIds.push_back(locationIndex + 1); }
+		sample.packedUintField(1, locationIds);
+		sample.packedUintField(2, {stackCount.second, stackCount.second * periodNS});
+		profile.messageField(2, sample);
+	}
+
+	// Profile.location
+	for(Uptr locationIndex = 0; locationIndex < profiler->locations.size(); ++locationIndex)
+	{
+		const ProfileLocation& location = profiler->locations[locationIndex];
+		ProtobufEncoder encodedLocation;
+		encodedLocation.uintField(1, locationIndex + 1);
+		encodedLocation.uintField(3, location.ip);
+		for(const ProfileLine& line : location.lines)
+		{
+			ProtobufEncoder encodedLine;
+			encodedLine.uintField(1, line.functionIndex + 1);
+			encodedLine.uintField(2, line.line);
+			encodedLocation.messageField(4, encodedLine);
+		}
+		profile.messageField(4, encodedLocation);
+	}
+
+	// Profile.function
+	for(Uptr functionIndex = 0; functionIndex < profiler->functionNames.size(); ++functionIndex)
+	{
+		const U64 nameStringIndex = stringTable.get(profiler->functionNames[functionIndex]);
+		ProtobufEncoder function;
+		function.uintField(1, functionIndex + 1);
+		function.uintField(2, nameStringIndex);
+		function.uintField(3, nameStringIndex);
+		profile.messageField(5, function);
+	}
+
+	// Profile.time_nanos, Profile.duration_nanos, Profile.period_type, and Profile.period
+	profile.uintField(9, U64(profiler->startTime.ns));
+	profile.uintField(10, U64(endTime.ns - profiler->startTime.ns));
+	profile.messageField(11, encodeValueType("cpu", "nanoseconds"));
+	profile.uintField(12, periodNS);
+
+	// Profile.comment
+	const U64 numDroppedSamples = profiler->numDroppedSamples.load(std::memory_order_relaxed);
+	if(numDroppedSamples)
+	{
+		profile.uintField(
+			13, stringTable.get(std::to_string(numDroppedSamples) + " samples were dropped"));
+	}
+
+	// Profile.string_table must be encoded after all strings have been added to it.
+	for(const std::string& string : stringTable.strings) { profile.stringField(6, string); }
+
+	return std::move(profile.bytes);
+}
+
+bool Runtime::startProfiling(Uptr samplesPerSecond)
+{
+	WAVM_ERROR_UNLESS(samplesPerSecond > 0);
+
+	Platform::Mutex::Lock activeProfilerLock(getActiveProfilerMutex());
+	if(activeProfiler) { return false; }
+
+	Profiler* profiler = new Profiler(samplesPerSecond);
+	profiler->startTime = Platform::getClockTime(Platform::Clock::realtime);
+	profiler->startCPUTime = Platform::getClockTime(Platform::Clock::processCPUTime);
+	if(!Platform::startSampling(samplesPerSecond, captureSample, profiler))
+	{
+		delete profiler;
+		return false;
+	}
+
+	profiler->drainThread = Platform::createThread(0, drainThreadEntry, profiler);
+	activeProfiler = profiler;
+	return true;
+}
+
+std::vector<U8> Runtime::stopProfiling(ProfileFormat format)
+{
+	Platform::Mutex::Lock activeProfilerLock(getActiveProfilerMutex());
+	WAVM_ERROR_UNLESS(activeProfiler);
+	Profiler* profiler = activeProfiler;
+	activeProfiler = nullptr;
+
+	Platform::stopSampling();
+	const Time endTime = Platform::getClockTime(Platform::Clock::realtime);
+	const Time endCPUTime = Platform::getClockTime(Platform::Clock::processCPUTime);
+
+	// Stop the drain thread, and drain any samples it didn't.
+	{
+		Platform::Mutex::Lock drainLock(profiler->drainMutex);
+		profiler->isStopping = true;
+		profiler->drainCondition.signal();
+	}
+	Platform::joinThread(profiler->drainThread);
+	drainSamples(profiler);
+
+	std::vector<U8> result;
+	switch(format)
+	{
+	case ProfileFormat::foldedStacks: result = encodeFoldedStacks(profiler); break;
+	case ProfileFormat::pprof: result = encodePprof(profiler, endTime, endCPUTime); break;
+	default: WAVM_UNREACHABLE();
+	};
+
+	delete profiler;
+	return result;
+}
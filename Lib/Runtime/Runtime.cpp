@@ -67,7 +67,7 @@ void* Runtime::getUserData(const Runtime::Function* function)
 }
 const std::string& Runtime::getDebugName(const Runtime::Function* function)
 {
-	return function->mutableData->debugName;
+	return function->mutableData->getDebugName();
 }
 
 void Runtime::setUserData(Runtime::Object* object, void* userData, void (*finalizer)(void*))
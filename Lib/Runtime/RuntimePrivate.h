@@ -14,7 +14,9 @@
 #include "WAVM/Inline/DenseStaticIntSet.h"
 #include "WAVM/Inline/HashMap.h"
 #include "WAVM/Inline/IndexMap.h"
+#include "WAVM/Inline/SharedBytes.h"
 #include "WAVM/LLVMJIT/LLVMJIT.h"
+#include "WAVM/Platform/Mutex.h"
 #include "WAVM/Platform/RWMutex.h"
 #include "WAVM/Runtime/Intrinsics.h"
 #include "WAVM/Runtime/Runtime.h"
@@ -156,18 +158,53 @@ namespace WAVM { namespace Runtime {
 		~ExceptionType() override;
 	};
 
-	typedef std::vector<std::shared_ptr<std::vector<U8>>> DataSegmentVector;
+	typedef std::vector<std::shared_ptr<const SharedBytes>> DataSegmentVector;
 	typedef std::vector<std::shared_ptr<IR::ElemSegment::Contents>> ElemSegmentVector;
 
+	// The debug names of a module's function definitions for a module debug name. They are shared
+	// by the FunctionMutableData of every instance of the module with that module debug name.
+	struct FunctionDefDebugNames
+	{
+		std::vector<std::string> names;
+	};
+
 	// A compiled WebAssembly module.
 	struct Module
 	{
 		IR::Module ir;
-		std::vector<U8> objectCode;
-
-		Module(IR::Module&& inIR, std::vector<U8>&& inObjectCode)
-		: ir(inIR), objectCode(std::move(inObjectCode))
+		SharedBytes objectCode;
+
+		// The contents of the module's passive data segments, indexed by data segment index, and
+		// null for active data segments. Each instance of the module starts with a copy of this, so
+		// instantiation doesn't allocate anything for the segments.
+		DataSegmentVector passiveDataSegments;
+
+		// The module's disassembly names, and the debug names of its function definitions for each
+		// module debug name that live instances of the module were created with. They are created
+		// by the first instantiation that needs them, so later instantiations don't decode the
+		// names or allocate a debug name for each function.
+		mutable Platform::Mutex debugNamesMutex;
+		mutable std::shared_ptr<const IR::DisassemblyNames> disassemblyNames;
+		mutable HashMap<std::string, std::weak_ptr<const FunctionDefDebugNames>>
+			functionDefDebugNames;
+
+		// If the function bodies in ir were released after compiling the module, the binary module
+		// to decode them from.
+		SharedBytes releasedFunctionBodiesWASMBytes;
+
+		Module(IR::Module&& inIR,
+			   SharedBytes&& inObjectCode,
+			   SharedBytes&& inReleasedFunctionBodiesWASMBytes = SharedBytes())
+		: ir(std::move(inIR))
+		, objectCode(std::move(inObjectCode))
+		, releasedFunctionBodiesWASMBytes(std::move(inReleasedFunctionBodiesWASMBytes))
 		{
+			for(const IR::DataSegment& dataSegment : ir.dataSegments)
+			{
+				passiveDataSegments.push_back(
+					dataSegment.isActive ? nullptr
+										 : std::make_shared<const SharedBytes>(dataSegment.data));
+			}
 		}
 	};
 
@@ -355,10 +392,14 @@ namespace WAVM { namespace Runtime {
 	Table* getTableFromRuntimeData(ContextRuntimeData* contextRuntimeData, Uptr tableId);
 	Memory* getMemoryFromRuntimeData(ContextRuntimeData* contextRuntimeData, Uptr memoryId);
 
+	// Like Runtime::unwindSignalsAsExceptions, but takes a plain function pointer to avoid the
+	// cost of calling through a std::function.
+	void unwindSignalsAsExceptions(void (*thunk)(void*), void* argument);
+
 	// Initialize a data segment (equivalent to executing a memory.init instruction).
 	void initDataSegment(Instance* instance,
 						 Uptr dataSegmentIndex,
-						 const std::vector<U8>* dataVector,
+						 const SharedBytes* dataBytes,
 						 Memory* memory,
 						 Uptr destAddress,
 						 Uptr sourceOffset,
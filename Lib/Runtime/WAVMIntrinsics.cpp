@@ -35,35 +35,40 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wavmIntrinsics,
 	throwException(ExceptionTypes::invalidFloatOperation, {}, 1);
 }
 
+WAVM_DEFINE_INTRINSIC_FUNCTION(wavmIntrinsics, "stackOverflowTrap", void, stackOverflowTrap)
+{
+	throwException(ExceptionTypes::stackOverflow, {}, 1);
+}
+
 static thread_local Uptr indentLevel = 0;
 
-WAVM_DEFINE_INTRINSIC_FUNCTION(wavmIntrinsics,
-							   "debugEnterFunction",
-							   void,
-							   debugEnterFunction,
-							   const Function* function)
+WAVM_DEFINE_LEAF_INTRINSIC_FUNCTION(wavmIntrinsics,
+									"debugEnterFunction",
+									void,
+									debugEnterFunction,
+									const Function* function)
 {
 	Log::printf(Log::debug,
 				"ENTER: %*s\n",
-				U32(indentLevel * 4 + function->mutableData->debugName.size()),
-				function->mutableData->debugName.c_str());
+				U32(indentLevel * 4 + function->mutableData->getDebugName().size()),
+				function->mutableData->getDebugName().c_str());
 	++indentLevel;
 }
 
-WAVM_DEFINE_INTRINSIC_FUNCTION(wavmIntrinsics,
-							   "debugExitFunction",
-							   void,
-							   debugExitFunction,
-							   const Function* function)
+WAVM_DEFINE_LEAF_INTRINSIC_FUNCTION(wavmIntrinsics,
+									"debugExitFunction",
+									void,
+									debugExitFunction,
+									const Function* function)
 {
 	--indentLevel;
 	Log::printf(Log::debug,
 				"EXIT:  %*s\n",
-				U32(indentLevel * 4 + function->mutableData->debugName.size()),
-				function->mutableData->debugName.c_str());
+				U32(indentLevel * 4 + function->mutableData->getDebugName().size()),
+				function->mutableData->getDebugName().c_str());
 }
 
-WAVM_DEFINE_INTRINSIC_FUNCTION(wavmIntrinsics, "debugBreak", void, debugBreak)
+WAVM_DEFINE_LEAF_INTRINSIC_FUNCTION(wavmIntrinsics, "debugBreak", void, debugBreak)
 {
 	Log::printf(Log::debug, "================== wavmIntrinsics.debugBreak\n");
 }
@@ -1,6 +1,7 @@
 #include "WAVM/VFS/SandboxFS.h"
 #include <memory>
 #include <string>
+#include "WAVM/Inline/BasicTypes.h"
 #include "WAVM/Inline/Time.h"
 #include "WAVM/VFS/VFS.h"
 
@@ -63,6 +64,30 @@ struct SandboxFS : FileSystem
 		return innerFS->createDir(getInnerPath(path));
 	}
 
+	virtual Result createHardLink(const std::string& existingPath,
+								  const std::string& newPath) override
+	{
+		return innerFS->createHardLink(getInnerPath(existingPath), getInnerPath(newPath));
+	}
+
+	virtual Result createSymbolicLink(const std::string& targetPath,
+									  const std::string& linkPath) override
+	{
+		// The target path is interpreted by the inner file system when the link is followed, so
+		// only allow links that can't escape the sandbox's root: the target path must be relative,
+		// and may not contain any .. components. This ensures that a link can only point to a path
+		// beneath the directory that contains it, so any chain of links created in the sandbox
+		// stays within it.
+		if(!isDescendantPath(targetPath)) { return Result::notPermitted; }
+
+		return innerFS->createSymbolicLink(targetPath, getInnerPath(linkPath));
+	}
+
+	virtual Result readSymbolicLink(const std::string& path, std::string& outTargetPath) override
+	{
+		return innerFS->readSymbolicLink(getInnerPath(path), outTargetPath);
+	}
+
 private:
 	VFS::FileSystem* innerFS;
 	std::string rootPath;
@@ -71,6 +96,27 @@ private:
 	{
 		return rootPath + absolutePathName;
 	}
+
+	static bool isDescendantPath(const std::string& path)
+	{
+		if(path.empty() || path[0] == '/' || path[0] == '\\') { return false; }
+
+		Uptr componentStart = 0;
+		while(componentStart <= path.size())
+		{
+			Uptr componentEnd = path.find_first_of("/\\", componentStart);
+			if(componentEnd == std::string::npos) { componentEnd = path.size(); }
+
+			// Reject .. components, and components that a Windows inner file system would
+			// interpret as a drive letter.
+			const std::string component
+				= path.substr(componentStart, componentEnd - componentStart);
+			if(component == ".." || component.find(':') != std::string::npos) { return false; }
+
+			componentStart = componentEnd + 1;
+		}
+		return true;
+	}
 };
 
 std::shared_ptr<FileSystem> VFS::makeSandboxFS(FileSystem* innerFS,
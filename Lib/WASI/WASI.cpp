@@ -1,4 +1,6 @@
 #include "WAVM/WASI/WASI.h"
+#include <cinttypes>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <string>
@@ -9,9 +11,11 @@
 #include "WAVM/Inline/Assert.h"
 #include "WAVM/Inline/BasicTypes.h"
 #include "WAVM/Inline/Errors.h"
-#include "WAVM/Inline/IndexMap.h"
+#include "WAVM/Inline/I128.h"
 #include "WAVM/Logging/Logging.h"
 #include "WAVM/Platform/Clock.h"
+#include "WAVM/Platform/File.h"
+#include "WAVM/Platform/Mutex.h"
 #include "WAVM/Platform/Random.h"
 #include "WAVM/Platform/Thread.h"
 #include "WAVM/Runtime/Intrinsics.h"
@@ -58,6 +62,38 @@ bool ProcessResolver::resolve(const std::string& moduleName,
 	return false;
 }
 
+// Takes a reactor from the process's pool of idle reactors, and returns it to the pool when the
+// poll is done.
+struct PooledReactor
+{
+	PooledReactor(Process* inProcess) : process(inProcess)
+	{
+		Platform::Mutex::Lock idleReactorsLock(process->idleReactorsMutex);
+		if(process->idleReactors.size())
+		{
+			reactor = std::move(process->idleReactors.back());
+			process->idleReactors.pop_back();
+		}
+		else
+		{
+			idleReactorsLock.unlock();
+			reactor = Platform::createReactor();
+		}
+	}
+
+	~PooledReactor()
+	{
+		Platform::Mutex::Lock idleReactorsLock(process->idleReactorsMutex);
+		process->idleReactors.push_back(std::move(reactor));
+	}
+
+	VFS::Reactor* operator->() const { return reactor.get(); }
+
+private:
+	Process* process;
+	std::unique_ptr<VFS::Reactor> reactor;
+};
+
 WAVM_DEFINE_INTRINSIC_FUNCTION(wasi,
 							   "poll_oneoff",
 							   __wasi_errno_return_t,
@@ -67,18 +103,189 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wasi,
 							   WASIAddress numSubscriptions,
 							   WASIAddress outNumEventsAddress)
 {
-	UNIMPLEMENTED_SYSCALL("poll_oneoff",
-						  "(" WASIADDRESS_FORMAT ", " WASIADDRESS_FORMAT ", %u, " WASIADDRESS_FORMAT
-						  ")",
-						  inAddress,
-						  outAddress,
-						  numSubscriptions,
-						  outNumEventsAddress);
+	TRACE_SYSCALL("poll_oneoff",
+				  "(" WASIADDRESS_FORMAT ", " WASIADDRESS_FORMAT ", %u, " WASIADDRESS_FORMAT ")",
+				  inAddress,
+				  outAddress,
+				  numSubscriptions,
+				  outNumEventsAddress);
+
+	Process* process = getProcessFromContextRuntimeData(contextRuntimeData);
+
+	if(numSubscriptions == 0) { return TRACE_SYSCALL_RETURN(__WASI_EINVAL); }
+
+	const __wasi_subscription_t* subscriptions
+		= memoryArrayPtr<__wasi_subscription_t>(process->memory, inAddress, numSubscriptions);
+	__wasi_event_t* events
+		= memoryArrayPtr<__wasi_event_t>(process->memory, outAddress, numSubscriptions);
+
+	// Translate the subscriptions: clock subscriptions are translated to a monotonic clock
+	// deadline, and FD subscriptions to a reactor entry. Subscriptions that fail are immediately
+	// reported as an event with an error.
+	const I128 startTime = Platform::getClockTime(Platform::Clock::monotonic).ns;
+	I128 earliestDeadline = I128::nan();
+	std::vector<I128> clockDeadlines(numSubscriptions, I128::nan());
+	std::vector<LockedFDE> lockedFDEs;
+	std::vector<VFS::PollEntry> pollEntries;
+	std::vector<Uptr> pollEntrySubscriptionIndices;
+	std::vector<__wasi_errno_t> subscriptionErrors(numSubscriptions, __WASI_ESUCCESS);
+	Uptr numFailedSubscriptions = 0;
+	for(Uptr subscriptionIndex = 0; subscriptionIndex < numSubscriptions; ++subscriptionIndex)
+	{
+		const __wasi_subscription_t subscription = subscriptions[subscriptionIndex];
+		switch(subscription.type)
+		{
+		case __WASI_EVENTTYPE_CLOCK: {
+			TRACE_SYSCALL_FLOW("Subscription[%" WAVM_PRIuPTR "]=(clock %u, timeout=%" PRIu64
+							   ", flags=0x%04x)",
+							   subscriptionIndex,
+							   subscription.u.clock.clock_id,
+							   subscription.u.clock.timeout,
+							   subscription.u.clock.flags);
+
+			I128 relativeTimeout = I128(subscription.u.clock.timeout);
+			if(subscription.u.clock.flags & __WASI_SUBSCRIPTION_CLOCK_ABSTIME)
+			{
+				switch(subscription.u.clock.clock_id)
+				{
+				case __WASI_CLOCK_REALTIME:
+					relativeTimeout -= Platform::getClockTime(Platform::Clock::realtime).ns;
+					break;
+				case __WASI_CLOCK_MONOTONIC: relativeTimeout -= startTime; break;
+				default: subscriptionErrors[subscriptionIndex] = __WASI_EINVAL; break;
+				};
+			}
+			else if(subscription.u.clock.clock_id != __WASI_CLOCK_REALTIME
+					&& subscription.u.clock.clock_id != __WASI_CLOCK_MONOTONIC)
+			{
+				subscriptionErrors[subscriptionIndex] = __WASI_EINVAL;
+			}
+
+			if(subscriptionErrors[subscriptionIndex] != __WASI_ESUCCESS)
+			{
+				++numFailedSubscriptions;
+			}
+			else
+			{
+				clockDeadlines[subscriptionIndex] = startTime + relativeTimeout;
+				if(isNaN(earliestDeadline) || clockDeadlines[subscriptionIndex] < earliestDeadline)
+				{
+					earliestDeadline = clockDeadlines[subscriptionIndex];
+				}
+			}
+			break;
+		}
+		case __WASI_EVENTTYPE_FD_READ:
+		case __WASI_EVENTTYPE_FD_WRITE: {
+			TRACE_SYSCALL_FLOW("Subscription[%" WAVM_PRIuPTR "]=(fd_%s %u)",
+							   subscriptionIndex,
+							   subscription.type == __WASI_EVENTTYPE_FD_READ ? "read" : "write",
+							   subscription.u.fd_readwrite.fd);
+
+			LockedFDE lockedFDE = getLockedFDE(
+				process, subscription.u.fd_readwrite.fd, __WASI_RIGHT_POLL_FD_READWRITE, 0);
+			if(lockedFDE.error != __WASI_ESUCCESS)
+			{
+				subscriptionErrors[subscriptionIndex] = lockedFDE.error;
+				++numFailedSubscriptions;
+				break;
+			}
+
+			VFS::PollEntry pollEntry;
+			pollEntry.vfd = lockedFDE.fde->vfd;
+			pollEntry.waitForRead = subscription.type == __WASI_EVENTTYPE_FD_READ;
+			pollEntry.waitForWrite = subscription.type == __WASI_EVENTTYPE_FD_WRITE;
+			pollEntries.push_back(pollEntry);
+			pollEntrySubscriptionIndices.push_back(subscriptionIndex);
+			lockedFDEs.push_back(std::move(lockedFDE));
+			break;
+		}
+		default:
+			subscriptionErrors[subscriptionIndex] = __WASI_EINVAL;
+			++numFailedSubscriptions;
+			break;
+		};
+	}
+
+	// Wait for one of the FDs to be ready, or for the earliest clock deadline.
+	PooledReactor reactor(process);
+	Uptr numReadyEntries = 0;
+	while(true)
+	{
+		Time timeout = Time::infinity();
+		if(numFailedSubscriptions) { timeout.ns = 0; }
+		else if(!isNaN(earliestDeadline))
+		{
+			timeout.ns = earliestDeadline - Platform::getClockTime(Platform::Clock::monotonic).ns;
+			if(timeout.ns < 0) { timeout.ns = 0; }
+		}
+
+		const VFS::Result result
+			= reactor->poll(pollEntries.data(), pollEntries.size(), timeout, numReadyEntries);
+		if(result == VFS::Result::interruptedBySignal) { continue; }
+		else if(result != VFS::Result::success)
+		{
+			return TRACE_SYSCALL_RETURN(asWASIErrNo(result));
+		}
+
+		if(numReadyEntries || numFailedSubscriptions || isNaN(earliestDeadline)) { break; }
+		if(Platform::getClockTime(Platform::Clock::monotonic).ns >= earliestDeadline) { break; }
+	}
+
+	// Write the events for failed subscriptions, expired clocks, and ready FDs.
+	const I128 endTime = Platform::getClockTime(Platform::Clock::monotonic).ns;
+	Uptr numEvents = 0;
+	auto addEvent = [&](Uptr subscriptionIndex,
+						__wasi_errno_t error,
+						__wasi_eventrwflags_t flags) {
+		__wasi_event_t event;
+		memset(&event, 0, sizeof(event));
+		event.userdata = subscriptions[subscriptionIndex].userdata;
+		event.error = error;
+		event.type = subscriptions[subscriptionIndex].type;
+		event.u.fd_readwrite.nbytes = 0;
+		event.u.fd_readwrite.flags = flags;
+		events[numEvents++] = event;
+	};
+	for(Uptr subscriptionIndex = 0; subscriptionIndex < numSubscriptions; ++subscriptionIndex)
+	{
+		if(subscriptionErrors[subscriptionIndex] != __WASI_ESUCCESS)
+		{
+			addEvent(subscriptionIndex, subscriptionErrors[subscriptionIndex], 0);
+		}
+		else if(!isNaN(clockDeadlines[subscriptionIndex])
+				&& endTime >= clockDeadlines[subscriptionIndex])
+		{
+			addEvent(subscriptionIndex, __WASI_ESUCCESS, 0);
+		}
+	}
+	for(Uptr entryIndex = 0; entryIndex < pollEntries.size(); ++entryIndex)
+	{
+		const VFS::PollEntry& pollEntry = pollEntries[entryIndex];
+		if(pollEntry.error != VFS::Result::success)
+		{
+			addEvent(pollEntrySubscriptionIndices[entryIndex], asWASIErrNo(pollEntry.error), 0);
+		}
+		else if(pollEntry.readable || pollEntry.writable)
+		{
+			addEvent(pollEntrySubscriptionIndices[entryIndex],
+					 __WASI_ESUCCESS,
+					 pollEntry.hangup ? __WASI_EVENT_FD_READWRITE_HANGUP : 0);
+		}
+	}
+
+	memoryRef<WASIAddress>(process->memory, outNumEventsAddress) = WASIAddress(numEvents);
+
+	return TRACE_SYSCALL_RETURN(__WASI_ESUCCESS, "(%" WAVM_PRIuPTR " events)", numEvents);
 }
 
 WAVM_DEFINE_INTRINSIC_FUNCTION(wasi, "proc_exit", void, wasi_proc_exit, __wasi_exitcode_t exitCode)
 {
 	TRACE_SYSCALL("proc_exit", "(%u)", exitCode);
+
+	Process* process = getProcessFromContextRuntimeData(contextRuntimeData);
+	flushProcessStdio(*process);
+
 	throw ExitException{exitCode};
 }
 
@@ -118,57 +325,6 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wasi,
 	return TRACE_SYSCALL_RETURN(result);
 }
 
-WAVM_DEFINE_INTRINSIC_FUNCTION(wasi,
-							   "sock_recv",
-							   __wasi_errno_return_t,
-							   wasi_sock_recv,
-							   __wasi_fd_t sock,
-							   WASIAddress ri_data,
-							   WASIAddress ri_data_len,
-							   __wasi_riflags_t ri_flags,
-							   WASIAddress ro_datalen,
-							   WASIAddress ro_flags)
-{
-	UNIMPLEMENTED_SYSCALL("sock_recv",
-						  "(%u, " WASIADDRESS_FORMAT ", %u, 0x%04x, " WASIADDRESS_FORMAT
-						  ", " WASIADDRESS_FORMAT ")",
-						  sock,
-						  ri_data,
-						  ri_data_len,
-						  ri_flags,
-						  ro_datalen,
-						  ro_flags);
-}
-
-WAVM_DEFINE_INTRINSIC_FUNCTION(wasi,
-							   "sock_send",
-							   __wasi_errno_return_t,
-							   wasi_sock_send,
-							   __wasi_fd_t sock,
-							   WASIAddress si_data,
-							   WASIAddress si_data_len,
-							   __wasi_siflags_t si_flags,
-							   WASIAddress so_datalen)
-{
-	UNIMPLEMENTED_SYSCALL("sock_send",
-						  "(%u, " WASIADDRESS_FORMAT ", %u, 0x%04x, " WASIADDRESS_FORMAT ")",
-						  sock,
-						  si_data,
-						  si_data_len,
-						  si_flags,
-						  so_datalen);
-}
-
-WAVM_DEFINE_INTRINSIC_FUNCTION(wasi,
-							   "sock_shutdown",
-							   __wasi_errno_return_t,
-							   wasi_sock_shutdown,
-							   __wasi_fd_t sock,
-							   __wasi_sdflags_t how)
-{
-	UNIMPLEMENTED_SYSCALL("sock_shutdown", "(%u, 0x%02x)", sock, how);
-}
-
 WAVM_DEFINE_INTRINSIC_FUNCTION(wasi, "sched_yield", __wasi_errno_return_t, wasi_sched_yield)
 {
 	TRACE_SYSCALL("sched_yield", "()");
@@ -178,8 +334,8 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wasi, "sched_yield", __wasi_errno_return_t, wasi_
 
 WASI::Process::~Process()
 {
-	for(const std::shared_ptr<WASI::FDE>& fde : fdMap)
-	{
+	// No other threads can be using the process's FDs, so they may be deleted immediately.
+	fdTable.removeAll([](FDE* fde) {
 		VFS::Result result = fde->close();
 		if(result != VFS::Result::success)
 		{
@@ -187,7 +343,8 @@ WASI::Process::~Process()
 						"Error while closing file because of process exit: %s\n",
 						VFS::describeResult(result));
 		}
-	}
+		delete fde;
+	});
 }
 
 std::shared_ptr<Process> WASI::createProcess(Runtime::Compartment* compartment,
@@ -196,12 +353,15 @@ std::shared_ptr<Process> WASI::createProcess(Runtime::Compartment* compartment,
 											 VFS::FileSystem* fileSystem,
 											 VFS::VFD* stdIn,
 											 VFS::VFD* stdOut,
-											 VFS::VFD* stdErr)
+											 VFS::VFD* stdErr,
+											 const StdioConfig& stdioConfig)
 {
 	std::shared_ptr<Process> process = std::make_shared<Process>();
 	process->args = std::move(inArgs);
 	process->envs = std::move(inEnvs);
 	process->fileSystem = fileSystem;
+	process->stdio.config = stdioConfig;
+	process->stdio.captureRing.resize(stdioConfig.numCaptureBytes);
 
 	process->compartment = compartment;
 	setUserData(process->compartment, process.get(), nullptr);
@@ -217,13 +377,29 @@ std::shared_ptr<Process> WASI::createProcess(Runtime::Compartment* compartment,
 	process->resolver.moduleNameToInstanceMap.set("wasi_unstable", wasi_snapshot_preview1);
 	process->resolver.moduleNameToInstanceMap.set("wasi_snapshot_preview1", wasi_snapshot_preview1);
 
+	Instance* wavm_wasi_file_mapping = Intrinsics::instantiateModule(
+		compartment, {WAVM_INTRINSIC_MODULE_REF(wasiFileMapping)}, "wavm_wasi_file_mapping");
+	process->resolver.moduleNameToInstanceMap.set("wavm_wasi_file_mapping", wavm_wasi_file_mapping);
+
 	__wasi_rights_t stdioRights = __WASI_RIGHT_FD_READ | __WASI_RIGHT_FD_FDSTAT_SET_FLAGS
 								  | __WASI_RIGHT_FD_WRITE | __WASI_RIGHT_FD_FILESTAT_GET
 								  | __WASI_RIGHT_POLL_FD_READWRITE;
 
-	process->fdMap.insertOrFail(0, std::make_shared<FDE>(stdIn, stdioRights, 0, "/dev/stdin"));
-	process->fdMap.insertOrFail(1, std::make_shared<FDE>(stdOut, stdioRights, 0, "/dev/stdout"));
-	process->fdMap.insertOrFail(2, std::make_shared<FDE>(stdErr, stdioRights, 0, "/dev/stderr"));
+	Platform::Mutex::Lock fdTableLock(process->fdTable.mutex);
+	process->fdTable.insertOrFail(0, new FDE(stdIn, stdioRights, 0, "/dev/stdin"));
+	// Buffered stdout and stderr may be flushed with fd_sync and fd_datasync.
+	__wasi_rights_t stdOutputRights = stdioRights;
+	if(stdioConfig.buffering != StdioBuffering::none)
+	{
+		stdOutputRights |= __WASI_RIGHT_FD_SYNC | __WASI_RIGHT_FD_DATASYNC;
+	}
+
+	process->fdTable.insertOrFail(
+		1,
+		new FDE(wrapStdOutputVFD(process->stdio, stdOut), stdOutputRights, 0, "/dev/stdout"));
+	process->fdTable.insertOrFail(
+		2,
+		new FDE(wrapStdOutputVFD(process->stdio, stdErr), stdOutputRights, 0, "/dev/stderr"));
 
 	if(fileSystem)
 	{
@@ -241,16 +417,16 @@ std::shared_ptr<Process> WASI::createProcess(Runtime::Compartment* compartment,
 							   VFS::describeResult(openResult));
 			}
 
-			process->fdMap.insertOrFail(
-				3 + __wasi_fd_t(aliasIndex),
-				std::make_shared<FDE>(rootFD,
-									  DIRECTORY_RIGHTS,
-									  INHERITING_DIRECTORY_RIGHTS,
-									  preopenedRootAliases[aliasIndex],
-									  true,
-									  __wasi_preopentype_t(__WASI_PREOPENTYPE_DIR)));
+			process->fdTable.insertOrFail(3 + __wasi_fd_t(aliasIndex),
+										  new FDE(rootFD,
+												  DIRECTORY_RIGHTS,
+												  INHERITING_DIRECTORY_RIGHTS,
+												  preopenedRootAliases[aliasIndex],
+												  true,
+												  __wasi_preopentype_t(__WASI_PREOPENTYPE_DIR)));
 		}
 	}
+	fdTableLock.unlock();
 
 	process->processClockOrigin = Platform::getClockTime(Platform::Clock::processCPUTime);
 
@@ -268,6 +444,15 @@ Process* WASI::getProcessFromContextRuntimeData(Runtime::ContextRuntimeData* con
 Memory* WASI::getProcessMemory(const Process& process) { return process.memory; }
 void WASI::setProcessMemory(Process& process, Memory* memory) { process.memory = memory; }
 
+U32 WASI::addProcessListeningSocket(Process& process, VFS::VFD* socketVFD, std::string&& address)
+{
+	Platform::Mutex::Lock fdTableLock(process.fdTable.mutex);
+	const __wasi_fd_t fd = process.fdTable.add(
+		new FDE(socketVFD, LISTENING_SOCKET_RIGHTS, SOCKET_RIGHTS, std::move(address)));
+	WAVM_ERROR_UNLESS(fd != UINT32_MAX);
+	return fd;
+}
+
 I32 WASI::catchExit(std::function<I32()>&& thunk)
 {
 	try
@@ -0,0 +1,258 @@
+#include <atomic>
+#include <vector>
+#include "./WASIFDTable.h"
+#include "./WASIPrivate.h"
+#include "WAVM/Inline/Assert.h"
+#include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Platform/Mutex.h"
+
+using namespace WAVM;
+using namespace WAVM::WASI;
+
+// Epoch-based reclamation: each thread that enters an EpochGuard publishes the table it entered
+// the guard for, and the table's epoch when it entered it. An FDE retired from a table in epoch N
+// may be deleted once no thread is in an epoch <= N of that table.
+//
+// Each table has its own epoch and retired list, but the list of thread records is shared by all
+// tables, since a thread is only in one table's guard at a time. Retiring FDEs is rare compared to
+// looking them up, so each table's retired list is simply protected by a mutex.
+
+static constexpr U64 quiescentEpoch = 0;
+
+struct alignas(64) ThreadEpochRecord
+{
+	// The epoch the thread entered its outermost guard in, or quiescentEpoch if it isn't in a
+	// guard. Only written by the thread that owns the record.
+	std::atomic<U64> epoch{quiescentEpoch};
+
+	// The table the thread entered its outermost guard for. Written by the owning thread before it
+	// publishes the epoch, and not cleared when the guard is exited.
+	std::atomic<const FDTable*> table{nullptr};
+
+	// Whether a thread owns this record. Records are reused after their thread exits.
+	std::atomic<bool> isOwned{true};
+
+	ThreadEpochRecord* next{nullptr};
+
+	// Only accessed by the owning thread.
+	Uptr guardDepth{0};
+};
+
+static std::atomic<ThreadEpochRecord*> threadRecordListHead{nullptr};
+
+static ThreadEpochRecord* acquireThreadRecord()
+{
+	// Try to reuse a record that was released by a thread that exited.
+	for(ThreadEpochRecord* record = threadRecordListHead.load(std::memory_order_acquire); record;
+		record = record->next)
+	{
+		bool expectedIsOwned = false;
+		if(!record->isOwned.load(std::memory_order_relaxed)
+		   && record->isOwned.compare_exchange_strong(expectedIsOwned, true))
+		{
+			return record;
+		}
+	}
+
+	// Allocate a new record, and push it on the list. Records are never freed.
+	ThreadEpochRecord* record = new ThreadEpochRecord;
+	ThreadEpochRecord* head = threadRecordListHead.load(std::memory_order_relaxed);
+	do
+	{
+		record->next = head;
+	} while(!threadRecordListHead.compare_exchange_weak(
+		head, record, std::memory_order_release, std::memory_order_relaxed));
+	return record;
+}
+
+struct ThreadRecordOwner
+{
+	ThreadEpochRecord* record = acquireThreadRecord();
+
+	~ThreadRecordOwner()
+	{
+		WAVM_ASSERT(!record->guardDepth);
+		record->isOwned.store(false, std::memory_order_release);
+	}
+};
+
+static ThreadEpochRecord* getThreadRecord()
+{
+	thread_local ThreadRecordOwner owner;
+	return owner.record;
+}
+
+void EpochGuard::enter(FDTable& inTable)
+{
+	WAVM_ASSERT(!table);
+	table = &inTable;
+
+	ThreadEpochRecord* record = getThreadRecord();
+	if(record->guardDepth++)
+	{
+		WAVM_ASSERT(record->table.load(std::memory_order_relaxed) == table);
+		return;
+	}
+
+	// Publish the table and its epoch, and make sure the publication is visible to threads
+	// retiring FDEs before this thread reads any FDTable slots. The epoch is stored with release
+	// semantics, so a thread that reads it also sees the table it is for.
+	record->table.store(table, std::memory_order_relaxed);
+	record->epoch.store(table->epoch.load(std::memory_order_relaxed), std::memory_order_release);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void EpochGuard::exit()
+{
+	if(!table) { return; }
+	table = nullptr;
+
+	ThreadEpochRecord* record = getThreadRecord();
+	WAVM_ASSERT(record->guardDepth);
+	if(--record->guardDepth) { return; }
+
+	record->epoch.store(quiescentEpoch, std::memory_order_release);
+}
+
+void FDTable::retire(FDE* fde)
+{
+	WAVM_ASSERT(!fde->vfd);
+
+	// Make the removal of the FDE from the table visible to threads entering a guard before
+	// reading the thread records.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	// Retire the FDE in the current epoch, and advance the epoch so that threads entering guards
+	// after this can be distinguished from threads that might have seen the FDE.
+	const U64 retireEpoch = epoch.fetch_add(1, std::memory_order_acq_rel);
+
+	// Find the oldest epoch of this table that any thread is in. If a thread's record is read
+	// while the thread is switching to a guard for another table, it may be attributed to the
+	// wrong table, but only once the thread has exited its guard for the first table.
+	U64 oldestActiveEpoch = UINT64_MAX;
+	for(ThreadEpochRecord* record = threadRecordListHead.load(std::memory_order_acquire); record;
+		record = record->next)
+	{
+		const U64 recordEpoch = record->epoch.load(std::memory_order_acquire);
+		if(recordEpoch != quiescentEpoch && recordEpoch < oldestActiveEpoch
+		   && record->table.load(std::memory_order_relaxed) == this)
+		{
+			oldestActiveEpoch = recordEpoch;
+		}
+	}
+
+	// Delete the retired FDEs that no thread can be using, and add this FDE to the retired list.
+	std::vector<FDE*> deletableFDEs;
+	{
+		Platform::Mutex::Lock retiredFDEsLock(retiredFDEsMutex);
+		retiredFDEs.push_back({fde, retireEpoch});
+
+		Uptr numRemainingFDEs = 0;
+		for(const RetiredFDE& retiredFDE : retiredFDEs)
+		{
+			if(retiredFDE.epoch < oldestActiveEpoch) { deletableFDEs.push_back(retiredFDE.fde); }
+			else
+			{
+				retiredFDEs[numRemainingFDEs++] = retiredFDE;
+			}
+		}
+		retiredFDEs.resize(numRemainingFDEs);
+	}
+
+	for(FDE* deletableFDE : deletableFDEs) { delete deletableFDE; }
+}
+
+FDTable::FDTable() : numFDs(0), lastAllocatedFD(maxFDs - 1), epoch(quiescentEpoch + 1)
+{
+	for(Uptr segmentIndex = 0; segmentIndex < maxSegments; ++segmentIndex)
+	{
+		segments[segmentIndex].store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+FDTable::~FDTable()
+{
+	// No thread can be in a guard for the table while it's being destroyed, so the FDEs that are
+	// still waiting to be deleted can be deleted now.
+	for(const RetiredFDE& retiredFDE : retiredFDEs) { delete retiredFDE.fde; }
+
+	for(Uptr segmentIndex = 0; segmentIndex < maxSegments; ++segmentIndex)
+	{
+		Segment* segment = segments[segmentIndex].load(std::memory_order_relaxed);
+		if(segment)
+		{
+			for(Uptr fdIndex = 0; fdIndex < numFDsPerSegment; ++fdIndex)
+			{
+				WAVM_ASSERT(!segment->fdes[fdIndex].load(std::memory_order_relaxed));
+			}
+			delete segment;
+		}
+	}
+}
+
+std::atomic<FDE*>& FDTable::getSlot(__wasi_fd_t fd)
+{
+	WAVM_ASSERT(fd < maxFDs);
+	std::atomic<Segment*>& segmentPointer = segments[fd / numFDsPerSegment];
+	Segment* segment = segmentPointer.load(std::memory_order_relaxed);
+	if(!segment)
+	{
+		segment = new Segment;
+		segmentPointer.store(segment, std::memory_order_release);
+	}
+	return segment->fdes[fd % numFDsPerSegment];
+}
+
+__wasi_fd_t FDTable::add(FDE* fde)
+{
+	WAVM_ASSERT_MUTEX_IS_LOCKED_BY_CURRENT_THREAD(mutex);
+
+	// If all FDs are allocated, return failure.
+	if(numFDs >= maxFDs) { return UINT32_MAX; }
+
+	// Starting from the FD after the last FD to be allocated, check FDs sequentially until one is
+	// found that isn't allocated.
+	do
+	{
+		++lastAllocatedFD;
+		if(lastAllocatedFD >= maxFDs) { lastAllocatedFD = 0; }
+	} while(get(lastAllocatedFD));
+
+	insertOrFail(lastAllocatedFD, fde);
+	return lastAllocatedFD;
+}
+
+void FDTable::insertOrFail(__wasi_fd_t fd, FDE* fde)
+{
+	WAVM_ASSERT_MUTEX_IS_LOCKED_BY_CURRENT_THREAD(mutex);
+	WAVM_ASSERT(fde);
+
+	std::atomic<FDE*>& slot = getSlot(fd);
+	WAVM_ERROR_UNLESS(!slot.load(std::memory_order_relaxed));
+	slot.store(fde, std::memory_order_release);
+	++numFDs;
+}
+
+void FDTable::removeOrFail(__wasi_fd_t fd)
+{
+	WAVM_ASSERT_MUTEX_IS_LOCKED_BY_CURRENT_THREAD(mutex);
+
+	std::atomic<FDE*>& slot = getSlot(fd);
+	WAVM_ERROR_UNLESS(slot.load(std::memory_order_relaxed));
+	slot.store(nullptr, std::memory_order_release);
+	--numFDs;
+}
+
+void FDTable::moveOrFail(__wasi_fd_t fromFD, __wasi_fd_t toFD)
+{
+	WAVM_ASSERT_MUTEX_IS_LOCKED_BY_CURRENT_THREAD(mutex);
+
+	std::atomic<FDE*>& fromSlot = getSlot(fromFD);
+	std::atomic<FDE*>& toSlot = getSlot(toFD);
+	FDE* fde = fromSlot.load(std::memory_order_relaxed);
+	WAVM_ERROR_UNLESS(fde);
+	WAVM_ERROR_UNLESS(!toSlot.load(std::memory_order_relaxed));
+
+	toSlot.store(fde, std::memory_order_release);
+	fromSlot.store(nullptr, std::memory_order_release);
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "WAVM/Inline/Assert.h"
+#include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Platform/Mutex.h"
+#include "WAVM/WASI/WASIABI.h"
+
+namespace WAVM { namespace WASI {
+	struct FDE;
+	struct FDTable;
+
+	// Keeps the FDEs that were in an FDTable when the guard was entered from being deleted until
+	// the guard is exited. Guards may be nested if they are for the same table, and are cheap to
+	// enter: entering one writes the table's current epoch to a record owned by the calling thread,
+	// so threads entering guards don't contend with each other.
+	// Guards should only be held briefly: while a thread is in a guard, the FDEs retired from the
+	// table can't be deleted.
+	struct EpochGuard
+	{
+		EpochGuard() : table(nullptr) {}
+		~EpochGuard() { exit(); }
+
+		EpochGuard(const EpochGuard&) = delete;
+		EpochGuard& operator=(const EpochGuard&) = delete;
+
+		void enter(FDTable& inTable);
+		void exit();
+
+	private:
+		FDTable* table;
+	};
+
+	// A fixed-capacity table mapping WASI FDs to FDEs. Lookups don't take any locks or modify any
+	// shared memory: they must be done while an EpochGuard is entered, which keeps the FDE from
+	// being deleted if it is concurrently removed from the table. Modifications of the table must
+	// be done while holding the table's mutex.
+	struct FDTable
+	{
+		static constexpr Uptr numFDsPerSegment = 1024;
+		static constexpr Uptr maxSegments = 1024;
+		static constexpr Uptr maxFDs = numFDsPerSegment * maxSegments;
+
+		FDTable();
+		~FDTable();
+
+		FDTable(const FDTable&) = delete;
+		FDTable& operator=(const FDTable&) = delete;
+
+		// Looks up an FD. The calling thread must have entered an EpochGuard, and the returned
+		// FDE is only valid until the guard is exited.
+		FDE* get(__wasi_fd_t fd) const
+		{
+			if(fd >= maxFDs) { return nullptr; }
+			const Segment* segment
+				= segments[fd / numFDsPerSegment].load(std::memory_order_acquire);
+			if(!segment) { return nullptr; }
+			return segment->fdes[fd % numFDsPerSegment].load(std::memory_order_acquire);
+		}
+
+		Platform::Mutex mutex;
+
+		// Adds an FDE to the table at an unused FD. FDs are allocated sequentially, wrapping back
+		// to 0 after the last FD, so recently closed FDs aren't immediately reused. If the table
+		// is full, returns UINT32_MAX.
+		__wasi_fd_t add(FDE* fde);
+
+		// Adds an FDE to the table at a specific FD, which must not already be in use.
+		void insertOrFail(__wasi_fd_t fd, FDE* fde);
+
+		// Removes the FDE at an FD from the table. The caller is responsible for closing the FDE
+		// and passing it to retireFDE.
+		void removeOrFail(__wasi_fd_t fd);
+
+		// Moves the FDE at fromFD to toFD, which must not be in use.
+		void moveOrFail(__wasi_fd_t fromFD, __wasi_fd_t toFD);
+
+		// Defers deleting a closed FDE that has been removed from the table until no thread can
+		// still be using it. FDEs that are still retired when the table is destroyed are deleted
+		// then.
+		void retire(FDE* fde);
+
+		// Removes all FDEs from the table, and calls visit on each of them. Only safe to call when
+		// no other thread is accessing the table.
+		template<typename Visitor> void removeAll(Visitor&& visit)
+		{
+			for(Uptr segmentIndex = 0; segmentIndex < maxSegments; ++segmentIndex)
+			{
+				Segment* segment = segments[segmentIndex].load(std::memory_order_relaxed);
+				if(!segment) { continue; }
+				for(Uptr fdIndex = 0; fdIndex < numFDsPerSegment; ++fdIndex)
+				{
+					FDE* fde = segment->fdes[fdIndex].exchange(nullptr, std::memory_order_relaxed);
+					if(fde) { visit(fde); }
+				}
+			}
+			numFDs = 0;
+		}
+
+	private:
+		friend struct EpochGuard;
+
+		struct RetiredFDE
+		{
+			FDE* fde;
+			U64 epoch;
+		};
+
+		struct Segment
+		{
+			std::atomic<FDE*> fdes[numFDsPerSegment];
+
+			Segment()
+			{
+				for(Uptr fdIndex = 0; fdIndex < numFDsPerSegment; ++fdIndex)
+				{
+					fdes[fdIndex].store(nullptr, std::memory_order_relaxed);
+				}
+			}
+		};
+
+		// Segments are allocated when an FD in them is first used, and aren't freed until the table
+		// is destroyed.
+		std::atomic<Segment*> segments[maxSegments];
+
+		Uptr numFDs;
+		__wasi_fd_t lastAllocatedFD;
+
+		// The table's reclamation epoch, and the FDEs removed from it that are waiting to be
+		// deleted. Each table has its own epochs, so a thread that stays in one table's guard
+		// doesn't stop other tables' FDEs from being deleted.
+		std::atomic<U64> epoch;
+		Platform::Mutex retiredFDEsMutex;
+		std::vector<RetiredFDE> retiredFDEs;
+
+		std::atomic<FDE*>& getSlot(__wasi_fd_t fd);
+	};
+}}
@@ -29,7 +29,7 @@ namespace WAVM { namespace WASI {
 	WAVM_DEFINE_INTRINSIC_MODULE(wasiFile)
 }}
 
-static __wasi_errno_t asWASIErrNo(VFS::Result result)
+__wasi_errno_t WASI::asWASIErrNo(VFS::Result result)
 {
 	switch(result)
 	{
@@ -64,10 +64,18 @@ static __wasi_errno_t asWASIErrNo(VFS::Result result)
 	case Result::isDirectory: return __WASI_EISDIR;
 	case Result::isNotDirectory: return __WASI_ENOTDIR;
 	case Result::isNotEmpty: return __WASI_ENOTEMPTY;
+	case Result::isNotSymbolicLink: return __WASI_EINVAL;
+	case Result::crossesDevices: return __WASI_EXDEV;
 	case Result::brokenPipe: return __WASI_EPIPE;
 	case Result::missingDevice: return __WASI_ENXIO;
 	case Result::busy: return __WASI_EBUSY;
 	case Result::notSupported: return __WASI_ENOTSUP;
+	case Result::notSocket: return __WASI_ENOTSOCK;
+	case Result::notConnected: return __WASI_ENOTCONN;
+	case Result::connectionRefused: return __WASI_ECONNREFUSED;
+	case Result::connectionReset: return __WASI_ECONNRESET;
+	case Result::addressInUse: return __WASI_EADDRINUSE;
+	case Result::invalidAddress: return __WASI_EINVAL;
 
 	default: WAVM_UNREACHABLE();
 	};
@@ -78,51 +86,40 @@ static __wasi_timestamp_t asWASITimestamp(I128 time)
 	return clampedCast<__wasi_timestamp_t>(time);
 }
 
-struct LockedFDE
+LockedFDE WASI::getLockedFDE(Process* process,
+							 __wasi_fd_t fd,
+							 __wasi_rights_t requiredRights,
+							 __wasi_rights_t requiredInheritingRights,
+							 Platform::RWMutex::LockShareability lockShareability)
 {
-	__wasi_errno_t error;
+	// Enter an epoch guard, which keeps the FDE from being deleted while it's locked, even if it
+	// is concurrently closed. Once the FDE is locked, closing it waits for the lock to be released,
+	// so the guard is exited when this function returns, before any blocking I/O on the FDE.
+	EpochGuard epochGuard;
+	epochGuard.enter(process->fdTable);
+
+	// Check that the FD table contains a FDE for the given FD.
+	FDE* fde = process->fdTable.get(fd);
+	if(!fde) { return LockedFDE(__WASI_EBADF); }
 
-	// Only set if result==_WASI_ESUCCESS:
-	Platform::RWMutex::Lock fdeLock;
-	std::shared_ptr<FDE> fde;
+	// Lock the FDE. If this function returns an error, lockedFDE is destroyed, unlocking the FDE,
+	// before the guard is exited.
+	LockedFDE lockedFDE(fde, lockShareability);
 
-	LockedFDE(__wasi_errno_t inError) : error(inError) {}
-	LockedFDE(const std::shared_ptr<FDE>& inFDE,
-			  Platform::RWMutex::LockShareability lockShareability)
-	: error(__WASI_ESUCCESS), fdeLock(inFDE->mutex, lockShareability), fde(inFDE)
-	{
-	}
-};
-
-static LockedFDE getLockedFDE(Process* process,
-							  __wasi_fd_t fd,
-							  __wasi_rights_t requiredRights,
-							  __wasi_rights_t requiredInheritingRights,
-							  Platform::RWMutex::LockShareability lockShareability
-							  = Platform::RWMutex::shareable)
-{
-	// Shareably lock the fdMap mutex.
-	Platform::RWMutex::ShareableLock fdsLock(process->fdMapMutex);
-
-	// Check that the fdMap contains a FDE for the given FD.
-	if(fd < process->fdMap.getMinIndex() || fd > process->fdMap.getMaxIndex())
-	{
-		return LockedFDE(__WASI_EBADF);
-	}
-	std::shared_ptr<FDE>* fde = process->fdMap.get(fd);
-	if(!fde) { return LockedFDE(__WASI_EBADF); }
+	// If the FDE was closed after it was looked up, but before it was locked, treat it as though
+	// the lookup failed.
+	if(!fde->vfd) { return LockedFDE(__WASI_EBADF); }
 
 	// Check that the FDE has the required rights.
-	if(((*fde)->rights & requiredRights) != requiredRights
-	   || ((*fde)->inheritingRights & requiredInheritingRights) != requiredInheritingRights)
+	if((fde->rights & requiredRights) != requiredRights
+	   || (fde->inheritingRights & requiredInheritingRights) != requiredInheritingRights)
 	{
 		return LockedFDE(__WASI_ENOTCAPABLE);
 	}
 
-	TRACE_SYSCALL_FLOW("Locked FDE: %s", (*fde)->originalPath.c_str());
+	TRACE_SYSCALL_FLOW("Locked FDE: %s", fde->originalPath.c_str());
 
-	// Lock the FDE and return a reference to it.
-	return LockedFDE(*fde, lockShareability);
+	return lockedFDE;
 }
 
 static __wasi_filetype_t asWASIFileType(FileType type)
@@ -313,6 +310,10 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
 	LockedFDE lockedFDE = getLockedFDE(process, fd, 0, 0);
 	if(lockedFDE.error != __WASI_ESUCCESS) { return TRACE_SYSCALL_RETURN(lockedFDE.error); }
 
+	// Only preopened FDs have a prestat: returning EBADF for others tells the libc preopen scan
+	// that it has reached the end of the preopened FDs.
+	if(!lockedFDE.fde->isPreopened) { return TRACE_SYSCALL_RETURN(__WASI_EBADF); }
+
 	if(lockedFDE.fde->originalPath.size() > UINT32_MAX)
 	{
 		return TRACE_SYSCALL_RETURN(__WASI_EOVERFLOW);
@@ -365,29 +366,27 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
 
 	Process* process = getProcessFromContextRuntimeData(contextRuntimeData);
 
-	// Exclusively lock the fds mutex, and look up the FDE corresponding to the FD.
-	Platform::RWMutex::ExclusiveLock fdsLock(process->fdMapMutex);
-	if(fd < process->fdMap.getMinIndex() || fd > process->fdMap.getMaxIndex())
-	{
-		return TRACE_SYSCALL_RETURN(__WASI_EBADF);
-	}
-	std::shared_ptr<FDE>* fdePointer = process->fdMap.get(fd);
-	if(!fdePointer) { return TRACE_SYSCALL_RETURN(__WASI_EBADF); }
-	std::shared_ptr<FDE> fde = *fdePointer;
-
-	// Exclusively lock the FDE.
-	Platform::RWMutex::ExclusiveLock fdeLock(fde->mutex);
-
-	// Remove this FDE from the FD table, and unlock the fds mutex.
-	process->fdMap.removeOrFail(fd);
-	fdsLock.unlock();
+	// Lock the FD table, and look up the FDE corresponding to the FD.
+	Platform::Mutex::Lock fdTableLock(process->fdTable.mutex);
+	FDE* fde = process->fdTable.get(fd);
+	if(!fde) { return TRACE_SYSCALL_RETURN(__WASI_EBADF); }
 
 	// Don't allow closing preopened FDs for now.
 	if(fde->isPreopened) { return TRACE_SYSCALL_RETURN(__WASI_EBADF); }
 
-	// Close the FDE's underlying VFD+DirEntStream. This can return an error code, but closes the
+	// Remove this FDE from the FD table, and unlock the FD table.
+	process->fdTable.removeOrFail(fd);
+	fdTableLock.unlock();
+
+	// Exclusively lock the FDE, which waits for any calls that are using it to finish, and close
+	// the FDE's underlying VFD+DirEntStream. This can return an error code, but closes the
 	// VFD+DirEntStream even if there was an error.
+	Platform::RWMutex::ExclusiveLock fdeLock(fde->mutex);
 	const VFS::Result result = fde->close();
+	fdeLock.unlock();
+
+	// Delete the FDE once no other threads can be accessing it.
+	process->fdTable.retire(fde);
 
 	return TRACE_SYSCALL_RETURN(asWASIErrNo(result));
 }
@@ -408,49 +407,44 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
 	return TRACE_SYSCALL_RETURN(asWASIErrNo(lockedFDE.fde->vfd->sync(SyncType::contents)));
 }
 
-static __wasi_errno_t readImpl(Process* process,
-							   __wasi_fd_t fd,
-							   WASIAddress iovsAddress,
-							   I32 numIOVs,
-							   const __wasi_filesize_t* offset,
-							   Uptr& outNumBytesRead)
+// Translates an array of WASI IOVs in the process memory to VFS IO buffers, and calls operation
+// with the translated buffers. Out-of-bounds IOVs are reported as EFAULT.
+template<typename WASIIOVec, typename VFSIOBuffer, typename Operation>
+static __wasi_errno_t withIOBuffers(Process* process,
+									WASIAddress iovsAddress,
+									I32 numIOVs,
+									Operation&& operation)
 {
-	const __wasi_rights_t requiredRights
-		= __WASI_RIGHT_FD_READ | (offset ? __WASI_RIGHT_FD_SEEK : 0);
-	LockedFDE lockedFDE = getLockedFDE(process, fd, requiredRights, 0);
-	if(lockedFDE.error != __WASI_ESUCCESS) { return lockedFDE.error; }
-
 	if(numIOVs < 0 || numIOVs > __WASI_IOV_MAX) { return __WASI_EINVAL; }
 
-	// Allocate memory for the IOReadBuffers.
-	IOReadBuffer* vfsReadBuffers = (IOReadBuffer*)malloc(numIOVs * sizeof(IOReadBuffer));
+	// Allocate memory for the VFS IO buffers.
+	VFSIOBuffer* vfsBuffers = (VFSIOBuffer*)malloc(numIOVs * sizeof(VFSIOBuffer));
 
 	// Catch any out-of-bounds memory access exceptions that are thrown.
 	__wasi_errno_t result = __WASI_ESUCCESS;
 	Runtime::catchRuntimeExceptions(
 		[&] {
-			// Translate the IOVs to IOReadBuffers.
-			const __wasi_iovec_t* iovs
-				= memoryArrayPtr<__wasi_iovec_t>(process->memory, iovsAddress, numIOVs);
+			// Translate the IOVs to VFS IO buffers.
+			const WASIIOVec* iovs
+				= memoryArrayPtr<WASIIOVec>(process->memory, iovsAddress, numIOVs);
 			U64 numBufferBytes = 0;
 			for(I32 iovIndex = 0; iovIndex < numIOVs; ++iovIndex)
 			{
-				__wasi_iovec_t iov = iovs[iovIndex];
+				WASIIOVec iov = iovs[iovIndex];
 				TRACE_SYSCALL_FLOW("IOV[%u]=(buf=" WASIADDRESS_FORMAT ", buf_len=%u)",
 								   iovIndex,
 								   iov.buf,
 								   iov.buf_len);
-				vfsReadBuffers[iovIndex].data
+				vfsBuffers[iovIndex].data
 					= memoryArrayPtr<U8>(process->memory, iov.buf, iov.buf_len);
-				vfsReadBuffers[iovIndex].numBytes = iov.buf_len;
+				vfsBuffers[iovIndex].numBytes = iov.buf_len;
 				numBufferBytes += iov.buf_len;
 			}
 			if(numBufferBytes > WASIADDRESS_MAX) { result = __WASI_EOVERFLOW; }
 			else
 			{
-				// Do the read.
-				result = asWASIErrNo(
-					lockedFDE.fde->vfd->readv(vfsReadBuffers, numIOVs, &outNumBytesRead, offset));
+				// Do the operation.
+				result = asWASIErrNo(operation(vfsBuffers, Uptr(numIOVs)));
 			}
 		},
 		[&](Exception* exception) {
@@ -464,12 +458,30 @@ static __wasi_errno_t readImpl(Process* process,
 			result = __WASI_EFAULT;
 		});
 
-	// Free the VFS read buffers.
-	free(vfsReadBuffers);
+	// Free the VFS IO buffers.
+	free(vfsBuffers);
 
 	return result;
 }
 
+static __wasi_errno_t readImpl(Process* process,
+							   __wasi_fd_t fd,
+							   WASIAddress iovsAddress,
+							   I32 numIOVs,
+							   const __wasi_filesize_t* offset,
+							   Uptr& outNumBytesRead)
+{
+	const __wasi_rights_t requiredRights
+		= __WASI_RIGHT_FD_READ | (offset ? __WASI_RIGHT_FD_SEEK : 0);
+	LockedFDE lockedFDE = getLockedFDE(process, fd, requiredRights, 0);
+	if(lockedFDE.error != __WASI_ESUCCESS) { return lockedFDE.error; }
+
+	return withIOBuffers<__wasi_iovec_t, IOReadBuffer>(
+		process, iovsAddress, numIOVs, [&](const IOReadBuffer* buffers, Uptr numBuffers) {
+			return lockedFDE.fde->vfd->readv(buffers, numBuffers, &outNumBytesRead, offset);
+		});
+}
+
 static __wasi_errno_t writeImpl(Process* process,
 								__wasi_fd_t fd,
 								WASIAddress iovsAddress,
@@ -482,54 +494,10 @@ static __wasi_errno_t writeImpl(Process* process,
 	LockedFDE lockedFDE = getLockedFDE(process, fd, requiredRights, 0);
 	if(lockedFDE.error != __WASI_ESUCCESS) { return lockedFDE.error; }
 
-	if(numIOVs < 0 || numIOVs > __WASI_IOV_MAX) { return __WASI_EINVAL; }
-
-	// Allocate memory for the IOWriteBuffers.
-	IOWriteBuffer* vfsWriteBuffers = (IOWriteBuffer*)malloc(numIOVs * sizeof(IOWriteBuffer));
-
-	// Catch any out-of-bounds memory access exceptions that are thrown.
-	__wasi_errno_t result = __WASI_ESUCCESS;
-	Runtime::catchRuntimeExceptions(
-		[&] {
-			// Translate the IOVs to IOWriteBuffers
-			const __wasi_ciovec_t* iovs
-				= memoryArrayPtr<__wasi_ciovec_t>(process->memory, iovsAddress, numIOVs);
-			U64 numBufferBytes = 0;
-			for(I32 iovIndex = 0; iovIndex < numIOVs; ++iovIndex)
-			{
-				__wasi_ciovec_t iov = iovs[iovIndex];
-				TRACE_SYSCALL_FLOW("IOV[%u]=(buf=" WASIADDRESS_FORMAT ", buf_len=%u)",
-								   iovIndex,
-								   iov.buf,
-								   iov.buf_len);
-				vfsWriteBuffers[iovIndex].data
-					= memoryArrayPtr<const U8>(process->memory, iov.buf, iov.buf_len);
-				vfsWriteBuffers[iovIndex].numBytes = iov.buf_len;
-				numBufferBytes += iov.buf_len;
-			}
-			if(numBufferBytes > WASIADDRESS_MAX) { result = __WASI_EOVERFLOW; }
-			else
-			{
-				// Do the writes.
-				result = asWASIErrNo(lockedFDE.fde->vfd->writev(
-					vfsWriteBuffers, numIOVs, &outNumBytesWritten, offset));
-			}
-		},
-		[&](Exception* exception) {
-			// If we catch an out-of-bounds memory exception, return EFAULT.
-			WAVM_ERROR_UNLESS(getExceptionType(exception)
-							  == ExceptionTypes::outOfBoundsMemoryAccess);
-			Log::printf(Log::debug,
-						"Caught runtime exception while reading memory at address 0x%" PRIx64,
-						getExceptionArgument(exception, 1).i64);
-			destroyException(exception);
-			result = __WASI_EFAULT;
+	return withIOBuffers<__wasi_ciovec_t, IOWriteBuffer>(
+		process, iovsAddress, numIOVs, [&](const IOWriteBuffer* buffers, Uptr numBuffers) {
+			return lockedFDE.fde->vfd->writev(buffers, numBuffers, &outNumBytesWritten, offset);
 		});
-
-	// Free the VFS write buffers.
-	free(vfsWriteBuffers);
-
-	return result;
 }
 
 WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
@@ -663,40 +631,32 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
 
 	Process* process = getProcessFromContextRuntimeData(contextRuntimeData);
 
-	// Exclusively lock the fds mutex.
-	Platform::RWMutex::ExclusiveLock fdsLock(process->fdMapMutex);
-
-	// Look up the FDE for the source FD.
-	if(fromFD < process->fdMap.getMinIndex() || fromFD > process->fdMap.getMaxIndex())
-	{
-		return TRACE_SYSCALL_RETURN(__WASI_EBADF);
-	}
-	std::shared_ptr<FDE>* fromFDEPointer = process->fdMap.get(fromFD);
-	if(!fromFDEPointer) { return TRACE_SYSCALL_RETURN(__WASI_EBADF); }
-	std::shared_ptr<FDE> fromFDE = *fromFDEPointer;
-
-	// Look up the FDE for the destination FD.
-	if(toFD < process->fdMap.getMinIndex() || toFD > process->fdMap.getMaxIndex())
-	{
-		return TRACE_SYSCALL_RETURN(__WASI_EBADF);
-	}
-	std::shared_ptr<FDE>* toFDEPointer = process->fdMap.get(toFD);
-	if(!toFDEPointer) { return TRACE_SYSCALL_RETURN(__WASI_EBADF); }
-	std::shared_ptr<FDE> toFDE = *toFDEPointer;
+	// Lock the FD table, and look up the FDEs for the source and destination FDs.
+	Platform::Mutex::Lock fdTableLock(process->fdTable.mutex);
+	FDE* fromFDE = process->fdTable.get(fromFD);
+	if(!fromFDE) { return TRACE_SYSCALL_RETURN(__WASI_EBADF); }
+	FDE* toFDE = process->fdTable.get(toFD);
+	if(!toFDE) { return TRACE_SYSCALL_RETURN(__WASI_EBADF); }
 
 	// Don't allow renumbering preopened files.
 	if(fromFDE->isPreopened || toFDE->isPreopened) { return TRACE_SYSCALL_RETURN(__WASI_ENOTSUP); }
 
-	// Exclusively lock the FDE being replaced at the destination FD.
-	Platform::RWMutex::ExclusiveLock fromFDELock(fromFDE->mutex);
+	// Renumbering an FD to itself doesn't do anything.
+	if(fromFD == toFD) { return TRACE_SYSCALL_RETURN(__WASI_ESUCCESS); }
+
+	// Move the FDE from fromFD to toFD in the FD table, and unlock the FD table.
+	process->fdTable.removeOrFail(toFD);
+	process->fdTable.moveOrFail(fromFD, toFD);
+	fdTableLock.unlock();
 
 	// Close the FDE being replaced. This can return an error code, but closes the VFD+DirEntStream
 	// even if there was an error.
-	Result result = toFDE->close();
+	Platform::RWMutex::ExclusiveLock toFDELock(toFDE->mutex);
+	const Result result = toFDE->close();
+	toFDELock.unlock();
 
-	// Move the FDE from fromFD to toFD in the fds map.
-	process->fdMap[toFD] = std::move(fromFDE);
-	process->fdMap.removeOrFail(fromFD);
+	// Delete the replaced FDE once no other threads can be accessing it.
+	process->fdTable.retire(toFDE);
 
 	return TRACE_SYSCALL_RETURN(asWASIErrNo(result));
 }
@@ -923,7 +883,17 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
 							   __wasi_filesize_t offset,
 							   __wasi_filesize_t numBytes)
 {
-	UNIMPLEMENTED_SYSCALL("fd_allocate", "(%u, %" PRIu64 ", %" PRIu64 ")", fd, offset, numBytes);
+	TRACE_SYSCALL("fd_allocate", "(%u, %" PRIu64 ", %" PRIu64 ")", fd, offset, numBytes);
+
+	Process* process = getProcessFromContextRuntimeData(contextRuntimeData);
+
+	LockedFDE lockedFDE = getLockedFDE(process, fd, __WASI_RIGHT_FD_ALLOCATE, 0);
+	if(lockedFDE.error != __WASI_ESUCCESS) { return TRACE_SYSCALL_RETURN(lockedFDE.error); }
+
+	if(!numBytes) { return TRACE_SYSCALL_RETURN(__WASI_EINVAL); }
+
+	const VFS::Result result = lockedFDE.fde->vfd->allocate(offset, numBytes);
+	return TRACE_SYSCALL_RETURN(asWASIErrNo(result));
 }
 
 WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
@@ -938,16 +908,46 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
 							   WASIAddress newPathAddress,
 							   WASIAddress numNewPathBytes)
 {
-	UNIMPLEMENTED_SYSCALL("path_link",
-						  "(%u, 0x%08x, " WASIADDRESS_FORMAT ", %u, %u, " WASIADDRESS_FORMAT
-						  ", %u)",
-						  dirFD,
-						  lookupFlags,
-						  oldPathAddress,
-						  numOldPathBytes,
-						  newFD,
-						  newPathAddress,
-						  numNewPathBytes);
+	TRACE_SYSCALL("path_link",
+				  "(%u, 0x%08x, " WASIADDRESS_FORMAT ", %u, %u, " WASIADDRESS_FORMAT ", %u)",
+				  dirFD,
+				  lookupFlags,
+				  oldPathAddress,
+				  numOldPathBytes,
+				  newFD,
+				  newPathAddress,
+				  numNewPathBytes);
+
+	Process* process = getProcessFromContextRuntimeData(contextRuntimeData);
+
+	// Creating a link to the file a symbolic link points to isn't supported: the VFS always links
+	// to the symbolic link itself.
+	if(lookupFlags & __WASI_LOOKUP_SYMLINK_FOLLOW) { return TRACE_SYSCALL_RETURN(__WASI_EINVAL); }
+
+	std::string canonicalOldPath;
+	const __wasi_errno_t oldPathError = validatePath(process,
+													 dirFD,
+													 lookupFlags,
+													 __WASI_RIGHT_PATH_LINK_SOURCE,
+													 0,
+													 oldPathAddress,
+													 numOldPathBytes,
+													 canonicalOldPath);
+	if(oldPathError != __WASI_ESUCCESS) { return TRACE_SYSCALL_RETURN(oldPathError); }
+
+	std::string canonicalNewPath;
+	const __wasi_errno_t newPathError = validatePath(process,
+													 newFD,
+													 0,
+													 __WASI_RIGHT_PATH_LINK_TARGET,
+													 0,
+													 newPathAddress,
+													 numNewPathBytes,
+													 canonicalNewPath);
+	if(newPathError != __WASI_ESUCCESS) { return TRACE_SYSCALL_RETURN(newPathError); }
+
+	return TRACE_SYSCALL_RETURN(
+		asWASIErrNo(process->fileSystem->createHardLink(canonicalOldPath, canonicalNewPath)));
 }
 
 WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
@@ -1034,14 +1034,15 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
 		= process->fileSystem->open(canonicalPath, accessMode, createMode, openedVFD, vfsVFDFlags);
 	if(result != VFS::Result::success) { return TRACE_SYSCALL_RETURN(asWASIErrNo(result)); }
 
-	Platform::RWMutex::ExclusiveLock fdsLock(process->fdMapMutex);
-	__wasi_fd_t fd = process->fdMap.add(
-		UINT32_MAX,
-		std::make_shared<FDE>(
-			openedVFD, requestedRights, requestedInheritingRights, std::move(canonicalPath)));
+	FDE* fde
+		= new FDE(openedVFD, requestedRights, requestedInheritingRights, std::move(canonicalPath));
+	Platform::Mutex::Lock fdTableLock(process->fdTable.mutex);
+	__wasi_fd_t fd = process->fdTable.add(fde);
+	fdTableLock.unlock();
 	if(fd == UINT32_MAX)
 	{
-		result = openedVFD->close();
+		result = fde->close();
+		delete fde;
 		if(result != VFS::Result::success)
 		{
 			Log::printf(Log::Category::debug,
@@ -1150,15 +1151,42 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
 							   WASIAddress numBufferBytes,
 							   WASIAddress outNumBufferBytesUsedAddress)
 {
-	UNIMPLEMENTED_SYSCALL("path_readlink",
-						  "(%u, " WASIADDRESS_FORMAT ", %u, " WASIADDRESS_FORMAT
-						  ", %u, " WASIADDRESS_FORMAT ")",
-						  fd,
-						  pathAddress,
-						  numPathBytes,
-						  bufferAddress,
-						  numBufferBytes,
-						  outNumBufferBytesUsedAddress);
+	TRACE_SYSCALL("path_readlink",
+				  "(%u, " WASIADDRESS_FORMAT ", %u, " WASIADDRESS_FORMAT ", %u, " WASIADDRESS_FORMAT
+				  ")",
+				  fd,
+				  pathAddress,
+				  numPathBytes,
+				  bufferAddress,
+				  numBufferBytes,
+				  outNumBufferBytesUsedAddress);
+
+	Process* process = getProcessFromContextRuntimeData(contextRuntimeData);
+
+	std::string canonicalPath;
+	const __wasi_errno_t pathError = validatePath(process,
+												  fd,
+												  0,
+												  __WASI_RIGHT_PATH_READLINK,
+												  0,
+												  pathAddress,
+												  numPathBytes,
+												  canonicalPath);
+	if(pathError != __WASI_ESUCCESS) { return TRACE_SYSCALL_RETURN(pathError); }
+
+	std::string targetPath;
+	const VFS::Result result = process->fileSystem->readSymbolicLink(canonicalPath, targetPath);
+	if(result != VFS::Result::success) { return TRACE_SYSCALL_RETURN(asWASIErrNo(result)); }
+
+	// Like POSIX readlink, silently truncate the target path if it doesn't fit in the buffer.
+	U8* buffer = memoryArrayPtr<U8>(process->memory, bufferAddress, numBufferBytes);
+	const Uptr numBufferBytesUsed
+		= truncatingMemcpy(buffer, targetPath.c_str(), targetPath.size(), numBufferBytes);
+	memoryRef<WASIAddress>(process->memory, outNumBufferBytesUsedAddress)
+		= WASIAddress(numBufferBytesUsed);
+
+	return TRACE_SYSCALL_RETURN(
+		__WASI_ESUCCESS, "(numBufferBytesUsed=%" WAVM_PRIuPTR ")", numBufferBytesUsed);
 }
 
 WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
@@ -1464,13 +1492,38 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
 							   WASIAddress newPathAddress,
 							   WASIAddress numNewPathBytes)
 {
-	UNIMPLEMENTED_SYSCALL("path_symlink",
-						  "(" WASIADDRESS_FORMAT ", %u, %u, " WASIADDRESS_FORMAT ", %u)",
-						  oldPathAddress,
-						  numOldPathBytes,
-						  fd,
-						  newPathAddress,
-						  numNewPathBytes);
+	TRACE_SYSCALL("path_symlink",
+				  "(" WASIADDRESS_FORMAT ", %u, %u, " WASIADDRESS_FORMAT ", %u)",
+				  oldPathAddress,
+				  numOldPathBytes,
+				  fd,
+				  newPathAddress,
+				  numNewPathBytes);
+
+	Process* process = getProcessFromContextRuntimeData(contextRuntimeData);
+
+	std::string canonicalNewPath;
+	const __wasi_errno_t newPathError = validatePath(process,
+													 fd,
+													 0,
+													 __WASI_RIGHT_PATH_SYMLINK,
+													 0,
+													 newPathAddress,
+													 numNewPathBytes,
+													 canonicalNewPath);
+	if(newPathError != __WASI_ESUCCESS) { return TRACE_SYSCALL_RETURN(newPathError); }
+
+	// The old path is stored in the symbolic link as-is, and isn't interpreted until the link is
+	// followed, so it isn't validated here. The file system is responsible for rejecting links that
+	// would escape it.
+	std::string targetPath;
+	if(!readUserString(process->memory, oldPathAddress, numOldPathBytes, targetPath))
+	{
+		return TRACE_SYSCALL_RETURN(__WASI_EFAULT);
+	}
+
+	return TRACE_SYSCALL_RETURN(
+		asWASIErrNo(process->fileSystem->createSymbolicLink(targetPath, canonicalNewPath)));
 }
 
 WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
@@ -1567,3 +1620,174 @@ WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
 	const VFS::Result result = process->fileSystem->createDir(canonicalPath);
 	return TRACE_SYSCALL_RETURN(asWASIErrNo(result));
 }
+
+WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
+							   "sock_recv",
+							   __wasi_errno_return_t,
+							   wasi_sock_recv,
+							   __wasi_fd_t sock,
+							   WASIAddress iovsAddress,
+							   I32 numIOVs,
+							   __wasi_riflags_t riFlags,
+							   WASIAddress numBytesReadAddress,
+							   WASIAddress roFlagsAddress)
+{
+	TRACE_SYSCALL("sock_recv",
+				  "(%u, " WASIADDRESS_FORMAT ", %u, 0x%04x, " WASIADDRESS_FORMAT
+				  ", " WASIADDRESS_FORMAT ")",
+				  sock,
+				  iovsAddress,
+				  numIOVs,
+				  riFlags,
+				  numBytesReadAddress,
+				  roFlagsAddress);
+
+	Process* process = getProcessFromContextRuntimeData(contextRuntimeData);
+
+	if(riFlags & ~(__WASI_SOCK_RECV_PEEK | __WASI_SOCK_RECV_WAITALL))
+	{
+		return TRACE_SYSCALL_RETURN(__WASI_EINVAL);
+	}
+
+	LockedFDE lockedFDE = getLockedFDE(process, sock, __WASI_RIGHT_FD_READ, 0);
+	if(lockedFDE.error != __WASI_ESUCCESS) { return TRACE_SYSCALL_RETURN(lockedFDE.error); }
+
+	SocketRecvFlags recvFlags;
+	recvFlags.peek = riFlags & __WASI_SOCK_RECV_PEEK;
+	recvFlags.waitAll = riFlags & __WASI_SOCK_RECV_WAITALL;
+
+	Uptr numBytesRead = 0;
+	bool dataTruncated = false;
+	const __wasi_errno_t result = withIOBuffers<__wasi_iovec_t, IOReadBuffer>(
+		process, iovsAddress, numIOVs, [&](const IOReadBuffer* buffers, Uptr numBuffers) {
+			return lockedFDE.fde->vfd->recv(
+				buffers, numBuffers, recvFlags, &numBytesRead, &dataTruncated);
+		});
+	if(result != __WASI_ESUCCESS) { return TRACE_SYSCALL_RETURN(result); }
+
+	// Write the number of bytes read and the output flags to memory.
+	WAVM_ASSERT(numBytesRead <= WASIADDRESS_MAX);
+	memoryRef<WASIAddress>(process->memory, numBytesReadAddress) = WASIAddress(numBytesRead);
+	memoryRef<__wasi_roflags_t>(process->memory, roFlagsAddress)
+		= dataTruncated ? __WASI_SOCK_RECV_DATA_TRUNCATED : 0;
+
+	return TRACE_SYSCALL_RETURN(result, "(numBytesRead=%" WAVM_PRIuPTR ")", numBytesRead);
+}
+
+WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
+							   "sock_send",
+							   __wasi_errno_return_t,
+							   wasi_sock_send,
+							   __wasi_fd_t sock,
+							   WASIAddress iovsAddress,
+							   I32 numIOVs,
+							   __wasi_siflags_t siFlags,
+							   WASIAddress numBytesWrittenAddress)
+{
+	TRACE_SYSCALL("sock_send",
+				  "(%u, " WASIADDRESS_FORMAT ", %u, 0x%04x, " WASIADDRESS_FORMAT ")",
+				  sock,
+				  iovsAddress,
+				  numIOVs,
+				  siFlags,
+				  numBytesWrittenAddress);
+
+	Process* process = getProcessFromContextRuntimeData(contextRuntimeData);
+
+	// There aren't any send flags defined by WASI.
+	if(siFlags) { return TRACE_SYSCALL_RETURN(__WASI_EINVAL); }
+
+	LockedFDE lockedFDE = getLockedFDE(process, sock, __WASI_RIGHT_FD_WRITE, 0);
+	if(lockedFDE.error != __WASI_ESUCCESS) { return TRACE_SYSCALL_RETURN(lockedFDE.error); }
+
+	Uptr numBytesWritten = 0;
+	const __wasi_errno_t result = withIOBuffers<__wasi_ciovec_t, IOWriteBuffer>(
+		process, iovsAddress, numIOVs, [&](const IOWriteBuffer* buffers, Uptr numBuffers) {
+			return lockedFDE.fde->vfd->send(buffers, numBuffers, &numBytesWritten);
+		});
+	if(result != __WASI_ESUCCESS) { return TRACE_SYSCALL_RETURN(result); }
+
+	// Write the number of bytes written to memory.
+	WAVM_ASSERT(numBytesWritten <= WASIADDRESS_MAX);
+	memoryRef<WASIAddress>(process->memory, numBytesWrittenAddress) = WASIAddress(numBytesWritten);
+
+	return TRACE_SYSCALL_RETURN(result, "(numBytesWritten=%" WAVM_PRIuPTR ")", numBytesWritten);
+}
+
+WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
+							   "sock_shutdown",
+							   __wasi_errno_return_t,
+							   wasi_sock_shutdown,
+							   __wasi_fd_t sock,
+							   __wasi_sdflags_t how)
+{
+	TRACE_SYSCALL("sock_shutdown", "(%u, 0x%02x)", sock, how);
+
+	Process* process = getProcessFromContextRuntimeData(contextRuntimeData);
+
+	SocketShutdownMode mode;
+	switch(how)
+	{
+	case __WASI_SHUT_RD: mode = SocketShutdownMode::read; break;
+	case __WASI_SHUT_WR: mode = SocketShutdownMode::write; break;
+	case __WASI_SHUT_RD | __WASI_SHUT_WR: mode = SocketShutdownMode::readWrite; break;
+	default: return TRACE_SYSCALL_RETURN(__WASI_EINVAL);
+	};
+
+	LockedFDE lockedFDE = getLockedFDE(process, sock, __WASI_RIGHT_SOCK_SHUTDOWN, 0);
+	if(lockedFDE.error != __WASI_ESUCCESS) { return TRACE_SYSCALL_RETURN(lockedFDE.error); }
+
+	return TRACE_SYSCALL_RETURN(asWASIErrNo(lockedFDE.fde->vfd->shutdown(mode)));
+}
+
+WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFile,
+							   "sock_accept",
+							   __wasi_errno_return_t,
+							   wasi_sock_accept,
+							   __wasi_fd_t sock,
+							   __wasi_fdflags_t flags,
+							   WASIAddress fdAddress)
+{
+	TRACE_SYSCALL("sock_accept", "(%u, 0x%04x, " WASIADDRESS_FORMAT ")", sock, flags, fdAddress);
+
+	Process* process = getProcessFromContextRuntimeData(contextRuntimeData);
+
+	// Only the non-blocking flag may be set for accepted connections.
+	if(flags & ~__WASI_FDFLAG_NONBLOCK) { return TRACE_SYSCALL_RETURN(__WASI_EINVAL); }
+
+	LockedFDE lockedFDE = getLockedFDE(process, sock, __WASI_RIGHT_SOCK_ACCEPT, 0);
+	if(lockedFDE.error != __WASI_ESUCCESS) { return TRACE_SYSCALL_RETURN(lockedFDE.error); }
+
+	VFDFlags vfsVFDFlags;
+	vfsVFDFlags.nonBlocking = flags & __WASI_FDFLAG_NONBLOCK;
+
+	VFD* connectionVFD = nullptr;
+	VFS::Result result = lockedFDE.fde->vfd->accept(connectionVFD, vfsVFDFlags);
+	if(result != VFS::Result::success) { return TRACE_SYSCALL_RETURN(asWASIErrNo(result)); }
+
+	// Accepted connections get the rights inherited from the listening socket.
+	const __wasi_rights_t connectionRights = lockedFDE.fde->inheritingRights;
+	std::string connectionPath = lockedFDE.fde->originalPath;
+	lockedFDE.fdeLock.unlock();
+
+	FDE* fde = new FDE(connectionVFD, connectionRights, 0, std::move(connectionPath));
+	Platform::Mutex::Lock fdTableLock(process->fdTable.mutex);
+	__wasi_fd_t fd = process->fdTable.add(fde);
+	fdTableLock.unlock();
+	if(fd == UINT32_MAX)
+	{
+		result = fde->close();
+		delete fde;
+		if(result != VFS::Result::success)
+		{
+			Log::printf(Log::Category::debug,
+						"Error when closing accepted connection VFD due to full FD table: %s\n",
+						VFS::describeResult(result));
+		}
+		return TRACE_SYSCALL_RETURN(__WASI_EMFILE);
+	}
+
+	memoryRef<__wasi_fd_t>(process->memory, fdAddress) = fd;
+
+	return TRACE_SYSCALL_RETURN(__WASI_ESUCCESS, "(%u)", fd);
+}
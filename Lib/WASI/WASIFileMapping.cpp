@@ -0,0 +1,118 @@
+#include <cinttypes>
+#include <cstring>
+#include "./WASIPrivate.h"
+#include "WAVM/IR/IR.h"
+#include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Runtime/Intrinsics.h"
+#include "WAVM/Runtime/Runtime.h"
+#include "WAVM/VFS/VFS.h"
+#include "WAVM/WASI/WASI.h"
+#include "WAVM/WASI/WASIABI.h"
+
+using namespace WAVM;
+using namespace WAVM::WASI;
+using namespace WAVM::Runtime;
+using namespace WAVM::VFS;
+
+// A WAVM extension to WASI that lets a guest map a file into its memory without copying it. Guests
+// opt in by importing the module "wavm_wasi_file_mapping".
+//
+// The guest's memory must be a private snapshot of the file: if the mapped file could be truncated
+// by another descriptor or process, accessing the pages past its new end would raise SIGBUS, even
+// in host calls that hold locks. Only files that are sealed against being shrunk or written (e.g.
+// a memfd the host created for the guest) are mapped; other files are copied into the memory.
+
+namespace WAVM { namespace WASI {
+	WAVM_DEFINE_INTRINSIC_MODULE(wasiFileMapping)
+}}
+
+// Copies a range of a file into memory, zeroing the bytes past the end of the file. This is used
+// when the file can't be mapped into memory, and has the same effect as mapping it.
+static Result copyFileToMemory(VFD* vfd, U8* bytes, Uptr numBytes, U64 offset)
+{
+	Uptr numBytesRead = 0;
+	while(numBytesRead < numBytes)
+	{
+		IOReadBuffer readBuffer{bytes + numBytesRead, numBytes - numBytesRead};
+		const U64 readOffset = offset + numBytesRead;
+		Uptr numBufferBytesRead = 0;
+		const Result result = vfd->readv(&readBuffer, 1, &numBufferBytesRead, &readOffset);
+		if(result != Result::success) { return result; }
+		else if(!numBufferBytesRead)
+		{
+			break;
+		}
+
+		numBytesRead += numBufferBytesRead;
+	}
+
+	memset(bytes + numBytesRead, 0, numBytes - numBytesRead);
+	return Result::success;
+}
+
+WAVM_DEFINE_INTRINSIC_FUNCTION(wasiFileMapping,
+							   "fd_map",
+							   __wasi_errno_return_t,
+							   wasi_fd_map,
+							   __wasi_fd_t fd,
+							   __wasi_filesize_t offset,
+							   WASIAddress address,
+							   WASIAddress numBytes)
+{
+	TRACE_SYSCALL("fd_map",
+				  "(%u, %" PRIu64 ", " WASIADDRESS_FORMAT ", %u)",
+				  fd,
+				  offset,
+				  address,
+				  numBytes);
+
+	Process* process = getProcessFromContextRuntimeData(contextRuntimeData);
+
+	// The file offset and the memory range must be aligned to WebAssembly pages, which are at
+	// least as large as the host's pages.
+	if((offset & (IR::numBytesPerPage - 1)) || (address & (IR::numBytesPerPage - 1))
+	   || (numBytes & (IR::numBytesPerPage - 1)))
+	{
+		return TRACE_SYSCALL_RETURN(__WASI_EINVAL);
+	}
+
+	LockedFDE lockedFDE
+		= getLockedFDE(process, fd, __WASI_RIGHT_FD_READ | __WASI_RIGHT_FD_SEEK, 0);
+	if(lockedFDE.error != __WASI_ESUCCESS) { return TRACE_SYSCALL_RETURN(lockedFDE.error); }
+	VFD* vfd = lockedFDE.fde->vfd;
+
+	VFDInfo vfdInfo;
+	const Result vfdInfoResult = vfd->getVFDInfo(vfdInfo);
+	if(vfdInfoResult != Result::success)
+	{
+		return TRACE_SYSCALL_RETURN(asWASIErrNo(vfdInfoResult));
+	}
+	else if(vfdInfo.type != FileType::file)
+	{
+		return TRACE_SYSCALL_RETURN(__WASI_ENODEV);
+	}
+
+	const U64 memoryNumBytes = U64(getMemoryNumPages(process->memory)) * IR::numBytesPerPage;
+	if(U64(address) + numBytes > memoryNumBytes) { return TRACE_SYSCALL_RETURN(__WASI_EFAULT); }
+	else if(!numBytes)
+	{
+		return TRACE_SYSCALL_RETURN(__WASI_ESUCCESS);
+	}
+
+	// Try to map the file over the memory's pages. If the VFD isn't backed by a host file that is
+	// sealed against changes, fall back to copying the file into memory.
+	Uptr hostDescriptor = 0;
+	if(vfd->getHostDescriptor(hostDescriptor) == Result::success
+	   && mapFileToMemoryPages(process->memory,
+							   address / IR::numBytesPerPage,
+							   numBytes / IR::numBytesPerPage,
+							   hostDescriptor,
+							   offset))
+	{
+		return TRACE_SYSCALL_RETURN(__WASI_ESUCCESS, "(mapped)");
+	}
+
+	U8* bytes = memoryArrayPtr<U8>(process->memory, address, numBytes);
+	const Result copyResult = copyFileToMemory(vfd, bytes, numBytes, offset);
+	return TRACE_SYSCALL_RETURN(asWASIErrNo(copyResult), "(copied)");
+}
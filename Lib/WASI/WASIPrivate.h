@@ -3,12 +3,13 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include "./WASIFDTable.h"
 #include "WAVM/IR/Types.h"
 #include "WAVM/Inline/BasicTypes.h"
 #include "WAVM/Inline/HashMap.h"
-#include "WAVM/Inline/IndexMap.h"
 #include "WAVM/Inline/Time.h"
 #include "WAVM/Platform/Defines.h"
+#include "WAVM/Platform/Mutex.h"
 #include "WAVM/Platform/RWMutex.h"
 #include "WAVM/Runtime/Intrinsics.h"
 #include "WAVM/Runtime/Linker.h"
@@ -53,9 +54,21 @@
 // Only allow directory or file operations to be derived from directories.
 #define INHERITING_DIRECTORY_RIGHTS (DIRECTORY_RIGHTS | REGULAR_FILE_RIGHTS)
 
+// Operations that apply to connected sockets.
+#define SOCKET_RIGHTS                                                                              \
+	(__WASI_RIGHT_FD_READ | __WASI_RIGHT_FD_WRITE | __WASI_RIGHT_FD_FDSTAT_SET_FLAGS               \
+	 | __WASI_RIGHT_FD_FILESTAT_GET | __WASI_RIGHT_POLL_FD_READWRITE | __WASI_RIGHT_SOCK_SHUTDOWN)
+
+// Operations that apply to listening sockets. The connections accepted from a listening socket
+// inherit SOCKET_RIGHTS.
+#define LISTENING_SOCKET_RIGHTS                                                                    \
+	(__WASI_RIGHT_FD_FDSTAT_SET_FLAGS | __WASI_RIGHT_FD_FILESTAT_GET                               \
+	 | __WASI_RIGHT_POLL_FD_READWRITE | __WASI_RIGHT_SOCK_ACCEPT)
+
 namespace WAVM { namespace VFS {
 	enum class Result;
 	struct DirEntStream;
+	struct Reactor;
 	struct VFD;
 }}
 
@@ -95,6 +108,44 @@ namespace WAVM { namespace WASI {
 		VFS::Result close();
 	};
 
+	struct LockedFDE
+	{
+		__wasi_errno_t error;
+
+		// Only set if result==_WASI_ESUCCESS. Closing the FDE waits for the lock to be released, so
+		// the FDE isn't deleted while it's locked.
+		Platform::RWMutex::Lock fdeLock;
+		FDE* fde{nullptr};
+
+		LockedFDE(__wasi_errno_t inError) : error(inError) {}
+		LockedFDE(FDE* inFDE, Platform::RWMutex::LockShareability lockShareability)
+		: error(__WASI_ESUCCESS), fdeLock(inFDE->mutex, lockShareability), fde(inFDE)
+		{
+		}
+	};
+
+	struct BufferedOutputVFD;
+
+	// The state shared by a process's stdout and stderr VFDs.
+	struct ProcessStdio
+	{
+		Platform::Mutex mutex;
+		StdioConfig config;
+
+		// The buffered VFDs that haven't been closed yet.
+		std::vector<BufferedOutputVFD*> bufferedVFDs;
+
+		// A ring buffer of the last config.numCaptureBytes bytes of output.
+		std::vector<U8> captureRing;
+		Uptr captureBeginIndex = 0;
+		Uptr numCapturedBytes = 0;
+		Uptr numDroppedCaptureBytes = 0;
+	};
+
+	// If the process's stdio config requires it, wraps a stdout or stderr VFD in a VFD that buffers
+	// and captures writes. Otherwise, returns the VFD unmodified.
+	VFS::VFD* wrapStdOutputVFD(ProcessStdio& stdio, VFS::VFD* vfd);
+
 	struct ProcessResolver : Runtime::Resolver
 	{
 		HashMap<std::string, Runtime::GCPointer<Runtime::Instance>> moduleNameToInstanceMap;
@@ -112,8 +163,7 @@ namespace WAVM { namespace WASI {
 		std::vector<std::string> args;
 		std::vector<std::string> envs;
 
-		Platform::RWMutex fdMapMutex;
-		IndexMap<__wasi_fd_t, std::shared_ptr<WASI::FDE>> fdMap{0, INT32_MAX};
+		FDTable fdTable;
 
 		VFS::FileSystem* fileSystem = nullptr;
 
@@ -121,6 +171,13 @@ namespace WAVM { namespace WASI {
 
 		Time processClockOrigin;
 
+		ProcessStdio stdio;
+
+		// Reactors that aren't being used by a poll_oneoff call. Each call takes a reactor from the
+		// pool (or creates one), so concurrent polls don't contend on a single reactor.
+		Platform::Mutex idleReactorsMutex;
+		std::vector<std::unique_ptr<VFS::Reactor>> idleReactors;
+
 		~Process();
 	};
 
@@ -146,8 +203,18 @@ namespace WAVM { namespace WASI {
 									   const char* format,
 									   ...);
 
+	__wasi_errno_t asWASIErrNo(VFS::Result result);
+
+	LockedFDE getLockedFDE(Process* process,
+						   __wasi_fd_t fd,
+						   __wasi_rights_t requiredRights,
+						   __wasi_rights_t requiredInheritingRights,
+						   Platform::RWMutex::LockShareability lockShareability
+						   = Platform::RWMutex::shareable);
+
 	WAVM_DECLARE_INTRINSIC_MODULE(wasi);
 	WAVM_DECLARE_INTRINSIC_MODULE(wasiArgsEnvs);
 	WAVM_DECLARE_INTRINSIC_MODULE(wasiClocks);
 	WAVM_DECLARE_INTRINSIC_MODULE(wasiFile);
+	WAVM_DECLARE_INTRINSIC_MODULE(wasiFileMapping);
 }}
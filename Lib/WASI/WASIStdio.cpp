@@ -0,0 +1,364 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "./WASIPrivate.h"
+#include "WAVM/Inline/Assert.h"
+#include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Logging/Logging.h"
+#include "WAVM/Platform/Mutex.h"
+#include "WAVM/VFS/VFS.h"
+#include "WAVM/WASI/WASI.h"
+
+using namespace WAVM;
+using namespace WAVM::WASI;
+using namespace WAVM::VFS;
+
+static void captureOutput(ProcessStdio& stdio, const U8* data, Uptr numBytes)
+{
+	const Uptr numCaptureBytes = stdio.captureRing.size();
+	if(!numCaptureBytes || !numBytes) { return; }
+
+	// If the data is larger than the ring buffer, only keep the end of it.
+	if(numBytes > numCaptureBytes)
+	{
+		stdio.numDroppedCaptureBytes += numBytes - numCaptureBytes;
+		data += numBytes - numCaptureBytes;
+		numBytes = numCaptureBytes;
+	}
+
+	// If the ring buffer doesn't have room for the data, drop the oldest captured bytes.
+	if(stdio.numCapturedBytes + numBytes > numCaptureBytes)
+	{
+		const Uptr numDroppedBytes = stdio.numCapturedBytes + numBytes - numCaptureBytes;
+		stdio.captureBeginIndex = (stdio.captureBeginIndex + numDroppedBytes) % numCaptureBytes;
+		stdio.numCapturedBytes -= numDroppedBytes;
+		stdio.numDroppedCaptureBytes += numDroppedBytes;
+	}
+
+	// Copy the data to the end of the ring buffer, wrapping around to the start if necessary.
+	const Uptr endIndex = (stdio.captureBeginIndex + stdio.numCapturedBytes) % numCaptureBytes;
+	const Uptr numBytesBeforeWrap = std::min(numBytes, numCaptureBytes - endIndex);
+	memcpy(stdio.captureRing.data() + endIndex, data, numBytesBeforeWrap);
+	memcpy(stdio.captureRing.data(), data + numBytesBeforeWrap, numBytes - numBytesBeforeWrap);
+	stdio.numCapturedBytes += numBytes;
+}
+
+// Captures the first numBytes bytes of a list of buffers.
+static void captureBuffers(ProcessStdio& stdio,
+						   const IOWriteBuffer* buffers,
+						   Uptr numBuffers,
+						   Uptr numBytes)
+{
+	for(Uptr bufferIndex = 0; bufferIndex < numBuffers && numBytes; ++bufferIndex)
+	{
+		const Uptr numBufferBytes = std::min(numBytes, buffers[bufferIndex].numBytes);
+		captureOutput(stdio, (const U8*)buffers[bufferIndex].data, numBufferBytes);
+		numBytes -= numBufferBytes;
+	}
+}
+
+// A VFD that buffers and captures the writes to a process's stdout or stderr. The buffer is
+// protected by the ProcessStdio mutex, which is shared by stdout and stderr so that captured
+// output from the two is interleaved in the order it was written.
+struct WASI::BufferedOutputVFD : VFD
+{
+	BufferedOutputVFD(ProcessStdio& inStdio, VFD* inInnerVFD)
+	: stdio(inStdio), innerVFD(inInnerVFD)
+	{
+		if(stdio.config.buffering != StdioBuffering::none)
+		{
+			buffer.reserve(stdio.config.numBufferBytes);
+		}
+
+		Platform::Mutex::Lock stdioLock(stdio.mutex);
+		stdio.bufferedVFDs.push_back(this);
+	}
+
+	Result flush()
+	{
+		WAVM_ASSERT_MUTEX_IS_LOCKED_BY_CURRENT_THREAD(stdio.mutex);
+
+		Uptr numFlushedBytes = 0;
+		Result result = Result::success;
+		while(numFlushedBytes < buffer.size())
+		{
+			IOWriteBuffer writeBuffer{buffer.data() + numFlushedBytes,
+									  buffer.size() - numFlushedBytes};
+			Uptr numBytesWritten = 0;
+			result = innerVFD->writev(&writeBuffer, 1, &numBytesWritten);
+			if(result != Result::success) { break; }
+			else if(!numBytesWritten)
+			{
+				result = Result::ioDeviceError;
+				break;
+			}
+
+			numFlushedBytes += numBytesWritten;
+		}
+
+		buffer.erase(buffer.begin(), buffer.begin() + numFlushedBytes);
+		return result;
+	}
+
+	// Writes unbuffered data to the inner VFD, and captures the bytes it accepted. The bytes it
+	// didn't accept aren't captured, so they aren't captured twice if the guest retries them.
+	Result writeDirectly(const IOWriteBuffer* buffers, Uptr numBuffers, Uptr* outNumBytesWritten)
+	{
+		WAVM_ASSERT_MUTEX_IS_LOCKED_BY_CURRENT_THREAD(stdio.mutex);
+
+		Uptr numBytesWritten = 0;
+		const Result result = innerVFD->writev(buffers, numBuffers, &numBytesWritten);
+		if(result != Result::success) { return result; }
+
+		captureBuffers(stdio, buffers, numBuffers, numBytesWritten);
+		if(outNumBytesWritten) { *outNumBytesWritten = numBytesWritten; }
+		return Result::success;
+	}
+
+	virtual Result close() override
+	{
+		Result result;
+		{
+			Platform::Mutex::Lock stdioLock(stdio.mutex);
+			result = flush();
+			if(result != Result::success)
+			{
+				Log::printf(Log::debug,
+							"Error flushing buffered output when closing VFD: %s\n",
+							describeResult(result));
+			}
+
+			auto it = std::find(stdio.bufferedVFDs.begin(), stdio.bufferedVFDs.end(), this);
+			WAVM_ASSERT(it != stdio.bufferedVFDs.end());
+			stdio.bufferedVFDs.erase(it);
+		}
+
+		result = innerVFD->close();
+		delete this;
+		return result;
+	}
+
+	virtual Result seek(I64 offset, SeekOrigin origin, U64* outAbsoluteOffset = nullptr) override
+	{
+		Platform::Mutex::Lock stdioLock(stdio.mutex);
+		const Result result = flush();
+		if(result != Result::success) { return result; }
+		return innerVFD->seek(offset, origin, outAbsoluteOffset);
+	}
+
+	virtual Result readv(const IOReadBuffer* buffers,
+						 Uptr numBuffers,
+						 Uptr* outNumBytesRead = nullptr,
+						 const U64* offset = nullptr) override
+	{
+		return innerVFD->readv(buffers, numBuffers, outNumBytesRead, offset);
+	}
+
+	virtual Result writev(const IOWriteBuffer* buffers,
+						  Uptr numBuffers,
+						  Uptr* outNumBytesWritten = nullptr,
+						  const U64* offset = nullptr) override
+	{
+		if(outNumBytesWritten) { *outNumBytesWritten = 0; }
+
+		Platform::Mutex::Lock stdioLock(stdio.mutex);
+
+		// Positioned writes bypass the buffer.
+		if(offset)
+		{
+			const Result result = flush();
+			if(result != Result::success) { return result; }
+			return innerVFD->writev(buffers, numBuffers, outNumBytesWritten, offset);
+		}
+
+		Uptr numBytes = 0;
+		for(Uptr bufferIndex = 0; bufferIndex < numBuffers; ++bufferIndex)
+		{
+			numBytes += buffers[bufferIndex].numBytes;
+		}
+
+		if(stdio.config.buffering == StdioBuffering::none)
+		{
+			return writeDirectly(buffers, numBuffers, outNumBytesWritten);
+		}
+
+		// If the data doesn't fit in the buffer, flush the buffer. If the data is larger than the
+		// buffer, write it directly to the inner VFD.
+		if(buffer.size() + numBytes > stdio.config.numBufferBytes)
+		{
+			const Result result = flush();
+			if(result != Result::success) { return result; }
+
+			if(numBytes > stdio.config.numBufferBytes)
+			{
+				return writeDirectly(buffers, numBuffers, outNumBytesWritten);
+			}
+		}
+
+		// Append the data to the buffer.
+		bool containsNewline = false;
+		for(Uptr bufferIndex = 0; bufferIndex < numBuffers; ++bufferIndex)
+		{
+			const U8* data = (const U8*)buffers[bufferIndex].data;
+			const Uptr numBufferBytes = buffers[bufferIndex].numBytes;
+			if(stdio.config.buffering == StdioBuffering::line && !containsNewline)
+			{
+				containsNewline = memchr(data, '\n', numBufferBytes) != nullptr;
+			}
+			buffer.insert(buffer.end(), data, data + numBufferBytes);
+		}
+		captureBuffers(stdio, buffers, numBuffers, numBytes);
+		if(outNumBytesWritten) { *outNumBytesWritten = numBytes; }
+
+		// Flush the buffer if it's full, or if the data contained a newline in line-buffered mode.
+		// The data has already been accepted, so errors writing it are reported by the next write,
+		// sync, or seek.
+		if(containsNewline || buffer.size() == stdio.config.numBufferBytes)
+		{
+			const Result result = flush();
+			if(result != Result::success && result != Result::wouldBlock)
+			{
+				Log::printf(Log::debug,
+							"Error flushing buffered output: %s\n",
+							describeResult(result));
+			}
+		}
+
+		return Result::success;
+	}
+
+	virtual Result sync(SyncType type) override
+	{
+		Platform::Mutex::Lock stdioLock(stdio.mutex);
+		Result result = flush();
+		if(result != Result::success) { return result; }
+
+		// Terminals and pipes can't be synced, but flushing the buffer is all the guest can
+		// observe, so don't report that as an error.
+		result = innerVFD->sync(type);
+		return result == Result::notSynchronizable ? Result::success : result;
+	}
+
+	virtual Result getVFDInfo(VFDInfo& outInfo) override { return innerVFD->getVFDInfo(outInfo); }
+	virtual Result getFileInfo(FileInfo& outInfo) override
+	{
+		return innerVFD->getFileInfo(outInfo);
+	}
+	virtual Result setVFDFlags(const VFDFlags& flags) override
+	{
+		return innerVFD->setVFDFlags(flags);
+	}
+	virtual Result setFileSize(U64 numBytes) override
+	{
+		Platform::Mutex::Lock stdioLock(stdio.mutex);
+		const Result result = flush();
+		if(result != Result::success) { return result; }
+		return innerVFD->setFileSize(numBytes);
+	}
+	virtual Result allocate(U64 offset, U64 numBytes) override
+	{
+		Platform::Mutex::Lock stdioLock(stdio.mutex);
+		const Result result = flush();
+		if(result != Result::success) { return result; }
+		return innerVFD->allocate(offset, numBytes);
+	}
+	virtual Result setFileTimes(bool setLastAccessTime,
+								Time lastAccessTime,
+								bool setLastWriteTime,
+								Time lastWriteTime) override
+	{
+		return innerVFD->setFileTimes(
+			setLastAccessTime, lastAccessTime, setLastWriteTime, lastWriteTime);
+	}
+
+	virtual Result openDir(DirEntStream*& outStream) override
+	{
+		return innerVFD->openDir(outStream);
+	}
+
+	virtual Result recv(const IOReadBuffer* buffers,
+						Uptr numBuffers,
+						SocketRecvFlags flags,
+						Uptr* outNumBytesRead = nullptr,
+						bool* outDataTruncated = nullptr) override
+	{
+		return innerVFD->recv(buffers, numBuffers, flags, outNumBytesRead, outDataTruncated);
+	}
+	virtual Result send(const IOWriteBuffer* buffers,
+						Uptr numBuffers,
+						Uptr* outNumBytesWritten = nullptr) override
+	{
+		Platform::Mutex::Lock stdioLock(stdio.mutex);
+		const Result result = flush();
+		if(result != Result::success) { return result; }
+		return innerVFD->send(buffers, numBuffers, outNumBytesWritten);
+	}
+	virtual Result shutdown(SocketShutdownMode mode) override
+	{
+		return innerVFD->shutdown(mode);
+	}
+	virtual Result accept(VFD*& outVFD, const VFDFlags& flags) override
+	{
+		return innerVFD->accept(outVFD, flags);
+	}
+
+	virtual Result getHostDescriptor(Uptr& outDescriptor) override
+	{
+		return innerVFD->getHostDescriptor(outDescriptor);
+	}
+
+private:
+	ProcessStdio& stdio;
+	VFD* innerVFD;
+	std::vector<U8> buffer;
+};
+
+VFD* WASI::wrapStdOutputVFD(ProcessStdio& stdio, VFD* vfd)
+{
+	if(stdio.config.buffering == StdioBuffering::none && !stdio.config.numCaptureBytes)
+	{
+		return vfd;
+	}
+
+	return new BufferedOutputVFD(stdio, vfd);
+}
+
+void WASI::flushProcessStdio(Process& process)
+{
+	Platform::Mutex::Lock stdioLock(process.stdio.mutex);
+	for(BufferedOutputVFD* bufferedVFD : process.stdio.bufferedVFDs)
+	{
+		const Result result = bufferedVFD->flush();
+		if(result != Result::success)
+		{
+			Log::printf(
+				Log::debug, "Error flushing buffered output: %s\n", describeResult(result));
+		}
+	}
+}
+
+std::string WASI::drainProcessStdioCapture(Process& process, Uptr* outNumDroppedBytes)
+{
+	ProcessStdio& stdio = process.stdio;
+	Platform::Mutex::Lock stdioLock(stdio.mutex);
+
+	// Copy the captured bytes out of the ring buffer, which may wrap around to the start.
+	std::string result;
+	if(stdio.numCapturedBytes)
+	{
+		const char* ringChars = (const char*)stdio.captureRing.data();
+		const Uptr numBytesBeforeWrap = std::min(
+			stdio.numCapturedBytes, stdio.captureRing.size() - stdio.captureBeginIndex);
+		result.assign(ringChars + stdio.captureBeginIndex, numBytesBeforeWrap);
+		result.append(ringChars, stdio.numCapturedBytes - numBytesBeforeWrap);
+	}
+
+	if(outNumDroppedBytes) { *outNumDroppedBytes = stdio.numDroppedCaptureBytes; }
+
+	stdio.captureBeginIndex = 0;
+	stdio.numCapturedBytes = 0;
+	stdio.numDroppedCaptureBytes = 0;
+
+	return result;
+}
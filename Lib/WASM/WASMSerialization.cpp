@@ -1,4 +1,7 @@
 #include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <memory>
 #include <new>
 #include <string>
@@ -17,6 +20,8 @@
 #include "WAVM/Inline/Unicode.h"
 #include "WAVM/Platform/Alloca.h"
 #include "WAVM/Platform/Defines.h"
+#include "WAVM/Platform/Mutex.h"
+#include "WAVM/Platform/Thread.h"
 #include "WAVM/WASM/WASM.h"
 
 using namespace WAVM;
@@ -41,13 +46,14 @@ WAVM_FORCEINLINE void serializeOpcode(InputStream& stream, Opcode& opcode)
 	{
 		U32 opcodeVarUInt;
 		serializeVarUInt32(stream, opcodeVarUInt);
-		if(opcodeVarUInt > 0xff)
+		if(opcodeVarUInt <= 0xff) { opcode = Opcode((U32(opcodeU8) << 8) | opcodeVarUInt); }
+		else if(opcodeVarUInt <= 0xffff) { opcode = Opcode((U32(opcodeU8) << 16) | opcodeVarUInt); }
+		else
 		{
 			throw FatalSerializationException(std::string("unknown opcode (")
 											  + std::to_string(Uptr(opcodeU8)) + " "
 											  + std::to_string(opcodeVarUInt) + ")");
 		}
-		opcode = Opcode((U32(opcodeU8) << 8) | opcodeVarUInt);
 	}
 }
 WAVM_FORCEINLINE void serializeOpcode(OutputStream& stream, Opcode opcode)
@@ -57,13 +63,36 @@ WAVM_FORCEINLINE void serializeOpcode(OutputStream& stream, Opcode opcode)
 		U8 opcodeU8 = U8(opcode);
 		Serialization::serializeNativeValue(stream, opcodeU8);
 	}
-	else
+	else if(opcode <= (Opcode)maxTwoByteOpcode)
 	{
-		U8 opcodePrefix = U8(U16(opcode) >> 8);
+		U8 opcodePrefix = U8(U32(opcode) >> 8);
 		U32 opcodeVarUInt = U32(opcode) & 0xff;
 		serializeNativeValue(stream, opcodePrefix);
 		serializeVarUInt32(stream, opcodeVarUInt);
 	}
+	else
+	{
+		U8 opcodePrefix = U8(U32(opcode) >> 16);
+		U32 opcodeVarUInt = U32(opcode) & 0xffff;
+		serializeNativeValue(stream, opcodePrefix);
+		serializeVarUInt32(stream, opcodeVarUInt);
+	}
+}
+
+// Returns a SharedBytes that references the given bytes if they are part of sharedModuleBytes, or
+// a copy of them otherwise.
+static SharedBytes shareOrCopyBytes(const U8* bytes,
+									Uptr numBytes,
+									const SharedBytes* sharedModuleBytes)
+{
+	if(sharedModuleBytes && sharedModuleBytes->contains(bytes, numBytes))
+	{
+		return sharedModuleBytes->slice(bytes, numBytes);
+	}
+	else
+	{
+		return SharedBytes(bytes, numBytes);
+	}
 }
 
 // These serialization functions need to be declared in the IR namespace for the array serializer in
@@ -268,6 +297,11 @@ namespace WAVM { namespace IR {
 		serializeVarUInt32(stream, e.index);
 	}
 
+	static_assert(sizeof(InitializerExpression::Type) == sizeof(Opcode),
+				  "InitializerExpression::Type must be the same size as Opcode");
+	static_assert(sizeof(ElemExpr::Type) == sizeof(Opcode),
+				  "ElemExpr::Type must be the same size as Opcode");
+
 	template<typename Stream> void serialize(Stream& stream, InitializerExpression& initializer)
 	{
 		serializeOpcode(stream, initializer.typeOpcode);
@@ -421,7 +455,27 @@ namespace WAVM { namespace IR {
 		};
 	}
 
-	template<typename Stream> void serialize(Stream& stream, DataSegment& dataSegment)
+	// Encodes or decodes a length-prefixed array of bytes. If the bytes are decoded from
+	// sharedModuleBytes, the decoded array references them instead of copying them.
+	static void serialize(OutputStream& stream, SharedBytes& bytes, const SharedBytes*)
+	{
+		Uptr numBytes = bytes.size();
+		serializeVarUInt32(stream, numBytes);
+		serializeBytes(stream, bytes.data(), numBytes);
+	}
+	static void serialize(InputStream& stream,
+						  SharedBytes& outBytes,
+						  const SharedBytes* sharedModuleBytes)
+	{
+		Uptr numBytes = 0;
+		serializeVarUInt32(stream, numBytes);
+		outBytes = shareOrCopyBytes(stream.advance(numBytes), numBytes, sharedModuleBytes);
+	}
+
+	template<typename Stream>
+	void serialize(Stream& stream,
+				   DataSegment& dataSegment,
+				   const SharedBytes* sharedModuleBytes = nullptr)
 	{
 		if(Stream::isInput)
 		{
@@ -447,7 +501,6 @@ namespace WAVM { namespace IR {
 				break;
 			default: throw FatalSerializationException("invalid data segment flags");
 			};
-			dataSegment.data = std::make_shared<std::vector<U8>>();
 		}
 		else
 		{
@@ -463,7 +516,7 @@ namespace WAVM { namespace IR {
 				serialize(stream, dataSegment.baseOffset);
 			}
 		}
-		serialize(stream, *dataSegment.data);
+		serialize(stream, dataSegment.data, sharedModuleBytes);
 	}
 }}
 
@@ -501,6 +554,11 @@ static void serialize(OutputStream& stream, SectionID sectionID)
 struct ModuleSerializationState
 {
 	bool hadDataCountSection = false;
+	Uptr maxCodeDecodeThreads = 0;
+
+	// The bytes the module is decoded from, if they may be shared by the decoded module's data
+	// segments and custom sections.
+	const SharedBytes* sharedModuleBytes = nullptr;
 	std::shared_ptr<ModuleValidationState> validationState;
 	const Module& module;
 
@@ -577,12 +635,17 @@ static void serialize(InputStream& stream,
 					  FunctionDef& functionDef,
 					  const ModuleSerializationState&)
 {
-	std::vector<Uptr> branchTable;
-	serializeArray(stream, branchTable, [](InputStream& stream, Uptr& targetDepth) {
+	// Append the target depths to the function's branch table target depths one at a time, so
+	// malformed input causes a serialization exception before a huge allocation.
+	std::vector<Uptr>& targetDepths = functionDef.branchTableTargetDepths;
+	imm.firstTargetDepthIndex = targetDepths.size();
+	serializeVarUInt32(stream, imm.numTargetDepths);
+	for(Uptr index = 0; index < imm.numTargetDepths; ++index)
+	{
+		Uptr targetDepth = 0;
 		serializeVarUInt32(stream, targetDepth);
-	});
-	imm.branchTableIndex = functionDef.branchTables.size();
-	functionDef.branchTables.push_back(std::move(branchTable));
+		targetDepths.push_back(targetDepth);
+	}
 	serializeVarUInt32(stream, imm.defaultTargetDepth);
 }
 static void serialize(OutputStream& stream,
@@ -590,11 +653,14 @@ static void serialize(OutputStream& stream,
 					  FunctionDef& functionDef,
 					  const ModuleSerializationState&)
 {
-	WAVM_ASSERT(imm.branchTableIndex < functionDef.branchTables.size());
-	std::vector<Uptr>& branchTable = functionDef.branchTables[imm.branchTableIndex];
-	serializeArray(stream, branchTable, [](OutputStream& stream, Uptr& targetDepth) {
-		serializeVarUInt32(stream, targetDepth);
-	});
+	WAVM_ASSERT(imm.firstTargetDepthIndex + imm.numTargetDepths
+				<= functionDef.branchTableTargetDepths.size());
+	serializeVarUInt32(stream, imm.numTargetDepths);
+	for(Uptr index = 0; index < imm.numTargetDepths; ++index)
+	{
+		serializeVarUInt32(stream,
+						   functionDef.branchTableTargetDepths[imm.firstTargetDepthIndex + index]);
+	}
 	serializeVarUInt32(stream, imm.defaultTargetDepth);
 }
 
@@ -924,7 +990,9 @@ static void serialize(OutputStream& stream, CustomSection& customSection)
 	serialize(stream, sectionBytes);
 }
 
-static void serialize(InputStream& stream, CustomSection& customSection)
+static void serialize(InputStream& stream,
+					  CustomSection& customSection,
+					  const SharedBytes* sharedModuleBytes)
 {
 	Uptr numSectionBytes = 0;
 	serializeVarUInt32(stream, numSectionBytes);
@@ -932,9 +1000,10 @@ static void serialize(InputStream& stream, CustomSection& customSection)
 	MemoryInputStream sectionStream(stream.advance(numSectionBytes), numSectionBytes);
 	serialize(sectionStream, customSection.name);
 	throwIfNotValidUTF8(customSection.name);
-	customSection.data.resize(sectionStream.capacity());
-	serializeBytes(sectionStream, customSection.data.data(), customSection.data.size());
-	WAVM_ASSERT(!sectionStream.capacity());
+
+	const Uptr numDataBytes = sectionStream.capacity();
+	customSection.data
+		= shareOrCopyBytes(sectionStream.advance(numDataBytes), numDataBytes, sharedModuleBytes);
 }
 
 struct LocalSet
@@ -1038,16 +1107,11 @@ static void serializeFunctionBody(OutputStream& sectionStream,
 	serialize(sectionStream, bodyBytes);
 }
 
-static void serializeFunctionBody(InputStream& sectionStream,
-								  Module& module,
-								  FunctionDef& functionDef,
-								  const ModuleSerializationState& moduleState)
+static void decodeFunctionBody(InputStream& bodyStream,
+							   Module& module,
+							   FunctionDef& functionDef,
+							   const ModuleSerializationState& moduleState)
 {
-	Uptr numBodyBytes = 0;
-	serializeVarUInt32(sectionStream, numBodyBytes);
-
-	MemoryInputStream bodyStream(sectionStream.advance(numBodyBytes), numBodyBytes);
-
 	// Deserialize local sets and unpack them into a linear array of local types.
 	Uptr numLocalSets = 0;
 	serializeVarUInt32(bodyStream, numLocalSets);
@@ -1073,7 +1137,7 @@ static void serializeFunctionBody(InputStream& sectionStream,
 	{
 		Opcode opcode;
 		serializeOpcode(bodyStream, opcode);
-		switch(U16(opcode))
+		switch(U32(opcode))
 		{
 #define VISIT_OPCODE(_, name, nameString, Imm, ...)                                                \
 	case Uptr(Opcode::name): {                                                                     \
@@ -1108,7 +1172,11 @@ static void serializeFunctionBody(InputStream& sectionStream,
 	};
 	codeValidationStream.finish();
 
+	// The IR stays resident for the lifetime of the module, so trim the excess capacity of the
+	// buffers it was encoded into.
 	functionDef.code = std::move(irCodeByteStream.getBytes());
+	functionDef.code.shrink_to_fit();
+	functionDef.branchTableTargetDepths.shrink_to_fit();
 }
 
 static void serializeCallingConvention(InputStream& stream, CallingConvention& callingConvention)
@@ -1413,6 +1481,119 @@ template<typename Stream> void serializeElementSection(Stream& moduleStream, Mod
 	});
 }
 
+// The state shared by the threads that decode the function bodies in a code section.
+struct CodeSectionDecodeState
+{
+	struct FunctionBody
+	{
+		const U8* bytes;
+		Uptr numBytes;
+	};
+
+	enum class ErrorType
+	{
+		malformed,
+		invalid,
+		outOfMemory,
+	};
+
+	Module& module;
+	const ModuleSerializationState& moduleState;
+	std::vector<FunctionBody> functionBodies;
+
+	std::atomic<Uptr> nextFunctionBodyIndex{0};
+
+	// The lowest index of a function body that failed to decode, or UINTPTR_MAX if none has. Only
+	// the error in that body is reported, so the result doesn't depend on the order that the
+	// threads decode the bodies in.
+	std::atomic<Uptr> firstErrorFunctionBodyIndex{UINTPTR_MAX};
+	Platform::Mutex errorMutex;
+	ErrorType firstErrorType;
+	std::string firstErrorMessage;
+
+	CodeSectionDecodeState(Module& inModule, const ModuleSerializationState& inModuleState)
+	: module(inModule), moduleState(inModuleState)
+	{
+	}
+
+	void recordError(Uptr functionBodyIndex, ErrorType type, const std::string& message)
+	{
+		Platform::Mutex::Lock errorLock(errorMutex);
+		if(functionBodyIndex < firstErrorFunctionBodyIndex.load(std::memory_order_relaxed))
+		{
+			firstErrorFunctionBodyIndex.store(functionBodyIndex, std::memory_order_relaxed);
+			firstErrorType = type;
+			firstErrorMessage = message;
+		}
+	}
+
+	void throwFirstError()
+	{
+		switch(firstErrorType)
+		{
+		case ErrorType::malformed:
+			throw FatalSerializationException(std::move(firstErrorMessage));
+		case ErrorType::invalid: throw ValidationException(std::move(firstErrorMessage));
+		case ErrorType::outOfMemory: throw std::bad_alloc();
+		default: WAVM_UNREACHABLE();
+		};
+	}
+};
+
+// Function bodies are only decoded in parallel if there are at least this many bytes of them per
+// thread, unless the caller explicitly asked for more threads.
+static constexpr Uptr minFunctionBodyBytesPerDecodeThread = 256 * 1024;
+
+static void decodeFunctionBodies(CodeSectionDecodeState& state)
+{
+	while(true)
+	{
+		// Stop once all the bodies have been decoded, or a body before the next one failed to
+		// decode, since any error in the next body wouldn't be reported.
+		const Uptr functionBodyIndex
+			= state.nextFunctionBodyIndex.fetch_add(1, std::memory_order_relaxed);
+		if(functionBodyIndex >= state.functionBodies.size()
+		   || functionBodyIndex
+				  > state.firstErrorFunctionBodyIndex.load(std::memory_order_relaxed))
+		{
+			break;
+		}
+
+		const CodeSectionDecodeState::FunctionBody& functionBody
+			= state.functionBodies[functionBodyIndex];
+		try
+		{
+			MemoryInputStream bodyStream(functionBody.bytes, functionBody.numBytes);
+			decodeFunctionBody(bodyStream,
+							   state.module,
+							   state.module.functions.defs[functionBodyIndex],
+							   state.moduleState);
+		}
+		catch(FatalSerializationException const& exception)
+		{
+			state.recordError(functionBodyIndex,
+							  CodeSectionDecodeState::ErrorType::malformed,
+							  exception.message);
+		}
+		catch(ValidationException const& exception)
+		{
+			state.recordError(
+				functionBodyIndex, CodeSectionDecodeState::ErrorType::invalid, exception.message);
+		}
+		catch(std::bad_alloc const&)
+		{
+			state.recordError(
+				functionBodyIndex, CodeSectionDecodeState::ErrorType::outOfMemory, std::string());
+		}
+	}
+}
+
+static I64 decodeFunctionBodiesThreadEntry(void* stateVoid)
+{
+	decodeFunctionBodies(*(CodeSectionDecodeState*)stateVoid);
+	return 0;
+}
+
 static void serializeCodeSection(InputStream& moduleStream,
 								 Module& module,
 								 const ModuleSerializationState& moduleState)
@@ -1426,9 +1607,54 @@ static void serializeCodeSection(InputStream& moduleStream,
 				throw FatalSerializationException(
 					"function and code sections have mismatched function counts");
 			}
-			for(FunctionDef& functionDef : module.functions.defs)
+
+			// Find the function bodies in the section before decoding any of them. If the section
+			// is truncated, the error is recorded as an error in the truncated body, so errors in
+			// the bodies before it take precedence, as they would if the bodies were decoded while
+			// scanning the section.
+			CodeSectionDecodeState state(module, moduleState);
+			state.functionBodies.reserve(numFunctionBodies);
+			Uptr numFunctionBodyBytes = 0;
+			try
 			{
-				serializeFunctionBody(sectionStream, module, functionDef, moduleState);
+				for(Uptr bodyIndex = 0; bodyIndex < numFunctionBodies; ++bodyIndex)
+				{
+					Uptr numBodyBytes = 0;
+					serializeVarUInt32(sectionStream, numBodyBytes);
+					const U8* bodyBytes = sectionStream.advance(numBodyBytes);
+					state.functionBodies.push_back({bodyBytes, numBodyBytes});
+					numFunctionBodyBytes += numBodyBytes;
+				}
+			}
+			catch(FatalSerializationException const& exception)
+			{
+				state.recordError(state.functionBodies.size(),
+								  CodeSectionDecodeState::ErrorType::malformed,
+								  exception.message);
+			}
+
+			// Decode and validate the bodies on the calling thread, and on any additional threads
+			// that are worth creating.
+			Uptr numThreads = moduleState.maxCodeDecodeThreads;
+			if(!numThreads)
+			{
+				numThreads = std::min(Platform::getNumberOfHardwareThreads(),
+									  numFunctionBodyBytes / minFunctionBodyBytesPerDecodeThread);
+			}
+			numThreads = std::max(Uptr(1), std::min(numThreads, state.functionBodies.size()));
+
+			std::vector<Platform::Thread*> threads;
+			for(Uptr threadIndex = 1; threadIndex < numThreads; ++threadIndex)
+			{
+				threads.push_back(
+					Platform::createThread(0, decodeFunctionBodiesThreadEntry, &state));
+			}
+			decodeFunctionBodies(state);
+			for(Platform::Thread* thread : threads) { Platform::joinThread(thread); }
+
+			if(state.firstErrorFunctionBodyIndex.load(std::memory_order_relaxed) != UINTPTR_MAX)
+			{
+				state.throwFirstError();
 			}
 		});
 }
@@ -1467,13 +1693,15 @@ template<typename Stream> void serializeDataCountSection(Stream& moduleStream, M
 	});
 }
 
-void serializeDataSection(InputStream& moduleStream, Module& module, bool hadDataCountSection)
+void serializeDataSection(InputStream& moduleStream,
+						  Module& module,
+						  const ModuleSerializationState& moduleState)
 {
 	serializeSection(
-		moduleStream, SectionID::data, [&module, hadDataCountSection](InputStream& sectionStream) {
+		moduleStream, SectionID::data, [&module, &moduleState](InputStream& sectionStream) {
 			Uptr numDataSegments = 0;
 			serializeVarUInt32(sectionStream, numDataSegments);
-			if(!hadDataCountSection)
+			if(!moduleState.hadDataCountSection)
 			{
 				// To make fuzzing more effective, fail gracefully instead of
 				// through OOM if the DataCount section specifies a large number of
@@ -1491,7 +1719,9 @@ void serializeDataSection(InputStream& moduleStream, Module& module, bool hadDat
 			}
 			for(Uptr segmentIndex = 0; segmentIndex < module.dataSegments.size(); ++segmentIndex)
 			{
-				serialize(sectionStream, module.dataSegments[segmentIndex]);
+				serialize(sectionStream,
+						  module.dataSegments[segmentIndex],
+						  moduleState.sharedModuleBytes);
 			}
 		});
 }
@@ -1554,59 +1784,88 @@ static void serializeModule(OutputStream& moduleStream, Module& module)
 	serializeCustomSectionsAfterKnownSection(moduleStream, module, OrderedSectionID::data);
 }
 
-static void serializeModule(InputStream& moduleStream, Module& module)
+// Decodes the sections of a binary module, and validates them as they are decoded.
+struct ModuleDecoder
 {
-	serializeConstant(moduleStream, "magic number", U32(magicNumber));
-	serializeConstant(moduleStream, "version", U32(currentVersion));
-
-	ModuleSerializationState moduleState(module);
-	moduleState.validationState = IR::createModuleValidationState(module);
-
+	Module& module;
+	ModuleSerializationState moduleState;
 	OrderedSectionID lastKnownOrderedSectionID = OrderedSectionID::moduleBeginning;
 	bool hadFunctionDefinitions = false;
 	bool hadDataSection = false;
-	while(moduleStream.capacity())
+
+	ModuleDecoder(Module& inModule,
+				  Uptr maxCodeDecodeThreads,
+				  const SharedBytes* sharedModuleBytes = nullptr)
+	: module(inModule), moduleState(inModule)
 	{
-		SectionID sectionID;
-		serialize(moduleStream, sectionID);
+		moduleState.validationState = IR::createModuleValidationState(module);
+		moduleState.maxCodeDecodeThreads = maxCodeDecodeThreads;
+		moduleState.sharedModuleBytes = sharedModuleBytes;
+	}
 
-		if(sectionID != SectionID::custom)
-		{
-			OrderedSectionID orderedSectionID;
-			switch(sectionID)
-			{
-			case SectionID::type: orderedSectionID = OrderedSectionID::type; break;
-			case SectionID::import: orderedSectionID = OrderedSectionID::import; break;
-			case SectionID::function: orderedSectionID = OrderedSectionID::function; break;
-			case SectionID::table: orderedSectionID = OrderedSectionID::table; break;
-			case SectionID::memory: orderedSectionID = OrderedSectionID::memory; break;
-			case SectionID::global: orderedSectionID = OrderedSectionID::global; break;
-			case SectionID::export_: orderedSectionID = OrderedSectionID::export_; break;
-			case SectionID::start: orderedSectionID = OrderedSectionID::start; break;
-			case SectionID::elem: orderedSectionID = OrderedSectionID::elem; break;
-			case SectionID::code: orderedSectionID = OrderedSectionID::code; break;
-			case SectionID::data: orderedSectionID = OrderedSectionID::data; break;
-			case SectionID::dataCount: orderedSectionID = OrderedSectionID::dataCount; break;
-			case SectionID::exceptionType:
-				orderedSectionID = OrderedSectionID::exceptionType;
-				break;
+	static void decodeMagicNumber(InputStream& moduleStream)
+	{
+		serializeConstant(moduleStream, "magic number", U32(magicNumber));
+	}
+	static void decodeVersion(InputStream& moduleStream)
+	{
+		serializeConstant(moduleStream, "version", U32(currentVersion));
+	}
+	static void decodeHeader(InputStream& moduleStream)
+	{
+		decodeMagicNumber(moduleStream);
+		decodeVersion(moduleStream);
+	}
 
-			case SectionID::custom: WAVM_UNREACHABLE();
-			default:
-				throw FatalSerializationException("unknown section ID ("
-												  + std::to_string(U8(sectionID)));
-			};
+	// Checks that a section with the given ID may follow the sections that have been decoded.
+	void beginSection(SectionID sectionID)
+	{
+		if(sectionID == SectionID::custom) { return; }
 
-			if(orderedSectionID > lastKnownOrderedSectionID)
-			{
-				lastKnownOrderedSectionID = orderedSectionID;
-			}
-			else
-			{
-				throw FatalSerializationException("incorrect order for known section");
-			}
+		OrderedSectionID orderedSectionID;
+		switch(sectionID)
+		{
+		case SectionID::type: orderedSectionID = OrderedSectionID::type; break;
+		case SectionID::import: orderedSectionID = OrderedSectionID::import; break;
+		case SectionID::function: orderedSectionID = OrderedSectionID::function; break;
+		case SectionID::table: orderedSectionID = OrderedSectionID::table; break;
+		case SectionID::memory: orderedSectionID = OrderedSectionID::memory; break;
+		case SectionID::global: orderedSectionID = OrderedSectionID::global; break;
+		case SectionID::export_: orderedSectionID = OrderedSectionID::export_; break;
+		case SectionID::start: orderedSectionID = OrderedSectionID::start; break;
+		case SectionID::elem: orderedSectionID = OrderedSectionID::elem; break;
+		case SectionID::code: orderedSectionID = OrderedSectionID::code; break;
+		case SectionID::data: orderedSectionID = OrderedSectionID::data; break;
+		case SectionID::dataCount: orderedSectionID = OrderedSectionID::dataCount; break;
+		case SectionID::exceptionType: orderedSectionID = OrderedSectionID::exceptionType; break;
+
+		case SectionID::custom: WAVM_UNREACHABLE();
+		default:
+			throw FatalSerializationException("unknown section ID ("
+											  + std::to_string(U8(sectionID)));
+		};
+
+		if(orderedSectionID > lastKnownOrderedSectionID)
+		{
+			lastKnownOrderedSectionID = orderedSectionID;
+		}
+		else
+		{
+			throw FatalSerializationException("incorrect order for known section");
 		}
+	}
+
+	// Decodes a section, starting with its size, from the module stream.
+	void decodeSection(InputStream& moduleStream, SectionID sectionID)
+	{
+		beginSection(sectionID);
+		decodeSectionContents(moduleStream, sectionID);
+	}
 
+	// Decodes a section that beginSection was already called for, starting with its size, from the
+	// module stream.
+	void decodeSectionContents(InputStream& moduleStream, SectionID sectionID)
+	{
 		switch(sectionID)
 		{
 		case SectionID::type:
@@ -1658,7 +1917,7 @@ static void serializeModule(InputStream& moduleStream, Module& module)
 			hadFunctionDefinitions = true;
 			break;
 		case SectionID::data:
-			serializeDataSection(moduleStream, module, moduleState.hadDataCountSection);
+			serializeDataSection(moduleStream, module, moduleState);
 			hadDataSection = true;
 			IR::validateDataSegments(*moduleState.validationState);
 			break;
@@ -1666,26 +1925,48 @@ static void serializeModule(InputStream& moduleStream, Module& module)
 			CustomSection& customSection
 				= *module.customSections.insert(module.customSections.end(), CustomSection());
 			customSection.afterSection = getMaxPresentSection(module, lastKnownOrderedSectionID);
-			serialize(moduleStream, customSection);
+			serialize(moduleStream, customSection, moduleState.sharedModuleBytes);
 			break;
 		}
 		default: throw FatalSerializationException("unknown section ID");
 		};
-	};
+	}
 
-	if(module.functions.defs.size() && !hadFunctionDefinitions)
+	// Checks that the sections that were decoded form a complete module.
+	void finish()
 	{
-		throw FatalSerializationException(
-			"module contained function declarations, but no corresponding "
-			"function definition section");
+		if(module.functions.defs.size() && !hadFunctionDefinitions)
+		{
+			throw FatalSerializationException(
+				"module contained function declarations, but no corresponding "
+				"function definition section");
+		}
+
+		if(module.dataSegments.size() && !hadDataSection)
+		{
+			throw FatalSerializationException(
+				"module contained DataCount section with non-zero segment count, but no "
+				"corresponding Data section");
+		}
 	}
+};
+
+static void serializeModule(InputStream& moduleStream,
+							Module& module,
+							Uptr maxCodeDecodeThreads,
+							const SharedBytes* sharedModuleBytes = nullptr)
+{
+	ModuleDecoder::decodeHeader(moduleStream);
 
-	if(module.dataSegments.size() && !hadDataSection)
+	ModuleDecoder decoder(module, maxCodeDecodeThreads, sharedModuleBytes);
+	while(moduleStream.capacity())
 	{
-		throw FatalSerializationException(
-			"module contained DataCount section with non-zero segment count, but no corresponding "
-			"Data section");
-	}
+		SectionID sectionID;
+		serialize(moduleStream, sectionID);
+		decoder.decodeSection(moduleStream, sectionID);
+	};
+
+	decoder.finish();
 }
 
 std::vector<U8> WASM::saveBinaryModule(const Module& module)
@@ -1702,27 +1983,20 @@ std::vector<U8> WASM::saveBinaryModule(const Module& module)
 	}
 }
 
-bool WASM::loadBinaryModule(const U8* wasmBytes,
-							Uptr numWASMBytes,
-							IR::Module& outModule,
-							LoadError* outError)
+// Calls a function that decodes a module, and translates any exception it throws into a LoadError.
+template<typename Function>
+static bool catchLoadErrors(WASM::LoadError* outError, Function&& function)
 {
-	// Load the module from a binary WebAssembly file.
 	try
 	{
-		Timing::Timer loadTimer;
-		MemoryInputStream stream(wasmBytes, numWASMBytes);
-
-		serializeModule(stream, outModule);
-
-		Timing::logRatePerSecond("Loaded WASM", loadTimer, numWASMBytes / 1024.0 / 1024.0, "MiB");
+		function();
 		return true;
 	}
 	catch(Serialization::FatalSerializationException const& exception)
 	{
 		if(outError)
 		{
-			outError->type = LoadError::Type::malformed;
+			outError->type = WASM::LoadError::Type::malformed;
 			outError->message = "Module was malformed: " + exception.message;
 		}
 		return false;
@@ -1731,7 +2005,7 @@ bool WASM::loadBinaryModule(const U8* wasmBytes,
 	{
 		if(outError)
 		{
-			outError->type = LoadError::Type::invalid;
+			outError->type = WASM::LoadError::Type::invalid;
 			outError->message = "Module was invalid: " + exception.message;
 		}
 		return false;
@@ -1740,9 +2014,341 @@ bool WASM::loadBinaryModule(const U8* wasmBytes,
 	{
 		if(outError)
 		{
-			outError->type = LoadError::Type::malformed;
+			outError->type = WASM::LoadError::Type::malformed;
 			outError->message = "Memory allocation failed: input is likely malformed";
 		}
 		return false;
 	}
 }
+
+bool WASM::loadBinaryModule(const U8* wasmBytes,
+							Uptr numWASMBytes,
+							IR::Module& outModule,
+							LoadError* outError,
+							Uptr maxCodeDecodeThreads)
+{
+	// Load the module from a binary WebAssembly file.
+	return catchLoadErrors(outError, [&]() {
+		Timing::Timer loadTimer;
+		MemoryInputStream stream(wasmBytes, numWASMBytes);
+
+		serializeModule(stream, outModule, maxCodeDecodeThreads);
+
+		Timing::logRatePerSecond("Loaded WASM", loadTimer, numWASMBytes / 1024.0 / 1024.0, "MiB");
+	});
+}
+
+bool WASM::loadBinaryModule(const SharedBytes& wasmBytes,
+							IR::Module& outModule,
+							LoadError* outError,
+							Uptr maxCodeDecodeThreads)
+{
+	return catchLoadErrors(outError, [&]() {
+		Timing::Timer loadTimer;
+		MemoryInputStream stream(wasmBytes.data(), wasmBytes.size());
+
+		serializeModule(stream, outModule, maxCodeDecodeThreads, &wasmBytes);
+
+		Timing::logRatePerSecond(
+			"Loaded WASM", loadTimer, wasmBytes.size() / 1024.0 / 1024.0, "MiB");
+	});
+}
+
+// Decodes a LEB128 encoded U32 from the beginning of some bytes. If the bytes end before the LEB128
+// does, returns false if more bytes may follow, or throws if isEndOfBytes is set.
+static bool tryDecodeVarUInt32(const U8* bytes,
+							   Uptr numBytes,
+							   bool isEndOfBytes,
+							   Uptr& outValue,
+							   Uptr& outNumValueBytes)
+{
+	// A LEB128 encoded U32 is at most 5 bytes, and its last byte has the high bit clear.
+	constexpr Uptr maxVarUInt32Bytes = 5;
+	if(!isEndOfBytes && numBytes < maxVarUInt32Bytes)
+	{
+		bool isComplete = false;
+		for(Uptr byteIndex = 0; byteIndex < numBytes && !isComplete; ++byteIndex)
+		{
+			isComplete = !(bytes[byteIndex] & 0x80);
+		}
+		if(!isComplete) { return false; }
+	}
+
+	MemoryInputStream stream(bytes, numBytes);
+	serializeVarUInt32(stream, outValue);
+	outNumValueBytes = numBytes - stream.capacity();
+	return true;
+}
+
+struct WASM::ModuleStreamDecoder
+{
+	enum class State
+	{
+		magicNumber,
+		version,
+		sectionStart,
+		sectionContents,
+		codeSectionNumFunctionBodies,
+		codeSectionFunctionBody,
+		codeSectionError,
+		failed,
+		finished,
+	};
+
+	IR::Module& module;
+	ModuleDecoder decoder;
+	State state = State::magicNumber;
+	LoadError error;
+
+	// The bytes that have been fed to the decoder, but not decoded yet.
+	std::vector<U8> pendingBytes;
+	Uptr numDecodedPendingBytes = 0;
+	Uptr numFedBytes = 0;
+
+	// The ID of the section whose contents are being decoded.
+	SectionID sectionID;
+
+	// The state of decoding a code section one function body at a time.
+	Uptr numCodeSectionBytesRemaining = 0;
+	Uptr nextFunctionBodyIndex = 0;
+	std::exception_ptr codeSectionException;
+
+	Timing::Timer loadTimer;
+
+	ModuleStreamDecoder(IR::Module& inModule) : module(inModule), decoder(inModule, 1) {}
+
+	// Decodes as many of the pending bytes as possible.
+	void decodePendingBytes()
+	{
+		while(true)
+		{
+			const U8* bytes = pendingBytes.data() + numDecodedPendingBytes;
+			const Uptr numBytes = pendingBytes.size() - numDecodedPendingBytes;
+			if(!decodeNext(bytes, numBytes)) { break; }
+		}
+
+		// Discard the decoded bytes once they are the majority of the buffer.
+		if(numDecodedPendingBytes > pendingBytes.size() / 2)
+		{
+			pendingBytes.erase(pendingBytes.begin(),
+							   pendingBytes.begin() + numDecodedPendingBytes);
+			numDecodedPendingBytes = 0;
+		}
+	}
+
+	// Decodes the next piece of the module, and returns true if there were enough bytes to do so.
+	// Each piece is decoded as soon as loadBinaryModule would have decoded it if the module ended
+	// after the piece, so errors are reported in the same order.
+	bool decodeNext(const U8* bytes, Uptr numBytes)
+	{
+		switch(state)
+		{
+		case State::magicNumber:
+		case State::version: {
+			if(numBytes < sizeof(U32)) { return false; }
+			MemoryInputStream headerStream(bytes, sizeof(U32));
+			if(state == State::magicNumber)
+			{
+				ModuleDecoder::decodeMagicNumber(headerStream);
+				state = State::version;
+			}
+			else
+			{
+				ModuleDecoder::decodeVersion(headerStream);
+				state = State::sectionStart;
+			}
+			numDecodedPendingBytes += sizeof(U32);
+			return true;
+		}
+		case State::sectionStart: {
+			if(!numBytes) { return false; }
+			sectionID = SectionID(bytes[0]);
+			decoder.beginSection(sectionID);
+			numDecodedPendingBytes += 1;
+			state = State::sectionContents;
+			return true;
+		}
+		case State::sectionContents: {
+			Uptr numSectionBytes = 0;
+			Uptr numSectionSizeBytes = 0;
+			if(!tryDecodeVarUInt32(bytes, numBytes, false, numSectionBytes, numSectionSizeBytes))
+			{
+				return false;
+			}
+
+			if(sectionID != SectionID::code)
+			{
+				// Other sections are decoded once all their bytes are available.
+				if(numBytes - numSectionSizeBytes < numSectionBytes) { return false; }
+				MemoryInputStream sectionStream(bytes, numSectionSizeBytes + numSectionBytes);
+				decoder.decodeSectionContents(sectionStream, sectionID);
+				numDecodedPendingBytes += numSectionSizeBytes + numSectionBytes;
+				state = State::sectionStart;
+				return true;
+			}
+
+			// Decode the number of function bodies at the start of the code section, and then
+			// decode the function bodies one at a time.
+			numDecodedPendingBytes += numSectionSizeBytes;
+			numCodeSectionBytesRemaining = numSectionBytes;
+			nextFunctionBodyIndex = 0;
+			state = State::codeSectionNumFunctionBodies;
+			return true;
+		}
+		case State::codeSectionNumFunctionBodies:
+		case State::codeSectionFunctionBody: {
+			// loadBinaryModule reports an error if the code section extends past the end of the
+			// module before decoding any of it, so an error in the code section isn't reported
+			// until all the section's bytes have been fed to the decoder.
+			try
+			{
+				return decodeNextCodeSectionPiece(bytes, numBytes);
+			}
+			catch(...)
+			{
+				codeSectionException = std::current_exception();
+				state = State::codeSectionError;
+				return true;
+			}
+		}
+		case State::codeSectionError: {
+			const Uptr numSkippedBytes = std::min(numBytes, numCodeSectionBytesRemaining);
+			numDecodedPendingBytes += numSkippedBytes;
+			numCodeSectionBytesRemaining -= numSkippedBytes;
+			if(numCodeSectionBytesRemaining) { return false; }
+			std::rethrow_exception(codeSectionException);
+		}
+
+		case State::failed:
+		case State::finished:
+		default: WAVM_UNREACHABLE();
+		};
+	}
+
+	bool decodeNextCodeSectionPiece(const U8* bytes, Uptr numBytes)
+	{
+		const Uptr numAvailableSectionBytes = std::min(numBytes, numCodeSectionBytesRemaining);
+		if(state == State::codeSectionNumFunctionBodies)
+		{
+			Uptr numFunctionBodies = 0;
+			Uptr numFunctionBodiesBytes = 0;
+			if(!tryDecodeVarUInt32(bytes,
+								   numAvailableSectionBytes,
+								   numAvailableSectionBytes == numCodeSectionBytesRemaining,
+								   numFunctionBodies,
+								   numFunctionBodiesBytes))
+			{
+				return false;
+			}
+			if(numFunctionBodies != module.functions.defs.size())
+			{
+				throw FatalSerializationException(
+					"function and code sections have mismatched function counts");
+			}
+
+			numDecodedPendingBytes += numFunctionBodiesBytes;
+			numCodeSectionBytesRemaining -= numFunctionBodiesBytes;
+			state = State::codeSectionFunctionBody;
+			return true;
+		}
+
+		if(nextFunctionBodyIndex == module.functions.defs.size())
+		{
+			if(numCodeSectionBytesRemaining)
+			{
+				throw FatalSerializationException("section contained more data than expected");
+			}
+			decoder.hadFunctionDefinitions = true;
+			state = State::sectionStart;
+			return true;
+		}
+
+		Uptr numBodyBytes = 0;
+		Uptr numBodySizeBytes = 0;
+		if(!tryDecodeVarUInt32(bytes,
+							   numAvailableSectionBytes,
+							   numAvailableSectionBytes == numCodeSectionBytesRemaining,
+							   numBodyBytes,
+							   numBodySizeBytes))
+		{
+			return false;
+		}
+		if(numCodeSectionBytesRemaining - numBodySizeBytes < numBodyBytes)
+		{
+			throw FatalSerializationException("expected data but found end of stream");
+		}
+		if(numBytes - numBodySizeBytes < numBodyBytes) { return false; }
+
+		// Decode and validate the function body as soon as all its bytes are available.
+		MemoryInputStream bodyStream(bytes + numBodySizeBytes, numBodyBytes);
+		decodeFunctionBody(bodyStream,
+						   module,
+						   module.functions.defs[nextFunctionBodyIndex],
+						   decoder.moduleState);
+
+		numDecodedPendingBytes += numBodySizeBytes + numBodyBytes;
+		numCodeSectionBytesRemaining -= numBodySizeBytes + numBodyBytes;
+		++nextFunctionBodyIndex;
+		return true;
+	}
+};
+
+WASM::ModuleStreamDecoder* WASM::createModuleStreamDecoder(IR::Module& outModule)
+{
+	return new ModuleStreamDecoder(outModule);
+}
+
+void WASM::destroyModuleStreamDecoder(ModuleStreamDecoder* decoder) { delete decoder; }
+
+bool WASM::feedModuleStreamDecoder(ModuleStreamDecoder* decoder,
+								   const U8* bytes,
+								   Uptr numBytes,
+								   LoadError* outError)
+{
+	WAVM_ERROR_UNLESS(decoder->state != ModuleStreamDecoder::State::finished);
+	if(decoder->state != ModuleStreamDecoder::State::failed)
+	{
+		const bool succeeded = catchLoadErrors(&decoder->error, [decoder, bytes, numBytes]() {
+			decoder->pendingBytes.insert(decoder->pendingBytes.end(), bytes, bytes + numBytes);
+			decoder->numFedBytes += numBytes;
+			decoder->decodePendingBytes();
+		});
+		if(succeeded) { return true; }
+		decoder->state = ModuleStreamDecoder::State::failed;
+	}
+
+	if(outError) { *outError = decoder->error; }
+	return false;
+}
+
+bool WASM::finishModuleStreamDecoder(ModuleStreamDecoder* decoder, LoadError* outError)
+{
+	WAVM_ERROR_UNLESS(decoder->state != ModuleStreamDecoder::State::finished);
+	if(decoder->state != ModuleStreamDecoder::State::failed)
+	{
+		const bool succeeded = catchLoadErrors(&decoder->error, [decoder]() {
+			// The module must end at the start of a section, and all the bytes that were fed to
+			// the decoder must have been decoded.
+			if(decoder->state != ModuleStreamDecoder::State::sectionStart
+			   || decoder->numDecodedPendingBytes != decoder->pendingBytes.size())
+			{
+				throw FatalSerializationException("expected data but found end of stream");
+			}
+			decoder->decoder.finish();
+
+			Timing::logRatePerSecond("Loaded WASM from stream",
+									 decoder->loadTimer,
+									 decoder->numFedBytes / 1024.0 / 1024.0,
+									 "MiB");
+		});
+		if(succeeded)
+		{
+			decoder->state = ModuleStreamDecoder::State::finished;
+			return true;
+		}
+		decoder->state = ModuleStreamDecoder::State::failed;
+	}
+
+	if(outError) { *outError = decoder->error; }
+	return false;
+}
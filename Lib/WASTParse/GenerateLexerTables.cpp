@@ -0,0 +1,71 @@
+// A build-time generator that builds the lexer's DFAs, and saves their transition tables as a C++
+// header that Lexer.cpp includes instead of building the DFAs at run time.
+
+#include <string>
+#include "Lexer.h"
+#include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/CLI.h"
+#include "WAVM/Inline/Errors.h"
+#include "WAVM/Logging/Logging.h"
+#include "WAVM/NFA/NFA.h"
+
+using namespace WAVM;
+using namespace WAVM::WAST;
+
+template<typename Element>
+static void appendArray(std::string& outString,
+						const char* elementType,
+						const char* name,
+						const Element* elements,
+						Uptr numElements)
+{
+	outString += std::string("static constexpr ") + elementType + " " + name + "["
+				 + std::to_string(numElements) + "] = {";
+	for(Uptr elementIndex = 0; elementIndex < numElements; ++elementIndex)
+	{
+		outString += elementIndex % 16 ? " " : "\n\t";
+		outString += std::to_string(elements[elementIndex]) + ",";
+	}
+	outString += "\n};\n";
+}
+
+static void appendMachineTables(std::string& outString,
+								const char* name,
+								const NFA::Machine& machine)
+{
+	const NFA::MachineTables tables = machine.getTables();
+	const std::string charToOffsetMapName = std::string(name) + "CharToOffsetMap";
+	const std::string nextStateMapName = std::string(name) + "StateAndOffsetToNextStateMap";
+
+	appendArray(outString, "WAVM::U32", charToOffsetMapName.c_str(), tables.charToOffsetMap, 256);
+	appendArray(outString,
+				"WAVM::NFA::StateIndex",
+				nextStateMapName.c_str(),
+				tables.stateAndOffsetToNextStateMap,
+				tables.numClasses * tables.numStates);
+	outString += std::string("static constexpr WAVM::NFA::MachineTables ") + name + " = {\n\t"
+				 + charToOffsetMapName + ",\n\t" + nextStateMapName + ",\n\t"
+				 + std::to_string(tables.numClasses) + ",\n\t"
+				 + std::to_string(tables.numStates) + ",\n};\n\n";
+}
+
+int main(int argc, char** argv)
+{
+	if(argc != 2)
+	{
+		Log::printf(Log::error, "Usage: GenerateLexerTables <output header>\n");
+		return EXIT_FAILURE;
+	}
+
+	std::string header
+		= "// Generated by GenerateLexerTables from the token definitions in LexerNFA.cpp.\n"
+		  "// Do not edit.\n\n"
+		  "#pragma once\n\n"
+		  "#include \"WAVM/Inline/BasicTypes.h\"\n"
+		  "#include \"WAVM/NFA/NFA.h\"\n\n";
+	appendMachineTables(header, "lexerTables", createLexerMachine(false));
+	appendMachineTables(header, "legacyLexerTables", createLexerMachine(true));
+
+	WAVM_ERROR_UNLESS(saveFile(argv[1], header.data(), header.size()));
+	return EXIT_SUCCESS;
+}
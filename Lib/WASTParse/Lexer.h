@@ -2,6 +2,7 @@
 
 #include "WAVM/IR/Operators.h"
 #include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/NFA/NFA.h"
 #include "WAVM/Platform/Defines.h"
 #include "WAVM/WASTParse/WASTParse.h"
 
@@ -123,6 +124,10 @@ namespace WAVM { namespace WAST {
 
 	struct LineInfo;
 
+	// Builds the DFA that recognizes tokens. Unless WAVM_ENABLE_PRECOMPILED_LEXER_TABLES is off,
+	// this is only called by the build-time generator of the lexer's tables.
+	NFA::Machine createLexerMachine(bool allowLegacyInstructionNames);
+
 	// Lexes a string and returns an array of tokens.
 	// Also returns a pointer in outLineInfo to the information necessary to resolve line/column
 	// numbers for the tokens. The caller should pass the tokens and line info to
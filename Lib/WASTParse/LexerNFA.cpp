@@ -0,0 +1,193 @@
+#include "Lexer.h"
+#include <string>
+#include <tuple>
+#include <utility>
+#include "WAVM/IR/Operators.h"
+#include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/CLI.h"
+#include "WAVM/Inline/Errors.h"
+#include "WAVM/Inline/Timing.h"
+#include "WAVM/NFA/NFA.h"
+#include "WAVM/RegExp/RegExp.h"
+
+#define DUMP_NFA_GRAPH 0
+#define DUMP_DFA_GRAPH 0
+
+using namespace WAVM;
+using namespace WAVM::WAST;
+
+static NFA::StateIndex createTokenSeparatorPeekState(NFA::Builder* builder,
+													 NFA::StateIndex finalState)
+{
+	NFA::CharSet tokenSeparatorCharSet;
+	tokenSeparatorCharSet.add(U8(' '));
+	tokenSeparatorCharSet.add(U8('\t'));
+	tokenSeparatorCharSet.add(U8('\r'));
+	tokenSeparatorCharSet.add(U8('\n'));
+	tokenSeparatorCharSet.add(U8('='));
+	tokenSeparatorCharSet.add(U8('('));
+	tokenSeparatorCharSet.add(U8(')'));
+	tokenSeparatorCharSet.add(U8(';'));
+	tokenSeparatorCharSet.add(0);
+	auto separatorState = addState(builder);
+	NFA::addEdge(builder,
+				 separatorState,
+				 tokenSeparatorCharSet,
+				 finalState | NFA::edgeDoesntConsumeInputFlag);
+	return separatorState;
+}
+
+static void addLiteralStringToNFA(const char* string,
+								  NFA::Builder* builder,
+								  NFA::StateIndex initialState,
+								  NFA::StateIndex finalState)
+{
+	// Add the literal to the NFA, one character at a time, reusing existing states that are
+	// reachable by the same string.
+	for(const char* nextChar = string; *nextChar; ++nextChar)
+	{
+		NFA::StateIndex nextState = NFA::getNonTerminalEdge(builder, initialState, *nextChar);
+		if(nextState < 0 || nextChar[1] == 0)
+		{
+			nextState = nextChar[1] == 0 ? finalState : addState(builder);
+			NFA::addEdge(builder, initialState, NFA::CharSet(*nextChar), nextState);
+		}
+		initialState = nextState;
+	}
+}
+
+static void addLiteralTokenToNFA(const char* literalString,
+								 NFA::Builder* builder,
+								 TokenType tokenType,
+								 bool isTokenSeparator)
+{
+	NFA::StateIndex finalState = NFA::maximumTerminalStateIndex - (NFA::StateIndex)tokenType;
+	if(!isTokenSeparator) { finalState = createTokenSeparatorPeekState(builder, finalState); }
+
+	addLiteralStringToNFA(literalString, builder, 0, finalState);
+}
+
+NFA::Machine WAST::createLexerMachine(bool allowLegacyInstructionNames)
+{
+	// clang-format off
+static const std::pair<TokenType, const char*> regexpTokenPairs[] = {
+	{t_decimalInt, "[+\\-]?\\d+(_\\d+)*"},
+	{t_decimalFloat, "[+\\-]?\\d+(_\\d+)*\\.(\\d+(_\\d+)*)*([eE][+\\-]?\\d+(_\\d+)*)?"},
+	{t_decimalFloat, "[+\\-]?\\d+(_\\d+)*[eE][+\\-]?\\d+(_\\d+)*"},
+
+	{t_hexInt, "[+\\-]?0[xX][\\da-fA-F]+(_[\\da-fA-F]+)*"},
+	{t_hexFloat, "[+\\-]?0[xX][\\da-fA-F]+(_[\\da-fA-F]+)*\\.([\\da-fA-F]+(_[\\da-fA-F]+)*)*([pP][+\\-]?\\d+(_\\d+)*)?"},
+	{t_hexFloat, "[+\\-]?0[xX][\\da-fA-F]+(_[\\da-fA-F]+)*[pP][+\\-]?\\d+(_\\d+)*"},
+
+	{t_floatNaN, "[+\\-]?nan(:0[xX][\\da-fA-F]+(_[\\da-fA-F]+)*)?"},
+	{t_floatInf, "[+\\-]?inf"},
+
+	{t_string, "\"([^\"\n\\\\]*(\\\\([^0-9a-fA-Fu]|[0-9a-fA-F][0-9a-fA-F]|u\\{[0-9a-fA-F]+})))*\""},
+
+	{t_name, "\\$[a-zA-Z0-9\'_+*/~=<>!?@#$%&|:`.\\-\\^\\\\]+"},
+	{t_quotedName, "\\$\"([^\"\n\\\\]*(\\\\([^0-9a-fA-Fu]|[0-9a-fA-F][0-9a-fA-F]|u\\{[0-9a-fA-F]+})))*\""},
+};
+
+static const std::tuple<TokenType, const char*, bool> literalTokenTuples[] = {
+	std::make_tuple(t_leftParenthesis, "(", true),
+	std::make_tuple(t_rightParenthesis, ")", true),
+	std::make_tuple(t_equals, "=", true),
+	std::make_tuple(t_canonicalNaN, "nan:canonical", false),
+	std::make_tuple(t_arithmeticNaN, "nan:arithmetic", false),
+
+	#define VISIT_TOKEN(name, _, literalString) std::make_tuple(t_##name, literalString, false),
+	ENUM_LITERAL_TOKENS()
+	#undef VISIT_TOKEN
+
+	#undef VISIT_OPERATOR_TOKEN
+	#define VISIT_OPERATOR_TOKEN(_, name, nameString, ...) std::make_tuple(t_##name, nameString, false),
+	WAVM_ENUM_OPERATORS(VISIT_OPERATOR_TOKEN)
+	#undef VISIT_OPERATOR_TOKEN
+};
+
+// Legacy aliases for tokens.
+static const std::tuple<TokenType, const char*> legacyOperatorAliasTuples[] = {
+	std::make_tuple(t_funcref            , "anyfunc"            ),
+
+	std::make_tuple(t_local_get          , "get_local"          ),
+	std::make_tuple(t_local_set          , "set_local"          ),
+	std::make_tuple(t_local_tee          , "tee_local"          ),
+	std::make_tuple(t_global_get         , "get_global"         ),
+	std::make_tuple(t_global_set         , "set_global"         ),
+
+	std::make_tuple(t_i32_wrap_i64       , "i32.wrap/i64"       ),
+	std::make_tuple(t_i32_trunc_f32_s    , "i32.trunc_s/f32"    ),
+	std::make_tuple(t_i32_trunc_f32_u    , "i32.trunc_u/f32"    ),
+	std::make_tuple(t_i32_trunc_f64_s    , "i32.trunc_s/f64"    ),
+	std::make_tuple(t_i32_trunc_f64_u    , "i32.trunc_u/f64"    ),
+	std::make_tuple(t_i64_extend_i32_s   , "i64.extend_s/i32"   ),
+	std::make_tuple(t_i64_extend_i32_u   , "i64.extend_u/i32"   ),
+	std::make_tuple(t_i64_trunc_f32_s    , "i64.trunc_s/f32"    ),
+	std::make_tuple(t_i64_trunc_f32_u    , "i64.trunc_u/f32"    ),
+	std::make_tuple(t_i64_trunc_f64_s    , "i64.trunc_s/f64"    ),
+	std::make_tuple(t_i64_trunc_f64_u    , "i64.trunc_u/f64"    ),
+	std::make_tuple(t_f32_convert_i32_s  , "f32.convert_s/i32"  ),
+	std::make_tuple(t_f32_convert_i32_u  , "f32.convert_u/i32"  ),
+	std::make_tuple(t_f32_convert_i64_s  , "f32.convert_s/i64"  ),
+	std::make_tuple(t_f32_convert_i64_u  , "f32.convert_u/i64"  ),
+	std::make_tuple(t_f32_demote_f64     , "f32.demote/f64"     ),
+	std::make_tuple(t_f64_convert_i32_s  , "f64.convert_s/i32"  ),
+	std::make_tuple(t_f64_convert_i32_u  , "f64.convert_u/i32"  ),
+	std::make_tuple(t_f64_convert_i64_s  , "f64.convert_s/i64"  ),
+	std::make_tuple(t_f64_convert_i64_u  , "f64.convert_u/i64"  ),
+	std::make_tuple(t_f64_promote_f32    , "f64.promote/f32"    ),
+	std::make_tuple(t_i32_reinterpret_f32, "i32.reinterpret/f32"),
+	std::make_tuple(t_i64_reinterpret_f64, "i64.reinterpret/f64"),
+	std::make_tuple(t_f32_reinterpret_i32, "f32.reinterpret/i32"),
+	std::make_tuple(t_f64_reinterpret_i64, "f64.reinterpret/i64")
+};
+	// clang-format on
+
+	Timing::Timer timer;
+
+	NFA::Builder* nfaBuilder = NFA::createBuilder();
+
+	for(auto regexpTokenPair : regexpTokenPairs)
+	{
+		NFA::StateIndex finalState
+			= NFA::maximumTerminalStateIndex - (NFA::StateIndex)regexpTokenPair.first;
+		finalState = createTokenSeparatorPeekState(nfaBuilder, finalState);
+		RegExp::addToNFA(regexpTokenPair.second, nfaBuilder, 0, finalState);
+	}
+
+	for(auto literalTokenTuple : literalTokenTuples)
+	{
+		const TokenType tokenType = std::get<0>(literalTokenTuple);
+		const char* literalString = std::get<1>(literalTokenTuple);
+		const bool isTokenSeparator = std::get<2>(literalTokenTuple);
+		addLiteralTokenToNFA(literalString, nfaBuilder, tokenType, isTokenSeparator);
+	}
+
+	for(auto legacyOperatorAliasTuple : legacyOperatorAliasTuples)
+	{
+		const TokenType tokenType = allowLegacyInstructionNames
+										? std::get<0>(legacyOperatorAliasTuple)
+										: TokenType(t_legacyInstructionName);
+		const char* literalString = std::get<1>(legacyOperatorAliasTuple);
+		addLiteralTokenToNFA(literalString, nfaBuilder, tokenType, false);
+	}
+
+	if(DUMP_NFA_GRAPH)
+	{
+		std::string nfaGraphVizString = NFA::dumpNFAGraphViz(nfaBuilder);
+		WAVM_ERROR_UNLESS(
+			saveFile("nfaGraph.dot", nfaGraphVizString.data(), nfaGraphVizString.size()));
+	}
+
+	NFA::Machine nfaMachine(nfaBuilder);
+
+	if(DUMP_DFA_GRAPH)
+	{
+		std::string dfaGraphVizString = nfaMachine.dumpDFAGraphViz();
+		WAVM_ERROR_UNLESS(
+			saveFile("dfaGraph.dot", dfaGraphVizString.data(), dfaGraphVizString.size()));
+	}
+
+	Timing::logTimer("built lexer tables", timer);
+	return nfaMachine;
+}
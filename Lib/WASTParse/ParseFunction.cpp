@@ -355,8 +355,13 @@ static void parseImm(CursorState* cursor, BranchTableImm& outImm)
 	{
 		outImm.defaultTargetDepth = targetDepths.back();
 		targetDepths.pop_back();
-		outImm.branchTableIndex = cursor->functionState->functionDef.branchTables.size();
-		cursor->functionState->functionDef.branchTables.push_back(std::move(targetDepths));
+
+		std::vector<Uptr>& functionTargetDepths
+			= cursor->functionState->functionDef.branchTableTargetDepths;
+		outImm.firstTargetDepthIndex = functionTargetDepths.size();
+		outImm.numTargetDepths = targetDepths.size();
+		functionTargetDepths.insert(
+			functionTargetDepths.end(), targetDepths.begin(), targetDepths.end());
 	}
 }
 
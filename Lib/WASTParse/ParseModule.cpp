@@ -531,10 +531,7 @@ static void parseData(CursorState* cursor)
 							   (const U8*)dataString.data() + dataString.size());
 	const Uptr dataSegmentIndex = cursor->moduleState->module.dataSegments.size();
 	cursor->moduleState->module.dataSegments.push_back(
-		{isActive,
-		 UINTPTR_MAX,
-		 InitializerExpression(),
-		 std::make_shared<std::vector<U8>>(std::move(dataVector))});
+		{isActive, UINTPTR_MAX, InitializerExpression(), SharedBytes(std::move(dataVector))});
 
 	if(segmentName)
 	{
@@ -1055,7 +1052,7 @@ static void parseMemory(CursorState* cursor)
 					 cursor->moduleState->module.memories.size(),
 					 indexType == IndexType::i32 ? InitializerExpression(I32(0))
 												 : InitializerExpression(I64(0)),
-					 std::make_shared<std::vector<U8>>(std::move(dataVector))});
+					 SharedBytes(std::move(dataVector))});
 				cursor->moduleState->disassemblyNames.dataSegments.emplace_back();
 			}
 
@@ -1245,8 +1242,7 @@ static void parseCustomSection(CursorState* cursor)
 	std::string dataString;
 	while(tryParseString(cursor, dataString)) {};
 
-	customSection.data = std::vector<U8>((const U8*)dataString.data(),
-										 (const U8*)dataString.data() + dataString.size());
+	customSection.data = SharedBytes((const U8*)dataString.data(), dataString.size());
 
 	// Add the custom section to the module.
 	cursor->moduleState->module.customSections.push_back(std::move(customSection));
@@ -470,9 +470,11 @@ struct FunctionPrintContext
 	{
 		string += "\nbr_table" INDENT_STRING;
 		static constexpr Uptr numTargetsPerLine = 16;
-		WAVM_ASSERT(imm.branchTableIndex < functionDef.branchTables.size());
-		const std::vector<Uptr>& targetDepths = functionDef.branchTables[imm.branchTableIndex];
-		for(Uptr targetIndex = 0; targetIndex < targetDepths.size(); ++targetIndex)
+		WAVM_ASSERT(imm.firstTargetDepthIndex + imm.numTargetDepths
+					<= functionDef.branchTableTargetDepths.size());
+		const Uptr* targetDepths
+			= functionDef.branchTableTargetDepths.data() + imm.firstTargetDepthIndex;
+		for(Uptr targetIndex = 0; targetIndex < imm.numTargetDepths; ++targetIndex)
 		{
 			if(targetIndex % numTargetsPerLine == 0) { string += '\n'; }
 			else
@@ -1212,12 +1214,12 @@ void ModulePrintContext::printModule()
 		}
 
 		static constexpr Uptr numBytesPerLine = 64;
-		for(Uptr offset = 0; offset < dataSegment.data->size(); offset += numBytesPerLine)
+		for(Uptr offset = 0; offset < dataSegment.data.size(); offset += numBytesPerLine)
 		{
 			string += "\n\"";
 			string += escapeString(
-				(const char*)dataSegment.data->data() + offset,
-				std::min(Uptr(dataSegment.data->size()) - offset, Uptr(numBytesPerLine)));
+				(const char*)dataSegment.data.data() + offset,
+				std::min(Uptr(dataSegment.data.size()) - offset, Uptr(numBytesPerLine)));
 			string += "\"";
 		}
 	}
@@ -43,6 +43,7 @@ typedef Global wasm_global_t;
 typedef Object wasm_extern_t;
 
 typedef Instance wasm_instance_t;
+typedef ModuleStream wasm_module_stream_t;
 typedef Function wasm_shared_func_t;
 typedef Table wasm_shared_table_t;
 typedef Memory wasm_shared_memory_t;
@@ -267,6 +268,7 @@ IMPLEMENT_FEATURE(multivalue, multipleResultsAndBlockParams)
 IMPLEMENT_FEATURE(reference_types, referenceTypes)
 IMPLEMENT_FEATURE(extended_name_section, extendedNameSection)
 IMPLEMENT_FEATURE(multimemory, multipleMemories)
+IMPLEMENT_FEATURE(relaxed_simd, relaxedSIMD)
 
 IMPLEMENT_FEATURE(shared_tables, sharedTables)
 IMPLEMENT_FEATURE(allow_legacy_inst_names, allowLegacyInstructionNames)
@@ -783,7 +785,7 @@ wasm_module_t* wasm_module_new_text(wasm_engine_t* engine, const char* text, siz
 
 char* wasm_module_print(const wasm_module_t* module, size_t* out_num_chars)
 {
-	const std::string wastString = WAST::print(getModuleIR(module->module));
+	const std::string wastString = WAST::print(*getModuleIRWithFunctionBodies(module->module));
 
 	char* returnBuffer = (char*)malloc(wastString.size() + 1);
 	memcpy(returnBuffer, wastString.c_str(), wastString.size());
@@ -808,6 +810,34 @@ bool wasm_module_validate(const char* binary, size_t numBinaryBytes)
 	}
 }
 
+// wasm_module_stream_t
+void wasm_module_stream_delete(wasm_module_stream_t* stream) { destroyModuleStream(stream); }
+wasm_module_stream_t* wasm_module_stream_new(wasm_engine_t* engine)
+{
+	return createModuleStream(engine->config.featureSpec);
+}
+bool wasm_module_stream_feed(wasm_module_stream_t* stream, const char* bytes, size_t numBytes)
+{
+	WASM::LoadError loadError;
+	if(feedModuleStream(stream, (const U8*)bytes, numBytes, &loadError)) { return true; }
+	else
+	{
+		Log::printf(Log::debug, "%s\n", loadError.message.c_str());
+		return false;
+	}
+}
+wasm_module_t* wasm_module_new_streaming(wasm_module_stream_t* stream)
+{
+	WASM::LoadError loadError;
+	ModuleRef module;
+	if(finishModuleStream(stream, module, &loadError)) { return new wasm_module_t{module}; }
+	else
+	{
+		Log::printf(Log::debug, "%s\n", loadError.message.c_str());
+		return nullptr;
+	}
+}
+
 size_t wasm_module_num_imports(const wasm_module_t* module)
 {
 	return getModuleIR(module->module).imports.size();
@@ -914,6 +944,25 @@ wasm_func_t* wasm_func_new(wasm_compartment_t* compartment,
 	addGCRoot(function);
 	return function;
 }
+wasm_func_t* wasm_func_new_native(wasm_compartment_t* compartment,
+								  const wasm_functype_t* type,
+								  void* native_function,
+								  const char* debug_name)
+{
+	if(type->type.results().size() > 1) { return nullptr; }
+
+	// The debug name is also used as the name of the function in the intrinsic module, so it must
+	// not be null.
+	const char* name = debug_name ? debug_name : "native";
+
+	FunctionType nativeType(type->type.results(), type->type.params(), CallingConvention::c);
+	Intrinsics::Module intrinsicModule;
+	Intrinsics::Function intrinsicFunction(&intrinsicModule, name, native_function, nativeType);
+	Instance* instance = Intrinsics::instantiateModule(compartment, {&intrinsicModule}, name);
+	Function* function = getTypedInstanceExport(instance, name, type->type);
+	addGCRoot(function);
+	return function;
+}
 wasm_func_t* wasm_func_new_with_env(wasm_compartment_t*,
 									const wasm_functype_t* type,
 									wasm_func_callback_with_env_t,
@@ -105,15 +105,15 @@ int execBenchmark(int argc, char** argv)
 
 	// Phase 1: Load the file
 	Timing::Timer loadTimer;
-	std::vector<U8> fileBytes;
-	if(!loadFile(filename, fileBytes)) { return EXIT_FAILURE; }
+	SharedBytes fileBytes;
+	if(!mapOrLoadFile(filename, fileBytes)) { return EXIT_FAILURE; }
 
 	IR::Module irModule(featureSpec);
 	if(fileBytes.size() >= sizeof(WASM::magicNumber)
 	   && !memcmp(fileBytes.data(), WASM::magicNumber, sizeof(WASM::magicNumber)))
 	{
 		WASM::LoadError loadError;
-		if(!WASM::loadBinaryModule(fileBytes.data(), fileBytes.size(), irModule, &loadError))
+		if(!WASM::loadBinaryModule(fileBytes, irModule, &loadError))
 		{
 			Log::printf(Log::error, "%s\n", loadError.message.c_str());
 			return EXIT_FAILURE;
@@ -121,13 +121,14 @@ int execBenchmark(int argc, char** argv)
 	}
 	else
 	{
-		fileBytes.push_back(0);
+		std::vector<U8> wastBytes(fileBytes.begin(), fileBytes.end());
+		wastBytes.push_back(0);
 		std::vector<WAST::Error> parseErrors;
 		if(!WAST::parseModule(
-			   (const char*)fileBytes.data(), fileBytes.size(), irModule, parseErrors))
+			   (const char*)wastBytes.data(), wastBytes.size(), irModule, parseErrors))
 		{
 			Log::printf(Log::error, "Error parsing WebAssembly text file:\n");
-			WAST::reportParseErrors(filename, (const char*)fileBytes.data(), parseErrors);
+			WAST::reportParseErrors(filename, (const char*)wastBytes.data(), parseErrors);
 			return EXIT_FAILURE;
 		}
 	}
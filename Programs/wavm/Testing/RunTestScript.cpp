@@ -1361,47 +1361,47 @@ static void processCommands(TestScriptState& state,
 	}
 }
 
-WAVM_DEFINE_INTRINSIC_FUNCTION(spectest, "print", void, spectest_print) {}
-WAVM_DEFINE_INTRINSIC_FUNCTION(spectest, "print_i32", void, spectest_print_i32, I32 a)
+WAVM_DEFINE_LEAF_INTRINSIC_FUNCTION(spectest, "print", void, spectest_print) {}
+WAVM_DEFINE_LEAF_INTRINSIC_FUNCTION(spectest, "print_i32", void, spectest_print_i32, I32 a)
 {
 	Log::printf(Log::debug, "%s : i32\n", asString(a).c_str());
 }
-WAVM_DEFINE_INTRINSIC_FUNCTION(spectest, "print_i64", void, spectest_print_i64, I64 a)
+WAVM_DEFINE_LEAF_INTRINSIC_FUNCTION(spectest, "print_i64", void, spectest_print_i64, I64 a)
 {
 	Log::printf(Log::debug, "%s : i64\n", asString(a).c_str());
 }
-WAVM_DEFINE_INTRINSIC_FUNCTION(spectest, "print_f32", void, spectest_print_f32, F32 a)
+WAVM_DEFINE_LEAF_INTRINSIC_FUNCTION(spectest, "print_f32", void, spectest_print_f32, F32 a)
 {
 	Log::printf(Log::debug, "%s : f32\n", asString(a).c_str());
 }
-WAVM_DEFINE_INTRINSIC_FUNCTION(spectest, "print_f64", void, spectest_print_f64, F64 a)
+WAVM_DEFINE_LEAF_INTRINSIC_FUNCTION(spectest, "print_f64", void, spectest_print_f64, F64 a)
 {
 	Log::printf(Log::debug, "%s : f64\n", asString(a).c_str());
 }
-WAVM_DEFINE_INTRINSIC_FUNCTION(spectest,
-							   "print_f64_f64",
-							   void,
-							   spectest_print_f64_f64,
-							   F64 a,
-							   F64 b)
+WAVM_DEFINE_LEAF_INTRINSIC_FUNCTION(spectest,
+									"print_f64_f64",
+									void,
+									spectest_print_f64_f64,
+									F64 a,
+									F64 b)
 {
 	Log::printf(Log::debug, "%s : f64\n%s : f64\n", asString(a).c_str(), asString(b).c_str());
 }
-WAVM_DEFINE_INTRINSIC_FUNCTION(spectest,
-							   "print_i32_f32",
-							   void,
-							   spectest_print_i32_f32,
-							   I32 a,
-							   F32 b)
+WAVM_DEFINE_LEAF_INTRINSIC_FUNCTION(spectest,
+									"print_i32_f32",
+									void,
+									spectest_print_i32_f32,
+									I32 a,
+									F32 b)
 {
 	Log::printf(Log::debug, "%s : i32\n%s : f32\n", asString(a).c_str(), asString(b).c_str());
 }
-WAVM_DEFINE_INTRINSIC_FUNCTION(spectest,
-							   "print_i64_f64",
-							   void,
-							   spectest_print_i64_f64,
-							   I64 a,
-							   F64 b)
+WAVM_DEFINE_LEAF_INTRINSIC_FUNCTION(spectest,
+									"print_i64_f64",
+									void,
+									spectest_print_i64_f64,
+									I64 a,
+									F64 b)
 {
 	Log::printf(Log::debug, "%s : i64\n%s : f64\n", asString(a).c_str(), asString(b).c_str());
 }
@@ -1497,6 +1497,8 @@ static void showHelp()
 		"                             module was invalid\n"
 		"  --test-cloning             Run each test command in the original compartment\n"
 		"                             and a clone of it, and compare the resulting state\n"
+		"  --imprecise-memory-traps   Compile modules with non-volatile accesses to\n"
+		"                             unshared memories\n"
 		"  --trace                    Prints instructions to stdout as they are compiled.\n"
 		"  --trace-tests              Prints test commands to stdout as they are executed.\n"
 		"  --trace-llvmir             Prints the LLVM IR for modules as they are compiled.\n"
@@ -1542,6 +1544,10 @@ int execRunTestScript(int argc, char** argv)
 			config.strictAssertMalformed = true;
 		}
 		else if(!strcmp(argv[argIndex], "--test-cloning")) { config.testCloning = true; }
+		else if(!strcmp(argv[argIndex], "--imprecise-memory-traps"))
+		{
+			config.featureSpec.preciseMemoryTraps = false;
+		}
 		else if(!strcmp(argv[argIndex], "--trace"))
 		{
 			Log::setCategoryEnabled(Log::traceValidation, true);
@@ -10,9 +10,13 @@
 #include "WAVM/IR/Value.h"
 #include "WAVM/Inline/Assert.h"
 #include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/SharedBytes.h"
 #include "WAVM/LLVMJIT/LLVMJIT.h"
+#include "WAVM/Runtime/Profiler.h"
 #include "WAVM/Runtime/Runtime.h"
+#include "WAVM/WASM/WASM.h"
 #include "WAVM/WASTParse/WASTParse.h"
+#include "WAVM/WASTPrint/WASTPrint.h"
 #include "wavm-test.h"
 
 using namespace WAVM;
@@ -421,6 +425,7 @@ static void testModuleCompileAndIntrospect(TEST_STATE_PARAM)
 	CHECK_EQ(retrievedIR.types.size(), Uptr(1));
 	CHECK_EQ(retrievedIR.functions.defs.size(), Uptr(1));
 	CHECK_EQ(retrievedIR.exports.size(), Uptr(1));
+	CHECK_EQ(getModuleIRWithFunctionBodies(compiledModule).get(), &retrievedIR);
 
 	// Verify object code can be extracted.
 	std::vector<U8> objectCode = getObjectCode(compiledModule);
@@ -463,6 +468,339 @@ static void testModuleCompileAndIntrospect(TEST_STATE_PARAM)
 	CHECK_TRUE(tryCollectCompartment(std::move(compartment)));
 }
 
+static void testReleasedFunctionBodies(TEST_STATE_PARAM)
+{
+	GCPointer<Compartment> compartment = createCompartment("releasedBodiesTest");
+	WAVM_ERROR_UNLESS(compartment);
+
+	// A module with a function that uses br_table, and a data segment.
+	static const char wat[]
+		= "(module"
+		  "  (memory 1)"
+		  "  (data (i32.const 0) \"\\2a\")"
+		  "  (func (export \"select\") (param i32) (result i32)"
+		  "    (block (block (block (br_table 0 1 2 (local.get 0)))"
+		  "      (return (i32.const 10)))"
+		  "      (return (i32.const 20)))"
+		  "    (i32.load8_u (i32.const 0)))"
+		  ")";
+
+	IR::Module irModule;
+	std::vector<WAST::Error> parseErrors;
+	bool parsed = WAST::parseModule(wat, sizeof(wat), irModule, parseErrors);
+	if(!parsed) { WAST::reportParseErrors("testReleasedFunctionBodies", wat, parseErrors); }
+	CHECK_TRUE(parsed);
+	WAVM_ERROR_UNLESS(parsed);
+	const std::string expectedText = WAST::print(irModule);
+
+	// Compile the module from IR, and load it from WASM, releasing the function bodies.
+	ModuleRef compiledModule = compileModule(irModule, true);
+	WAVM_ERROR_UNLESS(compiledModule);
+
+	const std::vector<U8> wasmBytes = WASM::saveBinaryModule(irModule);
+	ModuleRef loadedModule;
+	bool loaded = loadBinaryModule(
+		wasmBytes.data(), wasmBytes.size(), loadedModule, IR::FeatureSpec(), nullptr, true);
+	CHECK_TRUE(loaded);
+	WAVM_ERROR_UNLESS(loaded && loadedModule);
+
+	for(ModuleConstRefParam module : {ModuleConstRef(compiledModule), ModuleConstRef(loadedModule)})
+	{
+		// Instantiate the module and call the function.
+		Instance* instance = instantiateModule(compartment, module, {}, "releasedBodiesInstance");
+		WAVM_ERROR_UNLESS(instance);
+		Function* selectFunction = asFunctionNullable(getInstanceExport(instance, "select"));
+		WAVM_ERROR_UNLESS(selectFunction);
+
+		Context* context = createContext(compartment, "releasedBodiesContext");
+		WAVM_ERROR_UNLESS(context);
+
+		const I32 expectedResults[] = {10, 20, 42, 42};
+		for(I32 argument = 0; argument < 4; ++argument)
+		{
+			UntaggedValue invokeArgs[1];
+			invokeArgs[0].i32 = argument;
+			UntaggedValue invokeResults[1];
+			invokeFunction(context,
+						   selectFunction,
+						   getFunctionType(selectFunction),
+						   invokeArgs,
+						   invokeResults);
+			CHECK_EQ(invokeResults[0].i32, expectedResults[argument]);
+		}
+
+		// Verify that getModuleIR returns the module's metadata without decoding the function
+		// bodies again.
+		const IR::Module& metadataIR = getModuleIR(module);
+		CHECK_EQ(&getModuleIR(module), &metadataIR);
+		CHECK_EQ(metadataIR.exports.size(), Uptr(1));
+		CHECK_EQ(metadataIR.functions.defs.size(), Uptr(1));
+		CHECK_TRUE(metadataIR.functions.defs[0].code.empty());
+
+		// Verify that getModuleIRWithFunctionBodies decodes the function bodies each time it's
+		// called, without the module keeping them.
+		std::shared_ptr<const IR::Module> bodiesIR = getModuleIRWithFunctionBodies(module);
+		CHECK_EQ(WAST::print(*bodiesIR), expectedText);
+		CHECK_NE(getModuleIRWithFunctionBodies(module).get(), bodiesIR.get());
+		CHECK_EQ(bodiesIR.use_count(), long(1));
+	}
+
+	CHECK_TRUE(tryCollectCompartment(std::move(compartment)));
+}
+
+static void testSharedModuleBytes(TEST_STATE_PARAM)
+{
+	GCPointer<Compartment> compartment = createCompartment("sharedBytesTest");
+	WAVM_ERROR_UNLESS(compartment);
+
+	static const char wat[] = "(module"
+							  "  (memory (export \"memory\") 1)"
+							  "  (data (i32.const 0) \"active\")"
+							  "  (data $passive \"passive\")"
+							  "  (func (export \"init\")"
+							  "    (memory.init $passive"
+							  "      (i32.const 16) (i32.const 0) (i32.const 7)))"
+							  ")";
+
+	IR::Module irModule;
+	std::vector<WAST::Error> parseErrors;
+	bool parsed = WAST::parseModule(wat, sizeof(wat), irModule, parseErrors);
+	if(!parsed) { WAST::reportParseErrors("testSharedModuleBytes", wat, parseErrors); }
+	WAVM_ERROR_UNLESS(parsed);
+
+	// Load the module from a buffer that is only referenced by the SharedBytes passed to
+	// loadBinaryModule.
+	auto wasmBuffer = std::make_shared<std::vector<U8>>(WASM::saveBinaryModule(irModule));
+	const std::weak_ptr<std::vector<U8>> weakWASMBuffer = wasmBuffer;
+	const U8* wasmBufferBegin = wasmBuffer->data();
+	const U8* wasmBufferEnd = wasmBufferBegin + wasmBuffer->size();
+	SharedBytes wasmBytes(wasmBuffer, wasmBuffer->data(), wasmBuffer->size());
+	wasmBuffer.reset();
+
+	ModuleRef module;
+	bool loaded = loadBinaryModule(wasmBytes, module);
+	CHECK_TRUE(loaded);
+	WAVM_ERROR_UNLESS(loaded && module);
+
+	// The data segments are slices of the buffer, and keep it alive after the caller releases it.
+	wasmBytes = SharedBytes();
+	CHECK_FALSE(weakWASMBuffer.expired());
+	const IR::Module& loadedIR = getModuleIR(module);
+	CHECK_EQ(loadedIR.dataSegments.size(), Uptr(2));
+	for(const IR::DataSegment& dataSegment : loadedIR.dataSegments)
+	{
+		CHECK_TRUE(dataSegment.data.begin() >= wasmBufferBegin
+				   && dataSegment.data.end() <= wasmBufferEnd);
+	}
+
+	// Each instance initializes its memory from the shared active and passive segments.
+	Context* context = createContext(compartment, "sharedBytesContext");
+	WAVM_ERROR_UNLESS(context);
+	for(Uptr instanceIndex = 0; instanceIndex < 2; ++instanceIndex)
+	{
+		Instance* instance = instantiateModule(compartment, module, {}, "sharedBytesInstance");
+		WAVM_ERROR_UNLESS(instance);
+		Memory* memory = asMemoryNullable(getInstanceExport(instance, "memory"));
+		Function* initFunction = asFunctionNullable(getInstanceExport(instance, "init"));
+		WAVM_ERROR_UNLESS(memory && initFunction);
+
+		invokeFunction(context, initFunction, getFunctionType(initFunction));
+
+		const U8* memoryBytes = getMemoryBaseAddress(memory);
+		CHECK_EQ(std::string((const char*)memoryBytes, 6), std::string("active"));
+		CHECK_EQ(std::string((const char*)memoryBytes + 16, 7), std::string("passive"));
+	}
+
+	// Once the module and its instances are gone, nothing references the buffer.
+	CHECK_TRUE(tryCollectCompartment(std::move(compartment)));
+	CHECK_FALSE(weakWASMBuffer.expired());
+	module.reset();
+	CHECK_TRUE(weakWASMBuffer.expired());
+}
+
+static void testFunctionDebugNames(TEST_STATE_PARAM)
+{
+	GCPointer<Compartment> compartment = createCompartment("debugNamesTest");
+	WAVM_ERROR_UNLESS(compartment);
+
+	static const char wat[] = "(module"
+							  "  (func $named (export \"named\"))"
+							  "  (func (export \"unnamed\"))"
+							  ")";
+	ModuleRef compiledModule;
+	WAVM_ERROR_UNLESS(loadTextModule(wat, sizeof(wat), compiledModule));
+
+	auto getExportDebugName
+		= [&](Instance* instance, const char* exportName) -> const std::string& {
+		Function* function = asFunctionNullable(getInstanceExport(instance, exportName));
+		WAVM_ERROR_UNLESS(function);
+		return getDebugName(function);
+	};
+
+	// Instantiate the module with two different module debug names, alternating between them.
+	Instance* instanceA1 = instantiateModule(compartment, compiledModule, {}, "a");
+	Instance* instanceB = instantiateModule(compartment, compiledModule, {}, "b");
+	Instance* instanceA2 = instantiateModule(compartment, compiledModule, {}, "a");
+	WAVM_ERROR_UNLESS(instanceA1 && instanceB && instanceA2);
+
+	CHECK_EQ(getExportDebugName(instanceA1, "named"), std::string("wasm!a!named"));
+	CHECK_EQ(getExportDebugName(instanceA1, "unnamed"), std::string("wasm!a!<function #1>"));
+	CHECK_EQ(getExportDebugName(instanceB, "named"), std::string("wasm!b!named"));
+	CHECK_EQ(getExportDebugName(instanceA2, "named"), std::string("wasm!a!named"));
+
+	// Instances with the same module debug name should share the names, even if the module was
+	// instantiated with another module debug name in between.
+	CHECK_EQ(&getExportDebugName(instanceA1, "named"), &getExportDebugName(instanceA2, "named"));
+	CHECK_EQ(&getExportDebugName(instanceA1, "unnamed"),
+			 &getExportDebugName(instanceA2, "unnamed"));
+	CHECK_NE(&getExportDebugName(instanceA1, "named"), &getExportDebugName(instanceB, "named"));
+
+	CHECK_TRUE(tryCollectCompartment(std::move(compartment)));
+}
+
+static void testTypedFunction(TEST_STATE_PARAM)
+{
+	GCPointer<Compartment> compartment = createCompartment("typedFunctionTest");
+	WAVM_ERROR_UNLESS(compartment);
+
+	static const char wat[]
+		= "(module"
+		  "  (memory 1)"
+		  "  (func (export \"add\") (param i32 i64) (result i64)"
+		  "    (i64.add (i64.extend_i32_s (local.get 0)) (local.get 1)))"
+		  "  (func (export \"load\") (param i32) (result f64) (f64.load (local.get 0)))"
+		  "  (func (export \"double\") (param v128) (result v128)"
+		  "    (i32x4.add (local.get 0) (local.get 0)))"
+		  ")";
+
+	ModuleRef compiledModule;
+	bool loaded = loadTextModule(wat, sizeof(wat), compiledModule);
+	CHECK_TRUE(loaded);
+	WAVM_ERROR_UNLESS(loaded && compiledModule);
+
+	Instance* instance = instantiateModule(compartment, compiledModule, {}, "typedInstance");
+	WAVM_ERROR_UNLESS(instance);
+	Function* addFunction = asFunctionNullable(getInstanceExport(instance, "add"));
+	Function* loadFunction = asFunctionNullable(getInstanceExport(instance, "load"));
+	Function* doubleFunction = asFunctionNullable(getInstanceExport(instance, "double"));
+	WAVM_ERROR_UNLESS(addFunction && loadFunction && doubleFunction);
+
+	Context* context = createContext(compartment, "typedContext");
+	WAVM_ERROR_UNLESS(context);
+
+	// Call the functions through TypedFunctions.
+	TypedFunction<I64(I32, I64)> add(context, addFunction);
+	CHECK_EQ(add(-1, 100), I64(99));
+	TypedFunction<F64(U32)> load(context, loadFunction);
+	CHECK_EQ(load(0), 0.0);
+
+	// V128 arguments and results are passed through the TypedFunction.
+	TypedFunction<V128(V128)> doubleLanes(context, doubleFunction);
+	V128 lanes;
+	for(U32 laneIndex = 0; laneIndex < 4; ++laneIndex) { lanes.u32x4[laneIndex] = laneIndex + 1; }
+	const V128 doubledLanes = doubleLanes(lanes);
+	for(U32 laneIndex = 0; laneIndex < 4; ++laneIndex)
+	{
+		CHECK_EQ(doubledLanes.u32x4[laneIndex], (laneIndex + 1) * 2);
+	}
+
+	// Call a function many times from a single signal-catching frame.
+	I64 sum = 0;
+	unwindSignalsAsExceptions([&] {
+		for(I32 i = 0; i < 100; ++i) { sum = add.callWithinSignalScope(i, sum); }
+	});
+	CHECK_EQ(sum, I64(4950));
+
+	// Binding a function with the wrong signature throws an invokeSignatureMismatch exception.
+	Runtime::ExceptionType* caughtType = nullptr;
+	catchRuntimeExceptions([&] { TypedFunction<I32(I32)> badAdd(context, addFunction); },
+						   [&](Exception* caught) {
+							   caughtType = getExceptionType(caught);
+							   destroyException(caught);
+						   });
+	CHECK_EQ(caughtType, ExceptionTypes::invokeSignatureMismatch);
+
+	// Out of bounds accesses are caught whether the signal-catching frame is set up per call or
+	// by the caller.
+	caughtType = nullptr;
+	catchRuntimeExceptions([&] { load(U32(IR::numBytesPerPage)); },
+						   [&](Exception* caught) {
+							   caughtType = getExceptionType(caught);
+							   destroyException(caught);
+						   });
+	CHECK_EQ(caughtType, ExceptionTypes::outOfBoundsMemoryAccess);
+
+	caughtType = nullptr;
+	catchRuntimeExceptions(
+		[&] { load.callWithinSignalScope(U32(IR::numBytesPerPage)); },
+		[&](Exception* caught) {
+			caughtType = getExceptionType(caught);
+			destroyException(caught);
+		});
+	CHECK_EQ(caughtType, ExceptionTypes::outOfBoundsMemoryAccess);
+
+	CHECK_TRUE(tryCollectCompartment(std::move(compartment)));
+}
+
+static void testExplicitStackLimit(TEST_STATE_PARAM)
+{
+	GCPointer<Compartment> compartment = createCompartment("stackLimitTest");
+	WAVM_ERROR_UNLESS(compartment);
+
+	// A function that recurses n times, and returns -n*(n+1)/2.
+	static const char wat[]
+		= "(module"
+		  "  (func $recurse (export \"recurse\") (param i32) (result i32)"
+		  "    (if (result i32) (i32.eqz (local.get 0))"
+		  "      (then (i32.const 0))"
+		  "      (else (i32.sub (call $recurse (i32.sub (local.get 0) (i32.const 1)))"
+		  "                     (local.get 0)))))"
+		  ")";
+
+	IR::Module irModule;
+	irModule.featureSpec.explicitStackLimitChecks = true;
+	std::vector<WAST::Error> parseErrors;
+	bool parsed = WAST::parseModule(wat, sizeof(wat), irModule, parseErrors);
+	CHECK_TRUE(parsed);
+	WAVM_ERROR_UNLESS(parsed);
+	ModuleRef compiledModule = compileModule(irModule);
+
+	Instance* instance = instantiateModule(compartment, compiledModule, {}, "stackLimitInstance");
+	WAVM_ERROR_UNLESS(instance);
+	Function* recurseFunction = asFunctionNullable(getInstanceExport(instance, "recurse"));
+	WAVM_ERROR_UNLESS(recurseFunction);
+
+	Context* context = createContext(compartment, "stackLimitContext");
+	WAVM_ERROR_UNLESS(context);
+	CHECK_EQ(getContextStackLimit(context), (const void*)nullptr);
+
+	TypedFunction<I32(I32)> recurse(context, recurseFunction);
+	CHECK_EQ(recurse(100), I32(-5050));
+
+	// Limit the stack to 64KB below the current stack pointer.
+	U8 stackMarker = 0;
+	const void* stackLimit
+		= reinterpret_cast<const void*>(reinterpret_cast<Uptr>(&stackMarker) - 65536);
+	setContextStackLimit(context, stackLimit);
+	CHECK_EQ(getContextStackLimit(context), stackLimit);
+
+	// Shallow recursion still succeeds, but deep recursion exceeds the limit well before it would
+	// exhaust the thread's stack.
+	CHECK_EQ(recurse(100), I32(-5050));
+	Runtime::ExceptionType* caughtType = nullptr;
+	catchRuntimeExceptions([&] { recurse(1000000); },
+						   [&](Exception* caught) {
+							   caughtType = getExceptionType(caught);
+							   destroyException(caught);
+						   });
+	CHECK_EQ(caughtType, ExceptionTypes::stackOverflow);
+
+	// The context is still usable after the stack overflow.
+	CHECK_EQ(recurse(100), I32(-5050));
+
+	CHECK_TRUE(tryCollectCompartment(std::move(compartment)));
+}
+
 static void testForeignObjects(TEST_STATE_PARAM)
 {
 	GCPointer<Compartment> compartment = createCompartment("foreignTest");
@@ -661,6 +999,54 @@ static void testTrapInstructionIndexWithInlining(TEST_STATE_PARAM)
 	CHECK_TRUE(tryCollectCompartment(std::move(compartment)));
 }
 
+static void testProfiler(TEST_STATE_PARAM)
+{
+	GCPointer<Compartment> compartment = createCompartment("profilerTest");
+	WAVM_ERROR_UNLESS(compartment);
+
+	// A function that calls a function that loops for the given number of iterations.
+	static const char wat[]
+		= "(module"
+		  "  (func $spin (param i32) (result i32)"
+		  "    (local i32)"
+		  "    (loop $loop"
+		  "      (local.set 1"
+		  "        (i32.add (i32.mul (local.get 1) (i32.const 1103515245)) (i32.const 12345)))"
+		  "      (br_if $loop (local.tee 0 (i32.sub (local.get 0) (i32.const 1)))))"
+		  "    (local.get 1))"
+		  "  (func $outer (export \"outer\") (param i32) (result i32) (call $spin (local.get 0)))"
+		  ")";
+
+	ModuleRef compiledModule;
+	bool loaded = loadTextModule(wat, sizeof(wat), compiledModule);
+	CHECK_TRUE(loaded);
+	WAVM_ERROR_UNLESS(loaded && compiledModule);
+
+	Instance* instance = instantiateModule(compartment, compiledModule, {}, "profiled");
+	WAVM_ERROR_UNLESS(instance);
+	Function* outerFunction = asFunctionNullable(getInstanceExport(instance, "outer"));
+	WAVM_ERROR_UNLESS(outerFunction);
+
+	Context* context = createContext(compartment, "profilerContext");
+	WAVM_ERROR_UNLESS(context);
+
+	// Sampling is only supported by the POSIX platform.
+	if(startProfiling(1000))
+	{
+		TypedFunction<I32(I32)> outer(context, outerFunction);
+		outer(I32(0x20000000));
+		const std::vector<U8> profile = stopProfiling(ProfileFormat::foldedStacks);
+		const std::string foldedStacks(profile.begin(), profile.end());
+
+		// The samples of the loop should be attributed to $spin, called by $outer.
+		const std::string outerName = getDebugName(outerFunction);
+		const std::string spinName = outerName.substr(0, outerName.rfind('!') + 1) + "spin";
+		CHECK_NE(foldedStacks.find(outerName + ';' + spinName + ' '), std::string::npos);
+	}
+
+	CHECK_TRUE(tryCollectCompartment(std::move(compartment)));
+}
+
 static void testGarbageCollection(TEST_STATE_PARAM)
 {
 	GCPointer<Compartment> compartment = createCompartment("gcTest");
@@ -702,9 +1088,15 @@ int execAPITest(int argc, char** argv)
 	testGlobalOperations(testState);
 	testExceptionTypes(testState);
 	testModuleCompileAndIntrospect(testState);
+	testReleasedFunctionBodies(testState);
+	testSharedModuleBytes(testState);
+	testFunctionDebugNames(testState);
+	testTypedFunction(testState);
+	testExplicitStackLimit(testState);
 	testTrapInstructionIndex(testState);
 	testTrapInstructionIndexWithInlining(testState);
 	testForeignObjects(testState);
+	testProfiler(testState);
 	testGarbageCollection(testState);
 	return testState.exitCode();
 }
@@ -30,6 +30,9 @@ own wasm_trap_t* hello_callback(const wasm_val_t args[], wasm_val_t results[])
 	return NULL;
 }
 
+// A native function to be called from Wasm code with the C calling convention.
+static int32_t native_add(int32_t a, int32_t b) { return a + b; }
+
 int execCAPITest(int argc, char** argv)
 {
 	// Initialize.
@@ -298,6 +301,43 @@ int execCAPITest(int argc, char** argv)
 				   "invalid module fails validation");
 	}
 
+	// =========================================================================
+	// Streaming module compilation
+	// =========================================================================
+	{
+		// Feed the hello module to a stream a few bytes at a time.
+		own wasm_module_stream_t* stream = wasm_module_stream_new(engine);
+		CAPI_CHECK_NOT_NULL(stream);
+		for(size_t offset = 0; offset < sizeof(hello_wasm); offset += 5)
+		{
+			const size_t numBytes
+				= sizeof(hello_wasm) - offset < 5 ? sizeof(hello_wasm) - offset : 5;
+			CAPI_CHECK(wasm_module_stream_feed(stream, hello_wasm + offset, numBytes),
+					   "streamed module bytes are accepted");
+		}
+		own wasm_module_t* streamed_mod = wasm_module_new_streaming(stream);
+		CAPI_CHECK_NOT_NULL(streamed_mod);
+		CAPI_CHECK(wasm_module_num_exports(streamed_mod) == 1, "streamed module has 1 export");
+		wasm_module_delete(streamed_mod);
+		wasm_module_stream_delete(stream);
+
+		// A truncated module should fail to compile.
+		own wasm_module_stream_t* truncated_stream = wasm_module_stream_new(engine);
+		CAPI_CHECK(wasm_module_stream_feed(truncated_stream, hello_wasm, sizeof(hello_wasm) - 1),
+				   "truncated module bytes are accepted");
+		CAPI_CHECK(!wasm_module_new_streaming(truncated_stream),
+				   "truncated module fails to compile");
+		wasm_module_stream_delete(truncated_stream);
+
+		// Bytes that aren't a module should be rejected as soon as they are fed to the stream.
+		char invalid_wasm[] = {0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0xFF, 0x00};
+		own wasm_module_stream_t* invalid_stream = wasm_module_stream_new(engine);
+		CAPI_CHECK(!wasm_module_stream_feed(invalid_stream, invalid_wasm, sizeof(invalid_wasm)),
+				   "invalid module bytes are rejected");
+		CAPI_CHECK(!wasm_module_new_streaming(invalid_stream), "invalid module fails to compile");
+		wasm_module_stream_delete(invalid_stream);
+	}
+
 	// =========================================================================
 	// Text module compilation
 	// =========================================================================
@@ -336,6 +376,69 @@ int execCAPITest(int argc, char** argv)
 		wasm_func_delete(func);
 	}
 
+	// =========================================================================
+	// Native functions
+	// =========================================================================
+	{
+		static const char add_wat[]
+			= "(module"
+			  "  (func $add (import \"\" \"add\") (param i32 i32) (result i32))"
+			  "  (func (export \"run\") (param i32) (result i32)"
+			  "    (call $add (local.get 0) (i32.const 1000))"
+			  "  )"
+			  ")";
+
+		own wasm_module_t* add_mod = wasm_module_new_text(engine, add_wat, sizeof(add_wat));
+		CAPI_CHECK_NOT_NULL(add_mod);
+
+		own wasm_valtype_t* params[2];
+		params[0] = wasm_valtype_new_i32();
+		params[1] = wasm_valtype_new_i32();
+		own wasm_valtype_t* results[2];
+		results[0] = wasm_valtype_new_i32();
+		own wasm_functype_t* ft = wasm_functype_new(params, 2, results, 1);
+		own wasm_func_t* add_func
+			= wasm_func_new_native(compartment, ft, (void*)&native_add, "native_add");
+		CAPI_CHECK_NOT_NULL(add_func);
+
+		const wasm_extern_t* add_imports[1];
+		add_imports[0] = wasm_func_as_extern(add_func);
+		own wasm_instance_t* add_instance
+			= wasm_instance_new(store, add_mod, add_imports, NULL, "add_instance");
+		CAPI_CHECK_NOT_NULL(add_instance);
+
+		const wasm_func_t* add_run_func
+			= wasm_extern_as_func(wasm_instance_export(add_instance, 0));
+		CAPI_CHECK_NOT_NULL(add_run_func);
+
+		wasm_val_t args[1];
+		wasm_val_t outs[1];
+		args[0].i32 = 234;
+		CAPI_CHECK(!wasm_func_call(store, add_run_func, args, outs),
+				   "native function call succeeds");
+		CAPI_CHECK(outs[0].i32 == 1234, "native function returns 1234");
+
+		// Native functions may be created without a debug name.
+		own wasm_func_t* unnamed_func
+			= wasm_func_new_native(compartment, ft, (void*)&native_add, NULL);
+		CAPI_CHECK_NOT_NULL(unnamed_func);
+		wasm_func_delete(unnamed_func);
+
+		// Native functions can't have more than one result.
+		params[0] = wasm_valtype_new_i32();
+		results[0] = wasm_valtype_new_i32();
+		results[1] = wasm_valtype_new_i32();
+		own wasm_functype_t* multi_ft = wasm_functype_new(params, 1, results, 2);
+		CAPI_CHECK(!wasm_func_new_native(compartment, multi_ft, (void*)&native_add, "multi"),
+				   "native function with 2 results is rejected");
+
+		wasm_functype_delete(multi_ft);
+		wasm_instance_delete(add_instance);
+		wasm_module_delete(add_mod);
+		wasm_functype_delete(ft);
+		wasm_func_delete(add_func);
+	}
+
 	// =========================================================================
 	// Trap inspection
 	// =========================================================================
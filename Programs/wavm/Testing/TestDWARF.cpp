@@ -1,7 +1,8 @@
-// Tests for the DWARF parser (WAVM::DWARF::getSourceLocations).
+// Tests for the DWARF parser (WAVM::DWARF::getSourceLocations and DWARF::AddressIndex).
 // Constructs synthetic DWARF sections in memory and verifies address-to-source-location lookup.
 
 #include <cstring>
+#include <initializer_list>
 #include <vector>
 #include "TestUtils.h"
 #include "WAVM/DWARF/Constants.h"
@@ -216,6 +217,30 @@ static Uptr constAddPCIncrement()
 	return Uptr((255 - kOpcodeBase) / kLineRange) * kMinInstructionLength;
 }
 
+// Check that an AddressIndex built from the sections maps each address to the same source
+// locations as parsing the sections.
+static void checkAddressIndex(TEST_STATE_PARAM,
+							  const DWARF::Sections& sections,
+							  std::initializer_list<Uptr> addresses)
+{
+	DWARF::AddressIndex index;
+	DWARF::buildAddressIndex(sections, index);
+	for(Uptr address : addresses)
+	{
+		DWARF::SourceLocation expected[8];
+		DWARF::SourceLocation actual[8];
+		Uptr expectedCount = DWARF::getSourceLocations(sections, address, expected, 8);
+		Uptr actualCount = DWARF::getSourceLocations(index, address, actual, 8);
+		CHECK_EQ(actualCount, expectedCount);
+		for(Uptr i = 0; i < expectedCount && i < actualCount; ++i)
+		{
+			CHECK_TRUE(actual[i].linkageName == expected[i].linkageName);
+			CHECK_TRUE(actual[i].name == expected[i].name);
+			CHECK_EQ(actual[i].line, expected[i].line);
+		}
+	}
+}
+
 // ---------------------------------------------------------------------------
 // Test 1: testSimpleFunction
 // 1 CU with 1 subprogram, name via .debug_str, line from .debug_line.
@@ -290,6 +315,8 @@ static void testSimpleFunction(TEST_STATE_PARAM)
 		CHECK_TRUE(locs[0].name != nullptr && strcmp(locs[0].name, "myFunction") == 0);
 		CHECK_EQ(locs[0].line, Uptr(42));
 	}
+
+	checkAddressIndex(TEST_STATE_ARG, sections, {0xFFF, 0x1000, 0x1020, 0x107F, 0x1080, 0x1100});
 }
 
 // ---------------------------------------------------------------------------
@@ -341,6 +368,8 @@ static void testFunctionNotFound(TEST_STATE_PARAM)
 	// Address 0x2000 is outside [0x1000, 0x1100)
 	Uptr count = DWARF::getSourceLocations(sections, 0x2000, locs, 4);
 	CHECK_EQ(count, Uptr(0));
+
+	checkAddressIndex(TEST_STATE_ARG, sections, {0x1000, 0x1080, 0x2000});
 }
 
 // ---------------------------------------------------------------------------
@@ -428,6 +457,9 @@ static void testInlineChain(TEST_STATE_PARAM)
 		CHECK_TRUE(locs[1].name != nullptr && strcmp(locs[1].name, "outerFunc") == 0);
 		CHECK_EQ(locs[1].line, Uptr(100));
 	}
+
+	checkAddressIndex(
+		TEST_STATE_ARG, sections, {0x1000, 0x104F, 0x1050, 0x1060, 0x108F, 0x1090, 0x11FF, 0x1200});
 }
 
 // ---------------------------------------------------------------------------
@@ -530,6 +562,8 @@ static void testAbstractOrigin(TEST_STATE_PARAM)
 		CHECK_TRUE(locs[1].name != nullptr && strcmp(locs[1].name, "caller") == 0);
 		CHECK_EQ(locs[1].line, Uptr(77));
 	}
+
+	checkAddressIndex(TEST_STATE_ARG, sections, {0x2000, 0x2090, 0x20FF, 0x2100});
 }
 
 // ---------------------------------------------------------------------------
@@ -772,6 +806,8 @@ static void testLineTableSpecialOpcodes(TEST_STATE_PARAM)
 	count = DWARF::getSourceLocations(sections, 0x6003, locs, 4);
 	CHECK_EQ(count, Uptr(1));
 	if(count >= 1) { CHECK_EQ(locs[0].line, Uptr(14)); }
+
+	checkAddressIndex(TEST_STATE_ARG, sections, {0x5FFF, 0x6000, 0x6001, 0x6002, 0x6003, 0x6100});
 }
 
 // ---------------------------------------------------------------------------
@@ -942,6 +978,8 @@ static void testMultipleCUs(TEST_STATE_PARAM)
 		CHECK_TRUE(locs[0].name != nullptr && strcmp(locs[0].name, "cu2func") == 0);
 		CHECK_EQ(locs[0].line, Uptr(50));
 	}
+
+	checkAddressIndex(TEST_STATE_ARG, sections, {0xA000, 0xA010, 0xB000, 0xB020, 0xB100});
 }
 
 // ---------------------------------------------------------------------------
@@ -1154,6 +1192,8 @@ static void testMaxLocations(TEST_STATE_PARAM)
 		CHECK_TRUE(locs[1].name != nullptr && strcmp(locs[1].name, "level2") == 0);
 		CHECK_EQ(locs[1].line, Uptr(30));
 	}
+
+	checkAddressIndex(TEST_STATE_ARG, sections, {0xD000, 0xD010, 0xD080, 0xD100, 0xD180, 0xD200});
 }
 
 // ---------------------------------------------------------------------------
@@ -1254,6 +1294,8 @@ static void testDeclLineForSubprogram(TEST_STATE_PARAM)
 		CHECK_TRUE(locs[0].name != nullptr && strcmp(locs[0].name, "outerWithDeclLine") == 0);
 		CHECK_EQ(locs[0].line, Uptr(0)); // no line table entry covers 0xE000
 	}
+
+	checkAddressIndex(TEST_STATE_ARG, sections, {0xE000, 0xE050, 0xE100});
 }
 
 // ---------------------------------------------------------------------------
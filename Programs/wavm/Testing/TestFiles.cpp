@@ -0,0 +1,401 @@
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TestUtils.h"
+#include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/SharedBytes.h"
+#include "WAVM/Inline/Timing.h"
+#include "WAVM/Logging/Logging.h"
+#include "WAVM/Platform/File.h"
+#include "WAVM/Platform/Memory.h"
+#include "WAVM/Platform/Random.h"
+#include "WAVM/VFS/SandboxFS.h"
+#include "WAVM/VFS/VFS.h"
+#include "wavm-test.h"
+
+using namespace WAVM;
+using namespace WAVM::Testing;
+using namespace WAVM::VFS;
+
+#define CHECK_RESULT(actual, expected)                                                             \
+	CHECK_EQ(std::string(describeResult(actual)), std::string(describeResult(expected)))
+
+static std::string getTempPath(const char* name)
+{
+	const char* tempDir = getenv("TMPDIR");
+	if(!tempDir || !*tempDir) { tempDir = "/tmp"; }
+
+	U32 randomSuffix = 0;
+	Platform::getCryptographicRNG((U8*)&randomSuffix, sizeof(randomSuffix));
+	return std::string(tempDir) + "/wavm-" + name + "-" + std::to_string(randomSuffix);
+}
+
+static void closeVFD(TEST_STATE_PARAM, VFD*& vfd)
+{
+	if(vfd)
+	{
+		CHECK_RESULT(vfd->close(), Result::success);
+		vfd = nullptr;
+	}
+}
+
+static void writeFile(TEST_STATE_PARAM, FileSystem& fs, const std::string& path, const char* data)
+{
+	VFD* vfd = nullptr;
+	CHECK_RESULT(fs.open(path, FileAccessMode::writeOnly, FileCreateMode::createNew, vfd),
+				 Result::success);
+	if(!vfd) { return; }
+
+	Uptr numBytesWritten = 0;
+	CHECK_RESULT(vfd->write(data, strlen(data), &numBytesWritten), Result::success);
+	CHECK_EQ(numBytesWritten, Uptr(strlen(data)));
+	closeVFD(TEST_STATE_ARG, vfd);
+}
+
+static std::string readFile(TEST_STATE_PARAM, FileSystem& fs, const std::string& path)
+{
+	VFD* vfd = nullptr;
+	CHECK_RESULT(fs.open(path, FileAccessMode::readOnly, FileCreateMode::openExisting, vfd),
+				 Result::success);
+	if(!vfd) { return std::string(); }
+
+	char buffer[64];
+	Uptr numBytesRead = 0;
+	CHECK_RESULT(vfd->read(buffer, sizeof(buffer), &numBytesRead), Result::success);
+	closeVFD(TEST_STATE_ARG, vfd);
+	return std::string(buffer, numBytesRead);
+}
+
+static void testAllocate(TEST_STATE_PARAM, FileSystem& fs)
+{
+	VFD* vfd = nullptr;
+	CHECK_RESULT(fs.open("/allocated", FileAccessMode::readWrite, FileCreateMode::createNew, vfd),
+				 Result::success);
+	if(!vfd) { return; }
+
+	// Allocating past the end of the file should extend it.
+	FileInfo fileInfo;
+	CHECK_RESULT(vfd->allocate(4096, 65536), Result::success);
+	CHECK_RESULT(vfd->getFileInfo(fileInfo), Result::success);
+	CHECK_EQ(fileInfo.numBytes, U64(4096 + 65536));
+
+	// Allocating a range within the file shouldn't change its size.
+	CHECK_RESULT(vfd->allocate(0, 1024), Result::success);
+	CHECK_RESULT(vfd->getFileInfo(fileInfo), Result::success);
+	CHECK_EQ(fileInfo.numBytes, U64(4096 + 65536));
+
+	// The allocated range should read as zeros.
+	U8 buffer[256];
+	U64 readOffset = 8192;
+	Uptr numBytesRead = 0;
+	CHECK_RESULT(vfd->read(buffer, sizeof(buffer), &numBytesRead, &readOffset), Result::success);
+	CHECK_EQ(numBytesRead, sizeof(buffer));
+	bool isZero = true;
+	for(U8 byte : buffer) { isZero = isZero && !byte; }
+	CHECK_TRUE(isZero);
+
+	// Ranges that overflow the maximum file size should fail.
+	CHECK_RESULT(vfd->allocate(UINT64_MAX, 1), Result::exceededFileSizeLimit);
+	CHECK_RESULT(vfd->allocate(1, UINT64_MAX), Result::exceededFileSizeLimit);
+
+	closeVFD(TEST_STATE_ARG, vfd);
+	CHECK_RESULT(fs.unlinkFile("/allocated"), Result::success);
+}
+
+static void testHardLinks(TEST_STATE_PARAM, FileSystem& fs)
+{
+	writeFile(TEST_STATE_ARG, fs, "/original", "hard link");
+
+	CHECK_RESULT(fs.createHardLink("/original", "/hardlink"), Result::success);
+	CHECK_RESULT(fs.createHardLink("/original", "/hardlink"), Result::alreadyExists);
+	CHECK_RESULT(fs.createHardLink("/missing", "/hardlink2"), Result::doesNotExist);
+
+	// Both paths should refer to the same file.
+	FileInfo originalInfo;
+	FileInfo linkInfo;
+	CHECK_RESULT(fs.getFileInfo("/original", originalInfo), Result::success);
+	CHECK_RESULT(fs.getFileInfo("/hardlink", linkInfo), Result::success);
+	CHECK_EQ(originalInfo.fileNumber, linkInfo.fileNumber);
+	CHECK_EQ(linkInfo.numLinks, U32(2));
+
+	// The link should still refer to the file after the original path is removed.
+	CHECK_RESULT(fs.unlinkFile("/original"), Result::success);
+	CHECK_EQ(readFile(TEST_STATE_ARG, fs, "/hardlink"), std::string("hard link"));
+
+	CHECK_RESULT(fs.unlinkFile("/hardlink"), Result::success);
+}
+
+static void testSymbolicLinks(TEST_STATE_PARAM, FileSystem& fs)
+{
+	CHECK_RESULT(fs.createDir("/dir"), Result::success);
+	writeFile(TEST_STATE_ARG, fs, "/dir/target", "symbolic link");
+
+	// Create links to the target, and check that they can be read and followed.
+	CHECK_RESULT(fs.createSymbolicLink("dir/target", "/symlink"), Result::success);
+	CHECK_RESULT(fs.createSymbolicLink("./target", "/dir/symlink"), Result::success);
+
+	std::string targetPath;
+	CHECK_RESULT(fs.readSymbolicLink("/symlink", targetPath), Result::success);
+	CHECK_EQ(targetPath, std::string("dir/target"));
+	CHECK_RESULT(fs.readSymbolicLink("/dir/symlink", targetPath), Result::success);
+	CHECK_EQ(targetPath, std::string("./target"));
+	CHECK_EQ(readFile(TEST_STATE_ARG, fs, "/symlink"), std::string("symbolic link"));
+	CHECK_EQ(readFile(TEST_STATE_ARG, fs, "/dir/symlink"), std::string("symbolic link"));
+
+	// Reading a path that isn't a symbolic link should fail.
+	CHECK_RESULT(fs.readSymbolicLink("/dir/target", targetPath), Result::isNotSymbolicLink);
+	CHECK_RESULT(fs.readSymbolicLink("/missing", targetPath), Result::doesNotExist);
+
+	// Hard links to a symbolic link should refer to the link, not its target.
+	CHECK_RESULT(fs.createHardLink("/symlink", "/hardlink"), Result::success);
+	CHECK_RESULT(fs.readSymbolicLink("/hardlink", targetPath), Result::success);
+	CHECK_EQ(targetPath, std::string("dir/target"));
+
+	// Links that could escape the sandbox should be rejected.
+	const char* escapingTargetPaths[] = {
+		"",
+		"/etc/passwd",
+		"..",
+		"../target",
+		"dir/../../target",
+		"dir/..",
+		"C:/target",
+		"\\target",
+	};
+	for(const char* escapingTargetPath : escapingTargetPaths)
+	{
+		CHECK_RESULT(fs.createSymbolicLink(escapingTargetPath, "/dir/escape"),
+					 Result::notPermitted);
+	}
+
+	CHECK_RESULT(fs.unlinkFile("/hardlink"), Result::success);
+	CHECK_RESULT(fs.unlinkFile("/dir/symlink"), Result::success);
+	CHECK_RESULT(fs.unlinkFile("/symlink"), Result::success);
+	CHECK_RESULT(fs.unlinkFile("/dir/target"), Result::success);
+	CHECK_RESULT(fs.removeDir("/dir"), Result::success);
+}
+
+// Writes numBytes sequentially to a new file, after preparing the file with either
+// VFD::allocate, or by writing zeros to it as guests without fd_allocate do. If logTiming is set,
+// logs the rate of the writes.
+static void writeSequentially(TEST_STATE_PARAM,
+							  FileSystem& fs,
+							  const char* path,
+							  U64 numBytes,
+							  bool useAllocate,
+							  bool logTiming)
+{
+	VFD* vfd = nullptr;
+	CHECK_RESULT(fs.open(path, FileAccessMode::writeOnly, FileCreateMode::createNew, vfd),
+				 Result::success);
+	if(!vfd) { return; }
+
+	std::vector<U8> buffer(65536, 0);
+	U64 offset = 0;
+	Uptr numBytesWritten = 0;
+
+	Timing::Timer timer;
+	if(useAllocate) { CHECK_RESULT(vfd->allocate(0, numBytes), Result::success); }
+	else
+	{
+		for(offset = 0; offset < numBytes; offset += buffer.size())
+		{
+			CHECK_RESULT(vfd->write(buffer.data(), buffer.size(), &numBytesWritten, &offset),
+						 Result::success);
+		}
+	}
+
+	for(Uptr index = 0; index < buffer.size(); ++index) { buffer[index] = U8(index); }
+	for(offset = 0; offset < numBytes; offset += buffer.size())
+	{
+		CHECK_RESULT(vfd->write(buffer.data(), buffer.size(), &numBytesWritten),
+					 Result::success);
+		CHECK_EQ(numBytesWritten, buffer.size());
+	}
+	CHECK_RESULT(vfd->sync(SyncType::contents), Result::success);
+	timer.stop();
+
+	if(logTiming)
+	{
+		Timing::logRatePerSecond(
+			useAllocate ? "Wrote preallocated file" : "Wrote zero-filled file",
+			timer,
+			F64(numBytes) / (1024.0 * 1024.0),
+			"MiB");
+	}
+
+	closeVFD(TEST_STATE_ARG, vfd);
+}
+
+// Checks that a file written by writeSequentially has the expected size and contents.
+static void checkSequentialFile(TEST_STATE_PARAM, FileSystem& fs, const char* path, U64 numBytes)
+{
+	VFD* vfd = nullptr;
+	CHECK_RESULT(fs.open(path, FileAccessMode::readOnly, FileCreateMode::openExisting, vfd),
+				 Result::success);
+	if(!vfd) { return; }
+
+	FileInfo fileInfo;
+	CHECK_RESULT(vfd->getFileInfo(fileInfo), Result::success);
+	CHECK_EQ(fileInfo.numBytes, numBytes);
+
+	std::vector<U8> buffer(65536);
+	for(U64 offset = 0; offset < numBytes; offset += buffer.size())
+	{
+		Uptr numBytesRead = 0;
+		CHECK_RESULT(vfd->read(buffer.data(), buffer.size(), &numBytesRead), Result::success);
+		CHECK_EQ(numBytesRead, buffer.size());
+		for(Uptr index = 0; index < numBytesRead; ++index)
+		{
+			if(buffer[index] != U8(index))
+			{
+				CHECK_EQ(buffer[index], U8(index));
+				break;
+			}
+		}
+	}
+
+	closeVFD(TEST_STATE_ARG, vfd);
+}
+
+// Opens a file and maps it with Platform::mapFile. The VFD is closed before returning, since the
+// mapping doesn't need it.
+static const U8* mapFile(TEST_STATE_PARAM,
+						 FileSystem& fs,
+						 const std::string& path,
+						 Uptr& outNumBytes)
+{
+	VFD* vfd = nullptr;
+	CHECK_RESULT(fs.open(path, FileAccessMode::readOnly, FileCreateMode::openExisting, vfd),
+				 Result::success);
+	if(!vfd) { return nullptr; }
+
+	const U8* mappedBytes = nullptr;
+	Uptr hostDescriptor = 0;
+	const Result result = vfd->getHostDescriptor(hostDescriptor);
+	CHECK_RESULT(result, Result::success);
+	if(result == Result::success) { mappedBytes = Platform::mapFile(hostDescriptor, outNumBytes); }
+	closeVFD(TEST_STATE_ARG, vfd);
+	return mappedBytes;
+}
+
+static void testMapFile(TEST_STATE_PARAM, FileSystem& fs)
+{
+	static const char contents[] = "mapped file contents";
+	writeFile(TEST_STATE_ARG, fs, "/mapped", contents);
+
+	// The mapping should contain the whole file, and stay valid after the file is closed.
+	Uptr numMappedBytes = 0;
+	const U8* mappedBytes = mapFile(TEST_STATE_ARG, fs, "/mapped", numMappedBytes);
+	CHECK_NOT_NULL(mappedBytes);
+	if(!mappedBytes) { return; }
+	CHECK_EQ(numMappedBytes, Uptr(strlen(contents)));
+	CHECK_EQ(std::string((const char*)mappedBytes, numMappedBytes), std::string(contents));
+
+	// Share the mapping with SharedBytes, and check that it's only unmapped once the SharedBytes
+	// and all slices of it are destroyed.
+	auto isUnmapped = std::make_shared<bool>(false);
+	{
+		std::shared_ptr<const U8> mapping(
+			mappedBytes, [numMappedBytes, isUnmapped](const U8* baseAddress) {
+				Platform::unmapFile(baseAddress, numMappedBytes);
+				*isUnmapped = true;
+			});
+		SharedBytes fileBytes(std::move(mapping), mappedBytes, numMappedBytes);
+
+		SharedBytes slice = fileBytes.slice(fileBytes.data() + 7, 4);
+		CHECK_EQ(slice.data(), mappedBytes + 7);
+		CHECK_TRUE(fileBytes.contains(slice.data(), slice.size()));
+		CHECK_FALSE(slice.contains(fileBytes.data(), fileBytes.size()));
+
+		// SharedBytes compare by value, regardless of what owns their storage.
+		CHECK_TRUE(slice == SharedBytes((const U8*)"file", 4));
+		CHECK_TRUE(slice != SharedBytes((const U8*)"fire", 4));
+
+		fileBytes = SharedBytes();
+		CHECK_FALSE(*isUnmapped);
+		CHECK_EQ(std::string((const char*)slice.data(), slice.size()), std::string("file"));
+	}
+	CHECK_TRUE(*isUnmapped);
+
+	CHECK_RESULT(fs.unlinkFile("/mapped"), Result::success);
+
+	// Empty files can't be mapped.
+	writeFile(TEST_STATE_ARG, fs, "/empty", "");
+	numMappedBytes = 0;
+	CHECK_NULL(mapFile(TEST_STATE_ARG, fs, "/empty", numMappedBytes));
+	CHECK_EQ(numMappedBytes, Uptr(0));
+	CHECK_RESULT(fs.unlinkFile("/empty"), Result::success);
+}
+
+static void testSequentialWrites(TEST_STATE_PARAM, FileSystem& fs)
+{
+	// Check that both ways of preparing a file leave it with the data written over them.
+	const U64 numBytes = U64(256) * 1024;
+	for(bool useAllocate : {false, true})
+	{
+		const char* path = useAllocate ? "/preallocated" : "/zero-filled";
+		writeSequentially(TEST_STATE_ARG, fs, path, numBytes, useAllocate, false);
+		checkSequentialFile(TEST_STATE_ARG, fs, path, numBytes);
+		CHECK_RESULT(fs.unlinkFile(path), Result::success);
+	}
+}
+
+static void testStorageThroughput(TEST_STATE_PARAM, FileSystem& fs)
+{
+	// Compare the time to write a file that was preallocated to the time to write a file that was
+	// zero-filled. The timings are just logged, since they depend too much on the host to check.
+	const U64 numBytes = U64(64) * 1024 * 1024;
+	for(bool useAllocate : {false, true})
+	{
+		const char* path = useAllocate ? "/preallocated" : "/zero-filled";
+		writeSequentially(TEST_STATE_ARG, fs, path, numBytes, useAllocate, true);
+		CHECK_RESULT(fs.unlinkFile(path), Result::success);
+	}
+}
+
+I32 execFilesTest(int argc, char** argv)
+{
+	// The storage throughput test writes and syncs 128 MiB, so it only runs when requested.
+	bool testThroughput = false;
+	for(int argIndex = 0; argIndex < argc; ++argIndex)
+	{
+		if(!strcmp(argv[argIndex], "--throughput")) { testThroughput = true; }
+		else
+		{
+			Log::printf(Log::error,
+						"Usage: wavm test files [--throughput]\n"
+						"  --throughput  Also measure the storage throughput\n");
+			return EXIT_FAILURE;
+		}
+	}
+
+	TEST_STATE_LOCAL;
+	Timing::Timer timer;
+
+	const std::string rootPath = getTempPath("test-files");
+	CHECK_RESULT(Platform::getHostFS().createDir(rootPath), Result::success);
+	std::shared_ptr<FileSystem> sandboxFS = makeSandboxFS(&Platform::getHostFS(), rootPath);
+
+	testAllocate(TEST_STATE_ARG, *sandboxFS);
+	testHardLinks(TEST_STATE_ARG, *sandboxFS);
+
+	// Symbolic links are only supported by the POSIX platform.
+	std::string targetPath;
+	if(sandboxFS->readSymbolicLink("/", targetPath) != Result::notSupported)
+	{
+		testSymbolicLinks(TEST_STATE_ARG, *sandboxFS);
+	}
+
+	testMapFile(TEST_STATE_ARG, *sandboxFS);
+	testSequentialWrites(TEST_STATE_ARG, *sandboxFS);
+	if(testThroughput) { testStorageThroughput(TEST_STATE_ARG, *sandboxFS); }
+
+	CHECK_RESULT(Platform::getHostFS().removeDir(rootPath), Result::success);
+
+	Timing::logTimer("Ran files tests", timer);
+
+	return testState.exitCode();
+}
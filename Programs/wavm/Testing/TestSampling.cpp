@@ -0,0 +1,195 @@
+#include <atomic>
+#include <stdexcept>
+#include "TestUtils.h"
+#include "WAVM/Inline/Assert.h"
+#include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/I128.h"
+#include "WAVM/Inline/Time.h"
+#include "WAVM/Inline/Timing.h"
+#include "WAVM/Logging/Logging.h"
+#include "WAVM/Platform/Clock.h"
+#include "WAVM/Platform/Defines.h"
+#include "WAVM/Platform/Signal.h"
+#include "WAVM/Platform/Thread.h"
+#include "wavm-test.h"
+
+using namespace WAVM;
+using namespace WAVM::Platform;
+using namespace WAVM::Testing;
+
+struct SampleCounts
+{
+	std::atomic<U64> numSamples{0};
+	std::atomic<U64> maxNumIPs{0};
+
+	// The last sampled call stack, copied like the profiler copies samples to its ring buffer.
+	Uptr ips[maxSampleFrames];
+};
+
+static void countSample(void* countsVoid, const Uptr* ips, Uptr numIPs)
+{
+	SampleCounts* counts = (SampleCounts*)countsVoid;
+	counts->numSamples.fetch_add(1, std::memory_order_relaxed);
+
+	U64 maxNumIPs = counts->maxNumIPs.load(std::memory_order_relaxed);
+	while(numIPs > maxNumIPs
+		  && !counts->maxNumIPs.compare_exchange_weak(
+			  maxNumIPs, numIPs, std::memory_order_relaxed))
+	{
+	}
+
+	for(Uptr ipIndex = 0; ipIndex < numIPs; ++ipIndex) { counts->ips[ipIndex] = ips[ipIndex]; }
+}
+
+WAVM_FORCENOINLINE static U64 spin(U64 state, U64 numIterations)
+{
+	for(U64 iteration = 0; iteration < numIterations; ++iteration)
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+	}
+	return state;
+}
+
+// Storing the result of each recursive call to a volatile keeps the compiler from turning the
+// recursion into a loop.
+static volatile U64 recursionSink;
+
+WAVM_FORCENOINLINE static U64 recurse(Uptr depth, U64 state, U64 numIterations)
+{
+	if(!depth) { return spin(state, numIterations); }
+	const U64 result = recurse(depth - 1, state, numIterations);
+	recursionSink = result;
+	return result + depth;
+}
+
+static constexpr Uptr recursionDepth = 16;
+
+struct WorkloadArgs
+{
+	U64 numIterations;
+	F64 milliseconds;
+};
+
+static I64 recursiveWorkloadEntry(void* argsVoid)
+{
+	WorkloadArgs* args = (WorkloadArgs*)argsVoid;
+	Timing::Timer timer;
+	recursionSink = recurse(recursionDepth, 1, args->numIterations);
+	args->milliseconds = timer.getMilliseconds();
+	return 0;
+}
+
+// Runs the recursive workload on a thread created by WAVM, and returns how long it took.
+static F64 runRecursiveWorkload(U64 numIterations)
+{
+	WorkloadArgs args{numIterations, 0.0};
+	joinThread(createThread(0, recursiveWorkloadEntry, &args));
+	return args.milliseconds;
+}
+
+static I64 throwingWorkloadEntry(void* millisecondsVoid)
+{
+	const F64 milliseconds = *(const F64*)millisecondsVoid;
+	const I128 deadlineNS
+		= getClockTime(Clock::monotonic).ns + I128(U64(milliseconds * 1000000.0));
+	U64 numCaught = 0;
+	while(getClockTime(Clock::monotonic).ns < deadlineNS)
+	{
+		try
+		{
+			throw std::runtime_error("sampled");
+		}
+		catch(const std::runtime_error&)
+		{
+			++numCaught;
+		}
+	}
+	return I64(numCaught);
+}
+
+static void testSampledCallStacks(TEST_STATE_PARAM)
+{
+	// Sample a thread that spends most of its time at the bottom of a deep recursion, and check
+	// that the sampled call stacks include each of the recursive frames.
+	SampleCounts counts;
+	WAVM_ERROR_UNLESS(startSampling(1000, countSample, &counts));
+	runRecursiveWorkload(U64(1) << 27);
+	stopSampling();
+
+	CHECK_GT(counts.numSamples.load(), U64(0));
+	CHECK_GE(counts.maxNumIPs.load(), U64(recursionDepth + 2));
+}
+
+static void testSamplingWhileUnwinding(TEST_STATE_PARAM)
+{
+	// Sample a thread that is throwing and catching exceptions, which takes the locks used by the
+	// unwinder and the dynamic loader. The sample handler must not use those locks, or it would
+	// deadlock if it interrupted a thread that holds them.
+	SampleCounts counts;
+	WAVM_ERROR_UNLESS(startSampling(10000, countSample, &counts));
+	F64 milliseconds = 500.0;
+	const I64 numCaught = joinThread(createThread(0, throwingWorkloadEntry, &milliseconds));
+	stopSampling();
+
+	CHECK_GT(numCaught, I64(0));
+	CHECK_GT(counts.numSamples.load(), U64(0));
+}
+
+static void testSamplingOverhead(TEST_STATE_PARAM)
+{
+	// Measure how much sampling at 1kHz slows down a CPU-bound workload. Take the fastest of
+	// several runs with and without sampling to filter out noise from other processes.
+	static constexpr Uptr numRuns = 5;
+	static constexpr U64 numIterations = U64(1) << 27;
+	runRecursiveWorkload(numIterations);
+
+	F64 minUnsampledMS = 0.0;
+	F64 minSampledMS = 0.0;
+	U64 numSamples = 0;
+	for(Uptr runIndex = 0; runIndex < numRuns; ++runIndex)
+	{
+		const F64 unsampledMS = runRecursiveWorkload(numIterations);
+
+		SampleCounts counts;
+		WAVM_ERROR_UNLESS(startSampling(1000, countSample, &counts));
+		const F64 sampledMS = runRecursiveWorkload(numIterations);
+		stopSampling();
+		numSamples += counts.numSamples.load();
+
+		if(!runIndex || unsampledMS < minUnsampledMS) { minUnsampledMS = unsampledMS; }
+		if(!runIndex || sampledMS < minSampledMS) { minSampledMS = sampledMS; }
+	}
+
+	const F64 overhead = minSampledMS / minUnsampledMS - 1.0;
+	Log::printf(Log::metrics,
+				"Sampling at 1kHz: %.2fms without sampling, %.2fms with %" PRIu64
+				" samples, %.2f%% overhead\n",
+				minUnsampledMS,
+				minSampledMS,
+				numSamples / numRuns,
+				overhead * 100.0);
+	CHECK_GT(numSamples, U64(0));
+	CHECK_LT(overhead, 0.02);
+}
+
+I32 execSamplingTest(int argc, char** argv)
+{
+	TEST_STATE_LOCAL;
+	Timing::Timer timer;
+
+	// Sampling is only supported by the POSIX platform.
+	SampleCounts counts;
+	if(startSampling(1000, countSample, &counts))
+	{
+		stopSampling();
+		testSampledCallStacks(TEST_STATE_ARG);
+		testSamplingWhileUnwinding(TEST_STATE_ARG);
+		testSamplingOverhead(TEST_STATE_ARG);
+	}
+
+	Timing::logTimer("Ran sampling tests", timer);
+
+	return testState.exitCode();
+}
@@ -0,0 +1,364 @@
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include "TestUtils.h"
+#include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/Time.h"
+#include "WAVM/Inline/Timing.h"
+#include "WAVM/Platform/File.h"
+#include "WAVM/Platform/Random.h"
+#include "WAVM/VFS/VFS.h"
+#include "wavm-test.h"
+
+using namespace WAVM;
+using namespace WAVM::Testing;
+using namespace WAVM::VFS;
+
+#define CHECK_RESULT(actual, expected)                                                             \
+	CHECK_EQ(std::string(describeResult(actual)), std::string(describeResult(expected)))
+
+static const Time pollTimeout = Time{I128(5000000000)};
+
+static std::string getTempPath(const char* name)
+{
+	const char* tempDir = getenv("TMPDIR");
+	if(!tempDir || !*tempDir) { tempDir = "/tmp"; }
+
+	U32 randomSuffix = 0;
+	Platform::getCryptographicRNG((U8*)&randomSuffix, sizeof(randomSuffix));
+	return std::string(tempDir) + "/wavm-" + name + "-" + std::to_string(randomSuffix);
+}
+
+static void closeVFD(TEST_STATE_PARAM, VFD*& vfd)
+{
+	if(vfd)
+	{
+		CHECK_RESULT(vfd->close(), Result::success);
+		vfd = nullptr;
+	}
+}
+
+static void testInvalidAddresses(TEST_STATE_PARAM)
+{
+	const char* invalidAddresses[] = {
+		"",
+		"bogus:1234",
+		"tcp:127.0.0.1",
+		"tcp:127.0.0:80",
+		"tcp:127.0.0.1:",
+		"tcp:127.0.0.1:65536",
+		"tcp:127.0.0.1:8o",
+		"tcp6:[::1]80",
+		"tcp6:[::g]:80",
+		"unix:",
+	};
+	for(const char* address : invalidAddresses)
+	{
+		VFD* vfd = nullptr;
+		CHECK_RESULT(Platform::listenOnSocket(address, vfd), Result::invalidAddress);
+		CHECK_NULL(vfd);
+		CHECK_RESULT(Platform::connectToSocket(address, vfd), Result::invalidAddress);
+		CHECK_NULL(vfd);
+	}
+}
+
+static void testTCPListen(TEST_STATE_PARAM)
+{
+	// Listen on an ephemeral port, and check that the listening socket doesn't have any pending
+	// connections.
+	VFDFlags nonBlockingFlags;
+	nonBlockingFlags.nonBlocking = true;
+
+	VFD* listener = nullptr;
+	CHECK_RESULT(Platform::listenOnSocket("tcp:127.0.0.1:0", listener, nonBlockingFlags),
+				 Result::success);
+	if(!listener) { return; }
+
+	VFDInfo vfdInfo;
+	CHECK_RESULT(listener->getVFDInfo(vfdInfo), Result::success);
+	CHECK_TRUE(vfdInfo.type == FileType::streamSocket);
+	CHECK_TRUE(vfdInfo.flags.nonBlocking);
+
+	VFD* connection = nullptr;
+	CHECK_RESULT(listener->accept(connection), Result::wouldBlock);
+	CHECK_NULL(connection);
+
+	closeVFD(TEST_STATE_ARG, listener);
+}
+
+static void testUnixSocket(TEST_STATE_PARAM)
+{
+	const std::string socketPath = getTempPath("test-socket");
+	const std::string address = "unix:" + socketPath;
+
+	VFDFlags nonBlockingFlags;
+	nonBlockingFlags.nonBlocking = true;
+
+	VFD* listener = nullptr;
+	CHECK_RESULT(Platform::listenOnSocket(address, listener, nonBlockingFlags), Result::success);
+	if(!listener) { return; }
+
+	// Listening on the same path again should fail.
+	VFD* duplicateListener = nullptr;
+	CHECK_RESULT(Platform::listenOnSocket(address, duplicateListener), Result::addressInUse);
+
+	std::unique_ptr<Reactor> reactor = Platform::createReactor();
+
+	// The listener isn't readable until a client connects.
+	PollEntry listenerEntry;
+	listenerEntry.vfd = listener;
+	listenerEntry.waitForRead = true;
+	Uptr numReadyEntries = 0;
+	CHECK_RESULT(reactor->poll(&listenerEntry, 1, Time{0}, numReadyEntries), Result::success);
+	CHECK_EQ(numReadyEntries, Uptr(0));
+	CHECK_FALSE(listenerEntry.readable);
+
+	VFD* connection = nullptr;
+	CHECK_RESULT(listener->accept(connection), Result::wouldBlock);
+
+	VFD* client = nullptr;
+	CHECK_RESULT(Platform::connectToSocket(address, client), Result::success);
+	if(!client)
+	{
+		closeVFD(TEST_STATE_ARG, listener);
+		return;
+	}
+
+	CHECK_RESULT(reactor->poll(&listenerEntry, 1, pollTimeout, numReadyEntries), Result::success);
+	CHECK_EQ(numReadyEntries, Uptr(1));
+	CHECK_TRUE(listenerEntry.readable);
+
+	CHECK_RESULT(listener->accept(connection), Result::success);
+	if(!connection)
+	{
+		closeVFD(TEST_STATE_ARG, client);
+		closeVFD(TEST_STATE_ARG, listener);
+		return;
+	}
+
+	// Nothing has been sent yet, so a non-blocking receive on the connection would block, and
+	// the client is writable but not readable.
+	U8 buffer[16];
+	IOReadBuffer readBuffer{buffer, sizeof(buffer)};
+	Uptr numBytes = 0;
+	CHECK_RESULT(connection->setVFDFlags(nonBlockingFlags), Result::success);
+	CHECK_RESULT(connection->recv(&readBuffer, 1, SocketRecvFlags{}, &numBytes),
+				 Result::wouldBlock);
+
+	PollEntry clientEntries[2];
+	clientEntries[0].vfd = client;
+	clientEntries[0].waitForRead = true;
+	clientEntries[1].vfd = client;
+	clientEntries[1].waitForWrite = true;
+	CHECK_RESULT(reactor->poll(clientEntries, 2, pollTimeout, numReadyEntries), Result::success);
+	CHECK_EQ(numReadyEntries, Uptr(1));
+	CHECK_FALSE(clientEntries[0].readable);
+	CHECK_TRUE(clientEntries[1].writable);
+
+	// Send a message from the connection to the client.
+	const char message[] = "hello";
+	IOWriteBuffer writeBuffer{message, sizeof(message) - 1};
+	CHECK_RESULT(connection->send(&writeBuffer, 1, &numBytes), Result::success);
+	CHECK_EQ(numBytes, sizeof(message) - 1);
+
+	CHECK_RESULT(reactor->poll(clientEntries, 1, pollTimeout, numReadyEntries), Result::success);
+	CHECK_EQ(numReadyEntries, Uptr(1));
+	CHECK_TRUE(clientEntries[0].readable);
+	CHECK_FALSE(clientEntries[0].hangup);
+
+	// Peek at the message, and then receive it.
+	SocketRecvFlags peekFlags;
+	peekFlags.peek = true;
+	bool dataTruncated = true;
+	CHECK_RESULT(client->recv(&readBuffer, 1, peekFlags, &numBytes, &dataTruncated),
+				 Result::success);
+	CHECK_EQ(numBytes, sizeof(message) - 1);
+	CHECK_FALSE(dataTruncated);
+
+	memset(buffer, 0, sizeof(buffer));
+	CHECK_RESULT(client->recv(&readBuffer, 1, SocketRecvFlags{}, &numBytes), Result::success);
+	CHECK_EQ(numBytes, sizeof(message) - 1);
+	CHECK_EQ(std::string((const char*)buffer, numBytes), std::string(message));
+
+	// Shut down the client's side of the connection, and check that the connection sees the hangup
+	// and reads the end of the stream.
+	CHECK_RESULT(client->shutdown(SocketShutdownMode::write), Result::success);
+
+	PollEntry connectionEntry;
+	connectionEntry.vfd = connection;
+	connectionEntry.waitForRead = true;
+	CHECK_RESULT(reactor->poll(&connectionEntry, 1, pollTimeout, numReadyEntries),
+				 Result::success);
+	CHECK_EQ(numReadyEntries, Uptr(1));
+	CHECK_TRUE(connectionEntry.readable);
+	CHECK_TRUE(connectionEntry.hangup);
+
+	CHECK_RESULT(connection->recv(&readBuffer, 1, SocketRecvFlags{}, &numBytes), Result::success);
+	CHECK_EQ(numBytes, Uptr(0));
+
+	// Writing after shutting down the client's side of the connection should fail without raising
+	// SIGPIPE.
+	CHECK_RESULT(client->send(&writeBuffer, 1, &numBytes), Result::brokenPipe);
+
+	closeVFD(TEST_STATE_ARG, connection);
+	closeVFD(TEST_STATE_ARG, client);
+	closeVFD(TEST_STATE_ARG, listener);
+	CHECK_RESULT(Platform::getHostFS().unlinkFile(socketPath), Result::success);
+
+	// After the listener is closed and the path is removed, connecting should fail.
+	CHECK_RESULT(Platform::connectToSocket(address, client), Result::doesNotExist);
+}
+
+static void testReusedFD(TEST_STATE_PARAM)
+{
+	// Closing a socket that a reactor has waited on, and then creating sockets that reuse its host
+	// fd number, shouldn't stop the reactor from waiting on the new sockets.
+	const std::string socketPath = getTempPath("test-reused-fd");
+	const std::string address = "unix:" + socketPath;
+
+	VFD* listener = nullptr;
+	CHECK_RESULT(Platform::listenOnSocket(address, listener), Result::success);
+	if(!listener) { return; }
+
+	std::unique_ptr<Reactor> reactor = Platform::createReactor();
+
+	VFD* client = nullptr;
+	VFD* connection = nullptr;
+	CHECK_RESULT(Platform::connectToSocket(address, client), Result::success);
+	CHECK_RESULT(listener->accept(connection), Result::success);
+	if(!client || !connection)
+	{
+		closeVFD(TEST_STATE_ARG, connection);
+		closeVFD(TEST_STATE_ARG, client);
+		closeVFD(TEST_STATE_ARG, listener);
+		return;
+	}
+
+	// Wait on both ends of the connection, so the reactor registers their host fds.
+	PollEntry entries[2];
+	entries[0].vfd = client;
+	entries[0].waitForRead = true;
+	entries[1].vfd = connection;
+	entries[1].waitForRead = true;
+	Uptr numReadyEntries = 0;
+	CHECK_RESULT(reactor->poll(entries, 2, Time{0}, numReadyEntries), Result::success);
+	CHECK_EQ(numReadyEntries, Uptr(0));
+
+	Uptr oldHostFDs[2] = {0, 0};
+	CHECK_RESULT(client->getHostDescriptor(oldHostFDs[0]), Result::success);
+	CHECK_RESULT(connection->getHostDescriptor(oldHostFDs[1]), Result::success);
+	closeVFD(TEST_STATE_ARG, connection);
+	closeVFD(TEST_STATE_ARG, client);
+
+	// Connect again: the new sockets reuse the lowest free fd numbers, which the old sockets had.
+	CHECK_RESULT(Platform::connectToSocket(address, client), Result::success);
+	CHECK_RESULT(listener->accept(connection), Result::success);
+	if(!client || !connection)
+	{
+		closeVFD(TEST_STATE_ARG, connection);
+		closeVFD(TEST_STATE_ARG, client);
+		closeVFD(TEST_STATE_ARG, listener);
+		return;
+	}
+
+	Uptr newHostFDs[2] = {0, 0};
+	CHECK_RESULT(client->getHostDescriptor(newHostFDs[0]), Result::success);
+	CHECK_RESULT(connection->getHostDescriptor(newHostFDs[1]), Result::success);
+	CHECK_TRUE(newHostFDs[0] == oldHostFDs[0] || newHostFDs[0] == oldHostFDs[1]);
+	CHECK_TRUE(newHostFDs[1] == oldHostFDs[0] || newHostFDs[1] == oldHostFDs[1]);
+
+	// Send a byte in each direction, and check that the reactor sees that both ends are readable.
+	const char message[] = "x";
+	IOWriteBuffer writeBuffer{message, 1};
+	Uptr numBytes = 0;
+	CHECK_RESULT(client->send(&writeBuffer, 1, &numBytes), Result::success);
+	CHECK_RESULT(connection->send(&writeBuffer, 1, &numBytes), Result::success);
+
+	entries[0].vfd = client;
+	entries[1].vfd = connection;
+	CHECK_RESULT(reactor->poll(entries, 2, pollTimeout, numReadyEntries), Result::success);
+	CHECK_EQ(numReadyEntries, Uptr(2));
+	CHECK_TRUE(entries[0].readable);
+	CHECK_TRUE(entries[1].readable);
+
+	closeVFD(TEST_STATE_ARG, connection);
+	closeVFD(TEST_STATE_ARG, client);
+	closeVFD(TEST_STATE_ARG, listener);
+	CHECK_RESULT(Platform::getHostFS().unlinkFile(socketPath), Result::success);
+}
+
+static void testNonSocketVFD(TEST_STATE_PARAM)
+{
+	const std::string filePath = getTempPath("test-socket-file");
+
+	VFD* file = nullptr;
+	CHECK_RESULT(Platform::getHostFS().open(
+					 filePath, FileAccessMode::readWrite, FileCreateMode::createNew, file),
+				 Result::success);
+	if(!file) { return; }
+
+	// Socket operations on a regular file should fail.
+	U8 buffer[1];
+	IOReadBuffer readBuffer{buffer, sizeof(buffer)};
+	IOWriteBuffer writeBuffer{buffer, sizeof(buffer)};
+	VFD* connection = nullptr;
+	CHECK_RESULT(file->recv(&readBuffer, 1, SocketRecvFlags{}), Result::notSocket);
+	CHECK_RESULT(file->send(&writeBuffer, 1), Result::notSocket);
+	CHECK_RESULT(file->shutdown(SocketShutdownMode::readWrite), Result::notSocket);
+	CHECK_RESULT(file->accept(connection), Result::notSocket);
+
+	// Regular files are always ready for reading and writing.
+	std::unique_ptr<Reactor> reactor = Platform::createReactor();
+	PollEntry entries[2];
+	entries[0].vfd = file;
+	entries[0].waitForRead = true;
+	entries[1].vfd = file;
+	entries[1].waitForWrite = true;
+	Uptr numReadyEntries = 0;
+	CHECK_RESULT(reactor->poll(entries, 2, pollTimeout, numReadyEntries), Result::success);
+	CHECK_EQ(numReadyEntries, Uptr(2));
+	CHECK_TRUE(entries[0].readable);
+	CHECK_TRUE(entries[1].writable);
+
+	closeVFD(TEST_STATE_ARG, file);
+	CHECK_RESULT(Platform::getHostFS().unlinkFile(filePath), Result::success);
+}
+
+static void testReactorTimeout(TEST_STATE_PARAM)
+{
+	// Polling without any entries should wait for the timeout.
+	std::unique_ptr<Reactor> reactor = Platform::createReactor();
+
+	Timing::Timer timer;
+	Uptr numReadyEntries = 0;
+	CHECK_RESULT(reactor->poll(nullptr, 0, Time{I128(10000000)}, numReadyEntries),
+				 Result::success);
+	timer.stop();
+	CHECK_EQ(numReadyEntries, Uptr(0));
+	CHECK_GE(timer.getNanoseconds(), F64(10000000));
+}
+
+I32 execSocketsTest(int argc, char** argv)
+{
+	TEST_STATE_LOCAL;
+	Timing::Timer timer;
+
+	testNonSocketVFD(TEST_STATE_ARG);
+	testReactorTimeout(TEST_STATE_ARG);
+
+	// Sockets are only supported by the POSIX platform.
+	VFD* socket = nullptr;
+	if(Platform::listenOnSocket("tcp:127.0.0.1:0", socket) != Result::notSupported)
+	{
+		closeVFD(TEST_STATE_ARG, socket);
+		testInvalidAddresses(TEST_STATE_ARG);
+		testTCPListen(TEST_STATE_ARG);
+		testUnixSocket(TEST_STATE_ARG);
+		testReusedFD(TEST_STATE_ARG);
+	}
+
+	Timing::logTimer("Ran sockets tests", timer);
+
+	return testState.exitCode();
+}
@@ -0,0 +1,806 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "TestUtils.h"
+#include "WAVM/IR/IR.h"
+#include "WAVM/IR/Module.h"
+#include "WAVM/IR/Types.h"
+#include "WAVM/IR/Value.h"
+#include "WAVM/Inline/Assert.h"
+#include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/Time.h"
+#include "WAVM/Platform/ConditionVariable.h"
+#include "WAVM/Platform/File.h"
+#include "WAVM/Platform/Mutex.h"
+#include "WAVM/Platform/Random.h"
+#include "WAVM/Platform/Thread.h"
+#include "WAVM/Runtime/Linker.h"
+#include "WAVM/Runtime/Runtime.h"
+#include "WAVM/VFS/SandboxFS.h"
+#include "WAVM/VFS/VFS.h"
+#include "WAVM/WASI/WASI.h"
+#include "WAVM/WASI/WASIABI.h"
+#include "WAVM/WASTParse/WASTParse.h"
+#include "wavm-test.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace WAVM;
+using namespace WAVM::IR;
+using namespace WAVM::Runtime;
+using namespace WAVM::Testing;
+using namespace WAVM::VFS;
+
+#define CHECK_RESULT(actual, expected)                                                             \
+	CHECK_EQ(std::string(describeResult(actual)), std::string(describeResult(expected)))
+
+// The output written to a TestOutputVFD. It's shared with the test so it can be checked after the
+// process has closed the VFD.
+struct TestOutput
+{
+	std::string writtenBytes;
+
+	// The maximum number of bytes the VFD accepts from each write.
+	Uptr maxBytesPerWrite = UINTPTR_MAX;
+
+	// If true, writes fail with Result::wouldBlock.
+	bool failWrites = false;
+};
+
+// A VFD that doesn't support any operations. The test VFDs derive from it, and override the
+// operations they support.
+struct TestVFD : VFD
+{
+	virtual Result close() override
+	{
+		delete this;
+		return Result::success;
+	}
+
+	virtual Result seek(I64 offset, SeekOrigin origin, U64* outAbsoluteOffset = nullptr) override
+	{
+		return Result::notSeekable;
+	}
+
+	virtual Result readv(const IOReadBuffer* buffers,
+						 Uptr numBuffers,
+						 Uptr* outNumBytesRead = nullptr,
+						 const U64* offset = nullptr) override
+	{
+		return Result::notPermitted;
+	}
+
+	virtual Result writev(const IOWriteBuffer* buffers,
+						  Uptr numBuffers,
+						  Uptr* outNumBytesWritten = nullptr,
+						  const U64* offset = nullptr) override
+	{
+		return Result::notPermitted;
+	}
+
+	virtual Result sync(SyncType type) override { return Result::notSynchronizable; }
+
+	virtual Result getVFDInfo(VFDInfo& outInfo) override
+	{
+		outInfo.type = FileType::pipe;
+		outInfo.flags = VFDFlags{};
+		return Result::success;
+	}
+	virtual Result getFileInfo(FileInfo& outInfo) override { return Result::notSupported; }
+	virtual Result setVFDFlags(const VFDFlags& flags) override { return Result::notSupported; }
+	virtual Result setFileSize(U64 numBytes) override { return Result::notPermitted; }
+	virtual Result allocate(U64 offset, U64 numBytes) override { return Result::notPermitted; }
+	virtual Result setFileTimes(bool setLastAccessTime,
+								Time lastAccessTime,
+								bool setLastWriteTime,
+								Time lastWriteTime) override
+	{
+		return Result::notPermitted;
+	}
+
+	virtual Result openDir(DirEntStream*& outStream) override { return Result::isNotDirectory; }
+
+	virtual Result recv(const IOReadBuffer* buffers,
+						Uptr numBuffers,
+						SocketRecvFlags flags,
+						Uptr* outNumBytesRead = nullptr,
+						bool* outDataTruncated = nullptr) override
+	{
+		return Result::notSocket;
+	}
+	virtual Result send(const IOWriteBuffer* buffers,
+						Uptr numBuffers,
+						Uptr* outNumBytesWritten = nullptr) override
+	{
+		return Result::notSocket;
+	}
+	virtual Result shutdown(SocketShutdownMode mode) override { return Result::notSocket; }
+	virtual Result accept(VFD*& outVFD, const VFDFlags& flags) override
+	{
+		return Result::notSocket;
+	}
+
+	virtual Result getHostDescriptor(Uptr& outDescriptor) override
+	{
+		return Result::notSupported;
+	}
+};
+
+// A VFD that appends the data written to it to a TestOutput.
+struct TestOutputVFD : TestVFD
+{
+	TestOutputVFD(const std::shared_ptr<TestOutput>& inOutput) : output(inOutput) {}
+
+	virtual Result writev(const IOWriteBuffer* buffers,
+						  Uptr numBuffers,
+						  Uptr* outNumBytesWritten = nullptr,
+						  const U64* offset = nullptr) override
+	{
+		if(output->failWrites) { return Result::wouldBlock; }
+		if(offset) { return Result::notSeekable; }
+
+		Uptr numBytesWritten = 0;
+		for(Uptr bufferIndex = 0; bufferIndex < numBuffers; ++bufferIndex)
+		{
+			const Uptr numBufferBytes = std::min(buffers[bufferIndex].numBytes,
+												 output->maxBytesPerWrite - numBytesWritten);
+			output->writtenBytes.append((const char*)buffers[bufferIndex].data, numBufferBytes);
+			numBytesWritten += numBufferBytes;
+		}
+
+		if(outNumBytesWritten) { *outNumBytesWritten = numBytesWritten; }
+		return Result::success;
+	}
+
+private:
+	std::shared_ptr<TestOutput> output;
+};
+
+// The state shared by a BlockingInputVFD and the test.
+struct BlockingInput
+{
+	Platform::Mutex mutex;
+	Platform::ConditionVariable condition;
+
+	// Set by the VFD when a read has started, and by the test to let the read finish.
+	bool isReading = false;
+	bool isReleased = false;
+};
+
+// A VFD whose reads block until the test releases them, and then read a single 'x'.
+struct BlockingInputVFD : TestVFD
+{
+	BlockingInputVFD(const std::shared_ptr<BlockingInput>& inInput) : input(inInput) {}
+
+	virtual Result readv(const IOReadBuffer* buffers,
+						 Uptr numBuffers,
+						 Uptr* outNumBytesRead = nullptr,
+						 const U64* offset = nullptr) override
+	{
+		if(offset) { return Result::notSeekable; }
+
+		Platform::Mutex::Lock lock(input->mutex);
+		input->isReading = true;
+		input->condition.broadcast();
+		while(!input->isReleased) { input->condition.wait(input->mutex, Time::infinity()); }
+		lock.unlock();
+
+		Uptr numBytesRead = 0;
+		if(numBuffers && buffers[0].numBytes)
+		{
+			*(char*)buffers[0].data = 'x';
+			numBytesRead = 1;
+		}
+		if(outNumBytesRead) { *outNumBytesRead = numBytesRead; }
+		return Result::success;
+	}
+
+private:
+	std::shared_ptr<BlockingInput> input;
+};
+
+// A module that forwards calls to WASI functions, so the test can call them through the same path
+// a guest would.
+static const char forwardingWAT[] = R"(
+	(module
+		(import "wasi_snapshot_preview1" "fd_write"
+			(func $fd_write (param i32 i32 i32 i32) (result i32)))
+		(import "wasi_snapshot_preview1" "fd_read"
+			(func $fd_read (param i32 i32 i32 i32) (result i32)))
+		(import "wasi_snapshot_preview1" "fd_close"
+			(func $fd_close (param i32) (result i32)))
+		(import "wasi_snapshot_preview1" "path_open"
+			(func $path_open (param i32 i32 i32 i32 i32 i64 i64 i32 i32) (result i32)))
+		(import "wavm_wasi_file_mapping" "fd_map"
+			(func $fd_map (param i32 i64 i32 i32) (result i32)))
+		(memory (export "memory") 2)
+		(func (export "fd_write") (param i32 i32 i32 i32) (result i32)
+			(call $fd_write (local.get 0) (local.get 1) (local.get 2) (local.get 3))
+		)
+		(func (export "fd_read") (param i32 i32 i32 i32) (result i32)
+			(call $fd_read (local.get 0) (local.get 1) (local.get 2) (local.get 3))
+		)
+		(func (export "fd_close") (param i32) (result i32)
+			(call $fd_close (local.get 0))
+		)
+		(func (export "path_open")
+			(param i32 i32 i32 i32 i32 i64 i64 i32 i32) (result i32)
+			(call $path_open (local.get 0) (local.get 1) (local.get 2) (local.get 3)
+				(local.get 4) (local.get 5) (local.get 6) (local.get 7) (local.get 8))
+		)
+		(func (export "fd_map") (param i32 i64 i32 i32) (result i32)
+			(call $fd_map (local.get 0) (local.get 1) (local.get 2) (local.get 3))
+		)
+	)
+)";
+
+// The guest addresses that write uses for its arguments.
+static constexpr U32 iovsAddress = 0;
+static constexpr U32 numBytesWrittenAddress = 1024;
+static constexpr U32 dataAddress = 2048;
+
+// The guest addresses that read uses for its arguments.
+static constexpr U32 readIOVAddress = 4096;
+static constexpr U32 numBytesReadAddress = 4104;
+static constexpr U32 readDataAddress = 4112;
+
+// The guest addresses that openFile uses for its arguments.
+static constexpr U32 openedFDAddress = 8192;
+static constexpr U32 pathAddress = 8200;
+
+// A WASI process whose stdout is a TestOutputVFD.
+struct TestProcess
+{
+	std::shared_ptr<TestOutput> stdOut = std::make_shared<TestOutput>();
+
+	GCPointer<Compartment> compartment;
+	std::shared_ptr<WASI::Process> process;
+	Memory* memory = nullptr;
+	Context* context = nullptr;
+	Instance* instance = nullptr;
+
+	TestProcess(const WASI::StdioConfig& stdioConfig,
+				VFD* stdIn = Platform::getStdFD(Platform::StdDevice::in),
+				FileSystem* fileSystem = nullptr)
+	{
+		compartment = createCompartment("wasiTest");
+		process = WASI::createProcess(compartment,
+									  {"wasi-test"},
+									  {},
+									  fileSystem,
+									  stdIn,
+									  new TestOutputVFD(stdOut),
+									  Platform::getStdFD(Platform::StdDevice::err),
+									  stdioConfig);
+
+		IR::Module irModule;
+		std::vector<WAST::Error> parseErrors;
+		if(!WAST::parseModule(forwardingWAT, sizeof(forwardingWAT), irModule, parseErrors))
+		{
+			WAST::reportParseErrors("forwardingWAT", forwardingWAT, parseErrors);
+			WAVM_UNREACHABLE();
+		}
+
+		LinkResult linkResult = linkModule(irModule, WASI::getProcessResolver(*process));
+		WAVM_ERROR_UNLESS(linkResult.success);
+
+		instance = instantiateModule(compartment,
+									 compileModule(irModule),
+									 std::move(linkResult.resolvedImports),
+									 "forwarding");
+		WAVM_ERROR_UNLESS(instance);
+
+		memory = asMemoryNullable(getInstanceExport(instance, "memory"));
+		WAVM_ERROR_UNLESS(memory);
+		WASI::setProcessMemory(*process, memory);
+
+		context = createContext(compartment, "wasiTest");
+	}
+
+	~TestProcess()
+	{
+		process.reset();
+		WAVM_ERROR_UNLESS(tryCollectCompartment(std::move(compartment)));
+	}
+
+	// Calls fd_write on stdout with one iovec per string, and returns the WASI errno.
+	U32 write(const std::vector<std::string>& strings, Uptr& outNumBytesWritten)
+	{
+		U32 address = dataAddress;
+		for(Uptr stringIndex = 0; stringIndex < strings.size(); ++stringIndex)
+		{
+			const std::string& string = strings[stringIndex];
+			memcpy(memoryArrayPtr<char>(memory, address, string.size()),
+				   string.data(),
+				   string.size());
+			memoryRef<U32>(memory, iovsAddress + stringIndex * 8) = address;
+			memoryRef<U32>(memory, iovsAddress + stringIndex * 8 + 4) = U32(string.size());
+			address += U32(string.size());
+		}
+
+		UntaggedValue args[4];
+		args[0].u32 = 1;
+		args[1].u32 = iovsAddress;
+		args[2].u32 = U32(strings.size());
+		args[3].u32 = numBytesWrittenAddress;
+		const U32 result = invoke(context, "fd_write", args);
+
+		outNumBytesWritten = memoryRef<U32>(memory, numBytesWrittenAddress);
+		return result;
+	}
+
+	// Calls fd_read on stdin with a single byte iovec, and returns the WASI errno. The read uses
+	// its own guest memory, so it may be called from another thread with its own context.
+	U32 readByte(Context* readContext, char& outByte, Uptr& outNumBytesRead)
+	{
+		memoryRef<U32>(memory, readIOVAddress) = readDataAddress;
+		memoryRef<U32>(memory, readIOVAddress + 4) = 1;
+
+		UntaggedValue args[4];
+		args[0].u32 = 0;
+		args[1].u32 = readIOVAddress;
+		args[2].u32 = 1;
+		args[3].u32 = numBytesReadAddress;
+		const U32 result = invoke(readContext, "fd_read", args);
+
+		outByte = memoryRef<char>(memory, readDataAddress);
+		outNumBytesRead = memoryRef<U32>(memory, numBytesReadAddress);
+		return result;
+	}
+
+	// Calls path_open to open a file in the directory at dirFD with the given rights, and returns
+	// the WASI errno.
+	U32 openFile(__wasi_fd_t dirFD,
+				 const std::string& path,
+				 __wasi_oflags_t openFlags,
+				 __wasi_rights_t rights,
+				 __wasi_fd_t& outFD)
+	{
+		memcpy(memoryArrayPtr<char>(memory, pathAddress, path.size()), path.data(), path.size());
+
+		UntaggedValue args[9];
+		args[0].u32 = dirFD;
+		args[1].u32 = 0;
+		args[2].u32 = pathAddress;
+		args[3].u32 = U32(path.size());
+		args[4].u32 = openFlags;
+		args[5].u64 = rights;
+		args[6].u64 = 0;
+		args[7].u32 = 0;
+		args[8].u32 = openedFDAddress;
+		const U32 result = invoke(context, "path_open", args);
+
+		outFD = memoryRef<__wasi_fd_t>(memory, openedFDAddress);
+		return result;
+	}
+
+	// Calls fd_map to map numBytes of the file at fd, starting at offset, to the guest address, and
+	// returns the WASI errno.
+	U32 mapFile(__wasi_fd_t fd, U64 offset, U32 address, U32 numBytes)
+	{
+		UntaggedValue args[4];
+		args[0].u32 = fd;
+		args[1].u64 = offset;
+		args[2].u32 = address;
+		args[3].u32 = numBytes;
+		return invoke(context, "fd_map", args);
+	}
+
+	// Calls fd_close, and returns the WASI errno.
+	U32 close(__wasi_fd_t fd)
+	{
+		UntaggedValue args[1];
+		args[0].u32 = fd;
+		return invoke(context, "fd_close", args);
+	}
+
+private:
+	U32 invoke(Context* invokeContext, const char* exportName, const UntaggedValue* args)
+	{
+		Function* function = asFunctionNullable(getInstanceExport(instance, exportName));
+		WAVM_ERROR_UNLESS(function);
+
+		UntaggedValue result;
+		invokeFunction(invokeContext, function, getFunctionType(function), args, &result);
+		return result.u32;
+	}
+};
+
+static void testUnbufferedPartialWrites(TEST_STATE_PARAM)
+{
+	WASI::StdioConfig stdioConfig;
+	stdioConfig.numCaptureBytes = 64;
+	TestProcess testProcess(stdioConfig);
+
+	// A partial write that ends in the second iovec only captures the bytes that were written.
+	testProcess.stdOut->maxBytesPerWrite = 3;
+	Uptr numBytesWritten = 0;
+	CHECK_EQ(testProcess.write({"he", "llo"}, numBytesWritten), U32(__WASI_ESUCCESS));
+	CHECK_EQ(numBytesWritten, Uptr(3));
+	CHECK_EQ(testProcess.stdOut->writtenBytes, std::string("hel"));
+
+	// A failed write doesn't capture anything.
+	testProcess.stdOut->failWrites = true;
+	CHECK_EQ(testProcess.write({"lo"}, numBytesWritten), U32(__WASI_EAGAIN));
+	CHECK_EQ(numBytesWritten, Uptr(0));
+
+	// Retrying the rest of the data captures it once.
+	testProcess.stdOut->failWrites = false;
+	CHECK_EQ(testProcess.write({"lo"}, numBytesWritten), U32(__WASI_ESUCCESS));
+	CHECK_EQ(numBytesWritten, Uptr(2));
+	CHECK_EQ(testProcess.stdOut->writtenBytes, std::string("hello"));
+
+	Uptr numDroppedBytes = 1;
+	CHECK_EQ(WASI::drainProcessStdioCapture(*testProcess.process, &numDroppedBytes),
+			 std::string("hello"));
+	CHECK_EQ(numDroppedBytes, Uptr(0));
+
+	// Draining removes the captured output.
+	CHECK_EQ(WASI::drainProcessStdioCapture(*testProcess.process), std::string());
+}
+
+static void testBufferedCapture(TEST_STATE_PARAM)
+{
+	WASI::StdioConfig stdioConfig;
+	stdioConfig.buffering = WASI::StdioBuffering::full;
+	stdioConfig.numBufferBytes = 8;
+	stdioConfig.numCaptureBytes = 64;
+	TestProcess testProcess(stdioConfig);
+
+	// Buffered output is captured when the buffer accepts it, before it's flushed.
+	Uptr numBytesWritten = 0;
+	CHECK_EQ(testProcess.write({"abc"}, numBytesWritten), U32(__WASI_ESUCCESS));
+	CHECK_EQ(numBytesWritten, Uptr(3));
+	CHECK_EQ(testProcess.stdOut->writtenBytes, std::string());
+	CHECK_EQ(WASI::drainProcessStdioCapture(*testProcess.process), std::string("abc"));
+
+	WASI::flushProcessStdio(*testProcess.process);
+	CHECK_EQ(testProcess.stdOut->writtenBytes, std::string("abc"));
+
+	// Data larger than the buffer is written directly, and only the bytes the inner VFD accepted
+	// are captured.
+	testProcess.stdOut->maxBytesPerWrite = 4;
+	CHECK_EQ(testProcess.write({"0123456789"}, numBytesWritten), U32(__WASI_ESUCCESS));
+	CHECK_EQ(numBytesWritten, Uptr(4));
+	CHECK_EQ(testProcess.stdOut->writtenBytes, std::string("abc0123"));
+	CHECK_EQ(WASI::drainProcessStdioCapture(*testProcess.process), std::string("0123"));
+}
+
+static void testCaptureWraparound(TEST_STATE_PARAM)
+{
+	WASI::StdioConfig stdioConfig;
+	stdioConfig.numCaptureBytes = 8;
+	TestProcess testProcess(stdioConfig);
+
+	// Fill the ring buffer past its end, so the oldest bytes are dropped and the captured bytes
+	// wrap around to the start of the ring buffer.
+	Uptr numBytesWritten = 0;
+	Uptr numDroppedBytes = 0;
+	CHECK_EQ(testProcess.write({"abcdef"}, numBytesWritten), U32(__WASI_ESUCCESS));
+	CHECK_EQ(testProcess.write({"ghij"}, numBytesWritten), U32(__WASI_ESUCCESS));
+	CHECK_EQ(WASI::drainProcessStdioCapture(*testProcess.process, &numDroppedBytes),
+			 std::string("cdefghij"));
+	CHECK_EQ(numDroppedBytes, Uptr(2));
+
+	// Draining resets the dropped byte count.
+	CHECK_EQ(WASI::drainProcessStdioCapture(*testProcess.process, &numDroppedBytes),
+			 std::string());
+	CHECK_EQ(numDroppedBytes, Uptr(0));
+
+	// A write larger than the ring buffer only keeps its last bytes.
+	CHECK_EQ(testProcess.write({"xy"}, numBytesWritten), U32(__WASI_ESUCCESS));
+	CHECK_EQ(testProcess.write({"0123456789"}, numBytesWritten), U32(__WASI_ESUCCESS));
+	CHECK_EQ(WASI::drainProcessStdioCapture(*testProcess.process, &numDroppedBytes),
+			 std::string("23456789"));
+	CHECK_EQ(numDroppedBytes, Uptr(4));
+
+	CHECK_EQ(testProcess.stdOut->writtenBytes, std::string("abcdefghijxy0123456789"));
+}
+
+static std::string getTempPath(const char* name)
+{
+	const char* tempDir = getenv("TMPDIR");
+	if(!tempDir || !*tempDir) { tempDir = "/tmp"; }
+
+	U32 randomSuffix = 0;
+	Platform::getCryptographicRNG((U8*)&randomSuffix, sizeof(randomSuffix));
+	return std::string(tempDir) + "/wavm-" + name + "-" + std::to_string(randomSuffix);
+}
+
+struct BlockingReadThreadArgs
+{
+	TestProcess* testProcess = nullptr;
+	Context* context = nullptr;
+	U32 result = 0;
+	char byte = 0;
+	Uptr numBytesRead = 0;
+};
+
+static I64 blockingReadThreadEntry(void* argsVoid)
+{
+	BlockingReadThreadArgs* args = (BlockingReadThreadArgs*)argsVoid;
+	args->result = args->testProcess->readByte(args->context, args->byte, args->numBytesRead);
+	return 0;
+}
+
+static void testBlockingReadWhileReopeningFDs(TEST_STATE_PARAM)
+{
+	const std::string tempDirPath = getTempPath("wasi-test");
+	FileSystem& hostFS = Platform::getHostFS();
+	WAVM_ERROR_UNLESS(hostFS.createDir(tempDirPath) == Result::success);
+	std::shared_ptr<FileSystem> sandboxFS = makeSandboxFS(&hostFS, tempDirPath);
+
+	{
+		std::shared_ptr<BlockingInput> stdIn = std::make_shared<BlockingInput>();
+		TestProcess testProcess(WASI::StdioConfig(), new BlockingInputVFD(stdIn), sandboxFS.get());
+
+		// Start a thread that blocks reading stdin, and wait until it's blocked inside the read.
+		BlockingReadThreadArgs readArgs;
+		readArgs.testProcess = &testProcess;
+		readArgs.context = createContext(testProcess.compartment, "readThread");
+		Platform::Thread* readThread
+			= Platform::createThread(0, blockingReadThreadEntry, &readArgs);
+		{
+			Platform::Mutex::Lock lock(stdIn->mutex);
+			while(!stdIn->isReading) { stdIn->condition.wait(stdIn->mutex, Time::infinity()); }
+		}
+
+		// While the read is blocked, repeatedly open and close a file. Closing the file retires
+		// its FDE, and reopening it reuses the FD.
+		for(Uptr iteration = 0; iteration < 1000; ++iteration)
+		{
+			__wasi_fd_t fd = 0;
+			CHECK_EQ(testProcess.openFile(3,
+										  "file",
+										  __WASI_O_CREAT,
+										  __WASI_RIGHT_FD_READ | __WASI_RIGHT_FD_WRITE,
+										  fd),
+					 U32(__WASI_ESUCCESS));
+			CHECK_GE(fd, __wasi_fd_t(5));
+			CHECK_EQ(testProcess.close(fd), U32(__WASI_ESUCCESS));
+
+			// Closing the FD again fails, since the FDE was removed from the table.
+			CHECK_EQ(testProcess.close(fd), U32(__WASI_EBADF));
+		}
+
+		// Let the read finish, and check that it read from stdin.
+		{
+			Platform::Mutex::Lock lock(stdIn->mutex);
+			stdIn->isReleased = true;
+			stdIn->condition.broadcast();
+		}
+		Platform::joinThread(readThread);
+		CHECK_EQ(readArgs.result, U32(__WASI_ESUCCESS));
+		CHECK_EQ(readArgs.numBytesRead, Uptr(1));
+		CHECK_EQ(readArgs.byte, 'x');
+
+		// Destroying the process deletes any FDEs that are still retired.
+	}
+
+	CHECK_RESULT(hostFS.unlinkFile(tempDirPath + "/file"), Result::success);
+	CHECK_RESULT(hostFS.removeDir(tempDirPath), Result::success);
+}
+
+#ifdef __linux__
+// A VFD for a memfd that counts the reads from it.
+struct MemfdVFD : TestVFD
+{
+	MemfdVFD(int inFD, Uptr& inNumReads) : fd(inFD), numReads(inNumReads) {}
+
+	virtual Result close() override
+	{
+		WAVM_ERROR_UNLESS(!::close(fd));
+		delete this;
+		return Result::success;
+	}
+
+	virtual Result readv(const IOReadBuffer* buffers,
+						 Uptr numBuffers,
+						 Uptr* outNumBytesRead = nullptr,
+						 const U64* offset = nullptr) override
+	{
+		if(!offset || numBuffers != 1) { return Result::notSupported; }
+
+		++numReads;
+		const ssize_t result = pread(fd, buffers[0].data, buffers[0].numBytes, off_t(*offset));
+		WAVM_ERROR_UNLESS(result >= 0);
+		if(outNumBytesRead) { *outNumBytesRead = Uptr(result); }
+		return Result::success;
+	}
+
+	virtual Result getVFDInfo(VFDInfo& outInfo) override
+	{
+		outInfo.type = FileType::file;
+		outInfo.flags = VFDFlags{};
+		return Result::success;
+	}
+
+	virtual Result getHostDescriptor(Uptr& outDescriptor) override
+	{
+		outDescriptor = Uptr(fd);
+		return Result::success;
+	}
+
+private:
+	int fd;
+	Uptr& numReads;
+};
+
+// A VFD for the root directory of a MemfdFileSystem.
+struct MemfdRootVFD : TestVFD
+{
+	virtual Result getVFDInfo(VFDInfo& outInfo) override
+	{
+		outInfo.type = FileType::directory;
+		outInfo.flags = VFDFlags{};
+		return Result::success;
+	}
+};
+
+// A file system whose root directory contains two memfds with the same contents: "/sealed", which
+// is sealed against being shrunk or written, and "/unsealed", which isn't.
+struct MemfdFileSystem : FileSystem
+{
+	// The number of reads from the files opened from the file system.
+	Uptr numReads = 0;
+
+	MemfdFileSystem(const char* data, Uptr numBytes)
+	{
+		sealedFD = createMemfd(data, numBytes);
+		unsealedFD = createMemfd(data, numBytes);
+		const int seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+		WAVM_ERROR_UNLESS(!fcntl(sealedFD, F_ADD_SEALS, seals));
+	}
+
+	~MemfdFileSystem()
+	{
+		WAVM_ERROR_UNLESS(!::close(sealedFD));
+		WAVM_ERROR_UNLESS(!::close(unsealedFD));
+	}
+
+	int getFD(bool sealed) const { return sealed ? sealedFD : unsealedFD; }
+
+	virtual Result open(const std::string& path,
+						FileAccessMode accessMode,
+						FileCreateMode createMode,
+						VFD*& outFD,
+						const VFDFlags& flags = VFDFlags{}) override
+	{
+		if(createMode != FileCreateMode::openExisting) { return Result::notPermitted; }
+
+		if(path == "/") { outFD = new MemfdRootVFD; }
+		else if(path == "/sealed" || path == "/unsealed")
+		{
+			const int fd = dup(getFD(path == "/sealed"));
+			WAVM_ERROR_UNLESS(fd != -1);
+			outFD = new MemfdVFD(fd, numReads);
+		}
+		else
+		{
+			return Result::doesNotExist;
+		}
+		return Result::success;
+	}
+
+	virtual Result getFileInfo(const std::string& path, FileInfo& outInfo) override
+	{
+		return Result::notSupported;
+	}
+	virtual Result setFileTimes(const std::string& path,
+								bool setLastAccessTime,
+								Time lastAccessTime,
+								bool setLastWriteTime,
+								Time lastWriteTime) override
+	{
+		return Result::notPermitted;
+	}
+
+	virtual Result openDir(const std::string& path, DirEntStream*& outStream) override
+	{
+		return Result::notSupported;
+	}
+
+	virtual Result renameFile(const std::string& oldPath, const std::string& newPath) override
+	{
+		return Result::notPermitted;
+	}
+	virtual Result unlinkFile(const std::string& path) override { return Result::notPermitted; }
+	virtual Result removeDir(const std::string& path) override { return Result::notPermitted; }
+	virtual Result createDir(const std::string& path) override { return Result::notPermitted; }
+	virtual Result createHardLink(const std::string& existingPath,
+								  const std::string& newPath) override
+	{
+		return Result::notPermitted;
+	}
+	virtual Result createSymbolicLink(const std::string& targetPath,
+									  const std::string& linkPath) override
+	{
+		return Result::notPermitted;
+	}
+	virtual Result readSymbolicLink(const std::string& path, std::string& outTargetPath) override
+	{
+		return Result::notPermitted;
+	}
+
+private:
+	int sealedFD;
+	int unsealedFD;
+
+	static int createMemfd(const char* data, Uptr numBytes)
+	{
+		const int fd = memfd_create("wasi-test", MFD_ALLOW_SEALING);
+		WAVM_ERROR_UNLESS(fd != -1);
+		WAVM_ERROR_UNLESS(write(fd, data, numBytes) == ssize_t(numBytes));
+		return fd;
+	}
+};
+
+// Opens one of the files in a MemfdFileSystem, and maps it over the second page of the guest's
+// memory, which is filled with garbage first. Returns the number of times the file was read.
+static Uptr mapMemfd(TEST_STATE_PARAM,
+					 TestProcess& testProcess,
+					 MemfdFileSystem& fileSystem,
+					 const char* path)
+{
+	static constexpr U32 mappedAddress = U32(IR::numBytesPerPage);
+	U8* mappedBytes = memoryArrayPtr<U8>(testProcess.memory, mappedAddress, IR::numBytesPerPage);
+	memset(mappedBytes, 'x', IR::numBytesPerPage);
+
+	__wasi_fd_t fd = 0;
+	CHECK_EQ(testProcess.openFile(3, path, 0, __WASI_RIGHT_FD_READ | __WASI_RIGHT_FD_SEEK, fd),
+			 U32(__WASI_ESUCCESS));
+
+	const Uptr numReadsBeforeMap = fileSystem.numReads;
+	CHECK_EQ(testProcess.mapFile(fd, 0, mappedAddress, U32(IR::numBytesPerPage)),
+			 U32(__WASI_ESUCCESS));
+	const Uptr numReads = fileSystem.numReads - numReadsBeforeMap;
+	CHECK_EQ(testProcess.close(fd), U32(__WASI_ESUCCESS));
+
+	// The mapped pages contain the file, followed by zeros.
+	CHECK_EQ(std::string((const char*)mappedBytes), std::string("mapped file"));
+	CHECK_EQ(mappedBytes[IR::numBytesPerPage - 1], U8(0));
+
+	return numReads;
+}
+
+static void testFileMapping(TEST_STATE_PARAM)
+{
+	static const char fileData[] = "mapped file";
+	MemfdFileSystem fileSystem(fileData, sizeof(fileData) - 1);
+	TestProcess testProcess(
+		WASI::StdioConfig(), Platform::getStdFD(Platform::StdDevice::in), &fileSystem);
+
+	// A file that is sealed against being shrunk or written is mapped, so it isn't read.
+	CHECK_EQ(mapMemfd(TEST_STATE_ARG, testProcess, fileSystem, "sealed"), Uptr(0));
+
+	// Writes to the mapped pages are private to the guest's memory.
+	memoryRef<char>(testProcess.memory, U32(IR::numBytesPerPage)) = 'M';
+	char fileChar = 0;
+	CHECK_EQ(pread(fileSystem.getFD(true), &fileChar, 1, 0), ssize_t(1));
+	CHECK_EQ(fileChar, 'm');
+
+	// A file that could be truncated while it's mapped is copied into the memory instead.
+	CHECK_GT(mapMemfd(TEST_STATE_ARG, testProcess, fileSystem, "unsealed"), Uptr(0));
+}
+#endif
+
+int execWASITest(int argc, char** argv)
+{
+	TEST_STATE_LOCAL;
+	testUnbufferedPartialWrites(testState);
+	testBufferedCapture(testState);
+	testCaptureWraparound(testState);
+	testBlockingReadWhileReopeningFDs(testState);
+#ifdef __linux__
+	testFileMapping(testState);
+#endif
+	return testState.exitCode();
+}
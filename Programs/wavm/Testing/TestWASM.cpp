@@ -0,0 +1,327 @@
+#include <string.h>
+#include <algorithm>
+#include <new>
+#include <string>
+#include <vector>
+#include "TestUtils.h"
+#include "WAVM/IR/Module.h"
+#include "WAVM/IR/Operators.h"
+#include "WAVM/Inline/Assert.h"
+#include "WAVM/Inline/BasicTypes.h"
+#include "WAVM/Inline/Serialization.h"
+#include "WAVM/Inline/Timing.h"
+#include "WAVM/WASM/WASM.h"
+#include "WAVM/WASTParse/WASTParse.h"
+#include "WAVM/WASTPrint/WASTPrint.h"
+#include "wavm-test.h"
+
+using namespace WAVM;
+using namespace WAVM::IR;
+using namespace WAVM::Testing;
+
+static bool parseTextModule(const char* wat, Uptr watLength, IR::Module& outModule)
+{
+	std::vector<WAST::Error> parseErrors;
+	if(!WAST::parseModule(wat, watLength, outModule, parseErrors))
+	{
+		WAST::reportParseErrors("parseTextModule", wat, parseErrors);
+		return false;
+	}
+	return true;
+}
+
+static void testInitializerOpcodes(TEST_STATE_PARAM)
+{
+	// Construct initializer expressions in storage that is filled with garbage, and check that
+	// setting their type initializes the whole opcode that is serialized.
+	alignas(InitializerExpression) U8 initializerStorage[sizeof(InitializerExpression)];
+	memset(initializerStorage, 0xcc, sizeof(initializerStorage));
+	InitializerExpression* initializer = new(initializerStorage) InitializerExpression(I32(1));
+	CHECK_EQ(U32(initializer->typeOpcode), U32(Opcode::i32_const));
+	initializer->~InitializerExpression();
+
+	alignas(ElemExpr) U8 elemExprStorage[sizeof(ElemExpr)];
+	memset(elemExprStorage, 0xcc, sizeof(elemExprStorage));
+	ElemExpr* elemExpr = new(elemExprStorage) ElemExpr(ReferenceType::funcref);
+	CHECK_EQ(U32(elemExpr->typeOpcode), U32(Opcode::ref_null));
+	elemExpr->~ElemExpr();
+}
+
+static void testSaveInitializers(TEST_STATE_PARAM)
+{
+	// A data segment with a constant offset is saved to exactly the expected bytes.
+	{
+		static const char wat[] = "(module (memory 1) (data (i32.const 0) \"ab\"))";
+		IR::Module irModule;
+		WAVM_ERROR_UNLESS(parseTextModule(wat, sizeof(wat), irModule));
+		irModule.customSections.clear();
+
+		const U8 expectedBytes[] = {0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, // header
+									0x05, 0x03, 0x01, 0x00, 0x01, // memory section
+									0x0c, 0x01, 0x01, // data count section
+									0x0b, 0x08, 0x01, 0x00, 0x41, 0x00, 0x0b, 0x02, 0x61, 0x62};
+		const std::vector<U8> wasmBytes = WASM::saveBinaryModule(irModule);
+		CHECK_EQ(wasmBytes.size(), sizeof(expectedBytes));
+		CHECK_TRUE(wasmBytes.size() == sizeof(expectedBytes)
+				   && !memcmp(wasmBytes.data(), expectedBytes, sizeof(expectedBytes)));
+	}
+
+	// A module with each kind of initializer expression is saved to the same bytes every time,
+	// and the bytes load to the same module.
+	{
+		static const char wat[]
+			= "(module"
+			  "  (import \"m\" \"g\" (global $g i32))"
+			  "  (memory 1)"
+			  "  (table 4 funcref)"
+			  "  (func $f)"
+			  "  (global i32 (i32.const -1))"
+			  "  (global i64 (i64.const 0x123456789))"
+			  "  (global f32 (f32.const 1.5))"
+			  "  (global f64 (f64.const -2.5))"
+			  "  (global v128 (v128.const i32x4 1 2 3 4))"
+			  "  (global i32 (global.get $g))"
+			  "  (global funcref (ref.null func))"
+			  "  (global funcref (ref.func $f))"
+			  "  (data (global.get $g) \"ab\")"
+			  "  (elem (i32.const 1) funcref (ref.func $f) (ref.null func))"
+			  ")";
+		IR::Module irModule;
+		WAVM_ERROR_UNLESS(parseTextModule(wat, sizeof(wat), irModule));
+		const std::string expectedText = WAST::print(irModule);
+
+		const std::vector<U8> wasmBytes = WASM::saveBinaryModule(irModule);
+		CHECK_TRUE(WASM::saveBinaryModule(irModule) == wasmBytes);
+
+		IR::Module loadedModule;
+		WASM::LoadError loadError;
+		const bool loaded
+			= WASM::loadBinaryModule(wasmBytes.data(), wasmBytes.size(), loadedModule, &loadError);
+		if(!loaded) { Log::printf(Log::error, "%s\n", loadError.message.c_str()); }
+		CHECK_TRUE(loaded);
+		if(loaded)
+		{
+			CHECK_EQ(WAST::print(loadedModule), expectedText);
+			CHECK_TRUE(WASM::saveBinaryModule(loadedModule) == wasmBytes);
+		}
+	}
+}
+
+// Creates a module with many functions of type () -> i32. If slowInvalidBodyIndex is a function
+// index, that function executes many nops before leaving an f64 on the stack. If
+// fastInvalidBodyIndex is a function index, that function leaves nothing on the stack.
+static std::vector<U8> createModuleWithInvalidBodies(Uptr slowInvalidBodyIndex,
+													 Uptr fastInvalidBodyIndex)
+{
+	static constexpr Uptr numFunctions = 256;
+	static constexpr Uptr numSlowInvalidBodyNops = 100000;
+
+	IR::Module irModule;
+	irModule.types.push_back(FunctionType(TypeTuple{ValueType::i32}, TypeTuple{}));
+	for(Uptr functionIndex = 0; functionIndex < numFunctions; ++functionIndex)
+	{
+		Serialization::ArrayOutputStream codeStream;
+		OperatorEncoderStream opEncoder(codeStream);
+		if(functionIndex == slowInvalidBodyIndex)
+		{
+			for(Uptr nopIndex = 0; nopIndex < numSlowInvalidBodyNops; ++nopIndex)
+			{
+				opEncoder.nop(NoImm());
+			}
+			opEncoder.f64_const({0.0});
+		}
+		else if(functionIndex != fastInvalidBodyIndex)
+		{
+			opEncoder.i32_const({I32(functionIndex)});
+		}
+		opEncoder.end();
+
+		irModule.functions.defs.push_back({{0}, {}, codeStream.getBytes(), {}});
+	}
+
+	return WASM::saveBinaryModule(irModule);
+}
+
+static void testParallelCodeDecodeErrors(TEST_STATE_PARAM)
+{
+	// The error reported for a module with only the slow invalid body, and for a module with only
+	// the fast invalid body.
+	const std::vector<U8> slowInvalidBytes = createModuleWithInvalidBodies(100, UINTPTR_MAX);
+	WASM::LoadError slowError;
+	IR::Module slowInvalidModule;
+	CHECK_FALSE(WASM::loadBinaryModule(
+		slowInvalidBytes.data(), slowInvalidBytes.size(), slowInvalidModule, &slowError, 1));
+
+	const std::vector<U8> fastInvalidBytes = createModuleWithInvalidBodies(UINTPTR_MAX, 101);
+	WASM::LoadError fastError;
+	IR::Module fastInvalidModule;
+	CHECK_FALSE(WASM::loadBinaryModule(
+		fastInvalidBytes.data(), fastInvalidBytes.size(), fastInvalidModule, &fastError, 1));
+	CHECK_NE(fastError.message, slowError.message);
+
+	// Load a module with both invalid bodies on 1 and 8 threads. With multiple threads, the error
+	// in the fast invalid body is usually found first, but the error in the slow invalid body must
+	// be reported, since it has the lower index.
+	const std::vector<U8> bothInvalidBytes = createModuleWithInvalidBodies(100, 101);
+	for(Uptr numThreads : {Uptr(1), Uptr(8)})
+	{
+		for(Uptr repeatIndex = 0; repeatIndex < 4; ++repeatIndex)
+		{
+			WASM::LoadError loadError;
+			IR::Module irModule;
+			CHECK_FALSE(WASM::loadBinaryModule(bothInvalidBytes.data(),
+											   bothInvalidBytes.size(),
+											   irModule,
+											   &loadError,
+											   numThreads));
+			CHECK_TRUE(loadError.type == slowError.type);
+			CHECK_EQ(loadError.message, slowError.message);
+		}
+	}
+
+	// A valid module loads to the same IR on 1 and 8 threads.
+	const std::vector<U8> validBytes = createModuleWithInvalidBodies(UINTPTR_MAX, UINTPTR_MAX);
+	IR::Module singleThreadedModule;
+	IR::Module multiThreadedModule;
+	CHECK_TRUE(WASM::loadBinaryModule(
+		validBytes.data(), validBytes.size(), singleThreadedModule, nullptr, 1));
+	CHECK_TRUE(WASM::loadBinaryModule(
+		validBytes.data(), validBytes.size(), multiThreadedModule, nullptr, 8));
+	CHECK_TRUE(WASM::saveBinaryModule(singleThreadedModule)
+			   == WASM::saveBinaryModule(multiThreadedModule));
+}
+
+// Loads a module with a ModuleStreamDecoder, feeding it a first chunk of firstChunkBytes, followed
+// by chunks of chunkBytes.
+static bool loadStreamedModule(const std::vector<U8>& wasmBytes,
+							   Uptr firstChunkBytes,
+							   Uptr chunkBytes,
+							   IR::Module& outModule,
+							   WASM::LoadError& outError)
+{
+	WASM::ModuleStreamDecoder* decoder = WASM::createModuleStreamDecoder(outModule);
+	bool succeeded = true;
+	Uptr numChunkBytes = firstChunkBytes;
+	for(Uptr offset = 0; succeeded && offset < wasmBytes.size(); numChunkBytes = chunkBytes)
+	{
+		numChunkBytes = std::min(numChunkBytes, wasmBytes.size() - offset);
+		succeeded = WASM::feedModuleStreamDecoder(
+			decoder, wasmBytes.data() + offset, numChunkBytes, &outError);
+		offset += numChunkBytes;
+	}
+	if(succeeded) { succeeded = WASM::finishModuleStreamDecoder(decoder, &outError); }
+	WASM::destroyModuleStreamDecoder(decoder);
+	return succeeded;
+}
+
+// Checks that streaming the module in chunks of each size in chunkSizes gives the same result as
+// loadBinaryModule. If checkEachSplit is true, each split of the module into two chunks is checked
+// too.
+static void checkStreamedLoad(TEST_STATE_PARAM,
+							  const std::vector<U8>& wasmBytes,
+							  const std::vector<Uptr>& chunkSizes,
+							  bool checkEachSplit)
+{
+	IR::Module expectedModule;
+	WASM::LoadError expectedError;
+	const bool expectedLoaded = WASM::loadBinaryModule(
+		wasmBytes.data(), wasmBytes.size(), expectedModule, &expectedError, 1);
+	const std::string expectedText = expectedLoaded ? WAST::print(expectedModule) : std::string();
+
+	auto checkChunks = [&](Uptr firstChunkBytes, Uptr chunkBytes) {
+		IR::Module streamedModule;
+		WASM::LoadError streamedError;
+		const bool streamed = loadStreamedModule(
+			wasmBytes, firstChunkBytes, chunkBytes, streamedModule, streamedError);
+		CHECK_EQ(streamed, expectedLoaded);
+		if(streamed && expectedLoaded) { CHECK_EQ(WAST::print(streamedModule), expectedText); }
+		else if(!streamed && !expectedLoaded)
+		{
+			CHECK_TRUE(streamedError.type == expectedError.type);
+			CHECK_EQ(streamedError.message, expectedError.message);
+		}
+	};
+
+	for(Uptr chunkBytes : chunkSizes) { checkChunks(chunkBytes, chunkBytes); }
+	if(checkEachSplit)
+	{
+		for(Uptr splitOffset = 0; splitOffset <= wasmBytes.size(); ++splitOffset)
+		{
+			checkChunks(splitOffset, std::max(wasmBytes.size(), Uptr(1)));
+		}
+	}
+}
+
+static void testStreamedLoad(TEST_STATE_PARAM)
+{
+	static const char wat[]
+		= "(module"
+		  "  (import \"m\" \"f\" (func $imported (param i32) (result i32)))"
+		  "  (memory 1)"
+		  "  (table 2 funcref)"
+		  "  (global $g (mut i32) (i32.const 1))"
+		  "  (func $add (export \"add\") (param i32 i32) (result i32)"
+		  "    (i32.add (local.get 0) (local.get 1)))"
+		  "  (func $callImported (param i32) (result i32) (call $imported (local.get 0)))"
+		  "  (func $loop (result i32) (local i32)"
+		  "    (loop (br_if 0 (i32.eqz (local.get 0))))"
+		  "    (global.get $g))"
+		  "  (elem (i32.const 0) $add $loop)"
+		  "  (data (i32.const 16) \"streamed data\")"
+		  ")";
+	IR::Module irModule;
+	WAVM_ERROR_UNLESS(parseTextModule(wat, sizeof(wat), irModule));
+	const std::vector<U8> wasmBytes = WASM::saveBinaryModule(irModule);
+
+	// Stream the valid module in chunks of every size, and split in two at every offset.
+	std::vector<Uptr> allChunkSizes;
+	for(Uptr chunkBytes = 1; chunkBytes <= wasmBytes.size(); ++chunkBytes)
+	{
+		allChunkSizes.push_back(chunkBytes);
+	}
+	checkStreamedLoad(TEST_STATE_ARG, wasmBytes, allChunkSizes, true);
+
+	// Stream each truncation of the module in 1-byte chunks, and split in two at every offset.
+	for(Uptr numBytes = 0; numBytes < wasmBytes.size(); ++numBytes)
+	{
+		checkStreamedLoad(TEST_STATE_ARG,
+						  std::vector<U8>(wasmBytes.begin(), wasmBytes.begin() + numBytes),
+						  {1},
+						  true);
+	}
+
+	// Stream the module with each byte replaced by bytes that make it malformed or invalid in
+	// different ways, in 1-byte chunks and in one chunk. The mutated modules are also streamed
+	// truncated after the replaced byte, to check the errors that must be reported before the end
+	// of the module is reached.
+	for(Uptr byteIndex = 0; byteIndex < wasmBytes.size(); ++byteIndex)
+	{
+		for(U8 replacementByte : {U8(0x00), U8(0x7f), U8(0x80), U8(0xff)})
+		{
+			if(wasmBytes[byteIndex] == replacementByte) { continue; }
+			std::vector<U8> mutatedBytes = wasmBytes;
+			mutatedBytes[byteIndex] = replacementByte;
+			checkStreamedLoad(TEST_STATE_ARG, mutatedBytes, {1, mutatedBytes.size()}, false);
+			mutatedBytes.resize(byteIndex + 1);
+			checkStreamedLoad(TEST_STATE_ARG, mutatedBytes, {1, mutatedBytes.size()}, false);
+		}
+	}
+
+	// Stream a module with an invalid function body.
+	checkStreamedLoad(TEST_STATE_ARG, createModuleWithInvalidBodies(UINTPTR_MAX, 3), {1, 7}, true);
+}
+
+I32 execWASMTest(int argc, char** argv)
+{
+	TEST_STATE_LOCAL;
+	Timing::Timer timer;
+
+	testInitializerOpcodes(TEST_STATE_ARG);
+	testSaveInitializers(TEST_STATE_ARG);
+	testParallelCodeDecodeErrors(TEST_STATE_ARG);
+	testStreamedLoad(TEST_STATE_ARG);
+
+	Timing::logTimer("Ran WASM tests", timer);
+
+	return testState.exitCode();
+}
@@ -12,10 +12,14 @@ enum class TestCommand
 	invalid,
 
 	dumpModules,
+	files,
 	hashMap,
 	hashSet,
 	i128,
 	leb128,
+	sampling,
+	sockets,
+	wasm,
 
 #if WAVM_ENABLE_RUNTIME
 	api,
@@ -24,6 +28,7 @@ enum class TestCommand
 	dwarf,
 	objectLinker,
 	script,
+	wasi,
 #endif
 };
 
@@ -38,6 +43,7 @@ static const char* getTestCommandListHelpText()
 #if WAVM_ENABLE_RUNTIME
 		   "  dwarf         Test DWARF parser\n"
 #endif
+		   "  files         Test file allocation, links, and writes\n"
 		   "  hashmap       Test HashMap\n"
 		   "  hashset       Test HashSet\n"
 		   "  i128          Test I128\n"
@@ -46,6 +52,12 @@ static const char* getTestCommandListHelpText()
 		   "  objectlinker  Test ObjectLinker\n"
 		   "  benchmark     Benchmark WAVM\n"
 		   "  script        Run WAST test scripts\n"
+#endif
+		   "  sampling      Test call stack sampling\n"
+		   "  sockets       Test sockets and reactors\n"
+		   "  wasm          Test WebAssembly binary serialization\n"
+#if WAVM_ENABLE_RUNTIME
+		   "  wasi          Test the WASI host API\n"
 #endif
 		;
 }
@@ -62,10 +74,14 @@ void showTestHelp(Log::Category outputCategory)
 static TestCommand parseTestCommand(const char* string)
 {
 	if(!strcmp(string, "dumpmodules")) { return TestCommand::dumpModules; }
+	else if(!strcmp(string, "files")) { return TestCommand::files; }
 	else if(!strcmp(string, "hashmap")) { return TestCommand::hashMap; }
 	else if(!strcmp(string, "hashset")) { return TestCommand::hashSet; }
 	else if(!strcmp(string, "i128")) { return TestCommand::i128; }
 	else if(!strcmp(string, "leb128")) { return TestCommand::leb128; }
+	else if(!strcmp(string, "sampling")) { return TestCommand::sampling; }
+	else if(!strcmp(string, "sockets")) { return TestCommand::sockets; }
+	else if(!strcmp(string, "wasm")) { return TestCommand::wasm; }
 #if WAVM_ENABLE_RUNTIME
 	else if(!strcmp(string, "api")) { return TestCommand::api; }
 	else if(!strcmp(string, "c-api")) { return TestCommand::cAPI; }
@@ -73,6 +89,7 @@ static TestCommand parseTestCommand(const char* string)
 	else if(!strcmp(string, "dwarf")) { return TestCommand::dwarf; }
 	else if(!strcmp(string, "objectlinker")) { return TestCommand::objectLinker; }
 	else if(!strcmp(string, "script")) { return TestCommand::script; }
+	else if(!strcmp(string, "wasi")) { return TestCommand::wasi; }
 #endif
 	else
 	{
@@ -93,10 +110,14 @@ int execTestCommand(int argc, char** argv)
 		switch(command)
 		{
 		case TestCommand::dumpModules: return execDumpTestModules(argc - 1, argv + 1);
+		case TestCommand::files: return execFilesTest(argc - 1, argv + 1);
 		case TestCommand::hashMap: return execHashMapTest(argc - 1, argv + 1);
 		case TestCommand::hashSet: return execHashSetTest(argc - 1, argv + 1);
 		case TestCommand::i128: return execI128Test(argc - 1, argv + 1);
 		case TestCommand::leb128: return execLEB128Test(argc - 1, argv + 1);
+		case TestCommand::sampling: return execSamplingTest(argc - 1, argv + 1);
+		case TestCommand::sockets: return execSocketsTest(argc - 1, argv + 1);
+		case TestCommand::wasm: return execWASMTest(argc - 1, argv + 1);
 #if WAVM_ENABLE_RUNTIME
 		case TestCommand::api: return execAPITest(argc - 1, argv + 1);
 		case TestCommand::cAPI: return execCAPITest(argc - 1, argv + 1);
@@ -104,6 +125,7 @@ int execTestCommand(int argc, char** argv)
 		case TestCommand::dwarf: return execDWARFTest(argc - 1, argv + 1);
 		case TestCommand::objectLinker: return execObjectLinkerTest(argc - 1, argv + 1);
 		case TestCommand::script: return execRunTestScript(argc - 1, argv + 1);
+		case TestCommand::wasi: return execWASITest(argc - 1, argv + 1);
 #endif
 
 		case TestCommand::invalid:
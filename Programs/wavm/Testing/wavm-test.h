@@ -3,10 +3,14 @@
 #include "WAVM/Inline/Config.h"
 
 int execDumpTestModules(int argc, char** argv);
+int execFilesTest(int argc, char** argv);
 int execHashMapTest(int argc, char** argv);
 int execHashSetTest(int argc, char** argv);
 int execI128Test(int argc, char** argv);
 int execLEB128Test(int argc, char** argv);
+int execSamplingTest(int argc, char** argv);
+int execSocketsTest(int argc, char** argv);
+int execWASMTest(int argc, char** argv);
 
 #if WAVM_ENABLE_RUNTIME
 int execAPITest(int argc, char** argv);
@@ -14,6 +18,7 @@ int execBenchmark(int argc, char** argv);
 int execDWARFTest(int argc, char** argv);
 int execObjectLinkerTest(int argc, char** argv);
 int execRunTestScript(int argc, char** argv);
+int execWASITest(int argc, char** argv);
 
 #ifdef __cplusplus
 extern "C"
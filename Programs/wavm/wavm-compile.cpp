@@ -112,6 +112,12 @@ void showCompileHelp(Log::Category outputCategory)
 				"                            e.g. --target-cpu-feature +sse4.1,+avx,-avx512f\n"
 				"  --enable <feature>        Enable the specified feature. See the list of\n"
 				"                            supported features below.\n"
+				"  --imprecise-memory-traps  Allow optimizing memory accesses in ways that may\n"
+				"                            make out-of-bounds accesses trap imprecisely or not\n"
+				"                            at all\n"
+				"  --explicit-stack-limit-checks\n"
+				"                            Check the stack pointer against the context's\n"
+				"                            stack limit on entry to each function\n"
 				"  --format=<format>         Specifies the format of the output file. See the\n"
 				"                            list of supported output formats below.\n"
 				"\n"
@@ -258,6 +264,14 @@ int execCompileCommand(int argc, char** argv)
 				return EXIT_FAILURE;
 			}
 		}
+		else if(!strcmp(argv[argIndex], "--imprecise-memory-traps"))
+		{
+			featureSpec.preciseMemoryTraps = false;
+		}
+		else if(!strcmp(argv[argIndex], "--explicit-stack-limit-checks"))
+		{
+			featureSpec.explicitStackLimitChecks = true;
+		}
 		else if(stringStartsWith(argv[argIndex], "--format=", suffix))
 		{
 			if(outputFormat != OutputFormat::unspecified)
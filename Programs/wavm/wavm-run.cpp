@@ -25,6 +25,7 @@
 #include "WAVM/Platform/File.h"
 #include "WAVM/Platform/Memory.h"
 #include "WAVM/Runtime/Linker.h"
+#include "WAVM/Runtime/Profiler.h"
 #include "WAVM/Runtime/Runtime.h"
 #include "WAVM/VFS/SandboxFS.h"
 #include "WAVM/WASI/WASI.h"
@@ -37,7 +38,7 @@ using namespace WAVM::IR;
 using namespace WAVM::Runtime;
 
 static bool loadTextOrBinaryModule(const char* filename,
-								   std::vector<U8>&& fileBytes,
+								   const SharedBytes& fileBytes,
 								   const IR::FeatureSpec& featureSpec,
 								   ModuleRef& outModule)
 {
@@ -46,8 +47,7 @@ static bool loadTextOrBinaryModule(const char* filename,
 	   && !memcmp(fileBytes.data(), WASM::magicNumber, sizeof(WASM::magicNumber)))
 	{
 		WASM::LoadError loadError;
-		if(Runtime::loadBinaryModule(
-			   fileBytes.data(), fileBytes.size(), outModule, featureSpec, &loadError))
+		if(Runtime::loadBinaryModule(fileBytes, outModule, featureSpec, &loadError))
 		{
 			return true;
 		}
@@ -61,17 +61,18 @@ static bool loadTextOrBinaryModule(const char* filename,
 	}
 	else
 	{
-		// Make sure the WAST file is null terminated.
-		fileBytes.push_back(0);
+		// Make a null terminated copy of the WAST file.
+		std::vector<U8> wastBytes(fileBytes.begin(), fileBytes.end());
+		wastBytes.push_back(0);
 
 		// Parse the module text format to IR.
 		std::vector<WAST::Error> parseErrors;
 		IR::Module irModule(featureSpec);
 		if(!WAST::parseModule(
-			   (const char*)fileBytes.data(), fileBytes.size(), irModule, parseErrors))
+			   (const char*)wastBytes.data(), wastBytes.size(), irModule, parseErrors))
 		{
 			Log::printf(Log::error, "Error parsing WebAssembly text file:\n");
-			WAST::reportParseErrors(filename, (const char*)fileBytes.data(), parseErrors);
+			WAST::reportParseErrors(filename, (const char*)wastBytes.data(), parseErrors);
 			return false;
 		}
 
@@ -82,15 +83,16 @@ static bool loadTextOrBinaryModule(const char* filename,
 	}
 }
 
-static bool loadPrecompiledModule(std::vector<U8>&& fileBytes,
+static bool loadPrecompiledModule(const SharedBytes& fileBytes,
 								  const IR::FeatureSpec& featureSpec,
 								  ModuleRef& outModule)
 {
 	IR::Module irModule(featureSpec);
 
-	// Deserialize the module IR from the binary format.
+	// Deserialize the module IR from the binary format. The module's data segments and custom
+	// sections, including the precompiled object code, share the file's bytes.
 	WASM::LoadError loadError;
-	if(!WASM::loadBinaryModule(fileBytes.data(), fileBytes.size(), irModule, &loadError))
+	if(!WASM::loadBinaryModule(fileBytes, irModule, &loadError))
 	{
 		Log::printf(
 			Log::error, "Error loading WebAssembly binary file: %s\n", loadError.message.c_str());
@@ -152,13 +154,41 @@ void showRunHelp(Log::Category outputCategory)
 				"  --nocache             Don't use the WAVM object cache\n"
 				"  --enable <feature>    Enable the specified feature. See the list of supported\n"
 				"                        features below.\n"
+				"  --imprecise-memory-traps\n"
+				"                        Allow optimizing memory accesses in ways that may make\n"
+				"                        out-of-bounds accesses trap imprecisely or not at all\n"
+				"  --max-stack-bytes=<bytes>\n"
+				"                        Compiles the module with explicit stack limit checks,\n"
+				"                        and traps if it uses more than <bytes> of stack\n"
 				"  --abi=<abi>           Specifies the ABI used by the WASM module. See the list\n"
 				"                        of supported ABIs below. The default is to detect the\n"
 				"                        ABI based on the module imports/exports.\n"
 				"  --mount-root <dir>    Mounts <dir> as the WASI root directory\n"
+				"  --listen <address>    Passes a socket listening on <address> to the WASI\n"
+				"                        process as the next free fd. May be repeated.\n"
+				"                        <address> is one of:\n"
+				"                        - tcp:<IPv4 address>:<port>\n"
+				"                        - tcp6:[<IPv6 address>]:<port>\n"
+				"                        - unix:<path>\n"
 				"  --wasi-trace=<level>  Sets the level of WASI tracing:\n"
 				"                        - syscalls\n"
 				"                        - syscalls-with-callstacks\n"
+				"  --wasi-stdio-buffering=<mode>\n"
+				"                        Sets how WASI stdout and stderr writes are buffered:\n"
+				"                        - none (default)\n"
+				"                        - line\n"
+				"                        - full\n"
+				"  --wasi-stdio-buffer-size=<bytes>\n"
+				"                        Sets the size of the WASI stdout and stderr buffers\n"
+				"                        (default: 4096)\n"
+				"  --profile=<file>      Samples the program's call stacks while it runs, and\n"
+				"                        writes the profile to <file>\n"
+				"  --profile-format=<format>\n"
+				"                        Sets the format of the profile:\n"
+				"                        - pprof (default)\n"
+				"                        - folded: folded stacks for flame graph tools\n"
+				"  --profile-rate=<hz>   Sets the number of samples per second of CPU time\n"
+				"                        (default: 1000)\n"
 				"\n"
 				"ABIs:\n"
 				"%s"
@@ -198,11 +228,17 @@ struct State
 	const char* filename = nullptr;
 	const char* functionName = nullptr;
 	const char* rootMountPath = nullptr;
+	std::vector<std::string> listenAddresses;
 	std::vector<std::string> runArgs;
 	ABI abi = ABI::detect;
 	bool precompiled = false;
 	bool allowCaching = true;
 	WASI::SyscallTraceLevel wasiTraceLavel = WASI::SyscallTraceLevel::none;
+	WASI::StdioConfig wasiStdioConfig;
+	const char* profilePath = nullptr;
+	ProfileFormat profileFormat = ProfileFormat::pprof;
+	Uptr profileSamplesPerSecond = 1000;
+	Uptr maxStackBytes = 0;
 
 	// Objects that need to be cleaned up before exiting.
 	GCPointer<Compartment> compartment = createCompartment();
@@ -275,6 +311,10 @@ struct State
 					return false;
 				}
 			}
+			else if(!strcmp(*nextArg, "--imprecise-memory-traps"))
+			{
+				featureSpec.preciseMemoryTraps = false;
+			}
 			else if(!strcmp(*nextArg, "--precompiled")) { precompiled = true; }
 			else if(!strcmp(*nextArg, "--nocache")) { allowCaching = false; }
 			else if(!strcmp(*nextArg, "--mount-root"))
@@ -295,6 +335,94 @@ struct State
 
 				rootMountPath = *nextArg;
 			}
+			else if(!strcmp(*nextArg, "--listen"))
+			{
+				++nextArg;
+				if(!*nextArg)
+				{
+					Log::printf(Log::error, "Expected address following '--listen'.\n");
+					return false;
+				}
+
+				listenAddresses.push_back(*nextArg);
+			}
+			else if(stringStartsWith(*nextArg, "--wasi-stdio-buffering=", suffix))
+			{
+				if(!strcmp(suffix, "none"))
+				{
+					wasiStdioConfig.buffering = WASI::StdioBuffering::none;
+				}
+				else if(!strcmp(suffix, "line"))
+				{
+					wasiStdioConfig.buffering = WASI::StdioBuffering::line;
+				}
+				else if(!strcmp(suffix, "full"))
+				{
+					wasiStdioConfig.buffering = WASI::StdioBuffering::full;
+				}
+				else
+				{
+					Log::printf(Log::error, "Invalid WASI stdio buffering mode: %s\n", suffix);
+					return false;
+				}
+			}
+			else if(stringStartsWith(*nextArg, "--wasi-stdio-buffer-size=", suffix))
+			{
+				char* end = nullptr;
+				const unsigned long long numBufferBytes = strtoull(suffix, &end, 10);
+				if(!*suffix || *end || !numBufferBytes)
+				{
+					Log::printf(Log::error, "Invalid WASI stdio buffer size: %s\n", suffix);
+					return false;
+				}
+				wasiStdioConfig.numBufferBytes = Uptr(numBufferBytes);
+			}
+			else if(stringStartsWith(*nextArg, "--max-stack-bytes=", suffix))
+			{
+				char* end = nullptr;
+				const unsigned long long numStackBytes = strtoull(suffix, &end, 10);
+				if(!*suffix || *end || !numStackBytes)
+				{
+					Log::printf(Log::error, "Invalid maximum stack size: %s\n", suffix);
+					return false;
+				}
+				maxStackBytes = Uptr(numStackBytes);
+				featureSpec.explicitStackLimitChecks = true;
+			}
+			else if(stringStartsWith(*nextArg, "--profile=", suffix))
+			{
+				if(profilePath)
+				{
+					Log::printf(Log::error,
+								"'--profile=' may only occur once on the command line.\n");
+					return false;
+				}
+				profilePath = suffix;
+			}
+			else if(stringStartsWith(*nextArg, "--profile-format=", suffix))
+			{
+				if(!strcmp(suffix, "pprof")) { profileFormat = ProfileFormat::pprof; }
+				else if(!strcmp(suffix, "folded"))
+				{
+					profileFormat = ProfileFormat::foldedStacks;
+				}
+				else
+				{
+					Log::printf(Log::error, "Invalid profile format: %s\n", suffix);
+					return false;
+				}
+			}
+			else if(stringStartsWith(*nextArg, "--profile-rate=", suffix))
+			{
+				char* end = nullptr;
+				const unsigned long long samplesPerSecond = strtoull(suffix, &end, 10);
+				if(!*suffix || *end || !samplesPerSecond || samplesPerSecond > 1000000)
+				{
+					Log::printf(Log::error, "Invalid profile rate: %s\n", suffix);
+					return false;
+				}
+				profileSamplesPerSecond = Uptr(samplesPerSecond);
+			}
 			else if(stringStartsWith(*nextArg, "--wasi-trace=", suffix))
 			{
 				if(wasiTraceLavel != WASI::SyscallTraceLevel::none)
@@ -406,6 +534,8 @@ struct State
 			codeKey = Hash<U64>()(WAVM_VERSION_MAJOR, codeKey);
 			codeKey = Hash<U64>()(WAVM_VERSION_MINOR, codeKey);
 			codeKey = Hash<U64>()(WAVM_VERSION_PATCH, codeKey);
+			codeKey = Hash<U64>()(featureSpec.preciseMemoryTraps, codeKey);
+			codeKey = Hash<U64>()(featureSpec.explicitStackLimitChecks, codeKey);
 
 			// Initialize the object cache.
 			std::shared_ptr<Runtime::ObjectCacheInterface> objectCache;
@@ -506,7 +636,33 @@ struct State
 											  sandboxFS.get(),
 											  Platform::getStdFD(Platform::StdDevice::in),
 											  Platform::getStdFD(Platform::StdDevice::out),
-											  Platform::getStdFD(Platform::StdDevice::err));
+											  Platform::getStdFD(Platform::StdDevice::err),
+											  wasiStdioConfig);
+
+			// Create the listening sockets, and add them to the WASI process after the preopened
+			// directories.
+			for(std::string& listenAddress : listenAddresses)
+			{
+				VFS::VFD* socketVFD = nullptr;
+				const VFS::Result result = Platform::listenOnSocket(listenAddress, socketVFD);
+				if(result != VFS::Result::success)
+				{
+					Log::printf(Log::error,
+								"Couldn't listen on %s: %s\n",
+								listenAddress.c_str(),
+								VFS::describeResult(result));
+					return false;
+				}
+
+				const U32 fd = WASI::addProcessListeningSocket(
+					*wasiProcess, socketVFD, std::string(listenAddress));
+				Log::printf(Log::debug, "Listening on %s as fd %u\n", listenAddress.c_str(), fd);
+			}
+		}
+		else if(listenAddresses.size())
+		{
+			Log::printf(Log::error, "--listen may only be used with the WASI ABI.\n");
+			return false;
 		}
 		else if(abi == ABI::bare)
 		{
@@ -540,6 +696,19 @@ struct State
 		// Create a WASM execution context.
 		Context* context = Runtime::createContext(compartment);
 
+		// If a maximum stack size was specified, limit the stack to that many bytes below the
+		// current stack pointer.
+		if(maxStackBytes)
+		{
+			U8 stackMarker = 0;
+			const Uptr stackAddress = reinterpret_cast<Uptr>(&stackMarker);
+			setContextStackLimit(
+				context,
+				reinterpret_cast<const void*>(stackAddress > maxStackBytes
+												  ? stackAddress - maxStackBytes
+												  : 1));
+		}
+
 		// Call the module start function, if it has one.
 		Function* startFunction = getStartFunction(instance);
 		if(startFunction) { invokeFunction(context, startFunction); }
@@ -657,20 +826,17 @@ struct State
 		// Parse the command line.
 		if(!parseCommandLineAndEnvironment(argv)) { return EXIT_FAILURE; }
 
-		// Read the specified file into a byte array.
-		std::vector<U8> fileBytes;
-		if(!loadFile(filename, fileBytes)) { return EXIT_FAILURE; }
+		// Map the specified file into memory, or read it into a byte array if it can't be mapped.
+		SharedBytes fileBytes;
+		if(!mapOrLoadFile(filename, fileBytes)) { return EXIT_FAILURE; }
 
-		// Load the module from the byte array
+		// Load the module from the file's bytes.
 		Runtime::ModuleRef module = nullptr;
 		if(precompiled)
 		{
-			if(!loadPrecompiledModule(std::move(fileBytes), featureSpec, module))
-			{
-				return EXIT_FAILURE;
-			}
+			if(!loadPrecompiledModule(fileBytes, featureSpec, module)) { return EXIT_FAILURE; }
 		}
-		else if(!loadTextOrBinaryModule(filename, std::move(fileBytes), featureSpec, module))
+		else if(!loadTextOrBinaryModule(filename, fileBytes, featureSpec, module))
 		{
 			return EXIT_FAILURE;
 		}
@@ -718,6 +884,13 @@ struct State
 			WASI::setProcessMemory(*wasiProcess, memory);
 		}
 
+		// Start profiling the program.
+		if(profilePath && !startProfiling(profileSamplesPerSecond))
+		{
+			Log::printf(Log::error, "Profiling isn't supported on this platform.\n");
+			return EXIT_FAILURE;
+		}
+
 		// Execute the program.
 		Timing::Timer executionTimer;
 		auto executeThunk = [&] { return execute(irModule, instance); };
@@ -729,6 +902,13 @@ struct State
 		}
 		Timing::logTimer("Executed program", executionTimer);
 
+		// Write the profile while the program's code is still loaded.
+		if(profilePath)
+		{
+			const std::vector<U8> profile = stopProfiling(profileFormat);
+			if(!saveFile(profilePath, profile.data(), profile.size())) { return EXIT_FAILURE; }
+		}
+
 		// Log the peak memory usage.
 		Uptr peakMemoryUsage = Platform::getPeakMemoryUsageBytes();
 		Log::printf(
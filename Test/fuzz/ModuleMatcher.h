@@ -34,7 +34,7 @@ namespace WAVM {
 				if(segment.isActive
 				   && (segment.memoryIndex != wastSegment.memoryIndex
 					   || segment.baseOffset != wastSegment.baseOffset
-					   || *segment.data != *wastSegment.data))
+					   || segment.data != wastSegment.data))
 				{
 					failVerification();
 				}
@@ -173,11 +173,18 @@ namespace WAVM {
 		void verifyMatches(BranchTableImm a, BranchTableImm b)
 		{
 			if(a.defaultTargetDepth != b.defaultTargetDepth
-			   || aFunction->branchTables[a.branchTableIndex]
-					  != bFunction->branchTables[b.branchTableIndex])
+			   || a.numTargetDepths != b.numTargetDepths)
 			{
 				failVerification();
 			}
+			for(Uptr index = 0; index < a.numTargetDepths; ++index)
+			{
+				if(aFunction->branchTableTargetDepths[a.firstTargetDepthIndex + index]
+				   != bFunction->branchTableTargetDepths[b.firstTargetDepthIndex + index])
+				{
+					failVerification();
+				}
+			}
 		}
 
 		template<typename Value> void verifyMatches(LiteralImm<Value> a, LiteralImm<Value> b)
@@ -279,37 +286,28 @@ namespace WAVM {
 			verifyMatches(a.type, b.type);
 			if(a.nonParameterLocalTypes != b.nonParameterLocalTypes) { failVerification(); }
 
-			if(a.code.size() != b.code.size()) { failVerification(); }
-
 			const U8* aNextByte = a.code.data();
 			const U8* bNextByte = b.code.data();
 			const U8* aEnd = a.code.data() + a.code.size();
 			const U8* bEnd = b.code.data() + b.code.size();
 
+			// The operators' encodings may have different sizes even if they match (e.g. if their
+			// type indices are different), so compare the decoded operators.
 			while(aNextByte < aEnd && bNextByte < bEnd)
 			{
-				WAVM_ASSERT(aNextByte + sizeof(Opcode) <= aEnd);
-				WAVM_ASSERT(bNextByte + sizeof(Opcode) <= bEnd);
-
-				Opcode aOpcode;
-				Opcode bOpcode;
-				memcpy(&aOpcode, aNextByte, sizeof(Opcode));
-				memcpy(&bOpcode, bNextByte, sizeof(Opcode));
+				const Opcode aOpcode = decodeOpcode(aNextByte);
+				const Opcode bOpcode = decodeOpcode(bNextByte);
 				if(aOpcode != bOpcode) { failVerification(); }
 
 				switch(aOpcode)
 				{
 #define VISIT_OPCODE(opcode, name, nameString, Imm, ...)                                           \
 	case Opcode::name: {                                                                           \
-		WAVM_ASSERT(aNextByte + sizeof(OpcodeAndImm<Imm>) <= aEnd);                                \
-		WAVM_ASSERT(bNextByte + sizeof(OpcodeAndImm<Imm>) <= bEnd);                                \
-		OpcodeAndImm<Imm> aEncodedOperator;                                                        \
-		OpcodeAndImm<Imm> bEncodedOperator;                                                        \
-		memcpy(&aEncodedOperator, aNextByte, sizeof(OpcodeAndImm<Imm>));                           \
-		memcpy(&bEncodedOperator, bNextByte, sizeof(OpcodeAndImm<Imm>));                           \
-		aNextByte += sizeof(OpcodeAndImm<Imm>);                                                    \
-		bNextByte += sizeof(OpcodeAndImm<Imm>);                                                    \
-		verifyMatches(aEncodedOperator.imm, bEncodedOperator.imm);                                 \
+		Imm aImm;                                                                                  \
+		Imm bImm;                                                                                  \
+		decodeImm(aNextByte, aImm);                                                                \
+		decodeImm(bNextByte, bImm);                                                                \
+		verifyMatches(aImm, bImm);                                                                 \
 		break;                                                                                     \
 	}
 					WAVM_ENUM_OPERATORS(VISIT_OPCODE)
@@ -317,8 +315,7 @@ namespace WAVM {
 				default: WAVM_UNREACHABLE();
 				}
 			}
-			WAVM_ASSERT(aNextByte == aEnd);
-			WAVM_ASSERT(bNextByte == bEnd);
+			if(aNextByte != aEnd || bNextByte != bEnd) { failVerification(); }
 
 			aFunction = nullptr;
 			bFunction = nullptr;
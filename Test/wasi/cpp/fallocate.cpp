@@ -0,0 +1,33 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+int main(int argc, char** argv)
+{
+	if(argc != 3)
+	{
+		fprintf(stderr, "Usage: %s <file> <num bytes>\n", argv[0]);
+		return 1;
+	}
+
+	int fd = open(argv[1], O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if(fd < 0)
+	{
+		fprintf(stderr, "Failed to open '%s': %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	// posix_fallocate returns the error code instead of setting errno.
+	const int error = posix_fallocate(fd, 0, (off_t)strtoull(argv[2], nullptr, 10));
+	if(error)
+	{
+		fprintf(stderr, "Failed to allocate '%s': %s\n", argv[1], strerror(error));
+		return 1;
+	}
+
+	close(fd);
+	return 0;
+}
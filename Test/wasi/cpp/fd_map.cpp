@@ -0,0 +1,67 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// The WAVM extension for mapping a file into memory.
+__attribute__((import_module("wavm_wasi_file_mapping"), import_name("fd_map"))) uint16_t
+fd_map(uint32_t fd, uint64_t offset, uint32_t address, uint32_t numBytes);
+
+static const size_t numBytesPerPage = 65536;
+
+int main(int argc, char** argv)
+{
+	if(argc != 2)
+	{
+		fprintf(stderr, "Usage: %s <input file>\n", argv[0]);
+		return 1;
+	}
+
+	int fd = open(argv[1], O_RDONLY);
+	if(fd == -1)
+	{
+		fprintf(stderr, "Failed to open '%s' for reading: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	// Fill a page-aligned buffer with garbage, and map the file over it.
+	char* buffer = (char*)aligned_alloc(numBytesPerPage, numBytesPerPage);
+	memset(buffer, 'x', numBytesPerPage);
+	const uint16_t error = fd_map(fd, 0, (uint32_t)(uintptr_t)buffer, numBytesPerPage);
+	if(error)
+	{
+		fprintf(stderr, "Failed to map '%s': %s\n", argv[1], strerror(error));
+		return 1;
+	}
+
+	// The bytes past the end of the file should be zero, so the buffer is a terminated string.
+	printf("fd_map: %s\n", buffer);
+	if(buffer[numBytesPerPage - 1])
+	{
+		fprintf(stderr, "The bytes past the end of the file weren't zeroed.\n");
+		return 1;
+	}
+
+	// Writing to the mapped buffer shouldn't change the file.
+	const char firstChar = buffer[0];
+	buffer[0] = 'x';
+	char fileChar = 0;
+	if(pread(fd, &fileChar, 1, 0) != 1 || fileChar != firstChar)
+	{
+		fprintf(stderr, "Writing to the mapped buffer changed the file.\n");
+		return 1;
+	}
+
+	// Unaligned ranges should be rejected.
+	if(fd_map(fd, 1, (uint32_t)(uintptr_t)buffer, numBytesPerPage) != EINVAL)
+	{
+		fprintf(stderr, "fd_map didn't reject an unaligned file offset.\n");
+		return 1;
+	}
+
+	close(fd);
+	return 0;
+}
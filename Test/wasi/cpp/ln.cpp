@@ -0,0 +1,29 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+int main(int argc, char** argv)
+{
+	const bool symbolic = argc == 4 && !strcmp(argv[1], "-s");
+	if(argc != 3 && !symbolic)
+	{
+		fprintf(stderr, "Usage: %s [-s] <target> <link>\n", argv[0]);
+		return 1;
+	}
+
+	const char* targetPath = argv[argc - 2];
+	const char* linkPath = argv[argc - 1];
+	if(symbolic ? symlink(targetPath, linkPath) : link(targetPath, linkPath))
+	{
+		fprintf(stderr,
+				"Failed to create %s link '%s' to '%s': %s\n",
+				symbolic ? "symbolic" : "hard",
+				linkPath,
+				targetPath,
+				strerror(errno));
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,24 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+int main(int argc, char** argv)
+{
+	if(argc != 2)
+	{
+		fprintf(stderr, "Usage: %s <link>\n", argv[0]);
+		return 1;
+	}
+
+	char buffer[1024];
+	const ssize_t numBytes = readlink(argv[1], buffer, sizeof(buffer));
+	if(numBytes < 0)
+	{
+		fprintf(stderr, "Failed to read link '%s': %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	printf("%.*s\n", int(numBytes), buffer);
+	return 0;
+}
@@ -0,0 +1,173 @@
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wasi/api.h>
+
+// The socket passed to the process by "wavm run --listen" is the first fd after stdio.
+static const __wasi_fd_t listenFD = 3;
+
+// Waits until an fd is readable.
+static bool waitUntilReadable(__wasi_fd_t fd)
+{
+	__wasi_subscription_t subscription;
+	memset(&subscription, 0, sizeof(subscription));
+	subscription.u.tag = __WASI_EVENTTYPE_FD_READ;
+	subscription.u.u.fd_read.file_descriptor = fd;
+
+	__wasi_event_t event;
+	__wasi_size_t numEvents = 0;
+	__wasi_errno_t error = __wasi_poll_oneoff(&subscription, &event, 1, &numEvents);
+	if(!error && numEvents == 1) { error = event.error; }
+	if(error)
+	{
+		fprintf(stderr, "poll_oneoff failed: %s\n", strerror(error));
+		return false;
+	}
+	return true;
+}
+
+static bool sendAll(__wasi_fd_t fd, const char* data)
+{
+	__wasi_size_t numBytes = (__wasi_size_t)strlen(data);
+	while(numBytes)
+	{
+		__wasi_ciovec_t iov = {(const uint8_t*)data, numBytes};
+		__wasi_size_t numBytesSent = 0;
+		__wasi_errno_t error = __wasi_sock_send(fd, &iov, 1, 0, &numBytesSent);
+		if(error)
+		{
+			fprintf(stderr, "sock_send failed: %s\n", strerror(error));
+			return false;
+		}
+		data += numBytesSent;
+		numBytes -= numBytesSent;
+	}
+	return true;
+}
+
+// Accepts a connection from a client that waits for "ready\n", then sends a message and shuts down
+// its side of the connection. Replies with "pong: " and the message.
+static int echo()
+{
+	if(!waitUntilReadable(listenFD)) { return 1; }
+
+	__wasi_fd_t connectionFD = 0;
+	__wasi_errno_t error = __wasi_sock_accept(listenFD, __WASI_FDFLAGS_NONBLOCK, &connectionFD);
+	if(error)
+	{
+		fprintf(stderr, "sock_accept failed: %s\n", strerror(error));
+		return 1;
+	}
+
+	// The client hasn't sent anything yet, so a receive should fail without writing the results.
+	char message[256];
+	const __wasi_size_t maxMessageLength = sizeof(message) - 1;
+	__wasi_iovec_t iov = {(uint8_t*)message, maxMessageLength};
+	__wasi_size_t numBytesReceived = 12345;
+	__wasi_roflags_t roFlags = 0x5555;
+	error = __wasi_sock_recv(connectionFD, &iov, 1, 0, &numBytesReceived, &roFlags);
+	printf("sock_recv: %s numBytesReceived=%u roFlags=0x%04x\n",
+		   error == __WASI_ERRNO_AGAIN ? "EAGAIN" : strerror(error),
+		   numBytesReceived,
+		   roFlags);
+
+	if(!sendAll(connectionFD, "ready\n")) { return 1; }
+
+	// Receive the message until the client shuts down its side of the connection.
+	__wasi_size_t messageLength = 0;
+	while(true)
+	{
+		if(!waitUntilReadable(connectionFD)) { return 1; }
+
+		iov = {(uint8_t*)message + messageLength, maxMessageLength - messageLength};
+		error = __wasi_sock_recv(connectionFD, &iov, 1, 0, &numBytesReceived, &roFlags);
+		if(error == __WASI_ERRNO_AGAIN) { continue; }
+		else if(error)
+		{
+			fprintf(stderr, "sock_recv failed: %s\n", strerror(error));
+			return 1;
+		}
+		else if(!numBytesReceived) { break; }
+		messageLength += numBytesReceived;
+	}
+	message[messageLength] = 0;
+	printf("received: %s\n", message);
+
+	if(!sendAll(connectionFD, "pong: ") || !sendAll(connectionFD, message)) { return 1; }
+
+	error = __wasi_fd_close(connectionFD);
+	if(error)
+	{
+		fprintf(stderr, "fd_close failed: %s\n", strerror(error));
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc == 2 && !strcmp(argv[1], "echo")) { return echo(); }
+	else if(argc != 1)
+	{
+		fprintf(stderr, "Usage: %s [echo]\n", argv[0]);
+		return 1;
+	}
+
+	__wasi_fdstat_t fdstat;
+	__wasi_errno_t error = __wasi_fd_fdstat_get(listenFD, &fdstat);
+	if(error)
+	{
+		fprintf(stderr, "fd_fdstat_get failed: %s\n", strerror(error));
+		return 1;
+	}
+	if(fdstat.fs_filetype != __WASI_FILETYPE_SOCKET_STREAM)
+	{
+		fprintf(stderr, "fd %u isn't a stream socket\n", listenFD);
+		return 1;
+	}
+
+	// The listening socket isn't reported as a preopened directory.
+	__wasi_prestat_t prestat;
+	if(__wasi_fd_prestat_get(listenFD, &prestat) != __WASI_ERRNO_BADF)
+	{
+		fprintf(stderr, "fd_prestat_get didn't return EBADF for the listening socket\n");
+		return 1;
+	}
+
+	// Nothing has connected to the socket, so a non-blocking accept should fail with EAGAIN.
+	__wasi_fd_t connectionFD = 0;
+	error = __wasi_sock_accept(listenFD, __WASI_FDFLAGS_NONBLOCK, &connectionFD);
+	printf("sock_accept: %s\n", error == __WASI_ERRNO_AGAIN ? "EAGAIN" : strerror(error));
+
+	// Wait for a connection with a 10ms timeout: only the clock subscription should fire.
+	__wasi_subscription_t subscriptions[2];
+	memset(subscriptions, 0, sizeof(subscriptions));
+	subscriptions[0].userdata = 1;
+	subscriptions[0].u.tag = __WASI_EVENTTYPE_FD_READ;
+	subscriptions[0].u.u.fd_read.file_descriptor = listenFD;
+	subscriptions[1].userdata = 2;
+	subscriptions[1].u.tag = __WASI_EVENTTYPE_CLOCK;
+	subscriptions[1].u.u.clock.id = __WASI_CLOCKID_MONOTONIC;
+	subscriptions[1].u.u.clock.timeout = 10000000;
+
+	__wasi_event_t events[2];
+	__wasi_size_t numEvents = 0;
+	error = __wasi_poll_oneoff(subscriptions, events, 2, &numEvents);
+	if(error)
+	{
+		fprintf(stderr, "poll_oneoff failed: %s\n", strerror(error));
+		return 1;
+	}
+	for(__wasi_size_t eventIndex = 0; eventIndex < numEvents; ++eventIndex)
+	{
+		printf("event %" PRIu64 ": error=%u\n",
+			   events[eventIndex].userdata,
+			   events[eventIndex].error);
+	}
+
+	return 0;
+}
@@ -0,0 +1,84 @@
+;; call_indirect through a table that always holds the elements it's initialized with may be
+;; compiled to a direct call. These tests check that such calls still behave like call_indirect.
+
+;; Constant element indices.
+
+(module
+  (type $i32 (func (result i32)))
+  (type $f32 (func (result f32)))
+  (table 4 funcref)
+  (elem (i32.const 0) $a $b $c)
+  (elem (i32.const 2) $a)
+  (func $a (type $i32) (i32.const 1))
+  (func $b (type $f32) (f32.const 2))
+  (func $c (type $i32) (i32.const 3))
+
+  (func (export "const-0") (result i32) (call_indirect (type $i32) (i32.const 0)))
+  (func (export "const-overwritten") (result i32) (call_indirect (type $i32) (i32.const 2)))
+  (func (export "const-mismatch") (result i32) (call_indirect (type $i32) (i32.const 1)))
+  (func (export "const-null") (result i32) (call_indirect (type $i32) (i32.const 3)))
+  (func (export "const-oob") (result i32) (call_indirect (type $i32) (i32.const 4)))
+)
+
+(assert_return (invoke "const-0") (i32.const 1))
+(assert_return (invoke "const-overwritten") (i32.const 1))
+(assert_trap (invoke "const-mismatch") "indirect call type mismatch")
+(assert_trap (invoke "const-null") "uninitialized element")
+(assert_trap (invoke "const-oob") "undefined element")
+
+;; A table with a single function of the callee type.
+
+(module
+  (type $i32 (func (param i32) (result i32)))
+  (type $f32 (func (result f32)))
+  (table 3 funcref)
+  (elem (i32.const 0) $double $b)
+  (func $double (type $i32) (i32.add (local.get 0) (local.get 0)))
+  (func $b (type $f32) (f32.const 2))
+
+  (func (export "dynamic") (param i32 i32) (result i32)
+    (call_indirect (type $i32) (local.get 1) (local.get 0))
+  )
+)
+
+(assert_return (invoke "dynamic" (i32.const 0) (i32.const 21)) (i32.const 42))
+(assert_trap (invoke "dynamic" (i32.const 1) (i32.const 21)) "indirect call type mismatch")
+(assert_trap (invoke "dynamic" (i32.const 2) (i32.const 21)) "uninitialized element")
+(assert_trap (invoke "dynamic" (i32.const 3) (i32.const 21)) "undefined element")
+
+;; Tables that are written by table.set or exported can't be assumed to hold their initial
+;; elements.
+
+(module
+  (type $i32 (func (result i32)))
+  (table 2 funcref)
+  (elem (i32.const 0) $a)
+  (elem declare func $b)
+  (func $a (type $i32) (i32.const 1))
+  (func $b (type $i32) (i32.const 2))
+
+  (func (export "set") (table.set (i32.const 0) (ref.func $b)))
+  (func (export "const-0") (result i32) (call_indirect (type $i32) (i32.const 0)))
+)
+
+(assert_return (invoke "const-0") (i32.const 1))
+(invoke "set")
+(assert_return (invoke "const-0") (i32.const 2))
+
+(module $exporter
+  (type $i32 (func (result i32)))
+  (table (export "table") 1 funcref)
+  (elem (i32.const 0) $a)
+  (func $a (type $i32) (i32.const 1))
+  (func (export "const-0") (result i32) (call_indirect (type $i32) (i32.const 0)))
+)
+(register "exporter" $exporter)
+
+(module
+  (type $i32 (func (result i32)))
+  (table (import "exporter" "table") 1 funcref)
+  (elem (i32.const 0) $b)
+  (func $b (type $i32) (i32.const 2))
+)
+
+(assert_return (invoke $exporter "const-0") (i32.const 2))
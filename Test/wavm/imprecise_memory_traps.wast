@@ -0,0 +1,67 @@
+;; Tests that are also run with --imprecise-memory-traps, which allows the accesses to unshared
+;; memories to be optimized. Out-of-bounds accesses whose results are used must still trap, and
+;; accesses to shared memories must stay volatile.
+
+;; Unshared memory: loads whose results are used, and stores, still trap when out of bounds.
+
+(module
+	(memory 1)
+
+	(func (export "i32.load") (param $address i32) (result i32)
+		(i32.load (local.get $address)))
+	(func (export "i64.load") (param $address i32) (result i64)
+		(i64.load (local.get $address)))
+	(func (export "i32.store") (param $address i32) (param $value i32)
+		(i32.store (local.get $address) (local.get $value)))
+
+	;; Stores to the same address, and returns the value loaded from it.
+	(func (export "storeTwiceThenLoad") (param $address i32) (result i32)
+		(i32.store (local.get $address) (i32.const 1))
+		(i32.store (local.get $address) (i32.const 2))
+		(i32.load (local.get $address)))
+)
+
+(assert_return (invoke "storeTwiceThenLoad" (i32.const 0)) (i32.const 2))
+(assert_return (invoke "i32.load" (i32.const 0)) (i32.const 2))
+(assert_return (invoke "i32.load" (i32.const 65532)) (i32.const 0))
+(assert_trap (invoke "i32.load" (i32.const 65533)) "out of bounds memory access")
+(assert_trap (invoke "i32.load" (i32.const -1)) "out of bounds memory access")
+(assert_trap (invoke "i64.load" (i32.const 65529)) "out of bounds memory access")
+(assert_trap (invoke "i32.store" (i32.const 65536) (i32.const 0)) "out of bounds memory access")
+(assert_trap (invoke "storeTwiceThenLoad" (i32.const 65536)) "out of bounds memory access")
+
+;; Shared memory: accesses stay volatile, so a load whose result is unused still traps, and a loop
+;; that spins on an ordinary load sees a store from another thread.
+
+(module
+	(import "threadTest" "createThread" (func $threadTest.createThread (param funcref i32) (result i64)))
+	(import "threadTest" "joinThread" (func $threadTest.joinThread (param i64) (result i64)))
+
+	(memory 1 1 shared)
+
+	(elem declare $setFlagThreadEntry)
+
+	(func (export "dropLoad") (param $address i32)
+		(drop (i32.load (local.get $address))))
+
+	;; Thread entry: sets the flag at address 16 with an ordinary store.
+	(func $setFlagThreadEntry (param $argument i32) (result i64)
+		(i32.store (i32.const 16) (i32.const 1))
+		(i64.const 0))
+
+	(func (export "spinOnLoad") (result i64)
+		(local $thread i64)
+		(i32.store (i32.const 16) (i32.const 0))
+		(local.set $thread
+			(call $threadTest.createThread (ref.func $setFlagThreadEntry) (i32.const 0)))
+		;; If the load were hoisted out of the loop, this would never terminate.
+		(block $break
+			(loop $spin
+				(br_if $break (i32.load (i32.const 16)))
+				(br $spin)))
+		(call $threadTest.joinThread (local.get $thread)))
+)
+
+(assert_return (invoke "dropLoad" (i32.const 0)))
+(assert_trap (invoke "dropLoad" (i32.const 65536)) "out of bounds memory access")
+(assert_return (invoke "spinOnLoad") (i64.const 0))
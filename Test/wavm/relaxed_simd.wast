@@ -0,0 +1,360 @@
+;; Relaxed SIMD. Each relaxed operator may return one of several results for some inputs, so the
+;; tests of those inputs accept any of the results the proposal allows.
+
+;; i8x16.relaxed_swizzle
+
+(module
+  (func (export "i8x16.relaxed_swizzle") (param v128 v128) (result v128)
+    (i8x16.relaxed_swizzle (local.get 0) (local.get 1)))
+)
+
+(assert_return
+  (invoke "i8x16.relaxed_swizzle"
+    (v128.const i8x16 0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15)
+    (v128.const i8x16 15 14 13 12 11 10 9 8 7 6 5 4 3 2 1 0))
+  (v128.const i8x16 15 14 13 12 11 10 9 8 7 6 5 4 3 2 1 0))
+
+(assert_return
+  (invoke "i8x16.relaxed_swizzle"
+    (v128.const i8x16 0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15)
+    (v128.const i8x16 16 17 18 19 -128 -127 -1 -2 0 0 0 0 0 0 0 0))
+  (either (v128.const i8x16 0 1 2 3 0 0 0 0 0 0 0 0 0 0 0 0)
+          (v128.const i8x16 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0)))
+
+;; i32x4.relaxed_trunc_*
+
+(module
+  (func (export "i32x4.relaxed_trunc_f32x4_s") (param v128) (result v128)
+    (i32x4.relaxed_trunc_f32x4_s (local.get 0)))
+  (func (export "i32x4.relaxed_trunc_f32x4_u") (param v128) (result v128)
+    (i32x4.relaxed_trunc_f32x4_u (local.get 0)))
+  (func (export "i32x4.relaxed_trunc_f64x2_s_zero") (param v128) (result v128)
+    (i32x4.relaxed_trunc_f64x2_s_zero (local.get 0)))
+  (func (export "i32x4.relaxed_trunc_f64x2_u_zero") (param v128) (result v128)
+    (i32x4.relaxed_trunc_f64x2_u_zero (local.get 0)))
+)
+
+(assert_return
+  (invoke "i32x4.relaxed_trunc_f32x4_s" (v128.const f32x4 -1.5 0.0 1.5 -2147483648.0))
+  (v128.const i32x4 -1 0 1 -2147483648))
+
+(assert_return
+  (invoke "i32x4.relaxed_trunc_f32x4_s" (v128.const f32x4 nan 2147483648.0 -inf 7.9))
+  (either (v128.const i32x4 0 2147483647 -2147483648 7)
+          (v128.const i32x4 -2147483648 -2147483648 -2147483648 7)))
+
+(assert_return
+  (invoke "i32x4.relaxed_trunc_f32x4_u" (v128.const f32x4 0.0 1.5 4294967040.0 7.9))
+  (v128.const i32x4 0 1 4294967040 7))
+
+(assert_return
+  (invoke "i32x4.relaxed_trunc_f32x4_u" (v128.const f32x4 nan -1.0 4294967296.0 +inf))
+  (either (v128.const i32x4 0 0 0xffffffff 0xffffffff)
+          (v128.const i32x4 0xffffffff 0xffffffff 0xffffffff 0xffffffff)))
+
+(assert_return
+  (invoke "i32x4.relaxed_trunc_f64x2_s_zero" (v128.const f64x2 -2147483648.0 2147483647.9))
+  (v128.const i32x4 -2147483648 2147483647 0 0))
+
+(assert_return
+  (invoke "i32x4.relaxed_trunc_f64x2_s_zero" (v128.const f64x2 nan 2147483648.0))
+  (either (v128.const i32x4 0 2147483647 0 0)
+          (v128.const i32x4 -2147483648 -2147483648 0 0)))
+
+(assert_return
+  (invoke "i32x4.relaxed_trunc_f64x2_u_zero" (v128.const f64x2 0.0 4294967295.9))
+  (v128.const i32x4 0 4294967295 0 0))
+
+(assert_return
+  (invoke "i32x4.relaxed_trunc_f64x2_u_zero" (v128.const f64x2 nan 4294967296.0))
+  (either (v128.const i32x4 0 0xffffffff 0 0)
+          (v128.const i32x4 0xffffffff 0xffffffff 0 0)))
+
+;; f32x4.relaxed_madd, f32x4.relaxed_nmadd, f64x2.relaxed_madd, f64x2.relaxed_nmadd
+
+(module
+  (func (export "f32x4.relaxed_madd") (param v128 v128 v128) (result v128)
+    (f32x4.relaxed_madd (local.get 0) (local.get 1) (local.get 2)))
+  (func (export "f32x4.relaxed_nmadd") (param v128 v128 v128) (result v128)
+    (f32x4.relaxed_nmadd (local.get 0) (local.get 1) (local.get 2)))
+  (func (export "f64x2.relaxed_madd") (param v128 v128 v128) (result v128)
+    (f64x2.relaxed_madd (local.get 0) (local.get 1) (local.get 2)))
+  (func (export "f64x2.relaxed_nmadd") (param v128 v128 v128) (result v128)
+    (f64x2.relaxed_nmadd (local.get 0) (local.get 1) (local.get 2)))
+)
+
+(assert_return
+  (invoke "f32x4.relaxed_madd"
+    (v128.const f32x4 2.0 3.0 -4.0 0.5)
+    (v128.const f32x4 5.0 -6.0 7.0 8.0)
+    (v128.const f32x4 1.0 1.0 1.0 1.0))
+  (v128.const f32x4 11.0 -17.0 -27.0 5.0))
+
+(assert_return
+  (invoke "f32x4.relaxed_nmadd"
+    (v128.const f32x4 2.0 3.0 -4.0 0.5)
+    (v128.const f32x4 5.0 -6.0 7.0 8.0)
+    (v128.const f32x4 1.0 1.0 1.0 1.0))
+  (v128.const f32x4 -9.0 19.0 29.0 -3.0))
+
+;; (1 + 2^-23) * (1 - 2^-23) - 1 is -2^-46 if the multiply-add is fused, and 0 if the product is
+;; rounded to 1 first.
+(assert_return
+  (invoke "f32x4.relaxed_madd"
+    (v128.const f32x4 0x1.000002p+0 0x1.000002p+0 0x1.000002p+0 0x1.000002p+0)
+    (v128.const f32x4 0x1.fffffcp-1 0x1.fffffcp-1 0x1.fffffcp-1 0x1.fffffcp-1)
+    (v128.const f32x4 -1.0 -1.0 -1.0 -1.0))
+  (either (v128.const f32x4 -0x1p-46 -0x1p-46 -0x1p-46 -0x1p-46)
+          (v128.const f32x4 0.0 0.0 0.0 0.0)))
+
+(assert_return
+  (invoke "f32x4.relaxed_nmadd"
+    (v128.const f32x4 0x1.000002p+0 0x1.000002p+0 0x1.000002p+0 0x1.000002p+0)
+    (v128.const f32x4 0x1.fffffcp-1 0x1.fffffcp-1 0x1.fffffcp-1 0x1.fffffcp-1)
+    (v128.const f32x4 1.0 1.0 1.0 1.0))
+  (either (v128.const f32x4 0x1p-46 0x1p-46 0x1p-46 0x1p-46)
+          (v128.const f32x4 0.0 0.0 0.0 0.0)))
+
+(assert_return
+  (invoke "f64x2.relaxed_madd"
+    (v128.const f64x2 2.0 -4.0)
+    (v128.const f64x2 5.0 7.0)
+    (v128.const f64x2 1.0 1.0))
+  (v128.const f64x2 11.0 -27.0))
+
+(assert_return
+  (invoke "f64x2.relaxed_nmadd"
+    (v128.const f64x2 2.0 -4.0)
+    (v128.const f64x2 5.0 7.0)
+    (v128.const f64x2 1.0 1.0))
+  (v128.const f64x2 -9.0 29.0))
+
+(assert_return
+  (invoke "f64x2.relaxed_madd"
+    (v128.const f64x2 0x1.0000000000001p+0 0x1.0000000000001p+0)
+    (v128.const f64x2 0x1.ffffffffffffep-1 0x1.ffffffffffffep-1)
+    (v128.const f64x2 -1.0 -1.0))
+  (either (v128.const f64x2 -0x1p-104 -0x1p-104)
+          (v128.const f64x2 0.0 0.0)))
+
+;; *.relaxed_laneselect
+
+(module
+  (func (export "i8x16.relaxed_laneselect") (param v128 v128 v128) (result v128)
+    (i8x16.relaxed_laneselect (local.get 0) (local.get 1) (local.get 2)))
+  (func (export "i16x8.relaxed_laneselect") (param v128 v128 v128) (result v128)
+    (i16x8.relaxed_laneselect (local.get 0) (local.get 1) (local.get 2)))
+  (func (export "i32x4.relaxed_laneselect") (param v128 v128 v128) (result v128)
+    (i32x4.relaxed_laneselect (local.get 0) (local.get 1) (local.get 2)))
+  (func (export "i64x2.relaxed_laneselect") (param v128 v128 v128) (result v128)
+    (i64x2.relaxed_laneselect (local.get 0) (local.get 1) (local.get 2)))
+)
+
+(assert_return
+  (invoke "i8x16.relaxed_laneselect"
+    (v128.const i8x16 0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15)
+    (v128.const i8x16 16 17 18 19 20 21 22 23 24 25 26 27 28 29 30 31)
+    (v128.const i8x16 -1 0 -1 0 0 -1 0 -1 -1 -1 0 0 0 0 -1 -1))
+  (v128.const i8x16 0 17 2 19 20 5 22 7 8 9 26 27 28 29 14 15))
+
+(assert_return
+  (invoke "i8x16.relaxed_laneselect"
+    (v128.const i8x16 18 18 18 18 18 18 18 18 18 18 18 18 18 18 18 18)
+    (v128.const i8x16 52 52 52 52 52 52 52 52 52 52 52 52 52 52 52 52)
+    (v128.const i8x16 -16 -16 -16 -16 15 15 15 15 -16 -16 -16 -16 15 15 15 15))
+  (either (v128.const i8x16 20 20 20 20 50 50 50 50 20 20 20 20 50 50 50 50)
+          (v128.const i8x16 18 18 18 18 52 52 52 52 18 18 18 18 52 52 52 52)))
+
+(assert_return
+  (invoke "i16x8.relaxed_laneselect"
+    (v128.const i16x8 0 1 2 3 4 5 6 7)
+    (v128.const i16x8 8 9 10 11 12 13 14 15)
+    (v128.const i16x8 -1 0 -1 0 0 -1 0 -1))
+  (v128.const i16x8 0 9 2 11 12 5 14 7))
+
+(assert_return
+  (invoke "i16x8.relaxed_laneselect"
+    (v128.const i16x8 0x1234 0x1234 0x1234 0x1234 0x1234 0x1234 0x1234 0x1234)
+    (v128.const i16x8 0x5678 0x5678 0x5678 0x5678 0x5678 0x5678 0x5678 0x5678)
+    (v128.const i16x8 0xff00 0xff00 0xff00 0xff00 0x00ff 0x00ff 0x00ff 0x00ff))
+  (either (v128.const i16x8 0x1278 0x1278 0x1278 0x1278 0x5634 0x5634 0x5634 0x5634)
+          (v128.const i16x8 0x1234 0x1234 0x1234 0x1234 0x5678 0x5678 0x5678 0x5678)))
+
+(assert_return
+  (invoke "i32x4.relaxed_laneselect"
+    (v128.const i32x4 0 1 2 3)
+    (v128.const i32x4 4 5 6 7)
+    (v128.const i32x4 -1 0 0 -1))
+  (v128.const i32x4 0 5 6 3))
+
+(assert_return
+  (invoke "i32x4.relaxed_laneselect"
+    (v128.const i32x4 0x12345678 0x12345678 0x12345678 0x12345678)
+    (v128.const i32x4 0x9abcdef0 0x9abcdef0 0x9abcdef0 0x9abcdef0)
+    (v128.const i32x4 0xffff0000 0xffff0000 0x0000ffff 0x0000ffff))
+  (either (v128.const i32x4 0x1234def0 0x1234def0 0x9abc5678 0x9abc5678)
+          (v128.const i32x4 0x12345678 0x12345678 0x9abcdef0 0x9abcdef0)))
+
+(assert_return
+  (invoke "i64x2.relaxed_laneselect"
+    (v128.const i64x2 0 1)
+    (v128.const i64x2 2 3)
+    (v128.const i64x2 0 -1))
+  (v128.const i64x2 2 1))
+
+(assert_return
+  (invoke "i64x2.relaxed_laneselect"
+    (v128.const i64x2 0x123456789abcdef0 0x123456789abcdef0)
+    (v128.const i64x2 0xfedcba9876543210 0xfedcba9876543210)
+    (v128.const i64x2 0xffffffff00000000 0x00000000ffffffff))
+  (either (v128.const i64x2 0x1234567876543210 0xfedcba989abcdef0)
+          (v128.const i64x2 0x123456789abcdef0 0xfedcba9876543210)))
+
+;; f32x4.relaxed_min, f32x4.relaxed_max, f64x2.relaxed_min, f64x2.relaxed_max
+
+(module
+  (func (export "f32x4.relaxed_min") (param v128 v128) (result v128)
+    (f32x4.relaxed_min (local.get 0) (local.get 1)))
+  (func (export "f32x4.relaxed_max") (param v128 v128) (result v128)
+    (f32x4.relaxed_max (local.get 0) (local.get 1)))
+  (func (export "f64x2.relaxed_min") (param v128 v128) (result v128)
+    (f64x2.relaxed_min (local.get 0) (local.get 1)))
+  (func (export "f64x2.relaxed_max") (param v128 v128) (result v128)
+    (f64x2.relaxed_max (local.get 0) (local.get 1)))
+)
+
+(assert_return
+  (invoke "f32x4.relaxed_min"
+    (v128.const f32x4 1.0 -2.0 3.0 -inf)
+    (v128.const f32x4 2.0 -1.0 -3.0 +inf))
+  (v128.const f32x4 1.0 -2.0 -3.0 -inf))
+
+(assert_return
+  (invoke "f32x4.relaxed_max"
+    (v128.const f32x4 1.0 -2.0 3.0 -inf)
+    (v128.const f32x4 2.0 -1.0 -3.0 +inf))
+  (v128.const f32x4 2.0 -1.0 3.0 +inf))
+
+(assert_return
+  (invoke "f32x4.relaxed_min"
+    (v128.const f32x4 nan 0.0 -0.0 1.0)
+    (v128.const f32x4 1.0 -0.0 0.0 nan))
+  (either (v128.const f32x4 nan:canonical -0.0 -0.0 nan:canonical)
+          (v128.const f32x4 nan:canonical -0.0 -0.0 1.0)
+          (v128.const f32x4 1.0 -0.0 0.0 nan:canonical)
+          (v128.const f32x4 1.0 0.0 -0.0 nan:canonical)
+          (v128.const f32x4 1.0 -0.0 0.0 1.0)
+          (v128.const f32x4 nan:canonical 0.0 -0.0 nan:canonical)))
+
+(assert_return
+  (invoke "f32x4.relaxed_max"
+    (v128.const f32x4 nan 0.0 -0.0 1.0)
+    (v128.const f32x4 1.0 -0.0 0.0 nan))
+  (either (v128.const f32x4 nan:canonical 0.0 0.0 nan:canonical)
+          (v128.const f32x4 nan:canonical 0.0 0.0 1.0)
+          (v128.const f32x4 1.0 -0.0 0.0 nan:canonical)
+          (v128.const f32x4 1.0 0.0 -0.0 nan:canonical)
+          (v128.const f32x4 1.0 -0.0 0.0 1.0)
+          (v128.const f32x4 nan:canonical -0.0 0.0 nan:canonical)))
+
+(assert_return
+  (invoke "f64x2.relaxed_min" (v128.const f64x2 1.0 -3.0) (v128.const f64x2 2.0 3.0))
+  (v128.const f64x2 1.0 -3.0))
+
+(assert_return
+  (invoke "f64x2.relaxed_max" (v128.const f64x2 1.0 -3.0) (v128.const f64x2 2.0 3.0))
+  (v128.const f64x2 2.0 3.0))
+
+;; i16x8.relaxed_q15mulr_s
+
+(module
+  (func (export "i16x8.relaxed_q15mulr_s") (param v128 v128) (result v128)
+    (i16x8.relaxed_q15mulr_s (local.get 0) (local.get 1)))
+)
+
+(assert_return
+  (invoke "i16x8.relaxed_q15mulr_s"
+    (v128.const i16x8 16384 16384 -16384 32767 1 -1 0 100)
+    (v128.const i16x8 16384 -16384 -16384 32767 16384 16384 1234 -200))
+  (v128.const i16x8 8192 -8192 8192 32766 1 0 0 -1))
+
+(assert_return
+  (invoke "i16x8.relaxed_q15mulr_s"
+    (v128.const i16x8 -32768 -32768 -32768 -32768 -32768 -32768 -32768 -32768)
+    (v128.const i16x8 -32768 -32768 -32768 -32768 -32768 -32768 -32768 -32768))
+  (either (v128.const i16x8 32767 32767 32767 32767 32767 32767 32767 32767)
+          (v128.const i16x8 -32768 -32768 -32768 -32768 -32768 -32768 -32768 -32768)))
+
+;; i16x8.relaxed_dot_i8x16_i7x16_s, i32x4.relaxed_dot_i8x16_i7x16_add_s
+
+(module
+  (func (export "i16x8.relaxed_dot_i8x16_i7x16_s") (param v128 v128) (result v128)
+    (i16x8.relaxed_dot_i8x16_i7x16_s (local.get 0) (local.get 1)))
+  (func (export "i32x4.relaxed_dot_i8x16_i7x16_add_s") (param v128 v128 v128) (result v128)
+    (i32x4.relaxed_dot_i8x16_i7x16_add_s (local.get 0) (local.get 1) (local.get 2)))
+)
+
+(assert_return
+  (invoke "i16x8.relaxed_dot_i8x16_i7x16_s"
+    (v128.const i8x16 0 1 2 3 4 5 6 7 -1 -2 -3 -4 127 127 -128 -128)
+    (v128.const i8x16 0 1 2 3 4 5 6 7 1 2 3 4 127 127 127 127))
+  (v128.const i16x8 1 13 41 85 -5 -25 32258 -32512))
+
+(assert_return
+  (invoke "i16x8.relaxed_dot_i8x16_i7x16_s"
+    (v128.const i8x16 -128 -128 1 1 0 0 0 0 0 0 0 0 0 0 0 0)
+    (v128.const i8x16 -1 -1 -128 -128 0 0 0 0 0 0 0 0 0 0 0 0))
+  (either (v128.const i16x8 256 -256 0 0 0 0 0 0)
+          (v128.const i16x8 -32768 256 0 0 0 0 0 0)
+          (v128.const i16x8 256 256 0 0 0 0 0 0)))
+
+(assert_return
+  (invoke "i32x4.relaxed_dot_i8x16_i7x16_add_s"
+    (v128.const i8x16 0 1 2 3 4 5 6 7 -1 -2 -3 -4 -128 -128 -128 -128)
+    (v128.const i8x16 0 1 2 3 4 5 6 7 1 2 3 4 127 127 127 127)
+    (v128.const i32x4 1 2 3 4))
+  (v128.const i32x4 15 128 -27 -65020))
+
+(assert_return
+  (invoke "i32x4.relaxed_dot_i8x16_i7x16_add_s"
+    (v128.const i8x16 -128 -128 -128 -128 1 1 1 1 0 0 0 0 0 0 0 0)
+    (v128.const i8x16 -1 -1 -1 -1 -128 -128 -128 -128 0 0 0 0 0 0 0 0)
+    (v128.const i32x4 0 0 0 0))
+  (either (v128.const i32x4 512 -512 0 0)
+          (v128.const i32x4 -130560 512 0 0)
+          (v128.const i32x4 -65536 512 0 0)
+          (v128.const i32x4 512 512 0 0)))
+
+;; The relaxed SIMD opcodes are encoded as the SIMD prefix followed by an index that doesn't fit in
+;; a byte.
+
+(module binary
+  "\00asm" "\01\00\00\00"
+  "\01\07\01"                                 ;; type section
+  "\60\02\7b\7b\01\7b"                        ;; (func (param v128 v128) (result v128))
+  "\03\02\01\00"                              ;; function section
+  "\07\0f\01"                                 ;; export section
+  "\0brelaxed_max" "\00\00"                   ;; (export "relaxed_max" (func 0))
+  "\0a\0b\01"                                 ;; code section
+  "\09\00"                                    ;; function 0, no locals
+  "\20\00" "\20\01"                           ;; local.get 0, local.get 1
+  "\fd\8e\02"                                 ;; f32x4.relaxed_max
+  "\0b"                                       ;; end
+)
+
+(assert_return
+  (invoke "relaxed_max" (v128.const f32x4 1.0 -2.0 3.0 -4.0) (v128.const f32x4 2.0 -1.0 -3.0 4.0))
+  (v128.const f32x4 2.0 -1.0 3.0 4.0))
+
+(assert_malformed
+  (module binary
+    "\00asm" "\01\00\00\00"
+    "\01\04\01\60\00\00"                      ;; type section: (func)
+    "\03\02\01\00"                            ;; function section
+    "\0a\07\01"                               ;; code section
+    "\05\00"                                  ;; function 0, no locals
+    "\fd\ff\03"                               ;; an unknown SIMD opcode (0x1ff)
+    "\0b"                                     ;; end
+  )
+  "unknown opcode"
+)
@@ -657,6 +657,26 @@
   (invoke "i32x4.trunc_sat_f32x4_s" (f32.const nan:0x444444))
   (v128.const i32x4 0 0 0 0))
 
+(assert_return
+  (invoke "i32x4.trunc_sat_f32x4_s" (f32.const 2147483520.0))
+  (v128.const i32x4 2147483520 2147483520 2147483520 2147483520))
+
+(assert_return
+  (invoke "i32x4.trunc_sat_f32x4_s" (f32.const 2147483648.0))
+  (v128.const i32x4 2147483647 2147483647 2147483647 2147483647))
+
+;; Lanes that saturate in different directions or are NaN must not affect each other.
+
+(module (func (export "i32x4.trunc_sat_f32x4_s") (param $a v128) (result v128) (i32x4.trunc_sat_f32x4_s (local.get $a))))
+
+(assert_return
+  (invoke "i32x4.trunc_sat_f32x4_s" (v128.const f32x4 nan 3e9 -3e9 -7.5))
+  (v128.const i32x4 0 2147483647 -2147483648 -7))
+
+(assert_return
+  (invoke "i32x4.trunc_sat_f32x4_s" (v128.const f32x4 42.9 -nan +inf -inf))
+  (v128.const i32x4 42 0 2147483647 -2147483648))
+
 ;; i32x4.trunc_sat_f32x4_u
 
 (module (func (export "i32x4.trunc_sat_f32x4_u") (param $a f32) (result v128) (i32x4.trunc_sat_f32x4_u (f32x4.splat (local.get $a)))))